@@ -0,0 +1,145 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "bench.h"
+#include "crypto_hal.h"
+#include "ulorawan_crypto.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_mac.h"
+
+//! The RFC 4493 key
+static const uint8_t key[16] = {
+    0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+//! The RFC 4493 message
+static const uint8_t message[64] = {
+    0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96,
+    0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+    0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C,
+    0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+    0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11,
+    0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+    0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17,
+    0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+};
+
+struct mic_context {
+    const uint8_t *frame;
+    size_t size;
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void aes_cmac(void *ctx)
+{
+    struct mic_context *context = ctx;
+    uint32_t cmac;
+
+    crypto_hal_aes_cmac(key, context->frame, context->size, &cmac);
+
+    bench_consume(cmac);
+}
+
+static void crypto_mic(void *ctx)
+{
+    struct mic_context *context = ctx;
+    uint32_t mic;
+
+    ulorawan_crypto_mic(key, 0, 0x01020304, 42, context->frame, context->size,
+                        &mic);
+
+    bench_consume(mic);
+}
+
+void test_bench_crypto_hal_aes_cmac()
+{
+    // Arrange
+    struct mic_context context = { message, sizeof(message) };
+    uint32_t cmac[3];
+    struct bench_result result;
+
+    // The timings are only meaningful with a correct implementation
+    TEST_ASSERT_EQUAL_HEX8(CRYPTO_HAL_ERR_NONE,
+                           crypto_hal_aes_cmac(key, message, 0, &cmac[0]));
+    TEST_ASSERT_EQUAL_HEX8(CRYPTO_HAL_ERR_NONE,
+                           crypto_hal_aes_cmac(key, message, 16, &cmac[1]));
+    TEST_ASSERT_EQUAL_HEX8(CRYPTO_HAL_ERR_NONE,
+                           crypto_hal_aes_cmac(key, message, 64, &cmac[2]));
+    TEST_ASSERT_EQUAL_HEX32(0x29691DBB, cmac[0]);
+    TEST_ASSERT_EQUAL_HEX32(0xB4160A07, cmac[1]);
+    TEST_ASSERT_EQUAL_HEX32(0xBFBEF051, cmac[2]);
+
+    // Act
+    bench_run("crypto_hal_aes_cmac_64", aes_cmac, &context, &result);
+
+    // Assert
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
+
+void test_bench_crypto_mic_min_frame()
+{
+    // Arrange
+    struct mic_context context = { message, 12 };
+    struct bench_result result;
+
+    // Act
+    bench_run("crypto_mic_12", crypto_mic, &context, &result);
+
+    // Assert
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
+
+void test_bench_crypto_mic_max_frame()
+{
+    // Arrange
+    uint8_t frame[ULORAWAN_MAC_BUF_SIZE - 4];
+    struct mic_context context = { frame, sizeof(frame) };
+    struct bench_result result;
+
+    for (size_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = message[i % sizeof(message)];
+    }
+
+    // Act
+    bench_run("crypto_mic_251", crypto_mic, &context, &result);
+
+    // Assert
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
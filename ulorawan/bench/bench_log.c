@@ -0,0 +1,105 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+// The deferred log is timed whether or not the project defines enable logging
+#ifndef LOG_HAL_ENABLED
+#define LOG_HAL_ENABLED
+#endif
+#define LOG_HAL_DEFERRED
+
+#include "unity.h"
+#include "bench.h"
+#include "log_hal.h"
+#include "log_hal_deferred.h"
+
+void setUp(void)
+{
+    log_hal_deferred_init();
+}
+
+void tearDown(void) {}
+
+// A record is written and read back so the ring never fills
+static void deferred_write(void *ctx)
+{
+    struct log_hal_record record;
+
+    (void)ctx;
+
+    log_hal_log_debug("IRQ flags:[0x%04X]", 0x02);
+    log_hal_deferred_read(&record);
+
+    bench_consume(record.args[0]);
+}
+
+static void deferred_format(void *ctx)
+{
+    const struct log_hal_record *record = ctx;
+    char text[64];
+
+    bench_consume((uint32_t)log_hal_deferred_format(record, text, sizeof(text)));
+}
+
+void test_bench_log_deferred_write()
+{
+    // Arrange
+    struct log_hal_deferred_stats stats;
+    struct bench_result result;
+
+    // Act
+    bench_run("log_deferred_write_read", deferred_write, NULL, &result);
+
+    // Assert
+    log_hal_deferred_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
+
+void test_bench_log_deferred_format()
+{
+    // Arrange
+    struct log_hal_record record;
+    struct bench_result result;
+
+    log_hal_log_debug("IRQ flags:[0x%04X]", 0x02);
+    TEST_ASSERT_EQUAL_INT32(LOG_HAL_DEFERRED_ERR_NONE,
+                            log_hal_deferred_read(&record));
+
+    // Act
+    bench_run("log_deferred_format", deferred_format, &record, &result);
+
+    // Assert
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
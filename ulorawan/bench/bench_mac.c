@@ -0,0 +1,144 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "bench.h"
+#include "ulorawan_mac.h"
+#include "ulorawan_mac_frame.h"
+
+//! A data frame header with three bytes of frame options
+static const uint8_t frame[] = {
+    0x40, 0x04, 0x03, 0x02, 0x01, 0x03, 0x2A, 0x00, 0x02, 0x30, 0x06
+};
+
+static const uint8_t payload[51] = { 0x01 };
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void read_fhdr(void *ctx)
+{
+    struct ulorawan_mac_frame_context *context = ctx;
+    struct ulorawan_mac_fhdr fhdr;
+
+    context->eof = 1;
+    ulorawan_mac_read_fhdr(context, &fhdr);
+
+    bench_consume(fhdr.dev_addr ^ fhdr.fcnt);
+}
+
+static void write_fhdr(void *ctx)
+{
+    struct ulorawan_mac_frame_context *context = ctx;
+    struct ulorawan_mac_fhdr fhdr = {
+        .dev_addr = 0x01020304, .fctrl.value = 0x03, .fcnt = 42,
+        .fopts = { 0x02, 0x30, 0x06 }
+    };
+
+    context->eof = 1;
+    ulorawan_mac_write_fhdr(context, &fhdr);
+
+    bench_consume((uint32_t)context->eof);
+}
+
+static void write_frame(void *ctx)
+{
+    struct ulorawan_mac_frame_context *context = ctx;
+    union ulorawan_mac_mhdr mhdr =
+        ULORAWAN_MHDR_INIT(FRAME_TYPE_DATA_UNCONFIRMED_UP, LORAWAN_MAJOR_R1);
+    struct ulorawan_mac_fhdr fhdr = {
+        .dev_addr = 0x01020304, .fctrl.value = 0x03, .fcnt = 42,
+        .fopts = { 0x02, 0x30, 0x06 }
+    };
+
+    context->eof = 0;
+    ulorawan_mac_write_mhdr(context, &mhdr);
+    ulorawan_mac_write_fhdr(context, &fhdr);
+    ulorawan_mac_write_fport(context, 1);
+    ulorawan_mac_write_frmpayload(context, payload, sizeof(payload));
+    ulorawan_mac_write_mic(context, 0xDEADBEEF);
+
+    bench_consume((uint32_t)context->eof);
+}
+
+void test_bench_mac_read_fhdr()
+{
+    // Arrange
+    struct ulorawan_mac_frame_context context;
+    struct ulorawan_mac_fhdr fhdr;
+    struct bench_result result;
+
+    memcpy(context.buf, frame, sizeof(frame));
+    context.eof = 1;
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_MAC_ERR_NONE,
+                           ulorawan_mac_read_fhdr(&context, &fhdr));
+    TEST_ASSERT_EQUAL_HEX32(0x01020304, fhdr.dev_addr);
+
+    // Act
+    bench_run("mac_read_fhdr", read_fhdr, &context, &result);
+
+    // Assert
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
+
+void test_bench_mac_write_fhdr()
+{
+    // Arrange
+    struct ulorawan_mac_frame_context context;
+    struct bench_result result;
+
+    // Act
+    bench_run("mac_write_fhdr", write_fhdr, &context, &result);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&frame[1], &context.buf[1], sizeof(frame) - 1);
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
+
+void test_bench_mac_write_frame()
+{
+    // Arrange
+    struct ulorawan_mac_frame_context context;
+    struct bench_result result;
+
+    // Act
+    bench_run("mac_write_frame_51", write_frame, &context, &result);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(frame, context.buf, sizeof(frame));
+    TEST_ASSERT_EQUAL(sizeof(frame) + 1 + sizeof(payload) + 4, context.eof);
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
@@ -0,0 +1,182 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "bench.h"
+#include "ulorawan.h"
+#include "ulorawan_events.h"
+#include "ulorawan_error_codes.h"
+
+// The modules are linked in to run the whole stack against the host hal
+#include "ulorawan_adr.h"
+#include "ulorawan_aggregate.h"
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_class_b.h"
+#include "ulorawan_class_c.h"
+#include "ulorawan_cmds.h"
+#include "ulorawan_crypto.h"
+#include "ulorawan_downlink.h"
+#include "ulorawan_duty_cycle.h"
+#include "ulorawan_energy.h"
+#include "ulorawan_fcnt.h"
+#include "ulorawan_frag.h"
+#include "ulorawan_irq.h"
+#include "ulorawan_latency.h"
+#include "ulorawan_lbt.h"
+#include "ulorawan_link_stats.h"
+#include "ulorawan_mac.h"
+#include "ulorawan_multicast.h"
+#include "ulorawan_region.h"
+#include "ulorawan_region_tables.h"
+#include "ulorawan_retrans.h"
+#include "ulorawan_snapshot.h"
+#include "ulorawan_store.h"
+#include "ulorawan_tx.h"
+#include "ulorawan_uplink.h"
+#include "ulorawan_uplink_queue.h"
+
+static const uint8_t payload[51] = { 0x01 };
+
+struct uplink_context {
+    struct ulorawan_session *session;
+    uint32_t failures;
+};
+
+void setUp(void)
+{
+    struct ulorawan_device_security security = { .type = ACTIVATION_ABP };
+
+    security.context.abp.dev_addr = 0x01020304;
+    memset(security.context.abp.nwk_s_key, 0x2B, ULORAWAN_NWK_S_KEY_SIZE);
+    memset(security.context.abp.app_s_key, 0x7E, ULORAWAN_APP_S_KEY_SIZE);
+
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE,
+                           ulorawan_init(DEVICE_CLASS_A, security));
+}
+
+void tearDown(void) {}
+
+// The stack is idle so the event is dequeued and rejected by the state
+// machine, timing the queue and dispatch alone
+static void radio_irq_task(void *ctx)
+{
+    (void)ctx;
+
+    ulorawan_radio_irq(RADIO_HAL_IRQ_RX_DONE);
+
+    bench_consume((uint32_t)ulorawan_task());
+}
+
+// The stack is returned to idle as if both receive windows closed empty
+static void close_rx_windows(struct ulorawan_session *const session)
+{
+    ulorawan_retrans_rx_done(session, false);
+    session->state = ULORAWAN_STATE_IDLE;
+}
+
+// The channel activity detection of listen before talk finds the channel
+// clear and the uplink is transmitted
+static int32_t clear_channel(void)
+{
+#ifdef ULORAWAN_LBT_ENABLED
+    ulorawan_radio_irq(RADIO_HAL_IRQ_CAD_DONE);
+
+    return ulorawan_task();
+#else
+    return ULORAWAN_ERR_NONE;
+#endif // ULORAWAN_LBT_ENABLED
+}
+
+// The uplink is queued, framed, encrypted and handed to the radio
+static void uplink(void *ctx)
+{
+    struct uplink_context *context = ctx;
+    struct ulorawan_session *session = context->session;
+
+    if (ulorawan_send_frame(1, payload, sizeof(payload), false) !=
+            ULORAWAN_ERR_NONE ||
+        ulorawan_task() != ULORAWAN_ERR_NONE ||
+        clear_channel() != ULORAWAN_ERR_NONE ||
+        session->state != ULORAWAN_STATE_TX) {
+        context->failures++;
+    }
+
+    bench_consume(session->uplink.buf[session->uplink.eof - 1]);
+    close_rx_windows(session);
+}
+
+void test_bench_ulorawan_radio_irq_task()
+{
+    // Arrange
+    struct bench_result result;
+
+    ulorawan_radio_irq(RADIO_HAL_IRQ_RX_DONE);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_STATE, ulorawan_task());
+
+    // Act
+    bench_run("ulorawan_radio_irq_task", radio_irq_task, NULL, &result);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, ulorawan_get_session()->state);
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
+
+void test_bench_ulorawan_uplink()
+{
+    // Arrange
+    struct ulorawan_session *session = ulorawan_get_session();
+    struct uplink_context context = { session, 0 };
+    struct bench_result result;
+    uint32_t fcnt_up = session->keys.fcnt_up;
+
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE,
+                           ulorawan_send_frame(1, payload, sizeof(payload),
+                                               false));
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, ulorawan_task());
+#ifdef ULORAWAN_LBT_ENABLED
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_CAD, session->state);
+#endif // ULORAWAN_LBT_ENABLED
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, clear_channel());
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_TX, session->state);
+    TEST_ASSERT_EQUAL(fcnt_up + 1, session->keys.fcnt_up);
+    close_rx_windows(session);
+
+    // Act
+    bench_run("ulorawan_uplink_51", uplink, &context, &result);
+
+    // Assert
+    TEST_ASSERT_EQUAL(0, context.failures);
+    TEST_ASSERT_TRUE(result.ns_median > 0);
+}
@@ -0,0 +1,166 @@
+/**
+ * \file
+ *
+ * \brief The benchmark timing harness implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "bench.h"
+
+//! The number of untimed operations run first
+#define WARMUP_ITERATIONS 1000
+
+static volatile uint32_t sink;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int compare(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+// The samples are sorted in place
+static double median(double *const samples, size_t count) {
+  qsort(samples, count, sizeof(double), compare);
+
+  return count % 2 ? samples[count / 2]
+                   : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+}
+
+static uint32_t calibrate(bench_fn fn, void *ctx) {
+  uint32_t iterations = 1;
+
+  for (;;) {
+    uint64_t start = now_ns();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+      fn(ctx);
+    }
+
+    if (now_ns() - start >= BENCH_SAMPLE_NS || iterations >= 0x40000000U) {
+      return iterations;
+    }
+
+    iterations *= 2;
+  }
+}
+
+static void report(FILE *const file, const char *const name,
+                   const struct bench_result *const result) {
+  fprintf(file,
+          "{\"bench\":\"%s\",\"iterations\":%u,\"samples\":%u,"
+          "\"ns_per_op\":{\"median\":%.2f,\"min\":%.2f,\"mad\":%.2f},"
+          "\"cycles_per_op\":",
+          name, (unsigned)result->iterations, (unsigned)BENCH_SAMPLES,
+          result->ns_median, result->ns_min, result->ns_mad);
+
+  if (result->cycles_median > 0) {
+    fprintf(file, "{\"median\":%.1f}}\n", result->cycles_median);
+  } else {
+    fprintf(file, "null}\n");
+  }
+}
+
+void bench_run(const char *const name, bench_fn fn, void *ctx,
+               struct bench_result *const result) {
+  double ns[BENCH_SAMPLES];
+  double cycles[BENCH_SAMPLES];
+  struct bench_result stats;
+  const char *path;
+
+  for (uint32_t i = 0; i < WARMUP_ITERATIONS; i++) {
+    fn(ctx);
+  }
+
+  stats.iterations = calibrate(fn, ctx);
+
+  for (size_t s = 0; s < BENCH_SAMPLES; s++) {
+    uint64_t start = now_ns();
+    uint64_t start_cycles = now_cycles();
+
+    for (uint32_t i = 0; i < stats.iterations; i++) {
+      fn(ctx);
+    }
+
+    cycles[s] = (double)(now_cycles() - start_cycles) / stats.iterations;
+    ns[s] = (double)(now_ns() - start) / stats.iterations;
+  }
+
+  stats.ns_median = median(ns, BENCH_SAMPLES);
+  stats.ns_min = ns[0];
+  stats.cycles_median = median(cycles, BENCH_SAMPLES);
+
+  for (size_t s = 0; s < BENCH_SAMPLES; s++) {
+    ns[s] = ns[s] > stats.ns_median ? ns[s] - stats.ns_median
+                                    : stats.ns_median - ns[s];
+  }
+  stats.ns_mad = median(ns, BENCH_SAMPLES);
+
+  report(stdout, name, &stats);
+
+  path = getenv("ULORAWAN_BENCH_JSON");
+  if (path != NULL) {
+    FILE *file = fopen(path, "a");
+
+    if (file != NULL) {
+      report(file, name, &stats);
+      fclose(file);
+    }
+  }
+
+  if (result != NULL) {
+    *result = stats;
+  }
+}
+
+void bench_consume(uint32_t value) { sink = value; }
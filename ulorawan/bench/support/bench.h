@@ -0,0 +1,97 @@
+/**
+ * \file
+ *
+ * \brief The benchmark timing harness
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+//! The number of timed samples of each benchmark
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 31
+#endif
+
+//! The minimum duration of a sample in ns, the iterations are scaled to it
+#ifndef BENCH_SAMPLE_NS
+#define BENCH_SAMPLE_NS 2000000
+#endif
+
+//! The operation timed by a benchmark
+typedef void (*bench_fn)(void *ctx);
+
+//! The statistics of a benchmark, per operation
+struct bench_result {
+  //! The number of operations in each sample
+  uint32_t iterations;
+  //! The median time in ns
+  double ns_median;
+  //! The minimum time in ns
+  double ns_min;
+  //! The median absolute deviation of the time in ns
+  double ns_mad;
+  //! The median number of cycles, 0 where there is no cycle counter
+  double cycles_median;
+};
+
+/**
+ * \brief Time an operation and report its statistics.
+ *
+ * The operation is warmed up and its iterations scaled so a sample lasts at
+ * least BENCH_SAMPLE_NS, then BENCH_SAMPLES samples are timed. The median and
+ * its absolute deviation are reported so a few samples preempted by the host
+ * do not skew the result. One JSON line is printed to stdout and appended to
+ * the file named by the ULORAWAN_BENCH_JSON environment variable, if set.
+ *
+ * \param[in] name The benchmark name.
+ * \param[in] fn The operation.
+ * \param[in] ctx The operation context.
+ * \param[out] result The statistics, may be NULL.
+ */
+void bench_run(const char *const name, bench_fn fn, void *ctx,
+               struct bench_result *const result);
+
+/**
+ * \brief Consume a value so the computation of it is not optimised out.
+ *
+ * \param[in] value The value.
+ */
+void bench_consume(uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H_ */
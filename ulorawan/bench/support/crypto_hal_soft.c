@@ -0,0 +1,214 @@
+/**
+ * \file
+ *
+ * \brief A software AES-128 crypto hal for the host benchmarks
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "crypto_hal.h"
+
+// A compact table based AES-128 so the MIC and payload encryption cost is
+// measured on the host. It is not hardened against timing side channels and
+// is not meant for a device port.
+
+//! The size of an AES block
+#define BLOCK_SIZE 16
+//! The number of AES-128 rounds
+#define ROUNDS 10
+
+static const uint8_t sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
+    0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+    0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
+    0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
+    0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+    0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
+    0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
+    0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+    0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
+    0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+    0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+    0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
+    0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
+    0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+    0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
+    0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
+    0xb0, 0x54, 0xbb, 0x16};
+
+static uint8_t xtime(uint8_t x) {
+  return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static void expand_key(const uint8_t *const key,
+                       uint8_t round_keys[(ROUNDS + 1) * BLOCK_SIZE]) {
+  uint8_t rcon = 0x01;
+
+  memcpy(round_keys, key, BLOCK_SIZE);
+
+  for (size_t i = BLOCK_SIZE; i < (ROUNDS + 1) * BLOCK_SIZE; i += 4) {
+    uint8_t t[4];
+
+    memcpy(t, &round_keys[i - 4], sizeof(t));
+
+    if (i % BLOCK_SIZE == 0) {
+      uint8_t first = t[0];
+
+      t[0] = sbox[t[1]] ^ rcon;
+      t[1] = sbox[t[2]];
+      t[2] = sbox[t[3]];
+      t[3] = sbox[first];
+      rcon = xtime(rcon);
+    }
+
+    for (size_t j = 0; j < 4; j++) {
+      round_keys[i + j] = round_keys[i - BLOCK_SIZE + j] ^ t[j];
+    }
+  }
+}
+
+static void encrypt_block(const uint8_t *const round_keys,
+                          const uint8_t *const in, uint8_t *const out) {
+  uint8_t state[BLOCK_SIZE];
+
+  for (size_t i = 0; i < BLOCK_SIZE; i++) {
+    state[i] = in[i] ^ round_keys[i];
+  }
+
+  for (size_t round = 1; round <= ROUNDS; round++) {
+    uint8_t t[BLOCK_SIZE];
+
+    // SubBytes and ShiftRows, the state is stored column by column
+    for (size_t c = 0; c < 4; c++) {
+      for (size_t r = 0; r < 4; r++) {
+        t[c * 4 + r] = sbox[state[((c + r) % 4) * 4 + r]];
+      }
+    }
+
+    if (round < ROUNDS) {
+      for (size_t c = 0; c < 4; c++) {
+        uint8_t *col = &t[c * 4];
+        uint8_t all = col[0] ^ col[1] ^ col[2] ^ col[3];
+        uint8_t first = col[0];
+
+        col[0] ^= all ^ xtime(col[0] ^ col[1]);
+        col[1] ^= all ^ xtime(col[1] ^ col[2]);
+        col[2] ^= all ^ xtime(col[2] ^ col[3]);
+        col[3] ^= all ^ xtime(col[3] ^ first);
+      }
+    }
+
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+      state[i] = t[i] ^ round_keys[round * BLOCK_SIZE + i];
+    }
+  }
+
+  memcpy(out, state, BLOCK_SIZE);
+}
+
+// Multiply by x in GF(2^128) to derive the CMAC sub keys
+static void shift_subkey(uint8_t *const key) {
+  uint8_t msb = key[0] & 0x80;
+
+  for (size_t i = 0; i < BLOCK_SIZE - 1; i++) {
+    key[i] = (uint8_t)((key[i] << 1) | (key[i + 1] >> 7));
+  }
+  key[BLOCK_SIZE - 1] = (uint8_t)(key[BLOCK_SIZE - 1] << 1);
+
+  if (msb) {
+    key[BLOCK_SIZE - 1] ^= 0x87;
+  }
+}
+
+int32_t crypto_hal_aes_cmac(const uint8_t *const key,
+                            const uint8_t *const payload, size_t size,
+                            uint32_t *const cmac) {
+  uint8_t round_keys[(ROUNDS + 1) * BLOCK_SIZE];
+  uint8_t subkey[BLOCK_SIZE] = {0};
+  uint8_t mac[BLOCK_SIZE] = {0};
+  uint8_t last[BLOCK_SIZE];
+  size_t blocks = size == 0 ? 1 : (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  size_t tail = size - (blocks - 1) * BLOCK_SIZE;
+
+  if (key == NULL || (payload == NULL && size != 0) || cmac == NULL) {
+    return CRYPTO_HAL_ERR_FAIL;
+  }
+
+  expand_key(key, round_keys);
+  encrypt_block(round_keys, subkey, subkey);
+  shift_subkey(subkey);
+
+  // An incomplete last block is padded and uses the second sub key
+  memset(last, 0, sizeof(last));
+  if (tail > 0) {
+    memcpy(last, &payload[size - tail], tail);
+  }
+  if (tail < BLOCK_SIZE) {
+    last[tail] = 0x80;
+    shift_subkey(subkey);
+  }
+
+  for (size_t b = 0; b < blocks - 1; b++) {
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+      mac[i] ^= payload[b * BLOCK_SIZE + i];
+    }
+    encrypt_block(round_keys, mac, mac);
+  }
+
+  for (size_t i = 0; i < BLOCK_SIZE; i++) {
+    mac[i] ^= last[i] ^ subkey[i];
+  }
+  encrypt_block(round_keys, mac, mac);
+
+  // The MIC is the first four bytes of the CMAC
+  *cmac = (uint32_t)mac[0] | (uint32_t)mac[1] << 8 | (uint32_t)mac[2] << 16 |
+          (uint32_t)mac[3] << 24;
+
+  return CRYPTO_HAL_ERR_NONE;
+}
+
+int32_t crypto_hal_aes_encrypt(const uint8_t *const key,
+                               const uint8_t *const in, uint8_t *const out) {
+  uint8_t round_keys[(ROUNDS + 1) * BLOCK_SIZE];
+
+  if (key == NULL || in == NULL || out == NULL) {
+    return CRYPTO_HAL_ERR_FAIL;
+  }
+
+  expand_key(key, round_keys);
+  encrypt_block(round_keys, in, out);
+
+  return CRYPTO_HAL_ERR_NONE;
+}
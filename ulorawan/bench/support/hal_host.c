@@ -0,0 +1,188 @@
+/**
+ * \file
+ *
+ * \brief The host hal of the benchmarks
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "nvm_hal.h"
+#include "radio_hal.h"
+#include "rand_hal.h"
+#include "timer_hal.h"
+
+// The hal calls return at once so the benchmarks time the stack alone. The
+// clock is frozen and the memory is a RAM image covering the fragmentation
+// and session store areas.
+
+//! The size of the memory image
+#define NVM_SIZE 0x24000UL
+
+static uint8_t memory[NVM_SIZE];
+static uint16_t join_nonce;
+
+// The project defines enable logging, the messages are dropped so they do not
+// dominate the timings
+void log_hal_log(enum log_hal_log_level level, const char *file, int line,
+                 const char *fmt, ...) {
+  (void)level;
+  (void)file;
+  (void)line;
+  (void)fmt;
+}
+
+int32_t radio_hal_configure() { return RADIO_HAL_ERR_NONE; }
+
+int32_t radio_hal_fifo_read(uint8_t *const buf, size_t *const len) {
+  (void)buf;
+  *len = 0;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t radio_hal_fifo_write(const uint8_t *const buf, size_t len) {
+  (void)buf;
+  (void)len;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t radio_hal_set_mode(enum RADIO_HAL_MODE mode) {
+  (void)mode;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t radio_hal_set_frequency(uint32_t frequency) {
+  (void)frequency;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t radio_hal_set_symbol_timeout(uint16_t symbols) {
+  (void)symbols;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t radio_hal_set_tx_config(const struct radio_hal_tx_config *const config) {
+  (void)config;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t radio_hal_set_rx_config(const struct radio_hal_rx_config *const config) {
+  (void)config;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t radio_hal_get_rx_status(struct radio_hal_rx_status *const status) {
+  status->rssi = 0;
+  status->snr = 0;
+
+  return RADIO_HAL_ERR_NONE;
+}
+
+int32_t timer_hal_start(enum timer_hal_timer timer, uint32_t interval) {
+  (void)timer;
+  (void)interval;
+
+  return TIMER_HAL_ERR_NONE;
+}
+
+int32_t timer_hal_stop(enum timer_hal_timer timer) {
+  (void)timer;
+
+  return TIMER_HAL_ERR_NONE;
+}
+
+uint32_t timer_hal_get_time() { return 0; }
+
+int32_t rand_hal_init() { return RAND_HAL_ERR_NONE; }
+
+int32_t rand_hal_get_random(uint32_t *const value) {
+  static uint32_t state = 0x2545F491U;
+
+  // xorshift32
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  *value = state;
+
+  return RAND_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_read_join_nonce(uint16_t *const nonce) {
+  *nonce = join_nonce;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_write_join_nonce(uint16_t nonce) {
+  join_nonce = nonce;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_read(uint32_t address, uint8_t *const buf, size_t size) {
+  if (address > NVM_SIZE || size > NVM_SIZE - address) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  memcpy(buf, &memory[address], size);
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_write(uint32_t address, const uint8_t *const buf,
+                      size_t size) {
+  if (address > NVM_SIZE || size > NVM_SIZE - address) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  // Programming only clears bits, like flash
+  for (size_t i = 0; i < size; i++) {
+    memory[address + i] &= buf[i];
+  }
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_erase(uint32_t address) {
+  if (address % NVM_HAL_SECTOR_SIZE != 0 || address >= NVM_SIZE) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  memset(&memory[address], 0xFF, NVM_HAL_SECTOR_SIZE);
+
+  return NVM_HAL_ERR_NONE;
+}
@@ -0,0 +1,89 @@
+/**
+ * \file
+ *
+ * \brief The host event queue of the benchmarks
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "osal_queue.h"
+#include "radio_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_events.h"
+
+// The stack creates a single queue, so a single static ring backs it
+
+//! The number of events the ring holds
+#define QUEUE_SIZE 16
+
+static struct ulorawan_event ring[QUEUE_SIZE];
+static uint32_t head;
+static uint32_t tail;
+
+int32_t osal_queue_create(const struct osal_queue *const queue) {
+  (void)queue;
+  head = 0;
+  tail = 0;
+
+  return OSAL_QUEUE_ERR_NONE;
+}
+
+bool osal_queue_empty(const struct osal_queue *const queue) {
+  (void)queue;
+
+  return head == tail;
+}
+
+int32_t osal_queue_receive(const struct osal_queue *const queue, void *data) {
+  (void)queue;
+
+  if (head == tail) {
+    return OSAL_QUEUE_ERR_FAIL;
+  }
+
+  memcpy(data, &ring[tail % QUEUE_SIZE], sizeof(struct ulorawan_event));
+  tail++;
+
+  return OSAL_QUEUE_ERR_NONE;
+}
+
+int32_t osal_queue_send(const struct osal_queue *const queue,
+                        void const *data) {
+  (void)queue;
+
+  if (head - tail == QUEUE_SIZE) {
+    return OSAL_QUEUE_ERR_FAIL;
+  }
+
+  memcpy(&ring[head % QUEUE_SIZE], data, sizeof(struct ulorawan_event));
+  head++;
+
+  return OSAL_QUEUE_ERR_NONE;
+}
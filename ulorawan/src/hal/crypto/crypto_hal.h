@@ -46,6 +46,20 @@ extern "C" {
 int32_t crypto_hal_aes_cmac(const uint8_t *const key, const uint8_t *const payload,
                             size_t size, uint32_t * const cmac);
 
+/**
+ * \brief Encrypt a single block with AES-128 in ECB mode.
+ *
+ * \param key The 16 byte key.
+ * \param in The 16 byte block to encrypt.
+ * \param out The 16 byte encrypted block.
+ *
+ * \return Operation status.
+ * \retval CRYPTO_HAL_ERR_NONE Operation done successfully.
+ * \retval CRYPTO_HAL_ERR_FAIL The block could not be encrypted.
+ */
+int32_t crypto_hal_aes_encrypt(const uint8_t *const key,
+                               const uint8_t *const in, uint8_t *const out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,116 @@
+/**
+ * \file
+ *
+ * \brief The log hardware abstraction layer
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef LOG_HAL_H_
+#define LOG_HAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+//! The log levels, in increasing severity
+enum log_hal_log_level {
+  LOG_HAL_TRACE,
+  LOG_HAL_DEBUG,
+  LOG_HAL_INFO,
+  LOG_HAL_WARN,
+  LOG_HAL_ERROR,
+  LOG_HAL_FATAL
+};
+
+//! The lowest level compiled in, the calls below it are removed entirely
+#ifndef LOG_HAL_LEVEL
+#define LOG_HAL_LEVEL 0
+#endif
+
+/**
+ * \brief Format and write a log message.
+ *
+ * \param[in] level The message level.
+ * \param[in] file The source file of the call.
+ * \param[in] line The source line of the call.
+ * \param[in] fmt The printf style format.
+ */
+void log_hal_log(enum log_hal_log_level level, const char *file, int line,
+                 const char *fmt, ...);
+
+#if defined(LOG_HAL_ENABLED) && defined(LOG_HAL_DEFERRED)
+#include "log_hal_deferred.h"
+#define LOG_HAL_CALL(level, ...) LOG_HAL_DEFERRED_CALL(level, __VA_ARGS__)
+#elif defined(LOG_HAL_ENABLED)
+#define LOG_HAL_CALL(level, ...)                                               \
+  log_hal_log(level, __FILE__, __LINE__, __VA_ARGS__)
+#endif
+
+#if defined(LOG_HAL_ENABLED) && LOG_HAL_LEVEL <= 0
+#define log_hal_log_trace(...) LOG_HAL_CALL(LOG_HAL_TRACE, __VA_ARGS__)
+#else
+#define log_hal_log_trace(...) ((void)0)
+#endif
+
+#if defined(LOG_HAL_ENABLED) && LOG_HAL_LEVEL <= 1
+#define log_hal_log_debug(...) LOG_HAL_CALL(LOG_HAL_DEBUG, __VA_ARGS__)
+#else
+#define log_hal_log_debug(...) ((void)0)
+#endif
+
+#if defined(LOG_HAL_ENABLED) && LOG_HAL_LEVEL <= 2
+#define log_hal_log_info(...) LOG_HAL_CALL(LOG_HAL_INFO, __VA_ARGS__)
+#else
+#define log_hal_log_info(...) ((void)0)
+#endif
+
+#if defined(LOG_HAL_ENABLED) && LOG_HAL_LEVEL <= 3
+#define log_hal_log_warn(...) LOG_HAL_CALL(LOG_HAL_WARN, __VA_ARGS__)
+#else
+#define log_hal_log_warn(...) ((void)0)
+#endif
+
+#if defined(LOG_HAL_ENABLED) && LOG_HAL_LEVEL <= 4
+#define log_hal_log_error(...) LOG_HAL_CALL(LOG_HAL_ERROR, __VA_ARGS__)
+#else
+#define log_hal_log_error(...) ((void)0)
+#endif
+
+#if defined(LOG_HAL_ENABLED) && LOG_HAL_LEVEL <= 5
+#define log_hal_log_fatal(...) LOG_HAL_CALL(LOG_HAL_FATAL, __VA_ARGS__)
+#else
+#define log_hal_log_fatal(...) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_HAL_H_ */
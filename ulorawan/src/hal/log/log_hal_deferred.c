@@ -0,0 +1,145 @@
+/**
+ * \file
+ *
+ * \brief The deferred binary log backend implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "log_hal_deferred.h"
+
+//! The mask of the ring position of a sequence number
+#define RING_MASK (LOG_HAL_DEFERRED_RING_SIZE - 1U)
+
+#if (LOG_HAL_DEFERRED_RING_SIZE & RING_MASK) != 0
+#error "LOG_HAL_DEFERRED_RING_SIZE must be a power of two"
+#endif
+
+// A slot is free for the writer of position n when its sequence is n, and
+// holds a record for the reader of position n when its sequence is n + 1.
+// Writers claim a position with a compare and swap so an interrupt can
+// write while a task is part way through a record.
+struct slot {
+  atomic_uint_fast32_t sequence;
+  struct log_hal_record record;
+};
+
+static struct slot ring[LOG_HAL_DEFERRED_RING_SIZE];
+static atomic_uint_fast32_t head;
+static uint_fast32_t tail;
+static atomic_uint_fast32_t written;
+static atomic_uint_fast32_t dropped;
+
+void log_hal_deferred_init(void) {
+  for (uint_fast32_t i = 0; i < LOG_HAL_DEFERRED_RING_SIZE; i++) {
+    atomic_store_explicit(&ring[i].sequence, i, memory_order_relaxed);
+  }
+
+  tail = 0;
+  atomic_store_explicit(&written, 0, memory_order_relaxed);
+  atomic_store_explicit(&dropped, 0, memory_order_relaxed);
+  atomic_store_explicit(&head, 0, memory_order_release);
+}
+
+void log_hal_deferred_write(uint8_t level, const char *fmt, uint8_t nargs,
+                            uint32_t a0, uint32_t a1, uint32_t a2,
+                            uint32_t a3) {
+  uint_fast32_t pos = atomic_load_explicit(&head, memory_order_relaxed);
+  struct slot *slot;
+
+  for (;;) {
+    slot = &ring[pos & RING_MASK];
+
+    uint_fast32_t sequence =
+        atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+    if (sequence == pos) {
+      // A failed swap reloads the position another writer moved it to
+      if (atomic_compare_exchange_weak_explicit(&head, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if ((int_fast32_t)(sequence - pos) < 0) {
+      atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+      return;
+    } else {
+      pos = atomic_load_explicit(&head, memory_order_relaxed);
+    }
+  }
+
+  slot->record.fmt = fmt;
+  slot->record.level = level;
+  slot->record.nargs = nargs;
+  slot->record.args[0] = a0;
+  slot->record.args[1] = a1;
+  slot->record.args[2] = a2;
+  slot->record.args[3] = a3;
+
+  atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+  atomic_fetch_add_explicit(&written, 1, memory_order_relaxed);
+}
+
+int32_t log_hal_deferred_read(struct log_hal_record *const record) {
+  struct slot *slot = &ring[tail & RING_MASK];
+
+  if (atomic_load_explicit(&slot->sequence, memory_order_acquire) !=
+      tail + 1) {
+    return LOG_HAL_DEFERRED_ERR_EMPTY;
+  }
+
+  *record = slot->record;
+
+  atomic_store_explicit(&slot->sequence, tail + LOG_HAL_DEFERRED_RING_SIZE,
+                        memory_order_release);
+  tail++;
+
+  return LOG_HAL_DEFERRED_ERR_NONE;
+}
+
+size_t log_hal_deferred_format(const struct log_hal_record *const record,
+                               char *const buf, size_t size) {
+  const uint32_t *args = record->args;
+  int length;
+
+  // Unused arguments are passed as zero and ignored by the format
+  length = snprintf(buf, size, record->fmt, args[0], args[1], args[2],
+                    args[3]);
+
+  return length < 0 ? 0 : (size_t)length;
+}
+
+void log_hal_deferred_get_stats(struct log_hal_deferred_stats *const stats) {
+  stats->written =
+      (uint32_t)atomic_load_explicit(&written, memory_order_relaxed);
+  stats->dropped =
+      (uint32_t)atomic_load_explicit(&dropped, memory_order_relaxed);
+}
@@ -0,0 +1,163 @@
+/**
+ * \file
+ *
+ * \brief The deferred binary log backend
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef LOG_HAL_DEFERRED_H_
+#define LOG_HAL_DEFERRED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//! No error occurred.
+#define LOG_HAL_DEFERRED_ERR_NONE 0
+//! The ring holds no record.
+#define LOG_HAL_DEFERRED_ERR_EMPTY -1
+
+//! The number of records the ring holds, a power of two
+#ifndef LOG_HAL_DEFERRED_RING_SIZE
+#define LOG_HAL_DEFERRED_RING_SIZE 64
+#endif
+
+//! The maximum number of arguments of a message
+#define LOG_HAL_DEFERRED_MAX_ARGS 4
+
+//! The section the formats are collected in
+#ifndef LOG_HAL_DEFERRED_SECTION
+#define LOG_HAL_DEFERRED_SECTION ".log_hal_fmt"
+#endif
+
+//! A message recorded unformatted
+struct log_hal_record {
+  //! The format, its address in the format section identifies it
+  const char *fmt;
+  //! The message level
+  uint8_t level;
+  //! The number of arguments
+  uint8_t nargs;
+  //! The arguments, the formats only take integers
+  uint32_t args[LOG_HAL_DEFERRED_MAX_ARGS];
+};
+
+//! The counters of the deferred log
+struct log_hal_deferred_stats {
+  //! The number of messages recorded
+  uint32_t written;
+  //! The number of messages dropped with the ring full
+  uint32_t dropped;
+};
+
+// The format is placed in its own section so the table of formats can be
+// extracted from the image to decode the records offline, or left out of
+// the flashed image altogether. The arguments are counted and padded to
+// LOG_HAL_DEFERRED_MAX_ARGS, a call with more does not compile.
+#define LOG_HAL_DEFERRED_NARGS(...)                                            \
+  LOG_HAL_DEFERRED_NTH(_, ##__VA_ARGS__, LOG_HAL_DEFERRED_TOO_MANY_ARGS, 4, 3, \
+                       2, 1, 0)
+#define LOG_HAL_DEFERRED_NTH(_, a, b, c, d, e, n, ...) n
+#define LOG_HAL_DEFERRED_ARGS(...)                                             \
+  LOG_HAL_DEFERRED_PAD(_, ##__VA_ARGS__, 0, 0, 0, 0)
+#define LOG_HAL_DEFERRED_PAD(_, a, b, c, d, ...)                               \
+  (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)
+
+#define LOG_HAL_DEFERRED_CALL(level, fmt, ...)                                 \
+  do {                                                                         \
+    static const char log_hal_fmt[]                                            \
+        __attribute__((section(LOG_HAL_DEFERRED_SECTION), used)) = fmt;        \
+    log_hal_deferred_write(level, log_hal_fmt,                                 \
+                           LOG_HAL_DEFERRED_NARGS(__VA_ARGS__),                \
+                           LOG_HAL_DEFERRED_ARGS(__VA_ARGS__));                \
+  } while (0)
+
+/**
+ * \brief Clear the ring and the counters, before the first message.
+ */
+void log_hal_deferred_init(void);
+
+/**
+ * \brief Record a message without formatting it.
+ *
+ * Safe to call from interrupts and tasks at once without a lock, a message
+ * is dropped and counted when the ring is full.
+ *
+ * \param[in] level The message level.
+ * \param[in] fmt The format, in the format section.
+ * \param[in] nargs The number of arguments.
+ * \param[in] a0 The first argument.
+ * \param[in] a1 The second argument.
+ * \param[in] a2 The third argument.
+ * \param[in] a3 The fourth argument.
+ */
+void log_hal_deferred_write(uint8_t level, const char *fmt, uint8_t nargs,
+                            uint32_t a0, uint32_t a1, uint32_t a2,
+                            uint32_t a3);
+
+/**
+ * \brief Take the oldest record from the ring.
+ *
+ * A single reader, such as a background task, drains the ring.
+ *
+ * \param[out] record The record.
+ *
+ * \return Operation status.
+ * \retval LOG_HAL_DEFERRED_ERR_EMPTY There is no record.
+ * \retval LOG_HAL_DEFERRED_ERR_NONE Operation executed successfully.
+ */
+int32_t log_hal_deferred_read(struct log_hal_record *const record);
+
+/**
+ * \brief Format a record into text.
+ *
+ * \param[in] record The record.
+ * \param[out] buf The text, truncated to the buffer.
+ * \param[in] size The buffer size.
+ *
+ * \return The length of the full text.
+ */
+size_t log_hal_deferred_format(const struct log_hal_record *const record,
+                               char *const buf, size_t size);
+
+/**
+ * \brief Get the counters of the deferred log.
+ *
+ * \param[out] stats The counters.
+ */
+void log_hal_deferred_get_stats(struct log_hal_deferred_stats *const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_HAL_DEFERRED_H_ */
@@ -0,0 +1,314 @@
+/**
+ * \file
+ *
+ * \brief File backed flash emulation of the NVM HAL for Linux hosts.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nvm_hal.h"
+#include "nvm_hal_linux.h"
+
+//! The magic number identifying a formatted file
+#define FILE_MAGIC 0x464D564EUL
+//! The size of the file header, the magic number and geometry
+#define FILE_HEADER_SIZE 16
+//! The size of the device header before the erase counters
+#define DEVICE_HEADER_SIZE 8
+
+//! The file header
+struct file_header {
+  //! The magic number
+  uint32_t magic;
+  //! The memory size of each device
+  uint32_t device_size;
+  //! The sector size
+  uint32_t sector_size;
+  //! The number of devices
+  uint16_t devices;
+  //! Padding
+  uint16_t reserved;
+};
+
+//! The header of a virtual device, followed by its erase counters and memory
+struct device_header {
+  //! The join nonce
+  uint16_t nonce;
+  //! Padding
+  uint16_t reserved;
+  //! The highest erase count of any sector
+  uint32_t max_erases;
+};
+
+//! The mapped file
+static struct {
+  //! The mapping, NULL when no file is open
+  uint8_t *map;
+  //! The size of the mapping
+  size_t size;
+  //! The memory size of each device
+  uint32_t device_size;
+  //! The number of devices
+  uint16_t devices;
+  //! The selected device
+  uint16_t device;
+  //! The access counters of each device
+  struct nvm_hal_linux_stats *stats;
+} nvm;
+
+static uint32_t sectors(void) { return nvm.device_size / NVM_HAL_SECTOR_SIZE; }
+
+static size_t device_stride(void) {
+  return DEVICE_HEADER_SIZE + sectors() * sizeof(uint32_t) + nvm.device_size;
+}
+
+static struct device_header *device_header(void) {
+  return (struct device_header *)&nvm.map[FILE_HEADER_SIZE +
+                                           nvm.device * device_stride()];
+}
+
+static uint32_t *erase_counts(void) {
+  return (uint32_t *)((uint8_t *)device_header() + DEVICE_HEADER_SIZE);
+}
+
+static uint8_t *memory(void) {
+  return (uint8_t *)erase_counts() + sectors() * sizeof(uint32_t);
+}
+
+static int32_t check_range(uint32_t address, size_t size) {
+  if (nvm.map == NULL || address > nvm.device_size ||
+      size > nvm.device_size - address) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  return NVM_HAL_ERR_NONE;
+}
+
+static void format(void) {
+  struct file_header *header = (struct file_header *)nvm.map;
+
+  for (nvm.device = 0; nvm.device < nvm.devices; nvm.device++) {
+    memset(device_header(), 0, DEVICE_HEADER_SIZE + sectors() * sizeof(uint32_t));
+    memset(memory(), 0xFF, nvm.device_size);
+  }
+
+  header->device_size = nvm.device_size;
+  header->sector_size = NVM_HAL_SECTOR_SIZE;
+  header->devices = nvm.devices;
+  header->reserved = 0;
+  header->magic = FILE_MAGIC;
+}
+
+int32_t nvm_hal_linux_open(const char *const path, uint32_t device_size,
+                           uint16_t devices) {
+  struct stat st;
+  int fd;
+
+  if (nvm.map != NULL || device_size == 0 ||
+      device_size % NVM_HAL_SECTOR_SIZE != 0 || devices == 0) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  nvm.device_size = device_size;
+  nvm.devices = devices;
+  nvm.size = FILE_HEADER_SIZE + devices * device_stride();
+
+  fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  if (fstat(fd, &st) != 0 ||
+      ((size_t)st.st_size < nvm.size && ftruncate(fd, (off_t)nvm.size) != 0)) {
+    close(fd);
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  void *map = mmap(NULL, nvm.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  // The mapping stays valid once the descriptor is closed
+  close(fd);
+
+  if (map == MAP_FAILED) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  nvm.stats = calloc(devices, sizeof(struct nvm_hal_linux_stats));
+  if (nvm.stats == NULL) {
+    munmap(map, nvm.size);
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  nvm.map = map;
+
+  const struct file_header *header = (const struct file_header *)nvm.map;
+
+  if (header->magic != FILE_MAGIC || header->device_size != device_size ||
+      header->sector_size != NVM_HAL_SECTOR_SIZE ||
+      header->devices != devices) {
+    format();
+  }
+
+  nvm.device = 0;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_linux_select(uint16_t device) {
+  if (nvm.map == NULL || device >= nvm.devices) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  nvm.device = device;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+uint32_t nvm_hal_linux_erase_count(uint32_t sector) {
+  if (nvm.map == NULL || sector >= sectors()) {
+    return 0;
+  }
+
+  return erase_counts()[sector];
+}
+
+int32_t nvm_hal_linux_get_stats(struct nvm_hal_linux_stats *const stats) {
+  if (nvm.map == NULL) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  *stats = nvm.stats[nvm.device];
+  stats->erases = 0;
+
+  for (uint32_t sector = 0; sector < sectors(); sector++) {
+    stats->erases += erase_counts()[sector];
+  }
+
+  stats->max_sector_erases = device_header()->max_erases;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_linux_close(void) {
+  int32_t result = NVM_HAL_ERR_NONE;
+
+  if (nvm.map == NULL) {
+    return NVM_HAL_ERR_NONE;
+  }
+
+  if (msync(nvm.map, nvm.size, MS_SYNC) != 0) {
+    result = NVM_HAL_ERR_FAIL;
+  }
+
+  munmap(nvm.map, nvm.size);
+  free(nvm.stats);
+  memset(&nvm, 0, sizeof(nvm));
+
+  return result;
+}
+
+int32_t nvm_hal_read_join_nonce(uint16_t *const nonce) {
+  if (nvm.map == NULL) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  *nonce = device_header()->nonce;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_write_join_nonce(uint16_t nonce) {
+  if (nvm.map == NULL) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  device_header()->nonce = nonce;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_read(uint32_t address, uint8_t *const buf, size_t size) {
+  if (check_range(address, size) != NVM_HAL_ERR_NONE) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  memcpy(buf, &memory()[address], size);
+  nvm.stats[nvm.device].reads++;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_write(uint32_t address, const uint8_t *const buf,
+                      size_t size) {
+  if (check_range(address, size) != NVM_HAL_ERR_NONE) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  uint8_t *cell = &memory()[address];
+
+  // Programming only clears bits, setting one needs an erase
+  for (size_t i = 0; i < size; i++) {
+    if ((buf[i] & ~cell[i]) != 0) {
+      nvm.stats[nvm.device].program_errors++;
+      return NVM_HAL_ERR_FAIL;
+    }
+  }
+
+  for (size_t i = 0; i < size; i++) {
+    cell[i] &= buf[i];
+  }
+
+  nvm.stats[nvm.device].writes++;
+  nvm.stats[nvm.device].bytes_written += size;
+
+  return NVM_HAL_ERR_NONE;
+}
+
+int32_t nvm_hal_erase(uint32_t address) {
+  if (check_range(address, NVM_HAL_SECTOR_SIZE) != NVM_HAL_ERR_NONE ||
+      address % NVM_HAL_SECTOR_SIZE != 0) {
+    return NVM_HAL_ERR_FAIL;
+  }
+
+  uint32_t *count = &erase_counts()[address / NVM_HAL_SECTOR_SIZE];
+
+  memset(&memory()[address], 0xFF, NVM_HAL_SECTOR_SIZE);
+
+  if (++*count > device_header()->max_erases) {
+    device_header()->max_erases = *count;
+  }
+
+  return NVM_HAL_ERR_NONE;
+}
@@ -0,0 +1,125 @@
+/**
+ * \file
+ *
+ * \brief File backed flash emulation of the NVM HAL for Linux hosts.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef NVM_HAL_LINUX_H_
+#define NVM_HAL_LINUX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "nvm_hal.h"
+
+//! The access counters of a virtual device
+struct nvm_hal_linux_stats {
+  //! The number of reads
+  uint32_t reads;
+  //! The number of writes
+  uint32_t writes;
+  //! The number of bytes written
+  uint64_t bytes_written;
+  //! The number of writes refused because they set a bit erased to 0
+  uint32_t program_errors;
+  //! The number of sectors erased, persisted in the file
+  uint64_t erases;
+  //! The highest erase count of any sector, persisted in the file
+  uint32_t max_sector_erases;
+};
+
+/**
+ * \brief Map a file holding the memory of one or more virtual devices.
+ *
+ * A new file, or one created with another geometry, is formatted with the
+ * memory erased and the erase counters cleared. Each device has its own
+ * memory, join nonce and erase counters, the nvm_hal calls address the
+ * selected device, the first one after opening.
+ *
+ * \param[in] path The file path.
+ * \param[in] device_size The memory size of each device, a multiple of
+ * NVM_HAL_SECTOR_SIZE.
+ * \param[in] devices The number of devices.
+ *
+ * \return Operation status.
+ * \retval NVM_HAL_ERR_FAIL The file could not be mapped or the geometry is
+ * invalid.
+ * \retval NVM_HAL_ERR_NONE Operation executed successfully.
+ */
+int32_t nvm_hal_linux_open(const char *const path, uint32_t device_size,
+                           uint16_t devices);
+
+/**
+ * \brief Select the virtual device the nvm_hal calls address.
+ *
+ * \param[in] device The device index.
+ *
+ * \return Operation status.
+ * \retval NVM_HAL_ERR_FAIL No file is open or the device does not exist.
+ * \retval NVM_HAL_ERR_NONE Operation executed successfully.
+ */
+int32_t nvm_hal_linux_select(uint16_t device);
+
+/**
+ * \brief Get the erase count of a sector of the selected device.
+ *
+ * \param[in] sector The sector index.
+ *
+ * \return The number of times the sector was erased.
+ */
+uint32_t nvm_hal_linux_erase_count(uint32_t sector);
+
+/**
+ * \brief Get the access counters of the selected device.
+ *
+ * \param[out] stats The counters.
+ *
+ * \return Operation status.
+ * \retval NVM_HAL_ERR_FAIL No file is open.
+ * \retval NVM_HAL_ERR_NONE Operation executed successfully.
+ */
+int32_t nvm_hal_linux_get_stats(struct nvm_hal_linux_stats *const stats);
+
+/**
+ * \brief Flush and unmap the file.
+ *
+ * \return Operation status.
+ * \retval NVM_HAL_ERR_FAIL The file could not be flushed.
+ * \retval NVM_HAL_ERR_NONE Operation executed successfully.
+ */
+int32_t nvm_hal_linux_close(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NVM_HAL_LINUX_H_ */
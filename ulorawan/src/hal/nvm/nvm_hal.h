@@ -38,6 +38,7 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
 //! No error occurred.
@@ -45,6 +46,11 @@ extern "C" {
 //! An error occurred reading nvm
 #define NVM_HAL_ERR_FAIL -1
 
+//! The size of an erasable sector
+#ifndef NVM_HAL_SECTOR_SIZE
+#define NVM_HAL_SECTOR_SIZE 4096
+#endif
+
 /**
  * \brief
  *
@@ -63,6 +69,41 @@ int32_t nvm_hal_read_join_nonce(uint16_t *const nonce);
  */
 int32_t nvm_hal_write_join_nonce(uint16_t nonce);
 
+/**
+ * \brief Read from non volatile memory.
+ *
+ * \param[in] address The address to read from.
+ * \param[out] buf The buffer to read into.
+ * \param[in] size The number of bytes to read.
+ *
+ * \return Operation status.
+ */
+int32_t nvm_hal_read(uint32_t address, uint8_t *const buf, size_t size);
+
+/**
+ * \brief Write to non volatile memory.
+ *
+ * The stack writes each byte at most once between erases, so the memory may
+ * be flash.
+ *
+ * \param[in] address The address to write to.
+ * \param[in] buf The data to write.
+ * \param[in] size The number of bytes to write.
+ *
+ * \return Operation status.
+ */
+int32_t nvm_hal_write(uint32_t address, const uint8_t *const buf, size_t size);
+
+/**
+ * \brief Erase a sector of non volatile memory, setting its bytes to 0xFF.
+ *
+ * \param[in] address The address of the sector, a multiple of
+ * NVM_HAL_SECTOR_SIZE.
+ *
+ * \return Operation status.
+ */
+int32_t nvm_hal_erase(uint32_t address);
+
 #ifdef __cplusplus
 }
 #endif
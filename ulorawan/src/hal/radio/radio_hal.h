@@ -71,7 +71,41 @@ enum radio_hal_irq_flags {
   //! Radio Tx complete.
   RADIO_HAL_IRQ_TX_DONE = 0x02,
   //! Radio Rx timed out.
-  RADIO_HAL_IRQ_RX_TIMEOUT = 0x04
+  RADIO_HAL_IRQ_RX_TIMEOUT = 0x04,
+  //! Radio channel activity detection complete.
+  RADIO_HAL_IRQ_CAD_DONE = 0x08,
+  //! Radio channel activity detected.
+  RADIO_HAL_IRQ_CAD_DETECTED = 0x10
+};
+
+//! The signal metrics of a received frame
+struct radio_hal_rx_status {
+  //! The received signal strength in dBm
+  int16_t rssi;
+  //! The signal to noise ratio in dB
+  int8_t snr;
+};
+
+//! The modulation and power of a transmission
+struct radio_hal_tx_config {
+  //! The modulation, an ulorawan_modulation value
+  uint8_t modulation;
+  //! The LoRa spread factor, an ulorawan_sf value
+  uint8_t sf;
+  //! The LoRa bandwidth, an ulorawan_bw value
+  uint8_t bw;
+  //! The EIRP in dBm
+  int8_t eirp;
+};
+
+//! The modulation of a reception
+struct radio_hal_rx_config {
+  //! The modulation, an ulorawan_modulation value
+  uint8_t modulation;
+  //! The LoRa spread factor, an ulorawan_sf value
+  uint8_t sf;
+  //! The LoRa bandwidth, an ulorawan_bw value
+  uint8_t bw;
 };
 
 int32_t radio_hal_configure();
@@ -82,6 +116,61 @@ int32_t radio_hal_fifo_write(const uint8_t *const buf, size_t len);
 
 int32_t radio_hal_set_mode(enum RADIO_HAL_MODE mode);
 
+/**
+ * \brief Set the radio carrier frequency.
+ *
+ * \param frequency The frequency in Hz.
+ *
+ * \return Operation status.
+ * \retval RADIO_HAL_ERR_NONE Operation done successfully.
+ * \retval RADIO_HAL_ERR_PARAM The frequency is not supported by the radio.
+ */
+int32_t radio_hal_set_frequency(uint32_t frequency);
+
+/**
+ * \brief Set the number of symbols a single reception waits for a preamble.
+ *
+ * \param symbols The number of symbols.
+ *
+ * \return Operation status.
+ * \retval RADIO_HAL_ERR_NONE Operation done successfully.
+ * \retval RADIO_HAL_ERR_PARAM The timeout is not supported by the radio.
+ */
+int32_t radio_hal_set_symbol_timeout(uint16_t symbols);
+
+/**
+ * \brief Set the modulation and power of the next transmissions.
+ *
+ * \param config The modulation and power.
+ *
+ * \return Operation status.
+ * \retval RADIO_HAL_ERR_NONE Operation done successfully.
+ * \retval RADIO_HAL_ERR_PARAM The configuration is not supported by the radio.
+ */
+int32_t radio_hal_set_tx_config(const struct radio_hal_tx_config *const config);
+
+/**
+ * \brief Set the modulation of the next receptions.
+ *
+ * \param config The modulation.
+ *
+ * \return Operation status.
+ * \retval RADIO_HAL_ERR_NONE Operation done successfully.
+ * \retval RADIO_HAL_ERR_PARAM The configuration is not supported by the radio.
+ */
+int32_t radio_hal_set_rx_config(const struct radio_hal_rx_config *const config);
+
+/**
+ * \brief Get the signal metrics of the last received frame.
+ *
+ * \param status The signal metrics.
+ *
+ * \return Operation status.
+ * \retval RADIO_HAL_ERR_NONE Operation done successfully.
+ * \retval RADIO_HAL_ERR_PARAM No frame has been received.
+ */
+int32_t radio_hal_get_rx_status(struct radio_hal_rx_status *const status);
+
 #ifdef __cplusplus
 }
 #endif
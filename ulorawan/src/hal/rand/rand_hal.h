@@ -52,6 +52,16 @@ extern "C" {
  */
 int32_t rand_hal_init();
 
+/**
+ * \brief Get a random value from the rng.
+ *
+ * \param value The random value.
+ *
+ * \return Operation status.
+ * \retval RAND_HAL_ERR_NONE Operation done successfully.
+ */
+int32_t rand_hal_get_random(uint32_t *const value);
+
 #ifdef __cplusplus
 }
 #endif
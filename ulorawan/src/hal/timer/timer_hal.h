@@ -38,13 +38,16 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #define TIMER_HAL_ERR_NONE 0
 #define TIMER_HAL_ERR_FAIL -1
 
 enum timer_hal_timer
 {
     TIMER0,
-    TIMER1
+    TIMER1,
+    TIMER2
 };
 
 /**
@@ -66,6 +69,13 @@ int32_t timer_hal_start(enum timer_hal_timer timer, uint32_t interval);
  */
 int32_t timer_hal_stop(enum timer_hal_timer timer);
 
+/**
+ * \brief Get the current time.
+ *
+ * \return The free running time in milliseconds.
+ */
+uint32_t timer_hal_get_time();
+
 #ifdef __cplusplus
 }
 #endif
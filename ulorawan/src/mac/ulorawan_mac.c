@@ -71,8 +71,7 @@ int32_t ulorawan_mac_read_fhdr(struct ulorawan_mac_frame_context *const ctx,
 
 int32_t ulorawan_mac_read_fport(struct ulorawan_mac_frame_context *const ctx,
                                 uint8_t *const fport) {
-  if (ctx->eof <
-      sizeof(union ulorawan_mac_mhdr) + sizeof(struct ulorawan_mac_fhdr)) {
+  if (ctx->eof < sizeof(union ulorawan_mac_mhdr) + ULORAWAN_MAC_FHDR_MIN_SIZE) {
     return ULORAWAN_MAC_ERR_INDEX;
   }
 
@@ -84,8 +83,7 @@ int32_t ulorawan_mac_read_fport(struct ulorawan_mac_frame_context *const ctx,
 int32_t
 ulorawan_mac_read_frmpayload(struct ulorawan_mac_frame_context *const ctx,
                              uint8_t *const payload, size_t *const len) {
-  if (ctx->eof <
-      sizeof(union ulorawan_mac_mhdr) + sizeof(struct ulorawan_mac_fhdr)) {
+  if (ctx->eof < sizeof(union ulorawan_mac_mhdr) + ULORAWAN_MAC_FHDR_MIN_SIZE) {
     return ULORAWAN_MAC_ERR_INDEX;
   }
 
@@ -131,8 +129,7 @@ int32_t ulorawan_mac_write_fhdr(struct ulorawan_mac_frame_context *const ctx,
 
 int32_t ulorawan_mac_write_fport(struct ulorawan_mac_frame_context *const ctx,
                                  uint8_t fport) {
-  if (ctx->eof <
-      sizeof(union ulorawan_mac_mhdr) + sizeof(struct ulorawan_mac_fhdr)) {
+  if (ctx->eof < sizeof(union ulorawan_mac_mhdr) + ULORAWAN_MAC_FHDR_MIN_SIZE) {
     return ULORAWAN_MAC_ERR_INDEX;
   }
 
@@ -200,7 +200,7 @@ union __CROSS_ATTR_PACKED ulorawan_mac_redundancy {
  */
 struct __CROSS_ATTR_PACKED ulorawan_mac_link_adr_req {
   //! The data rate and tx power
-  union __CROSS_ATTR_PACKED tx_power {
+  union __CROSS_ATTR_PACKED {
     //! The value
     uint8_t value;
     struct __CROSS_ATTR_PACKED {
@@ -208,10 +208,12 @@ struct __CROSS_ATTR_PACKED ulorawan_mac_link_adr_req {
       uint8_t tx_power : 4;
       //! The data rate
       uint8_t data_rate : 4;
-    };
-    //! The channel mask
-    uint8_t ch_mask;
-  } bits;
+    } bits;
+  } dr_tx_power;
+  //! The channel mask
+  uint16_t ch_mask;
+  //! The redundancy
+  union ulorawan_mac_redundancy redundancy;
 };
 
 /**
@@ -377,16 +379,16 @@ struct __CROSS_ATTR_PACKED ulorawan_mac_tx_param_setup_req {
   union __CROSS_ATTR_PACKED {
     //! The value
     uint8_t value;
-    union __CROSS_ATTR_PACKED {
-      //! reserved
-      uint8_t rfu : 2;
-      //! The maximum downlink dwell time
-      uint8_t downlink_dwell_time : 1;
-      //! The maximum uplink dwell time
-      uint8_t uplink_dwell_time : 1;
+    struct __CROSS_ATTR_PACKED {
       //! The MaxEIRP value, the the maximum allowed end-device Effective
       //! Isotropic Radiated Power (EIRP)
-      uint8_t max_erip : 4;
+      uint8_t max_eirp : 4;
+      //! The maximum uplink dwell time
+      uint8_t uplink_dwell_time : 1;
+      //! The maximum downlink dwell time
+      uint8_t downlink_dwell_time : 1;
+      //! reserved
+      uint8_t rfu : 2;
     } bits;
   } eirp_dwell_time;
 };
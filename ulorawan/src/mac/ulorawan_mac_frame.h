@@ -44,6 +44,9 @@ extern "C" {
 //! FOpts maximum field size
 #define ULORAWAN_MAC_FHDR_F_OPTS_MAX_SIZE 15
 
+//! The size of a frame header without frame options
+#define ULORAWAN_MAC_FHDR_MIN_SIZE 7
+
 //! The size of the globally unique end-device identifier
 #define ULORAWAN_MAC_DEV_EUI_SIZE 8
 
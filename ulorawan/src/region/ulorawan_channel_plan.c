@@ -0,0 +1,562 @@
+/**
+ * \file
+ *
+ * \brief The uloraWan channel plan implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_region.h"
+
+//! The ChMaskCntl value that enables sub-bands of a fixed plan
+#define CHMASK_CNTL_SUB_BANDS 5
+//! The ChMaskCntl value that enables all 125 kHz or defined channels
+#define CHMASK_CNTL_ALL_ON 6
+//! The ChMaskCntl value that disables all 125 kHz channels of a fixed plan
+#define CHMASK_CNTL_ALL_OFF 7
+
+static uint8_t popcount(uint32_t value) {
+#if defined(__GNUC__)
+  return (uint8_t)__builtin_popcount(value);
+#else
+  value = value - ((value >> 1) & 0x55555555UL);
+  value = (value & 0x33333333UL) + ((value >> 2) & 0x33333333UL);
+  value = (value + (value >> 4)) & 0x0F0F0F0FUL;
+  return (uint8_t)((value * 0x01010101UL) >> 24);
+#endif
+}
+
+// Find the position of the nth (zero based) set bit of a word by halving the
+// word on popcounts, five steps regardless of the word contents.
+static uint8_t select_bit(uint32_t word, uint8_t n) {
+  uint8_t position = 0;
+
+  for (uint8_t width = 16; width > 0; width >>= 1) {
+    uint32_t low = word & ((1UL << width) - 1);
+    uint8_t count = popcount(low);
+
+    if (n >= count) {
+      n -= count;
+      word >>= width;
+      position += width;
+    } else {
+      word = low;
+    }
+  }
+
+  return position;
+}
+
+static inline void mask_set(struct ulorawan_channel_mask *const mask,
+                            uint8_t index) {
+  mask->words[index / 32] |= 1UL << (index % 32);
+}
+
+static inline void mask_clear(struct ulorawan_channel_mask *const mask,
+                              uint8_t index) {
+  mask->words[index / 32] &= ~(1UL << (index % 32));
+}
+
+static inline bool mask_test(const struct ulorawan_channel_mask *const mask,
+                             uint8_t index) {
+  return (mask->words[index / 32] & (1UL << (index % 32))) != 0;
+}
+
+static uint8_t find_band(const struct ulorawan_region_desc *const desc,
+                         uint32_t frequency) {
+  for (uint8_t i = 0; i < desc->band_count; i++) {
+    if (frequency >= desc->bands[i].min_frequency &&
+        frequency <= desc->bands[i].max_frequency) {
+      return i;
+    }
+  }
+
+  return 0;
+}
+
+// Add a defined channel to the data rate and band masks
+static void index_channel(struct ulorawan_channel_plan *const plan,
+                          const struct ulorawan_channel *const channel) {
+  for (uint8_t dr = channel->min_dr;
+       dr <= channel->max_dr && dr < ULORAWAN_CHANNEL_PLAN_MAX_DR; dr++) {
+    mask_set(&plan->dr_masks[dr], channel->index);
+  }
+
+  mask_set(&plan->band_masks[channel->band], channel->index);
+  mask_set(&plan->defined, channel->index);
+}
+
+// Remove a channel from every mask
+static void unindex_channel(struct ulorawan_channel_plan *const plan,
+                            uint8_t index) {
+  for (uint8_t dr = 0; dr < ULORAWAN_CHANNEL_PLAN_MAX_DR; dr++) {
+    mask_clear(&plan->dr_masks[dr], index);
+  }
+
+  for (uint8_t band = 0; band < ULORAWAN_CHANNEL_PLAN_MAX_BANDS; band++) {
+    mask_clear(&plan->band_masks[band], index);
+  }
+
+  mask_clear(&plan->defined, index);
+  mask_clear(&plan->enabled, index);
+}
+
+// Check for a fixed plan with a block of 125 kHz sub-bands and a block of
+// 500 kHz channels, one per sub-band
+static bool has_sub_bands(const struct ulorawan_channel_plan *const plan) {
+  return plan->desc->plan == CFLIST_TYPE_FIXED &&
+         plan->desc->channel_block_count > 1;
+}
+
+static uint8_t sub_band_count(const struct ulorawan_channel_plan *const plan) {
+  return plan->desc->channel_blocks[0].count /
+         ULORAWAN_CHANNEL_PLAN_SUB_BAND_SIZE;
+}
+
+static void mask_assign(struct ulorawan_channel_mask *const mask, uint8_t index,
+                        bool value) {
+  if (value) {
+    mask_set(mask, index);
+  } else {
+    mask_clear(mask, index);
+  }
+}
+
+static void apply_sub_band_chmask(const struct ulorawan_channel_plan *const plan,
+                                  struct ulorawan_channel_mask *const mask,
+                                  uint8_t cntl, uint16_t chmask) {
+  uint8_t narrow = plan->desc->channel_blocks[0].count;
+  uint8_t wide = plan->desc->channel_blocks[1].count;
+
+  if (cntl == CHMASK_CNTL_SUB_BANDS) {
+    for (uint8_t i = 0; i < sub_band_count(plan) && i < wide; i++) {
+      bool enable = (chmask & (1U << i)) != 0;
+
+      for (uint8_t j = 0; j < ULORAWAN_CHANNEL_PLAN_SUB_BAND_SIZE; j++) {
+        mask_assign(mask, i * ULORAWAN_CHANNEL_PLAN_SUB_BAND_SIZE + j, enable);
+      }
+
+      mask_assign(mask, narrow + i, enable);
+    }
+
+    return;
+  }
+
+  for (uint8_t i = 0; i < narrow; i++) {
+    mask_assign(mask, i, cntl == CHMASK_CNTL_ALL_ON);
+  }
+
+  for (uint8_t i = 0; i < wide; i++) {
+    mask_assign(mask, narrow + i, (chmask & (1U << i)) != 0);
+  }
+}
+
+// Generate a channel of a fixed plan from the region channel blocks
+static int32_t get_fixed(const struct ulorawan_channel_plan *const plan,
+                         uint8_t index, struct ulorawan_channel *const channel) {
+  const struct ulorawan_region_desc *desc = plan->desc;
+  uint8_t offset = index;
+
+  for (uint8_t i = 0; i < desc->channel_block_count; i++) {
+    const struct ulorawan_region_channels *block = &desc->channel_blocks[i];
+
+    if (offset < block->count) {
+      channel->frequency = block->frequency + offset * block->step;
+      channel->min_dr = block->min_dr;
+      channel->max_dr = block->max_dr;
+      channel->index = index;
+      channel->band = find_band(desc, channel->frequency);
+      channel->rx1_frequency =
+          desc->downlink.frequency +
+          (index % desc->downlink.count) * desc->downlink.step;
+      channel->modulation = desc->data_rates[block->min_dr].modulation;
+
+      return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+    }
+
+    offset -= block->count;
+  }
+
+  return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+}
+
+void ulorawan_channel_plan_init(struct ulorawan_channel_plan *const plan,
+                                const struct ulorawan_region_desc *const desc) {
+  struct ulorawan_channel channel;
+  uint8_t index = 0;
+
+  memset(plan, 0, sizeof(*plan));
+
+  plan->desc = desc;
+  plan->join_sub_band = ULORAWAN_CHANNEL_PLAN_SUB_BAND_NONE;
+
+  if (desc->plan == CFLIST_TYPE_FIXED) {
+    for (index = 0; index < desc->max_channels; index++) {
+      if (get_fixed(plan, index, &channel) == ULORAWAN_CHANNEL_PLAN_ERR_NONE) {
+        index_channel(plan, &channel);
+      }
+    }
+  } else {
+    for (uint8_t i = 0; i < desc->channel_block_count; i++) {
+      const struct ulorawan_region_channels *block = &desc->channel_blocks[i];
+
+      for (uint8_t j = 0; j < block->count; j++) {
+        ulorawan_channel_plan_set(plan, index++, block->frequency + j * block->step,
+                                  block->min_dr, block->max_dr);
+      }
+    }
+  }
+
+  plan->enabled = plan->defined;
+
+  memset(&plan->available, 0xFF, sizeof(plan->available));
+}
+
+int32_t ulorawan_channel_plan_set(struct ulorawan_channel_plan *const plan,
+                                  uint8_t index, uint32_t frequency,
+                                  uint8_t min_dr, uint8_t max_dr) {
+  const struct ulorawan_region_desc *desc = plan->desc;
+  struct ulorawan_channel *channel;
+
+  if (desc->plan != CFLIST_TYPE_DYNAMIC ||
+      index >= ULORAWAN_CHANNEL_PLAN_MAX_DYNAMIC ||
+      index >= desc->max_channels) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+  }
+
+  if (frequency != 0 &&
+      (frequency < desc->min_frequency || frequency > desc->max_frequency ||
+       min_dr > max_dr || max_dr >= ULORAWAN_CHANNEL_PLAN_MAX_DR)) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+  }
+
+  unindex_channel(plan, index);
+
+  if (frequency == 0) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+  }
+
+  channel = &plan->channels[index];
+  channel->frequency = frequency;
+  channel->rx1_frequency = frequency;
+  channel->min_dr = min_dr;
+  channel->max_dr = max_dr;
+  channel->index = index;
+  channel->band = find_band(desc, frequency);
+  channel->modulation = desc->data_rates[min_dr].modulation;
+
+  index_channel(plan, channel);
+  mask_set(&plan->enabled, index);
+
+  return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+}
+
+int32_t ulorawan_channel_plan_get(const struct ulorawan_channel_plan *const plan,
+                                  uint8_t index,
+                                  struct ulorawan_channel *const channel) {
+  if (index >= ULORAWAN_CHANNEL_PLAN_MAX_CHANNELS ||
+      !mask_test(&plan->defined, index)) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+  }
+
+  if (plan->desc->plan == CFLIST_TYPE_FIXED) {
+    return get_fixed(plan, index, channel);
+  }
+
+  *channel = plan->channels[index];
+
+  return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+}
+
+int32_t
+ulorawan_channel_plan_apply_chmask(const struct ulorawan_channel_plan *const plan,
+                                   struct ulorawan_channel_mask *const mask,
+                                   uint8_t cntl, uint16_t chmask) {
+  uint8_t blocks = (plan->desc->max_channels + 15) / 16;
+
+  if (cntl < blocks) {
+    uint8_t word = cntl / 2;
+    uint8_t shift = (cntl % 2) * 16;
+
+    mask->words[word] &= ~(0xFFFFUL << shift);
+    mask->words[word] |= (uint32_t)chmask << shift;
+
+    return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+  }
+
+  if (has_sub_bands(plan) && cntl >= CHMASK_CNTL_SUB_BANDS &&
+      cntl <= CHMASK_CNTL_ALL_OFF) {
+    apply_sub_band_chmask(plan, mask, cntl, chmask);
+
+    return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+  }
+
+  if (!has_sub_bands(plan) && cntl == CHMASK_CNTL_ALL_ON) {
+    *mask = plan->defined;
+
+    return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+  }
+
+  return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+}
+
+int32_t
+ulorawan_channel_plan_validate(const struct ulorawan_channel_plan *const plan,
+                               const struct ulorawan_channel_mask *const mask) {
+  uint32_t any = 0;
+
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    if ((mask->words[i] & ~plan->defined.words[i]) != 0) {
+      return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+    }
+
+    any |= mask->words[i];
+  }
+
+  if (any == 0) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+  }
+
+  return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+}
+
+int32_t
+ulorawan_channel_plan_set_enabled(struct ulorawan_channel_plan *const plan,
+                                  const struct ulorawan_channel_mask *const mask) {
+  if (ulorawan_channel_plan_validate(plan, mask) !=
+      ULORAWAN_CHANNEL_PLAN_ERR_NONE) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_PARAM;
+  }
+
+  plan->enabled = *mask;
+
+  return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+}
+
+bool ulorawan_channel_plan_supports_dr(
+    const struct ulorawan_channel_plan *const plan,
+    const struct ulorawan_channel_mask *const mask, uint8_t dr) {
+  if (dr >= ULORAWAN_CHANNEL_PLAN_MAX_DR) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    if (mask->words[i] & plan->dr_masks[dr].words[i]) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ulorawan_channel_plan_enable_defaults(
+    struct ulorawan_channel_plan *const plan) {
+  uint8_t count = 0;
+
+  if (plan->desc->plan == CFLIST_TYPE_FIXED) {
+    plan->enabled = plan->defined;
+    return;
+  }
+
+  for (uint8_t i = 0; i < plan->desc->channel_block_count; i++) {
+    count += plan->desc->channel_blocks[i].count;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    mask_set(&plan->enabled, i);
+  }
+}
+
+void ulorawan_channel_plan_set_band_available(
+    struct ulorawan_channel_plan *const plan, uint8_t band, bool available) {
+  if (band >= ULORAWAN_CHANNEL_PLAN_MAX_BANDS) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    if (available) {
+      plan->available.words[i] |= plan->band_masks[band].words[i];
+    } else {
+      plan->available.words[i] &= ~plan->band_masks[band].words[i];
+    }
+  }
+}
+
+bool ulorawan_channel_plan_band_enabled(
+    const struct ulorawan_channel_plan *const plan, uint8_t band) {
+  if (band >= ULORAWAN_CHANNEL_PLAN_MAX_BANDS) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    if (plan->enabled.words[i] & plan->band_masks[band].words[i]) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint8_t ulorawan_channel_plan_count(const struct ulorawan_channel_plan *const plan,
+                                    uint8_t dr) {
+  uint8_t count = 0;
+
+  if (dr >= ULORAWAN_CHANNEL_PLAN_MAX_DR) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    count += popcount(plan->enabled.words[i] & plan->available.words[i] &
+                      plan->dr_masks[dr].words[i]);
+  }
+
+  return count;
+}
+
+int32_t ulorawan_channel_plan_select(const struct ulorawan_channel_plan *const plan,
+                                     uint8_t dr, uint32_t random,
+                                     struct ulorawan_channel *const channel) {
+  uint32_t eligible[ULORAWAN_CHANNEL_PLAN_MASK_WORDS];
+  uint8_t counts[ULORAWAN_CHANNEL_PLAN_MASK_WORDS];
+  uint8_t total = 0;
+  uint8_t n;
+
+  if (dr >= ULORAWAN_CHANNEL_PLAN_MAX_DR) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_NO_CHANNEL;
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    eligible[i] = plan->enabled.words[i] & plan->available.words[i] &
+                  plan->dr_masks[dr].words[i];
+    counts[i] = popcount(eligible[i]);
+    total += counts[i];
+  }
+
+  if (total == 0) {
+    return ULORAWAN_CHANNEL_PLAN_ERR_NO_CHANNEL;
+  }
+
+  n = (uint8_t)(random % total);
+
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    if (n < counts[i]) {
+      ulorawan_channel_plan_get(plan, (uint8_t)(i * 32 + select_bit(eligible[i], n)),
+                                channel);
+      channel->modulation = plan->desc->data_rates[dr].modulation;
+
+      return ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+    }
+
+    n -= counts[i];
+  }
+
+  return ULORAWAN_CHANNEL_PLAN_ERR_NO_CHANNEL;
+}
+
+// Shuffle the sub-bands with a Fisher-Yates pass, drawing each swap from the
+// mixed radix digits of a single random value
+static void shuffle_sub_bands(struct ulorawan_channel_plan *const plan,
+                              uint32_t random) {
+  uint8_t count = sub_band_count(plan);
+
+  for (uint8_t i = 0; i < count; i++) {
+    plan->join_order[i] = i;
+  }
+
+  for (uint8_t i = count - 1; i > 0; i--) {
+    uint8_t j = (uint8_t)(random % (i + 1));
+    uint8_t swap = plan->join_order[i];
+
+    random /= (i + 1);
+    plan->join_order[i] = plan->join_order[j];
+    plan->join_order[j] = swap;
+  }
+
+  // Try the sub-band the network was last found on first
+  for (uint8_t i = 0; i < count; i++) {
+    if (plan->join_order[i] == plan->join_sub_band) {
+      plan->join_order[i] = plan->join_order[0];
+      plan->join_order[0] = plan->join_sub_band;
+      break;
+    }
+  }
+}
+
+int32_t ulorawan_channel_plan_select_join(struct ulorawan_channel_plan *const plan,
+                                          uint8_t dr, uint32_t random,
+                                          struct ulorawan_channel *const channel) {
+  uint8_t count;
+  uint8_t sub_band;
+  uint8_t index;
+
+  if (!has_sub_bands(plan)) {
+    return ulorawan_channel_plan_select(plan, dr, random, channel);
+  }
+
+  count = sub_band_count(plan);
+
+  if (plan->join_attempts % (count * 2) == 0) {
+    shuffle_sub_bands(plan, random);
+  }
+
+  sub_band = plan->join_order[(plan->join_attempts / 2) % count];
+
+  if (plan->join_attempts % 2 == 0) {
+    index = sub_band * ULORAWAN_CHANNEL_PLAN_SUB_BAND_SIZE +
+            (random >> 24) % ULORAWAN_CHANNEL_PLAN_SUB_BAND_SIZE;
+  } else {
+    index = plan->desc->channel_blocks[0].count + sub_band;
+  }
+
+  plan->join_attempts++;
+
+  return ulorawan_channel_plan_get(plan, index, channel);
+}
+
+void ulorawan_channel_plan_join_accepted(
+    struct ulorawan_channel_plan *const plan,
+    const struct ulorawan_channel *const channel) {
+  uint8_t narrow;
+
+  plan->join_attempts = 0;
+
+  if (!has_sub_bands(plan)) {
+    return;
+  }
+
+  narrow = plan->desc->channel_blocks[0].count;
+
+  if (channel->index < narrow) {
+    plan->join_sub_band = channel->index / ULORAWAN_CHANNEL_PLAN_SUB_BAND_SIZE;
+  } else {
+    plan->join_sub_band = channel->index - narrow;
+  }
+}
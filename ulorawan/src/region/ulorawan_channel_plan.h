@@ -0,0 +1,318 @@
+/**
+ * \file
+ *
+ * \brief The uloraWan channel plan function prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ULORAWAN_CHANNEL_PLAN_H_
+#define ULORAWAN_CHANNEL_PLAN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ulorawan_common.h"
+
+//! The maximum number of uplink channels in a channel plan
+#define ULORAWAN_CHANNEL_PLAN_MAX_CHANNELS 96
+//! The maximum number of dynamically defined channels in a channel plan
+#define ULORAWAN_CHANNEL_PLAN_MAX_DYNAMIC 16
+//! The maximum number of data rates in a channel plan
+#define ULORAWAN_CHANNEL_PLAN_MAX_DR 16
+//! The maximum number of duty cycle bands in a channel plan
+#define ULORAWAN_CHANNEL_PLAN_MAX_BANDS 6
+//! The number of 125 kHz channels in a fixed plan sub-band
+#define ULORAWAN_CHANNEL_PLAN_SUB_BAND_SIZE 8
+//! The maximum number of sub-bands in a fixed plan
+#define ULORAWAN_CHANNEL_PLAN_MAX_SUB_BANDS 8
+//! The join sub-band is not known
+#define ULORAWAN_CHANNEL_PLAN_SUB_BAND_NONE 0xFF
+//! The number of words in a channel mask
+#define ULORAWAN_CHANNEL_PLAN_MASK_WORDS                                       \
+  ((ULORAWAN_CHANNEL_PLAN_MAX_CHANNELS + 31) / 32)
+
+#define ULORAWAN_CHANNEL_PLAN_ERR_NONE 0
+#define ULORAWAN_CHANNEL_PLAN_ERR_PARAM -1
+#define ULORAWAN_CHANNEL_PLAN_ERR_NO_CHANNEL -2
+
+struct ulorawan_region_desc;
+
+//! A ulorawan channel
+struct ulorawan_channel {
+  //! The channel frequency
+  uint32_t frequency;
+  //! The channel modulation type
+  enum ulorawan_modulation modulation;
+  //! The RX1 downlink frequency
+  uint32_t rx1_frequency;
+  //! The lowest uplink data rate of the channel
+  uint8_t min_dr;
+  //! The highest uplink data rate of the channel
+  uint8_t max_dr;
+  //! The duty cycle band of the channel
+  uint8_t band;
+  //! The channel index
+  uint8_t index;
+};
+
+//! A channel bitset, bit n represents channel n
+struct ulorawan_channel_mask {
+  uint32_t words[ULORAWAN_CHANNEL_PLAN_MASK_WORDS];
+};
+
+//! A channel plan
+struct ulorawan_channel_plan {
+  //! The region descriptor
+  const struct ulorawan_region_desc *desc;
+  //! The channels that are defined
+  struct ulorawan_channel_mask defined;
+  //! The channels enabled by the network
+  struct ulorawan_channel_mask enabled;
+  //! The channels not blocked by the duty cycle
+  struct ulorawan_channel_mask available;
+  //! The channels that support each data rate
+  struct ulorawan_channel_mask dr_masks[ULORAWAN_CHANNEL_PLAN_MAX_DR];
+  //! The channels that belong to each duty cycle band
+  struct ulorawan_channel_mask band_masks[ULORAWAN_CHANNEL_PLAN_MAX_BANDS];
+  //! The channels of a dynamic plan
+  struct ulorawan_channel channels[ULORAWAN_CHANNEL_PLAN_MAX_DYNAMIC];
+  //! The order sub-bands are tried in while joining a fixed plan network
+  uint8_t join_order[ULORAWAN_CHANNEL_PLAN_MAX_SUB_BANDS];
+  //! The number of join attempts since the last accepted join
+  uint8_t join_attempts;
+  //! The sub-band of the last accepted join
+  uint8_t join_sub_band;
+};
+
+/**
+ * \brief Initialise a channel plan with the default channels of a region.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] desc The region descriptor.
+ */
+void ulorawan_channel_plan_init(struct ulorawan_channel_plan *const plan,
+                                const struct ulorawan_region_desc *const desc);
+
+/**
+ * \brief Define or remove a channel of a dynamic channel plan.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] index The channel index.
+ * \param[in] frequency The channel frequency in Hz, zero removes the channel.
+ * \param[in] min_dr The lowest uplink data rate of the channel.
+ * \param[in] max_dr The highest uplink data rate of the channel.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_PARAM The plan is fixed or a parameter is
+ * invalid.
+ */
+int32_t ulorawan_channel_plan_set(struct ulorawan_channel_plan *const plan,
+                                  uint8_t index, uint32_t frequency,
+                                  uint8_t min_dr, uint8_t max_dr);
+
+/**
+ * \brief Get a defined channel.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] index The channel index.
+ * \param[out] channel The channel.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_PARAM The channel is not defined.
+ */
+int32_t ulorawan_channel_plan_get(const struct ulorawan_channel_plan *const plan,
+                                  uint8_t index,
+                                  struct ulorawan_channel *const channel);
+
+/**
+ * \brief Apply a ChMask to a channel mask.
+ *
+ * A control below the number of 16 channel blocks replaces that block. A
+ * fixed plan with 500 kHz channels also accepts 5 to enable sub-bands with
+ * their 500 kHz channel, 6 to enable all 125 kHz channels and 7 to disable
+ * them, the ChMask of 6 and 7 applying to the 500 kHz channels. Other plans
+ * accept 6 to enable all defined channels.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in,out] mask The channel mask to update.
+ * \param[in] cntl The channel mask control.
+ * \param[in] chmask The channel mask.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_PARAM The control is not supported.
+ */
+int32_t
+ulorawan_channel_plan_apply_chmask(const struct ulorawan_channel_plan *const plan,
+                                   struct ulorawan_channel_mask *const mask,
+                                   uint8_t cntl, uint16_t chmask);
+
+/**
+ * \brief Check that a channel mask can be enabled.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] mask The channel mask.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NONE The mask can be enabled.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_PARAM The mask is empty or enables an
+ * undefined channel.
+ */
+int32_t
+ulorawan_channel_plan_validate(const struct ulorawan_channel_plan *const plan,
+                               const struct ulorawan_channel_mask *const mask);
+
+/**
+ * \brief Check whether a channel mask holds a channel supporting a data rate.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] mask The channel mask.
+ * \param[in] dr The data rate.
+ *
+ * \return True when at least one channel of the mask supports the data rate.
+ */
+bool ulorawan_channel_plan_supports_dr(
+    const struct ulorawan_channel_plan *const plan,
+    const struct ulorawan_channel_mask *const mask, uint8_t dr);
+
+/**
+ * \brief Enable the default channels of the region.
+ *
+ * \param[in] plan The channel plan.
+ */
+void ulorawan_channel_plan_enable_defaults(
+    struct ulorawan_channel_plan *const plan);
+
+/**
+ * \brief Replace the enabled channels.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] mask The channels to enable.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_PARAM The mask is empty or enables an
+ * undefined channel.
+ */
+int32_t
+ulorawan_channel_plan_set_enabled(struct ulorawan_channel_plan *const plan,
+                                  const struct ulorawan_channel_mask *const mask);
+
+/**
+ * \brief Mark the channels of a duty cycle band as available or blocked.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] band The duty cycle band.
+ * \param[in] available True when the band may transmit.
+ */
+void ulorawan_channel_plan_set_band_available(
+    struct ulorawan_channel_plan *const plan, uint8_t band, bool available);
+
+/**
+ * \brief Check whether a duty cycle band holds an enabled channel.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] band The duty cycle band.
+ *
+ * \return True when at least one channel of the band is enabled.
+ */
+bool ulorawan_channel_plan_band_enabled(
+    const struct ulorawan_channel_plan *const plan, uint8_t band);
+
+/**
+ * \brief Count the enabled and available channels that support a data rate.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] dr The data rate.
+ *
+ * \return The number of eligible channels.
+ */
+uint8_t ulorawan_channel_plan_count(const struct ulorawan_channel_plan *const plan,
+                                    uint8_t dr);
+
+/**
+ * \brief Select an enabled and available channel that supports a data rate.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] dr The data rate.
+ * \param[in] random A random value used to pick among the eligible channels.
+ * \param[out] channel The selected channel.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NO_CHANNEL No channel is eligible.
+ */
+int32_t ulorawan_channel_plan_select(const struct ulorawan_channel_plan *const plan,
+                                     uint8_t dr, uint32_t random,
+                                     struct ulorawan_channel *const channel);
+
+/**
+ * \brief Select a channel for a join request.
+ *
+ * Fixed plans with 500 kHz channels walk the sub-bands in a random order,
+ * starting with the sub-band of the last accepted join, alternating between
+ * a random 125 kHz channel of the sub-band and its 500 kHz channel. Other
+ * plans select any enabled and available channel that supports the data
+ * rate.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] dr The data rate used by plans without sub-bands.
+ * \param[in] random A random value.
+ * \param[out] channel The selected channel.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_CHANNEL_PLAN_ERR_NO_CHANNEL No channel is eligible.
+ */
+int32_t ulorawan_channel_plan_select_join(struct ulorawan_channel_plan *const plan,
+                                          uint8_t dr, uint32_t random,
+                                          struct ulorawan_channel *const channel);
+
+/**
+ * \brief Record the channel of an accepted join so the next join starts on
+ * the same sub-band.
+ *
+ * \param[in] plan The channel plan.
+ * \param[in] channel The channel of the accepted join request.
+ */
+void ulorawan_channel_plan_join_accepted(
+    struct ulorawan_channel_plan *const plan,
+    const struct ulorawan_channel *const channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_CHANNEL_PLAN_H_ */
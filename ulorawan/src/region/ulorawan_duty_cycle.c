@@ -0,0 +1,160 @@
+/**
+ * \file
+ *
+ * \brief The uloraWan duty cycle implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "ulorawan_duty_cycle.h"
+#include "ulorawan_region.h"
+
+// Wrap safe check that time a is at or before time b
+static inline bool time_reached(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) <= 0;
+}
+
+// Move a band to its place in the release order after its release time grew.
+// The array holds at most ULORAWAN_CHANNEL_PLAN_MAX_BANDS entries so a single
+// insertion pass keeps the earliest release at the front.
+static void reorder(struct ulorawan_duty_cycle *const duty_cycle,
+                    uint8_t band) {
+  uint8_t position = 0;
+
+  while (duty_cycle->order[position] != band) {
+    position++;
+  }
+
+  while (position + 1 < duty_cycle->band_count &&
+         time_reached(duty_cycle->release[duty_cycle->order[position + 1]],
+                      duty_cycle->release[band])) {
+    duty_cycle->order[position] = duty_cycle->order[position + 1];
+    position++;
+  }
+
+  duty_cycle->order[position] = band;
+}
+
+void ulorawan_duty_cycle_init(struct ulorawan_duty_cycle *const duty_cycle,
+                              const struct ulorawan_region_desc *const desc,
+                              uint32_t now) {
+  memset(duty_cycle, 0, sizeof(*duty_cycle));
+
+  duty_cycle->band_count = desc->band_count;
+  duty_cycle->aggregated = 1;
+  duty_cycle->aggregated_release = now;
+
+  for (uint8_t i = 0; i < duty_cycle->band_count; i++) {
+    duty_cycle->release[i] = now;
+    duty_cycle->order[i] = i;
+    duty_cycle->limit[i] = desc->bands[i].duty_cycle;
+  }
+}
+
+void ulorawan_duty_cycle_record(struct ulorawan_duty_cycle *const duty_cycle,
+                                struct ulorawan_channel_plan *const plan,
+                                uint8_t band, uint32_t start, uint32_t end) {
+  uint32_t airtime = end - start;
+
+  if (duty_cycle->aggregated > 1) {
+    duty_cycle->aggregated_release =
+        end + airtime * (uint32_t)(duty_cycle->aggregated - 1);
+  }
+
+  if (band >= duty_cycle->band_count || duty_cycle->limit[band] <= 1) {
+    return;
+  }
+
+  duty_cycle->release[band] =
+      end + airtime * (uint32_t)(duty_cycle->limit[band] - 1);
+  reorder(duty_cycle, band);
+
+  if (!(duty_cycle->blocked & (1U << band))) {
+    duty_cycle->blocked |= 1U << band;
+    ulorawan_channel_plan_set_band_available(plan, band, false);
+  }
+}
+
+void ulorawan_duty_cycle_update(struct ulorawan_duty_cycle *const duty_cycle,
+                                struct ulorawan_channel_plan *const plan,
+                                uint32_t now) {
+  if (time_reached(duty_cycle->aggregated_release, now)) {
+    duty_cycle->aggregated_release = now;
+  }
+
+  for (uint8_t i = 0; i < duty_cycle->band_count; i++) {
+    uint8_t band = duty_cycle->order[i];
+
+    if (!time_reached(duty_cycle->release[band], now)) {
+      break;
+    }
+
+    // Keep released times close to now so they never appear to be in the
+    // future once the millisecond clock wraps
+    duty_cycle->release[band] = now;
+
+    if (duty_cycle->blocked & (1U << band)) {
+      duty_cycle->blocked &= ~(1U << band);
+      ulorawan_channel_plan_set_band_available(plan, band, true);
+    }
+  }
+}
+
+uint32_t
+ulorawan_duty_cycle_next(const struct ulorawan_duty_cycle *const duty_cycle,
+                         const struct ulorawan_channel_plan *const plan) {
+  uint32_t next = duty_cycle->aggregated_release;
+
+  // Bands are ordered by release time, the first one holding an enabled
+  // channel is normally at the front
+  for (uint8_t i = 0; i < duty_cycle->band_count; i++) {
+    uint8_t band = duty_cycle->order[i];
+
+    if (ulorawan_channel_plan_band_enabled(plan, band)) {
+      if (time_reached(next, duty_cycle->release[band])) {
+        next = duty_cycle->release[band];
+      }
+      break;
+    }
+  }
+
+  return next;
+}
+
+int32_t ulorawan_duty_cycle_set_max(struct ulorawan_duty_cycle *const duty_cycle,
+                                    uint8_t max_duty_cycle) {
+  if (max_duty_cycle > ULORAWAN_DUTY_CYCLE_MAX_AGGREGATED) {
+    return ULORAWAN_DUTY_CYCLE_ERR_PARAM;
+  }
+
+  duty_cycle->aggregated = (uint16_t)(1U << max_duty_cycle);
+
+  return ULORAWAN_DUTY_CYCLE_ERR_NONE;
+}
@@ -0,0 +1,135 @@
+/**
+ * \file
+ *
+ * \brief The uloraWan duty cycle function prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ULORAWAN_DUTY_CYCLE_H_
+#define ULORAWAN_DUTY_CYCLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_channel_plan.h"
+
+//! The maximum MaxDutyCycle value of a DutyCycleReq
+#define ULORAWAN_DUTY_CYCLE_MAX_AGGREGATED 15
+
+#define ULORAWAN_DUTY_CYCLE_ERR_NONE 0
+#define ULORAWAN_DUTY_CYCLE_ERR_PARAM -1
+
+//! The duty cycle accounting of a region
+struct ulorawan_duty_cycle {
+  //! The time in milliseconds each band may transmit again
+  uint32_t release[ULORAWAN_CHANNEL_PLAN_MAX_BANDS];
+  //! The band indices ordered by release time, earliest first
+  uint8_t order[ULORAWAN_CHANNEL_PLAN_MAX_BANDS];
+  //! The duty cycle reciprocal of each band, 1 for no limit
+  uint16_t limit[ULORAWAN_CHANNEL_PLAN_MAX_BANDS];
+  //! The number of bands
+  uint8_t band_count;
+  //! The bitmap of bands currently blocked
+  uint8_t blocked;
+  //! The aggregated duty cycle reciprocal set by DutyCycleReq, 1 for no limit
+  uint16_t aggregated;
+  //! The time in milliseconds the device may transmit again
+  uint32_t aggregated_release;
+};
+
+/**
+ * \brief Initialise the duty cycle accounting of a region.
+ *
+ * \param[in] duty_cycle The duty cycle accounting.
+ * \param[in] desc The region descriptor.
+ * \param[in] now The current time in milliseconds.
+ */
+void ulorawan_duty_cycle_init(struct ulorawan_duty_cycle *const duty_cycle,
+                              const struct ulorawan_region_desc *const desc,
+                              uint32_t now);
+
+/**
+ * \brief Record the airtime of an uplink and block its band for the
+ * regulatory time off.
+ *
+ * \param[in] duty_cycle The duty cycle accounting.
+ * \param[in] plan The channel plan.
+ * \param[in] band The band of the uplink channel.
+ * \param[in] start The time in milliseconds the uplink started.
+ * \param[in] end The time in milliseconds the uplink ended.
+ */
+void ulorawan_duty_cycle_record(struct ulorawan_duty_cycle *const duty_cycle,
+                                struct ulorawan_channel_plan *const plan,
+                                uint8_t band, uint32_t start, uint32_t end);
+
+/**
+ * \brief Release the bands whose time off has elapsed.
+ *
+ * \param[in] duty_cycle The duty cycle accounting.
+ * \param[in] plan The channel plan.
+ * \param[in] now The current time in milliseconds.
+ */
+void ulorawan_duty_cycle_update(struct ulorawan_duty_cycle *const duty_cycle,
+                                struct ulorawan_channel_plan *const plan,
+                                uint32_t now);
+
+/**
+ * \brief Get the earliest time any band with an enabled channel may transmit.
+ *
+ * \param[in] duty_cycle The duty cycle accounting.
+ * \param[in] plan The channel plan.
+ *
+ * \return The time in milliseconds.
+ */
+uint32_t
+ulorawan_duty_cycle_next(const struct ulorawan_duty_cycle *const duty_cycle,
+                         const struct ulorawan_channel_plan *const plan);
+
+/**
+ * \brief Set the aggregated duty cycle limit of a DutyCycleReq.
+ *
+ * \param[in] duty_cycle The duty cycle accounting.
+ * \param[in] max_duty_cycle The MaxDutyCycle value, the aggregated duty cycle
+ * is 1 / 2^max_duty_cycle.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_DUTY_CYCLE_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_DUTY_CYCLE_ERR_PARAM The value is out of range.
+ */
+int32_t ulorawan_duty_cycle_set_max(struct ulorawan_duty_cycle *const duty_cycle,
+                                    uint8_t max_duty_cycle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_DUTY_CYCLE_H_ */
@@ -30,16 +30,461 @@
  * SOFTWARE.
  *
  */
+#include <stddef.h>
+#include <string.h>
+
+#include "rand_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_duty_cycle.h"
 #include "ulorawan_region.h"
+#include "ulorawan_region_tables.h"
 #include "ulorawan_common.h"
 
+//! The EIRP in dBm of each TxParamSetupReq MaxEIRP index
+static const int8_t max_eirp_table[ULORAWAN_REGION_MAX_EIRP_COUNT] = {
+    8, 10, 12, 13, 14, 16, 18, 20, 21, 24, 26, 27, 29, 30, 33, 36};
+
+//! The supported region descriptors indexed by region
+static const struct ulorawan_region_desc *const regions[] = {
+#ifdef ULORAWAN_REGION_EU868_SUPPORT
+    [REGION_EU868] = &ulorawan_region_eu868,
+#endif
+#ifdef ULORAWAN_REGION_US915_SUPPORT
+    [REGION_US915] = &ulorawan_region_us915,
+#endif
+#ifdef ULORAWAN_REGION_CN779_SUPPORT
+    [REGION_CN779] = &ulorawan_region_cn779,
+#endif
+#ifdef ULORAWAN_REGION_EU433_SUPPORT
+    [REGION_EU433] = &ulorawan_region_eu433,
+#endif
+#ifdef ULORAWAN_REGION_AU915_SUPPORT
+    [REGION_AU915] = &ulorawan_region_au915,
+#endif
+#ifdef ULORAWAN_REGION_CN470_SUPPORT
+    [REGION_CN470] = &ulorawan_region_cn470,
+#endif
+#ifdef ULORAWAN_REGION_AS923_SUPPORT
+    [REGION_AS923] = &ulorawan_region_as923,
+#endif
+#ifdef ULORAWAN_REGION_AS923_2_SUPPORT
+    [REGION_AS923_2] = &ulorawan_region_as923_2,
+#endif
+#ifdef ULORAWAN_REGION_AS923_3_SUPPORT
+    [REGION_AS923_3] = &ulorawan_region_as923_3,
+#endif
+#ifdef ULORAWAN_REGION_KR920_SUPPORT
+    [REGION_KR920] = &ulorawan_region_kr920,
+#endif
+#ifdef ULORAWAN_REGION_IN865_SUPPORT
+    [REGION_IN865] = &ulorawan_region_in865,
+#endif
+#ifdef ULORAWAN_REGION_RU864_SUPPORT
+    [REGION_RU864] = &ulorawan_region_ru864,
+#endif
+#ifdef ULORAWAN_REGION_AS923_4_SUPPORT
+    [REGION_AS923_4] = &ulorawan_region_as923_4,
+#endif
+    [REGION_NONE] = NULL};
+
+// The largest MACPayload of a LoRa data rate whose time on air fits the dwell
+// time. The time on air formula with an 8 symbol preamble, explicit header,
+// CRC and coding rate 4/5 is solved for the payload length in quarter
+// symbols so no division by the symbol time is needed per payload size.
+static uint8_t dwell_payload(const struct ulorawan_region_dr *const dr) {
+  int32_t sf = dr->sf + 6;
+  int32_t de = (sf >= 11 && dr->bw == BW_125) ? 1 : 0;
+  uint32_t symbol_us = ((1UL << sf) * 1000) / (125UL << dr->bw);
+  int32_t quarters =
+      (int32_t)((ULORAWAN_REGION_DWELL_TIME * 1000UL * 4) / symbol_us) - 49 - 32;
+  int32_t phy_size;
+
+  if (quarters < 0) {
+    return 0;
+  }
+
+  phy_size = ((quarters / 20) * 4 * (sf - 2 * de) + 4 * sf - 44) / 8;
+
+  // Less the MHDR and MIC
+  phy_size -= 5;
+
+  if (phy_size <= 0) {
+    return 0;
+  }
+
+  return phy_size > UINT8_MAX ? UINT8_MAX : (uint8_t)phy_size;
+}
+
+static void update_max_payload(struct ulorawan_region_params *const params) {
+  for (uint8_t i = 0; i < ULORAWAN_REGION_MAX_DR; i++) {
+    const struct ulorawan_region_dr *dr = &params->desc->data_rates[i];
+    uint8_t max_payload = dr->max_payload;
+
+    if (params->uplink_dwell_time && max_payload != 0 &&
+        dr->modulation == MODULATION_LORA) {
+      uint8_t limit = dwell_payload(dr);
+
+      if (limit < max_payload) {
+        max_payload = limit;
+      }
+    }
+
+    params->max_payload[i] = max_payload;
+  }
+}
+
 int32_t ulorawan_region_init_params(struct ulorawan_region_params *const params)
 {
-   params->region = ACTIVE_REGION;
-   params->rx_delay_1 = ULORAWAN_REGION_RECEIVE_DELAY1;
-   params->rx_delay_2 = ULORAWAN_REGION_RECEIVE_DELAY2;
-   
-   return ULORAWAN_REGION_ERR_NONE;
+   return ulorawan_region_select(params, ACTIVE_REGION);
+}
+
+int32_t ulorawan_region_select(struct ulorawan_region_params *const params,
+                               enum ulorawan_region region) {
+  const struct ulorawan_region_desc *desc = ulorawan_region_get_desc(region);
+
+  if (desc == NULL) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  params->region = region;
+  params->desc = desc;
+  params->rx_delay_1 = ULORAWAN_REGION_RECEIVE_DELAY1;
+  params->rx_delay_2 = ULORAWAN_REGION_RECEIVE_DELAY2;
+  params->rx2_frequency = desc->rx2_frequency;
+  params->rx2_dr = desc->rx2_dr;
+  params->data_rate = DR_0;
+  params->tx_power = 0;
+  params->uplink_dwell_time = desc->uplink_dwell_time;
+  params->downlink_dwell_time = 0;
+  params->max_eirp = desc->tx_power[0];
+
+  update_max_payload(params);
+
+  ulorawan_channel_plan_init(&params->plan, desc);
+  ulorawan_duty_cycle_init(&params->duty_cycle, desc, timer_hal_get_time());
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+int32_t ulorawan_region_get_channel(struct ulorawan_region_params *const params,
+                                    struct ulorawan_channel *const channel) {
+  uint32_t now = timer_hal_get_time();
+  uint32_t random;
+
+  ulorawan_duty_cycle_update(&params->duty_cycle, &params->plan, now);
+
+  if ((int32_t)(ulorawan_duty_cycle_next(&params->duty_cycle, &params->plan) -
+                now) > 0) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  if (rand_hal_get_random(&random) != RAND_HAL_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  if (ulorawan_channel_plan_select(&params->plan, params->data_rate, random,
+                                   channel) != ULORAWAN_CHANNEL_PLAN_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+// The lowest data rate of a join request on a channel, the region may ask
+// for more than the channel allows for other uplinks
+static uint8_t join_dr(const struct ulorawan_region_desc *const desc,
+                       const struct ulorawan_channel *const channel) {
+  for (uint8_t i = 0; i < desc->channel_block_count; i++) {
+    const struct ulorawan_region_channels *block = &desc->channel_blocks[i];
+    uint32_t offset = channel->frequency - block->frequency;
+
+    if (channel->frequency < block->frequency) {
+      continue;
+    }
+
+    if (block->step == 0 ? offset == 0
+                         : offset % block->step == 0 &&
+                               offset / block->step < block->count) {
+      return block->join_dr > channel->min_dr ? block->join_dr
+                                              : channel->min_dr;
+    }
+  }
+
+  return channel->min_dr;
+}
+
+int32_t
+ulorawan_region_get_join_channel(struct ulorawan_region_params *const params,
+                                 struct ulorawan_channel *const channel) {
+  uint32_t now = timer_hal_get_time();
+  uint32_t random;
+
+  ulorawan_duty_cycle_update(&params->duty_cycle, &params->plan, now);
+
+  if ((int32_t)(ulorawan_duty_cycle_next(&params->duty_cycle, &params->plan) -
+                now) > 0) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  if (rand_hal_get_random(&random) != RAND_HAL_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  if (ulorawan_channel_plan_select_join(&params->plan, params->data_rate,
+                                        random, channel) !=
+      ULORAWAN_CHANNEL_PLAN_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  uint8_t dr = join_dr(params->desc, channel);
+
+  if (params->data_rate < dr || params->data_rate > channel->max_dr) {
+    params->data_rate = dr;
+  }
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+void ulorawan_region_join_accepted(struct ulorawan_region_params *const params,
+                                   const struct ulorawan_channel *const channel) {
+  ulorawan_channel_plan_join_accepted(&params->plan, channel);
+}
+
+void ulorawan_region_record_tx(struct ulorawan_region_params *const params,
+                               uint8_t band, uint32_t start, uint32_t end) {
+  ulorawan_duty_cycle_record(&params->duty_cycle, &params->plan, band, start,
+                             end);
+}
+
+uint32_t
+ulorawan_region_next_tx_time(const struct ulorawan_region_params *const params) {
+  return ulorawan_duty_cycle_next(&params->duty_cycle, &params->plan);
+}
+
+int32_t
+ulorawan_region_set_max_duty_cycle(struct ulorawan_region_params *const params,
+                                   uint8_t max_duty_cycle) {
+  if (ulorawan_duty_cycle_set_max(&params->duty_cycle, max_duty_cycle) !=
+      ULORAWAN_DUTY_CYCLE_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+int32_t ulorawan_region_set_tx_params(struct ulorawan_region_params *const params,
+                                      uint8_t uplink_dwell_time,
+                                      uint8_t downlink_dwell_time,
+                                      uint8_t max_eirp) {
+  if (!params->desc->tx_param_setup ||
+      max_eirp >= ULORAWAN_REGION_MAX_EIRP_COUNT) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  params->uplink_dwell_time = uplink_dwell_time;
+  params->downlink_dwell_time = downlink_dwell_time;
+  params->max_eirp = max_eirp_table[max_eirp];
+
+  update_max_payload(params);
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+uint8_t
+ulorawan_region_max_payload(const struct ulorawan_region_params *const params,
+                            uint8_t dr) {
+  if (dr >= ULORAWAN_REGION_MAX_DR) {
+    return 0;
+  }
+
+  return params->max_payload[dr];
+}
+
+int32_t ulorawan_region_fit_payload(const struct ulorawan_region_params *const params,
+                                    uint8_t size, uint8_t *const dr) {
+  if (ulorawan_region_max_payload(params, params->data_rate) >= size) {
+    *dr = params->data_rate;
+    return ULORAWAN_REGION_ERR_NONE;
+  }
+
+  for (uint8_t i = params->data_rate + 1; i < ULORAWAN_REGION_MAX_DR; i++) {
+    if (params->max_payload[i] >= size &&
+        ulorawan_channel_plan_count(&params->plan, i) > 0) {
+      *dr = i;
+      return ULORAWAN_REGION_ERR_NONE;
+    }
+  }
+
+  return ULORAWAN_REGION_ERR_FAIL;
+}
+
+int8_t ulorawan_region_get_eirp(const struct ulorawan_region_params *const params,
+                                uint8_t tx_power) {
+  const struct ulorawan_region_desc *desc = params->desc;
+
+  if (tx_power >= desc->tx_power_count) {
+    tx_power = desc->tx_power_count - 1;
+  }
+
+  // Power levels are offsets below the maximum EIRP
+  return params->max_eirp - (desc->tx_power[0] - desc->tx_power[tx_power]);
+}
+
+int32_t ulorawan_region_chmask(const struct ulorawan_region_params *const params,
+                               struct ulorawan_channel_mask *const mask,
+                               uint8_t cntl, uint16_t chmask) {
+  if (ulorawan_channel_plan_apply_chmask(&params->plan, mask, cntl, chmask) !=
+      ULORAWAN_CHANNEL_PLAN_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+bool ulorawan_region_chmask_valid(
+    const struct ulorawan_region_params *const params,
+    const struct ulorawan_channel_mask *const mask) {
+  return ulorawan_channel_plan_validate(&params->plan, mask) ==
+         ULORAWAN_CHANNEL_PLAN_ERR_NONE;
+}
+
+bool ulorawan_region_dr_valid(const struct ulorawan_region_params *const params,
+                              const struct ulorawan_channel_mask *const mask,
+                              uint8_t dr) {
+  return ulorawan_region_max_payload(params, dr) != 0 &&
+         ulorawan_channel_plan_supports_dr(&params->plan, mask, dr);
+}
+
+bool ulorawan_region_frequency_valid(
+    const struct ulorawan_region_params *const params, uint32_t frequency) {
+  return frequency >= params->desc->min_frequency &&
+         frequency <= params->desc->max_frequency;
+}
+
+int32_t ulorawan_region_set_chmask(struct ulorawan_region_params *const params,
+                                   const struct ulorawan_channel_mask *const mask) {
+  if (ulorawan_channel_plan_set_enabled(&params->plan, mask) !=
+      ULORAWAN_CHANNEL_PLAN_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+void ulorawan_region_enable_default_channels(
+    struct ulorawan_region_params *const params) {
+  ulorawan_channel_plan_enable_defaults(&params->plan);
+}
+
+int32_t ulorawan_region_apply_chmask(struct ulorawan_region_params *const params,
+                                     uint8_t cntl, uint16_t chmask) {
+  struct ulorawan_channel_mask mask = params->plan.enabled;
+
+  if (ulorawan_region_chmask(params, &mask, cntl, chmask) !=
+      ULORAWAN_REGION_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  return ulorawan_region_set_chmask(params, &mask);
+}
+
+const struct ulorawan_region_desc *
+ulorawan_region_get_desc(enum ulorawan_region region) {
+  if ((size_t)region >= sizeof(regions) / sizeof(regions[0])) {
+    return NULL;
+  }
+
+  return regions[region];
+}
+
+const struct ulorawan_region_dr *
+ulorawan_region_get_dr(const struct ulorawan_region_params *const params,
+                       uint8_t dr) {
+  if (dr >= ULORAWAN_REGION_MAX_DR ||
+      params->desc->data_rates[dr].max_payload == 0) {
+    return NULL;
+  }
+
+  return &params->desc->data_rates[dr];
+}
+
+// Decode a 24 bit little endian frequency in units of 100 Hz
+static uint32_t read_frequency(const uint8_t *const buf) {
+  return ((uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+          ((uint32_t)buf[2] << 16)) *
+         100;
+}
+
+static int32_t update_dynamic(struct ulorawan_region_params *const params,
+                              const uint8_t *const cflist) {
+  const struct ulorawan_region_desc *desc = params->desc;
+  const struct ulorawan_region_channels *defaults = &desc->channel_blocks[0];
+  uint32_t frequencies[ULORAWAN_REGION_CFLIST_FREQUENCIES];
+  uint8_t index = 0;
+
+  for (uint8_t i = 0; i < desc->channel_block_count; i++) {
+    index += desc->channel_blocks[i].count;
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_REGION_CFLIST_FREQUENCIES; i++) {
+    frequencies[i] = read_frequency(&cflist[i * ULORAWAN_FREQ_SIZE]);
+
+    if (frequencies[i] != 0 && (frequencies[i] < desc->min_frequency ||
+                                frequencies[i] > desc->max_frequency)) {
+      return ULORAWAN_REGION_ERR_FAIL;
+    }
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_REGION_CFLIST_FREQUENCIES; i++) {
+    ulorawan_channel_plan_set(&params->plan, index + i, frequencies[i],
+                              defaults->min_dr, defaults->max_dr);
+  }
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+static int32_t update_fixed(struct ulorawan_region_params *const params,
+                            const uint8_t *const cflist) {
+  struct ulorawan_channel_mask mask;
+  uint8_t groups = (params->desc->max_channels + 15) / 16;
+
+  memset(&mask, 0, sizeof(mask));
+
+  for (uint8_t i = 0; i < groups && i < ULORAWAN_REGION_CFLIST_CHMASKS; i++) {
+    uint16_t chmask =
+        (uint16_t)(cflist[i * ULORAWAN_REGION_CHMASK_GROUP_SIZE] |
+                   (cflist[i * ULORAWAN_REGION_CHMASK_GROUP_SIZE + 1] << 8));
+
+    ulorawan_channel_plan_apply_chmask(&params->plan, &mask, i, chmask);
+  }
+
+  // Bits past the last channel of the region are RFU
+  for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MASK_WORDS; i++) {
+    mask.words[i] &= params->plan.defined.words[i];
+  }
+
+  if (ulorawan_channel_plan_set_enabled(&params->plan, &mask) !=
+      ULORAWAN_CHANNEL_PLAN_ERR_NONE) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  return ULORAWAN_REGION_ERR_NONE;
+}
+
+int32_t ulorawan_region_update_channels(struct ulorawan_region_params *const params,
+                                        const uint8_t *const cflist) {
+  enum ulorawan_cflist_type type = cflist[ULORAWAN_REGION_CFLIST_SIZE - 1];
+
+  if (type != params->desc->plan) {
+    return ULORAWAN_REGION_ERR_FAIL;
+  }
+
+  if (type == CFLIST_TYPE_DYNAMIC) {
+    return update_dynamic(params, cflist);
+  }
+
+  return update_fixed(params, cflist);
 }
 
 union version ulorawan_region_version() {
@@ -38,13 +38,38 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+
+#include "ulorawan_channel_plan.h"
 #include "ulorawan_common.h"
+#include "ulorawan_duty_cycle.h"
 
 //! The ulorawan region version.
 #define ULORAWAN_REGION_VERSION 0x02010004
 
 #define ULORAWAN_REGION_CHMASK_GROUP_SIZE 2
 
+//! The maximum dwell time in milliseconds when a dwell time limit applies
+#define ULORAWAN_REGION_DWELL_TIME 400
+//! The number of MaxEIRP values of a TxParamSetupReq
+#define ULORAWAN_REGION_MAX_EIRP_COUNT 16
+
+//! The size of a CFList in bytes
+#define ULORAWAN_REGION_CFLIST_SIZE 16
+//! The number of frequencies in a dynamic CFList
+#define ULORAWAN_REGION_CFLIST_FREQUENCIES 5
+//! The number of ChMask groups in a fixed CFList
+#define ULORAWAN_REGION_CFLIST_CHMASKS 6
+
+//! The maximum number of data rates in a region
+#define ULORAWAN_REGION_MAX_DR ULORAWAN_CHANNEL_PLAN_MAX_DR
+//! The maximum number of tx power levels in a region
+#define ULORAWAN_REGION_MAX_TX_POWER 16
+//! The maximum number of duty cycle bands in a region
+#define ULORAWAN_REGION_MAX_BANDS ULORAWAN_CHANNEL_PLAN_MAX_BANDS
+//! The maximum number of channel blocks in a region
+#define ULORAWAN_REGION_MAX_CHANNEL_BLOCKS 3
+
 #define ULORAWAN_REGION_ERR_NONE 0
 #define ULORAWAN_REGION_ERR_FAIL -1
 
@@ -58,6 +83,36 @@ extern "C" {
 #define ACTIVE_REGION REGION_EU868
 #endif
 
+// Define one or more ULORAWAN_REGION_xxx_SUPPORT macros to link only the
+// required region descriptors. All regions are supported when none are defined.
+#if !defined(ULORAWAN_REGION_EU868_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_US915_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_CN779_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_EU433_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_AU915_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_CN470_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_AS923_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_AS923_2_SUPPORT) &&                               \
+    !defined(ULORAWAN_REGION_AS923_3_SUPPORT) &&                               \
+    !defined(ULORAWAN_REGION_KR920_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_IN865_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_RU864_SUPPORT) &&                                 \
+    !defined(ULORAWAN_REGION_AS923_4_SUPPORT)
+#define ULORAWAN_REGION_EU868_SUPPORT
+#define ULORAWAN_REGION_US915_SUPPORT
+#define ULORAWAN_REGION_CN779_SUPPORT
+#define ULORAWAN_REGION_EU433_SUPPORT
+#define ULORAWAN_REGION_AU915_SUPPORT
+#define ULORAWAN_REGION_CN470_SUPPORT
+#define ULORAWAN_REGION_AS923_SUPPORT
+#define ULORAWAN_REGION_AS923_2_SUPPORT
+#define ULORAWAN_REGION_AS923_3_SUPPORT
+#define ULORAWAN_REGION_KR920_SUPPORT
+#define ULORAWAN_REGION_IN865_SUPPORT
+#define ULORAWAN_REGION_RU864_SUPPORT
+#define ULORAWAN_REGION_AS923_4_SUPPORT
+#endif
+
 //! The Regional Parameter Channel Plan Common Names
 enum ulorawan_region {
   REGION_NONE,
@@ -112,27 +167,408 @@ struct ulorawan_cflist {
   enum ulorawan_cflist_type type;
 };
 
-//! A ulorawan channel
-struct ulorawan_channel {
-  //! The channel frequency
+//! A region data rate definition
+struct ulorawan_region_dr {
+  //! The modulation, an ulorawan_modulation value
+  uint8_t modulation;
+  //! The LoRa spread factor, an ulorawan_sf value
+  uint8_t sf;
+  //! The LoRa bandwidth, an ulorawan_bw value
+  uint8_t bw;
+  //! The maximum MACPayload size in bytes, zero when the data rate is RFU
+  uint8_t max_payload;
+};
+
+//! A region sub-band with a duty cycle limit
+struct ulorawan_region_band {
+  //! The lowest frequency of the band in Hz
+  uint32_t min_frequency;
+  //! The highest frequency of the band in Hz
+  uint32_t max_frequency;
+  //! The reciprocal of the permitted duty cycle, 1 for no limit
+  uint16_t duty_cycle;
+};
+
+//! A block of evenly spaced region channels
+struct ulorawan_region_channels {
+  //! The frequency of the first channel in Hz
   uint32_t frequency;
-  //! The channel modulation type
-  enum ulorawan_modulation modulation;
+  //! The spacing between channels in Hz
+  uint32_t step;
+  //! The number of channels
+  uint8_t count;
+  //! The lowest uplink data rate of the channels
+  uint8_t min_dr;
+  //! The highest uplink data rate of the channels
+  uint8_t max_dr;
+  //! The lowest data rate of a join request on the channels when above
+  //! min_dr
+  uint8_t join_dr;
+};
+
+//! A region descriptor
+struct ulorawan_region_desc {
+  //! The region
+  enum ulorawan_region region;
+  //! The channel plan type
+  enum ulorawan_cflist_type plan;
+  //! The lowest frequency of the region in Hz
+  uint32_t min_frequency;
+  //! The highest frequency of the region in Hz
+  uint32_t max_frequency;
+  //! The maximum number of uplink channels
+  uint8_t max_channels;
+  //! The number of channel blocks
+  uint8_t channel_block_count;
+  //! The default channels for a dynamic plan or all channels of a fixed plan
+  struct ulorawan_region_channels channel_blocks[ULORAWAN_REGION_MAX_CHANNEL_BLOCKS];
+  //! The downlink channels of a fixed plan, count is zero for dynamic plans
+  struct ulorawan_region_channels downlink;
+  //! The RX2 default frequency in Hz
+  uint32_t rx2_frequency;
+  //! The RX2 default data rate
+  uint8_t rx2_dr;
+  //! The data rate definitions
+  struct ulorawan_region_dr data_rates[ULORAWAN_REGION_MAX_DR];
+  //! The number of duty cycle bands
+  uint8_t band_count;
+  //! The duty cycle bands
+  struct ulorawan_region_band bands[ULORAWAN_REGION_MAX_BANDS];
+  //! The number of tx power levels
+  uint8_t tx_power_count;
+  //! The EIRP in dBm of each tx power level
+  int8_t tx_power[ULORAWAN_REGION_MAX_TX_POWER];
+  //! Non zero when the region supports TxParamSetupReq
+  uint8_t tx_param_setup;
+  //! The default uplink dwell time, non zero for a 400 ms limit
+  uint8_t uplink_dwell_time;
 };
 
+//! The region parameters
 struct ulorawan_region_params {
-    enum ulorawan_region region;
+  //! The region
+  enum ulorawan_region region;
+  //! The region descriptor
+  const struct ulorawan_region_desc *desc;
   //! The RX 1 delay
   uint32_t rx_delay_1;
   //! The RX 2 delay
   uint32_t rx_delay_2;
+  //! The RX 2 frequency
+  uint32_t rx2_frequency;
+  //! The RX 2 data rate
+  uint8_t rx2_dr;
+  //! The uplink data rate
+  uint8_t data_rate;
+  //! The uplink tx power level
+  uint8_t tx_power;
+  //! Non zero when uplinks are limited to the dwell time
+  uint8_t uplink_dwell_time;
+  //! Non zero when downlinks are limited to the dwell time
+  uint8_t downlink_dwell_time;
+  //! The maximum EIRP in dBm
+  int8_t max_eirp;
+  //! The maximum MACPayload size of each data rate under the current limits
+  uint8_t max_payload[ULORAWAN_REGION_MAX_DR];
+  //! The channel plan
+  struct ulorawan_channel_plan plan;
+  //! The duty cycle accounting
+  struct ulorawan_duty_cycle duty_cycle;
 };
 
-int32_t ulorawan_region_get_channel(const struct ulorawan_channel const *channel);
+/**
+ * \brief Get a random enabled and available channel for an uplink at the
+ * current data rate.
+ *
+ * \param[in] params The region parameters.
+ * \param[out] channel The selected channel.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL No channel is available.
+ */
+int32_t ulorawan_region_get_channel(struct ulorawan_region_params *const params,
+                                    struct ulorawan_channel *const channel);
+
+/**
+ * \brief Get a channel for a join request.
+ *
+ * The uplink data rate is moved into the join range of the selected
+ * channel.
+ *
+ * \param[in] params The region parameters.
+ * \param[out] channel The selected channel.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL No channel is available.
+ */
+int32_t
+ulorawan_region_get_join_channel(struct ulorawan_region_params *const params,
+                                 struct ulorawan_channel *const channel);
+
+/**
+ * \brief Record the channel of an accepted join request.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] channel The channel of the accepted join request.
+ */
+void ulorawan_region_join_accepted(struct ulorawan_region_params *const params,
+                                   const struct ulorawan_channel *const channel);
+
+/**
+ * \brief Record the airtime of an uplink against the duty cycle limits.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] band The band of the uplink channel.
+ * \param[in] start The time in milliseconds the uplink started.
+ * \param[in] end The time in milliseconds the uplink ended.
+ */
+void ulorawan_region_record_tx(struct ulorawan_region_params *const params,
+                               uint8_t band, uint32_t start, uint32_t end);
+
+/**
+ * \brief Get the earliest time the duty cycle limits allow an uplink.
+ *
+ * \param[in] params The region parameters.
+ *
+ * \return The time in milliseconds.
+ */
+uint32_t
+ulorawan_region_next_tx_time(const struct ulorawan_region_params *const params);
+
+/**
+ * \brief Set the aggregated duty cycle limit of a DutyCycleReq.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] max_duty_cycle The MaxDutyCycle value.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The value is out of range.
+ */
+int32_t
+ulorawan_region_set_max_duty_cycle(struct ulorawan_region_params *const params,
+                                   uint8_t max_duty_cycle);
+
+/**
+ * \brief Apply the parameters of a TxParamSetupReq and recompute the maximum
+ * payload size of each data rate.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] uplink_dwell_time Non zero to limit uplinks to the dwell time.
+ * \param[in] downlink_dwell_time Non zero to limit downlinks to the dwell
+ * time.
+ * \param[in] max_eirp The MaxEIRP index.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The region does not support
+ * TxParamSetupReq or the index is invalid.
+ */
+int32_t ulorawan_region_set_tx_params(struct ulorawan_region_params *const params,
+                                      uint8_t uplink_dwell_time,
+                                      uint8_t downlink_dwell_time,
+                                      uint8_t max_eirp);
+
+/**
+ * \brief Get the maximum MACPayload size of a data rate under the current
+ * dwell time limit.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] dr The data rate.
+ *
+ * \return The size in bytes, zero when the data rate can not be used.
+ */
+uint8_t
+ulorawan_region_max_payload(const struct ulorawan_region_params *const params,
+                            uint8_t dr);
+
+/**
+ * \brief Find the data rate to send a MACPayload with.
+ *
+ * The current data rate is used when the payload fits, otherwise the lowest
+ * faster data rate with an eligible channel that fits the payload.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] size The MACPayload size in bytes.
+ * \param[out] dr The data rate to use.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL No data rate can carry the payload.
+ */
+int32_t ulorawan_region_fit_payload(const struct ulorawan_region_params *const params,
+                                    uint8_t size, uint8_t *const dr);
+
+/**
+ * \brief Get the EIRP of a tx power level limited by the maximum EIRP.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] tx_power The tx power level.
+ *
+ * \return The EIRP in dBm.
+ */
+int8_t ulorawan_region_get_eirp(const struct ulorawan_region_params *const params,
+                                uint8_t tx_power);
+
+/**
+ * \brief Apply a LinkADRReq channel mask to a channel mask without changing
+ * the enabled channels.
+ *
+ * The resulting mask is not validated so that the masks of a LinkADRReq
+ * block can be accumulated, see ulorawan_region_chmask_valid.
+ *
+ * \param[in] params The region parameters.
+ * \param[in,out] mask The channel mask to update.
+ * \param[in] cntl The channel mask control.
+ * \param[in] chmask The channel mask.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The control is not supported.
+ */
+int32_t ulorawan_region_chmask(const struct ulorawan_region_params *const params,
+                               struct ulorawan_channel_mask *const mask,
+                               uint8_t cntl, uint16_t chmask);
+
+/**
+ * \brief Check that a channel mask can be enabled.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] mask The channel mask.
+ *
+ * \return True when the mask is not empty and only holds defined channels.
+ */
+bool ulorawan_region_chmask_valid(
+    const struct ulorawan_region_params *const params,
+    const struct ulorawan_channel_mask *const mask);
+
+/**
+ * \brief Check whether a data rate can be used with a channel mask.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] mask The channel mask.
+ * \param[in] dr The data rate.
+ *
+ * \return True when the data rate is defined, carries a payload and is
+ * supported by a channel of the mask.
+ */
+bool ulorawan_region_dr_valid(const struct ulorawan_region_params *const params,
+                              const struct ulorawan_channel_mask *const mask,
+                              uint8_t dr);
+
+/**
+ * \brief Check whether a frequency is in the band of the region.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] frequency The frequency in Hz.
+ *
+ * \return True when the frequency is one NewChannelReq may set.
+ */
+bool ulorawan_region_frequency_valid(
+    const struct ulorawan_region_params *const params, uint32_t frequency);
+
+/**
+ * \brief Replace the enabled channels.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] mask The channels to enable.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The mask can not be enabled.
+ */
+int32_t ulorawan_region_set_chmask(struct ulorawan_region_params *const params,
+                                   const struct ulorawan_channel_mask *const mask);
+
+/**
+ * \brief Enable the default channels of the region.
+ *
+ * \param[in] params The region parameters.
+ */
+void ulorawan_region_enable_default_channels(
+    struct ulorawan_region_params *const params);
+
+/**
+ * \brief Apply a LinkADRReq channel mask to the enabled channels.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] cntl The channel mask control.
+ * \param[in] chmask The channel mask.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The channel mask is invalid and was not
+ * applied.
+ */
+int32_t ulorawan_region_apply_chmask(struct ulorawan_region_params *const params,
+                                     uint8_t cntl, uint16_t chmask);
 
+/**
+ * \brief Initialise the region parameters for the active region.
+ *
+ * \param[out] params The region parameters.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The active region is not supported.
+ */
 int32_t ulorawan_region_init_params(struct ulorawan_region_params *const params);
 
-int32_t ulorawan_region_update_channels(struct ulorawan_cflist sflist);
+/**
+ * \brief Initialise the region parameters for a region.
+ *
+ * \param[out] params The region parameters.
+ * \param[in] region The region to select.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The region is not supported.
+ */
+int32_t ulorawan_region_select(struct ulorawan_region_params *const params,
+                               enum ulorawan_region region);
+
+/**
+ * \brief Get the descriptor of a region.
+ *
+ * \param[in] region The region.
+ *
+ * \return The region descriptor or NULL if the region is not supported.
+ */
+const struct ulorawan_region_desc *
+ulorawan_region_get_desc(enum ulorawan_region region);
+
+/**
+ * \brief Get the definition of a data rate for the selected region.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] dr The data rate.
+ *
+ * \return The data rate definition or NULL if the data rate is not defined.
+ */
+const struct ulorawan_region_dr *
+ulorawan_region_get_dr(const struct ulorawan_region_params *const params,
+                       uint8_t dr);
+
+/**
+ * \brief Apply the CFList of a join accept to the channel plan.
+ *
+ * A dynamic CFList defines up to five channels following the default
+ * channels, a fixed CFList replaces the enabled channels with its ChMasks.
+ * The CFList is validated before any channel is changed.
+ *
+ * \param[in] params The region parameters.
+ * \param[in] cflist The ULORAWAN_REGION_CFLIST_SIZE byte CFList within the
+ * join accept.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_REGION_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_REGION_ERR_FAIL The CFList does not match the region or
+ * holds an invalid channel.
+ */
+int32_t ulorawan_region_update_channels(struct ulorawan_region_params *const params,
+                                        const uint8_t *const cflist);
 
 /**
  * \brief Get the ulorawan region version
@@ -0,0 +1,338 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan region descriptor tables from the RP002-1.0.4 regional parameters
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "ulorawan_region_tables.h"
+
+// Each descriptor is a separate const object so that unreferenced regions
+// are discarded when building with -fdata-sections and --gc-sections.
+
+#define LORA(_sf, _bw, _m)                                                     \
+  { MODULATION_LORA, SPREAD_FACTOR_##_sf, BW_##_bw, _m }
+#define FSK(_m)                                                                \
+  { MODULATION_FSK, 0, 0, _m }
+#define LR_FHSS(_m)                                                            \
+  { MODULATION_LR_FHSS, 0, 0, _m }
+#define RFU                                                                    \
+  { 0, 0, 0, 0 }
+
+#define EU868_LIKE_DATA_RATES                                                  \
+  {                                                                            \
+    LORA(12, 125, 59), LORA(11, 125, 59), LORA(10, 125, 59),                   \
+        LORA(9, 125, 123), LORA(8, 125, 230), LORA(7, 125, 230),               \
+        LORA(7, 250, 230), FSK(230)                                            \
+  }
+
+#define AS923_DATA_RATES                                                       \
+  {                                                                            \
+    LORA(12, 125, 59), LORA(11, 125, 59), LORA(10, 125, 123),                  \
+        LORA(9, 125, 123), LORA(8, 125, 250), LORA(7, 125, 250),               \
+        LORA(7, 250, 250), FSK(250)                                            \
+  }
+
+#define AS923_TX_POWER                                                         \
+  { 16, 14, 12, 10, 8, 6, 4, 2 }
+
+#define FIXED_PLAN_TX_POWER                                                    \
+  { 30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2 }
+
+#ifdef ULORAWAN_REGION_EU868_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_eu868 = {
+    .region = REGION_EU868,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 863000000,
+    .max_frequency = 870000000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{868100000, 200000, 3, DR_0, DR_5}},
+    .rx2_frequency = 869525000,
+    .rx2_dr = DR_0,
+    .data_rates = {LORA(12, 125, 59), LORA(11, 125, 59), LORA(10, 125, 59),
+                   LORA(9, 125, 123), LORA(8, 125, 230), LORA(7, 125, 230),
+                   LORA(7, 250, 230), FSK(230), LR_FHSS(58), LR_FHSS(123),
+                   LR_FHSS(58), LR_FHSS(123)},
+    .band_count = 6,
+    .bands = {{863000000, 865000000, 1000},
+              {865000000, 868000000, 100},
+              {868000000, 868600000, 100},
+              {868700000, 869200000, 1000},
+              {869400000, 869650000, 10},
+              {869700000, 870000000, 100}},
+    .tx_power_count = 8,
+    .tx_power = {16, 14, 12, 10, 8, 6, 4, 2}};
+#endif
+
+#ifdef ULORAWAN_REGION_US915_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_us915 = {
+    .region = REGION_US915,
+    .plan = CFLIST_TYPE_FIXED,
+    .min_frequency = 902000000,
+    .max_frequency = 928000000,
+    .max_channels = 72,
+    .channel_block_count = 2,
+    .channel_blocks = {{902300000, 200000, 64, DR_0, DR_3},
+                       {903000000, 1600000, 8, DR_4, DR_4}},
+    .downlink = {923300000, 600000, 8, DR_8, DR_13},
+    .rx2_frequency = 923300000,
+    .rx2_dr = DR_8,
+    .data_rates = {LORA(10, 125, 19), LORA(9, 125, 61), LORA(8, 125, 133),
+                   LORA(7, 125, 250), LORA(8, 500, 250), LR_FHSS(58),
+                   LR_FHSS(133), RFU, LORA(12, 500, 61), LORA(11, 500, 137),
+                   LORA(10, 500, 250), LORA(9, 500, 250), LORA(8, 500, 250),
+                   LORA(7, 500, 250)},
+    .band_count = 1,
+    .bands = {{902000000, 928000000, 1}},
+    .tx_power_count = 15,
+    .tx_power = FIXED_PLAN_TX_POWER};
+#endif
+
+#ifdef ULORAWAN_REGION_CN779_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_cn779 = {
+    .region = REGION_CN779,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 779500000,
+    .max_frequency = 786500000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{779500000, 200000, 3, DR_0, DR_5}},
+    .rx2_frequency = 786000000,
+    .rx2_dr = DR_0,
+    .data_rates = EU868_LIKE_DATA_RATES,
+    .band_count = 1,
+    .bands = {{779500000, 786500000, 100}},
+    .tx_power_count = 6,
+    .tx_power = {12, 10, 8, 6, 4, 2}};
+#endif
+
+#ifdef ULORAWAN_REGION_EU433_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_eu433 = {
+    .region = REGION_EU433,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 433175000,
+    .max_frequency = 434665000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{433175000, 200000, 3, DR_0, DR_5}},
+    .rx2_frequency = 434665000,
+    .rx2_dr = DR_0,
+    .data_rates = EU868_LIKE_DATA_RATES,
+    .band_count = 1,
+    .bands = {{433175000, 434665000, 100}},
+    .tx_power_count = 6,
+    .tx_power = {12, 10, 8, 6, 4, 2}};
+#endif
+
+#ifdef ULORAWAN_REGION_AU915_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_au915 = {
+    .region = REGION_AU915,
+    .plan = CFLIST_TYPE_FIXED,
+    .min_frequency = 915000000,
+    .max_frequency = 928000000,
+    .max_channels = 72,
+    .channel_block_count = 2,
+    .channel_blocks = {{915200000, 200000, 64, DR_0, DR_5, DR_2},
+                       {915900000, 1600000, 8, DR_6, DR_6, DR_6}},
+    .downlink = {923300000, 600000, 8, DR_8, DR_13},
+    .rx2_frequency = 923300000,
+    .rx2_dr = DR_8,
+    .data_rates = {LORA(12, 125, 59), LORA(11, 125, 59), LORA(10, 125, 59),
+                   LORA(9, 125, 123), LORA(8, 125, 230), LORA(7, 125, 230),
+                   LORA(8, 500, 230), LR_FHSS(58), LORA(12, 500, 61),
+                   LORA(11, 500, 137), LORA(10, 500, 250), LORA(9, 500, 250),
+                   LORA(8, 500, 250), LORA(7, 500, 250)},
+    .band_count = 1,
+    .bands = {{915000000, 928000000, 1}},
+    .tx_power_count = 15,
+    .tx_power = FIXED_PLAN_TX_POWER,
+    .tx_param_setup = 1,
+    .uplink_dwell_time = 1};
+#endif
+
+#ifdef ULORAWAN_REGION_CN470_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_cn470 = {
+    .region = REGION_CN470,
+    .plan = CFLIST_TYPE_FIXED,
+    .min_frequency = 470000000,
+    .max_frequency = 510000000,
+    .max_channels = 96,
+    .channel_block_count = 1,
+    .channel_blocks = {{470300000, 200000, 96, DR_0, DR_5}},
+    .downlink = {500300000, 200000, 48, DR_0, DR_5},
+    .rx2_frequency = 505300000,
+    .rx2_dr = DR_0,
+    .data_rates = {LORA(12, 125, 59), LORA(11, 125, 59), LORA(10, 125, 59),
+                   LORA(9, 125, 123), LORA(8, 125, 230), LORA(7, 125, 230),
+                   LORA(7, 500, 230), FSK(230)},
+    .band_count = 1,
+    .bands = {{470000000, 510000000, 1}},
+    .tx_power_count = 8,
+    .tx_power = {19, 17, 15, 13, 11, 9, 7, 5}};
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_as923 = {
+    .region = REGION_AS923,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 915000000,
+    .max_frequency = 928000000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{923200000, 200000, 2, DR_0, DR_5, DR_2}},
+    .rx2_frequency = 923200000,
+    .rx2_dr = DR_2,
+    .data_rates = AS923_DATA_RATES,
+    .band_count = 1,
+    .bands = {{915000000, 928000000, 100}},
+    .tx_power_count = 8,
+    .tx_power = AS923_TX_POWER,
+    .tx_param_setup = 1,
+    .uplink_dwell_time = 1};
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_2_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_as923_2 = {
+    .region = REGION_AS923_2,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 915000000,
+    .max_frequency = 928000000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{921400000, 200000, 2, DR_0, DR_5, DR_2}},
+    .rx2_frequency = 921400000,
+    .rx2_dr = DR_2,
+    .data_rates = AS923_DATA_RATES,
+    .band_count = 1,
+    .bands = {{915000000, 928000000, 100}},
+    .tx_power_count = 8,
+    .tx_power = AS923_TX_POWER,
+    .tx_param_setup = 1,
+    .uplink_dwell_time = 1};
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_3_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_as923_3 = {
+    .region = REGION_AS923_3,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 915000000,
+    .max_frequency = 928000000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{916600000, 200000, 2, DR_0, DR_5, DR_2}},
+    .rx2_frequency = 916600000,
+    .rx2_dr = DR_2,
+    .data_rates = AS923_DATA_RATES,
+    .band_count = 1,
+    .bands = {{915000000, 928000000, 100}},
+    .tx_power_count = 8,
+    .tx_power = AS923_TX_POWER,
+    .tx_param_setup = 1,
+    .uplink_dwell_time = 1};
+#endif
+
+#ifdef ULORAWAN_REGION_KR920_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_kr920 = {
+    .region = REGION_KR920,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 920900000,
+    .max_frequency = 923300000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{922100000, 200000, 3, DR_0, DR_5}},
+    .rx2_frequency = 921900000,
+    .rx2_dr = DR_0,
+    .data_rates = {LORA(12, 125, 59), LORA(11, 125, 59), LORA(10, 125, 59),
+                   LORA(9, 125, 123), LORA(8, 125, 230), LORA(7, 125, 230)},
+    .band_count = 1,
+    .bands = {{920900000, 923300000, 1}},
+    .tx_power_count = 8,
+    .tx_power = {14, 12, 10, 8, 6, 4, 2, 0}};
+#endif
+
+#ifdef ULORAWAN_REGION_IN865_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_in865 = {
+    .region = REGION_IN865,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 865000000,
+    .max_frequency = 867000000,
+    .max_channels = 16,
+    .channel_block_count = 3,
+    .channel_blocks = {{865062500, 0, 1, DR_0, DR_5},
+                       {865402500, 0, 1, DR_0, DR_5},
+                       {865985000, 0, 1, DR_0, DR_5}},
+    .rx2_frequency = 866550000,
+    .rx2_dr = DR_2,
+    .data_rates = {LORA(12, 125, 59), LORA(11, 125, 59), LORA(10, 125, 59),
+                   LORA(9, 125, 123), LORA(8, 125, 230), LORA(7, 125, 230),
+                   RFU, FSK(230)},
+    .band_count = 1,
+    .bands = {{865000000, 867000000, 1}},
+    .tx_power_count = 11,
+    .tx_power = {30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10}};
+#endif
+
+#ifdef ULORAWAN_REGION_RU864_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_ru864 = {
+    .region = REGION_RU864,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 864000000,
+    .max_frequency = 870000000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{868900000, 200000, 2, DR_0, DR_5}},
+    .rx2_frequency = 869100000,
+    .rx2_dr = DR_0,
+    .data_rates = EU868_LIKE_DATA_RATES,
+    .band_count = 1,
+    .bands = {{864000000, 870000000, 100}},
+    .tx_power_count = 8,
+    .tx_power = {16, 14, 12, 10, 8, 6, 4, 2}};
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_4_SUPPORT
+const struct ulorawan_region_desc ulorawan_region_as923_4 = {
+    .region = REGION_AS923_4,
+    .plan = CFLIST_TYPE_DYNAMIC,
+    .min_frequency = 917000000,
+    .max_frequency = 920000000,
+    .max_channels = 16,
+    .channel_block_count = 1,
+    .channel_blocks = {{917300000, 200000, 2, DR_0, DR_5, DR_2}},
+    .rx2_frequency = 917300000,
+    .rx2_dr = DR_2,
+    .data_rates = AS923_DATA_RATES,
+    .band_count = 1,
+    .bands = {{917000000, 920000000, 100}},
+    .tx_power_count = 8,
+    .tx_power = AS923_TX_POWER,
+    .tx_param_setup = 1,
+    .uplink_dwell_time = 1};
+#endif
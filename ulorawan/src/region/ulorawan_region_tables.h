@@ -0,0 +1,112 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan region descriptor tables
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ULORAWAN_REGION_TABLES_H_
+#define ULORAWAN_REGION_TABLES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ulorawan_region.h"
+
+#ifdef ULORAWAN_REGION_EU868_SUPPORT
+//! The EU863-870 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_eu868;
+#endif
+
+#ifdef ULORAWAN_REGION_US915_SUPPORT
+//! The US902-928 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_us915;
+#endif
+
+#ifdef ULORAWAN_REGION_CN779_SUPPORT
+//! The CN779-787 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_cn779;
+#endif
+
+#ifdef ULORAWAN_REGION_EU433_SUPPORT
+//! The EU433 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_eu433;
+#endif
+
+#ifdef ULORAWAN_REGION_AU915_SUPPORT
+//! The AU915-928 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_au915;
+#endif
+
+#ifdef ULORAWAN_REGION_CN470_SUPPORT
+//! The CN470-510 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_cn470;
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_SUPPORT
+//! The AS923-1 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_as923;
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_2_SUPPORT
+//! The AS923-2 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_as923_2;
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_3_SUPPORT
+//! The AS923-3 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_as923_3;
+#endif
+
+#ifdef ULORAWAN_REGION_KR920_SUPPORT
+//! The KR920-923 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_kr920;
+#endif
+
+#ifdef ULORAWAN_REGION_IN865_SUPPORT
+//! The IN865-867 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_in865;
+#endif
+
+#ifdef ULORAWAN_REGION_RU864_SUPPORT
+//! The RU864-870 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_ru864;
+#endif
+
+#ifdef ULORAWAN_REGION_AS923_4_SUPPORT
+//! The AS923-4 region descriptor
+extern const struct ulorawan_region_desc ulorawan_region_as923_4;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_REGION_TABLES_H_ */
@@ -36,14 +36,33 @@
 
 #include "log_hal.h"
 #include "ulorawan.h"
+#include "ulorawan_adr.h"
+#include "ulorawan_aggregate.h"
+#include "ulorawan_class_b.h"
+#include "ulorawan_class_c.h"
+#include "ulorawan_energy.h"
 #include "ulorawan_irq.h"
 #include "ulorawan_error_codes.h"
 #include "ulorawan_events.h"
+#include "ulorawan_fcnt.h"
+#include "ulorawan_frag.h"
+#include "ulorawan_latency.h"
+#include "ulorawan_lbt.h"
+#include "ulorawan_multicast.h"
+#include "ulorawan_snapshot.h"
+#include "ulorawan_store.h"
+#include "ulorawan_uplink.h"
+#include "ulorawan_uplink_queue.h"
+
+//! The lowest application port
+#define FPORT_MIN 1
+//! The highest application port
+#define FPORT_MAX 223
 
 static struct ulorawan_session session = {ULORAWAN_STATE_INIT};
 static struct osal_queue event_queue;
 
-static int32_t ulorawan_send_event(const struct ulorawan_event *const event);
+static int32_t ulorawan_send_event(struct ulorawan_event *const event);
 
 static int32_t ulorawan_timer_expire_handler(enum timer_hal_timer timer);
 
@@ -67,9 +86,36 @@ int32_t ulorawan_init(enum ulorawan_device_class class,
     return ULORAWAN_ERR_REGION;
   }
 
+  if (ulorawan_store_init(&session.store) != ULORAWAN_ERR_NONE) {
+    session.state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_NVM;
+  }
+
   session.state = ULORAWAN_STATE_IDLE;
   session.security = security;
   session.class = class;
+  session.adr.nb_trans = 1;
+  session.fcnt.block = ULORAWAN_FCNT_RESERVE;
+#ifdef ULORAWAN_LATENCY_ENABLED
+  ulorawan_latency_reset(&session.latency);
+#endif // ULORAWAN_LATENCY_ENABLED
+#ifdef ULORAWAN_ENERGY_ENABLED
+  ulorawan_energy_reset(&session.energy);
+#endif // ULORAWAN_ENERGY_ENABLED
+
+  if (security.type == ACTIVATION_ABP) {
+    session.keys.dev_addr = security.context.abp.dev_addr;
+    memcpy(session.keys.nwk_s_key, security.context.abp.nwk_s_key,
+           ULORAWAN_NWK_S_KEY_SIZE);
+    memcpy(session.keys.app_s_key, security.context.abp.app_s_key,
+           ULORAWAN_APP_S_KEY_SIZE);
+  }
+
+  if (ulorawan_store_load_session(&session) != ULORAWAN_ERR_NONE ||
+      ulorawan_fcnt_restore(&session) != ULORAWAN_ERR_NONE) {
+    session.state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_NVM;
+  }
 
   return ULORAWAN_ERR_NONE;
 }
@@ -85,7 +131,8 @@ int32_t ulorawan_join() {
 
   // struct ulorawan_channel channel;
   //
-  // if (ulorawan_region_get_channel(&channel) != ULORAWAN_REGION_ERR_NONE) {
+  // if (ulorawan_region_get_join_channel(&session.region_params, &channel) !=
+  //     ULORAWAN_REGION_ERR_NONE) {
   // return ULORAWAN_ERR_NO_CHANNEL;
   //}
   //
@@ -148,6 +195,297 @@ int32_t ulorawan_join() {
   return ULORAWAN_ERR_NONE;
 }
 
+int32_t ulorawan_send_frame(uint8_t port, const uint8_t *const payload,
+                            uint8_t size, bool confirm) {
+  return ulorawan_send_frame_priority(port, payload, size, confirm,
+                                      ULORAWAN_UPLINK_PRIORITY_NORMAL, 0);
+}
+
+int32_t ulorawan_send_frame_priority(uint8_t port,
+                                     const uint8_t *const payload,
+                                     uint8_t size, bool confirm,
+                                     uint8_t priority, uint32_t lifetime) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (port < FPORT_MIN || port > FPORT_MAX ||
+      (payload == NULL && size != 0)) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  struct ulorawan_uplink_req req = {.port = port,
+                                    .payload = payload,
+                                    .size = size,
+                                    .confirm = confirm,
+                                    .priority = priority,
+                                    .lifetime = lifetime};
+
+  return ulorawan_uplink_queue_push(&session.uplink_queue, &req,
+                                    timer_hal_get_time());
+}
+
+int32_t ulorawan_set_aggregation(uint8_t port, uint8_t threshold,
+                                 uint32_t max_age) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (port > FPORT_MAX) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  return ulorawan_aggregate_configure(&session, port, threshold, max_age);
+}
+
+int32_t ulorawan_send_record(const uint8_t *const record, uint8_t size) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (record == NULL || size == 0) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  return ulorawan_aggregate_add(&session, record, size, timer_hal_get_time());
+}
+
+int32_t ulorawan_flush_records() {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  return ulorawan_aggregate_flush(&session);
+}
+
+int32_t ulorawan_start_class_b(uint8_t periodicity) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  // The class C groups of a class A device give the radio up to class B
+  int32_t result = ulorawan_class_c_stop(&session);
+
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  return ulorawan_class_b_start(&session, periodicity);
+}
+
+int32_t ulorawan_stop_class_b() {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  return ulorawan_class_b_stop(&session);
+}
+
+int32_t
+ulorawan_add_multicast(const struct ulorawan_multicast_group *const group) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (group == NULL || (group->class != DEVICE_CLASS_B &&
+                        group->class != DEVICE_CLASS_C)) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  // Class C listens on one channel, a group elsewhere would hide unicast
+  if (group->class == DEVICE_CLASS_C &&
+      (group->frequency != session.region_params.rx2_frequency ||
+       group->dr != session.region_params.rx2_dr)) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  if (group->class == DEVICE_CLASS_B &&
+      (group->frequency == 0 ||
+       group->periodicity > ULORAWAN_CLASS_B_MAX_PERIODICITY ||
+       ulorawan_region_get_dr(&session.region_params, group->dr) == NULL)) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  // The task starts listening for a class C group once the stack is idle
+  return ulorawan_multicast_add(&session.multicast, group);
+}
+
+int32_t ulorawan_remove_multicast(uint32_t dev_addr) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  int32_t result = ulorawan_multicast_remove(&session.multicast, dev_addr);
+
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  // The task listens again while class C groups remain
+  return ulorawan_class_c_stop(&session);
+}
+
+int32_t ulorawan_get_frag_block(uint32_t *const size) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (size == NULL) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  *size = ulorawan_frag_block_size(&session.frag);
+
+  return *size != 0 ? ULORAWAN_ERR_NONE : ULORAWAN_ERR_STATE;
+}
+
+int32_t ulorawan_save_snapshot(uint8_t *const buf, size_t size) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (session.state != ULORAWAN_STATE_IDLE &&
+      session.state != ULORAWAN_STATE_RXC) {
+    return ULORAWAN_ERR_STATE;
+  }
+
+  if (buf == NULL) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  return ulorawan_snapshot_save(&session, buf, size);
+}
+
+int32_t ulorawan_restore_snapshot(const uint8_t *const buf, size_t size) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (session.state != ULORAWAN_STATE_IDLE) {
+    return ULORAWAN_ERR_STATE;
+  }
+
+  if (buf == NULL) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  return ulorawan_snapshot_restore(&session, buf, size);
+}
+
+int32_t ulorawan_set_fcnt_reserve(uint16_t block) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (block == 0) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  session.fcnt.block = block;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_set_adr(bool enabled) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  ulorawan_adr_set_enabled(&session, enabled);
+
+  return ULORAWAN_ERR_NONE;
+}
+
+#ifdef ULORAWAN_LATENCY_ENABLED
+int32_t ulorawan_get_latency(enum ulorawan_state from, enum ulorawan_state to,
+                             struct ulorawan_latency_histogram *const histogram) {
+  const struct ulorawan_latency_histogram *found;
+
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (histogram == NULL) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  found = ulorawan_latency_find(&session.latency, from, to);
+  if (found != NULL) {
+    *histogram = *found;
+  } else {
+    memset(histogram, 0, sizeof(struct ulorawan_latency_histogram));
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t
+ulorawan_get_queue_latency(enum ulorawan_event_type type,
+                           struct ulorawan_latency_histogram *const histogram) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (histogram == NULL) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  *histogram = type == EVENT_TYPE_RADIO_IRQ ? session.latency.radio_queue
+                                            : session.latency.timer_queue;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_dump_latency(char *const buf, size_t size,
+                              size_t *const length) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if ((buf == NULL && size != 0) || length == NULL) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  *length = ulorawan_latency_dump(&session.latency, buf, size);
+
+  return ULORAWAN_ERR_NONE;
+}
+#endif // ULORAWAN_LATENCY_ENABLED
+
+#ifdef ULORAWAN_ENERGY_ENABLED
+int32_t ulorawan_set_radio_current(enum RADIO_HAL_MODE mode,
+                                   uint32_t microamps) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (mode >= ULORAWAN_ENERGY_MODES) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  // Charge the time already spent in the mode at the previous current
+  ulorawan_energy_update(&session.energy);
+  session.energy.current[mode] = microamps;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_get_energy(struct ulorawan_energy *const energy) {
+  if (session.state == ULORAWAN_STATE_INIT) {
+    return ULORAWAN_ERR_INIT;
+  }
+
+  if (energy == NULL) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  ulorawan_energy_update(&session.energy);
+  *energy = session.energy;
+
+  return ULORAWAN_ERR_NONE;
+}
+#endif // ULORAWAN_ENERGY_ENABLED
+
 int32_t ulorawan_radio_irq(const enum radio_hal_irq_flags flags) {
   if (session.state == ULORAWAN_STATE_INIT) {
     return ULORAWAN_ERR_INIT;
@@ -178,14 +516,60 @@ int32_t ulorawan_task() {
       result = ULORAWAN_ERR_QUEUE;
     } else {
       log_hal_log_info("Processing event type: [0x%02X]", event.type);
+#if defined(ULORAWAN_LATENCY_ENABLED) || defined(ULORAWAN_ENERGY_ENABLED)
+      enum ulorawan_state from = session.state;
+#endif
+#ifdef ULORAWAN_LATENCY_ENABLED
+      ulorawan_latency_dequeue(&session.latency, &event);
+#endif // ULORAWAN_LATENCY_ENABLED
       if (event.type == EVENT_TYPE_RADIO_IRQ) {
+#ifdef ULORAWAN_ENERGY_ENABLED
+        ulorawan_energy_irq(&session.energy, event.data.flags);
+#endif // ULORAWAN_ENERGY_ENABLED
         result = ulorawan_radio_irq_handler(&session, event.data.flags);
       } else {
         result = ulorawan_timer_expire_handler(event.data.timer);
       }
+#ifdef ULORAWAN_LATENCY_ENABLED
+      ulorawan_latency_step(&session.latency, from, session.state);
+#endif // ULORAWAN_LATENCY_ENABLED
+#ifdef ULORAWAN_ENERGY_ENABLED
+      ulorawan_energy_step(&session.energy, from, session.state,
+                           event.type == EVENT_TYPE_RADIO_IRQ &&
+                               (event.data.flags & RADIO_HAL_IRQ_RX_DONE) &&
+                               result == ULORAWAN_ERR_NONE);
+#endif // ULORAWAN_ENERGY_ENABLED
     }
   };
 
+#if defined(ULORAWAN_LATENCY_ENABLED) || defined(ULORAWAN_ENERGY_ENABLED)
+  enum ulorawan_state from = session.state;
+#endif
+
+  if (result == ULORAWAN_ERR_NONE && (session.state == ULORAWAN_STATE_IDLE ||
+                                      session.state == ULORAWAN_STATE_RXC)) {
+    // Changes from the events are persisted together once the stack is idle
+    if (ulorawan_store_save_session(&session) != ULORAWAN_ERR_NONE) {
+      log_hal_log_error("Session not persisted");
+    }
+
+    result = ulorawan_uplink_dispatch(&session);
+  }
+
+  if (result == ULORAWAN_ERR_NONE && session.state == ULORAWAN_STATE_IDLE) {
+    result = ulorawan_class_c_start(&session);
+  }
+
+#ifdef ULORAWAN_LATENCY_ENABLED
+  // An uplink or class C listen started by the task is a step of its own
+  if (session.state != from) {
+    ulorawan_latency_step(&session.latency, from, session.state);
+  }
+#endif // ULORAWAN_LATENCY_ENABLED
+#ifdef ULORAWAN_ENERGY_ENABLED
+  ulorawan_energy_step(&session.energy, from, session.state, false);
+#endif // ULORAWAN_ENERGY_ENABLED
+
   log_hal_log_debug("Task end [0x%i]", result);
 
   return result;
@@ -213,7 +597,10 @@ union version ulorawan_version() {
   return v;
 }
 
-int32_t ulorawan_send_event(const struct ulorawan_event *const event) {
+int32_t ulorawan_send_event(struct ulorawan_event *const event) {
+#ifdef ULORAWAN_LATENCY_ENABLED
+  ulorawan_latency_enqueue(event);
+#endif // ULORAWAN_LATENCY_ENABLED
 
   if (osal_queue_send(&event_queue, event) != OSAL_QUEUE_ERR_NONE) {
     session.state = ULORAWAN_STATE_FAULT;
@@ -224,16 +611,34 @@ int32_t ulorawan_send_event(const struct ulorawan_event *const event) {
 }
 
 int32_t ulorawan_timer_expire_handler(enum timer_hal_timer timer) {
+  if (timer == TIMER2) {
+    return ulorawan_class_b_timer(&session);
+  }
+
+#ifdef ULORAWAN_LBT_ENABLED
+  if (session.state == ULORAWAN_STATE_CAD && timer == TIMER0) {
+    return ulorawan_lbt_backoff_expired(&session);
+  }
+#endif // ULORAWAN_LBT_ENABLED
 
   if ((session.state == ULORAWAN_STATE_RX1 && timer == TIMER0) ||
       (session.state == ULORAWAN_STATE_RX2 && timer == TIMER1)) {
     log_hal_log_debug("Session state [0x%02X] timer: [0x%02X]", session.state,
                       timer);
+    // The radio is still on the uplink channel, or on the class C listening
+    // frequency, when the window opens
+    uint32_t frequency = session.state == ULORAWAN_STATE_RX1
+                             ? session.channel.rx1_frequency
+                             : session.region_params.rx2_frequency;
+
     log_hal_log_info("Set radio mode RX Single");
-    if (radio_hal_set_mode(MODE_RX_SINGLE) != RADIO_HAL_ERR_NONE) {
+    if (radio_hal_set_frequency(frequency) != RADIO_HAL_ERR_NONE ||
+        radio_hal_set_mode(MODE_RX_SINGLE) != RADIO_HAL_ERR_NONE) {
       session.state = ULORAWAN_STATE_FAULT;
       return ULORAWAN_ERR_RADIO;
     }
+
+    ULORAWAN_ENERGY_MODE(&session, MODE_RX_SINGLE);
   }
 
   return ULORAWAN_ERR_NONE;
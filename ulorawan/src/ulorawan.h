@@ -44,6 +44,7 @@ extern "C" {
 #include "timer_hal.h"
 #include "osal_queue.h"
 #include "ulorawan_common.h"
+#include "ulorawan_events.h"
 #include "ulorawan_session.h"
 
 //! The ulorawan specification version
@@ -66,6 +67,7 @@ SESSION_ACCESS ulorawan_get_session();
  * \return Operation status.
  * \retval ULORAWAN_ERR_RAND The rand initalisation failed.
  * \retval ULORAWAN_ERR_QUEUE The queue initalisation failed.
+ * \retval ULORAWAN_ERR_NVM The session store could not be mounted or read.
  * \retval ULORAWAN_ERR_NONE Operation executed successfully.
  */
 int32_t ulorawan_init(enum ulorawan_device_class class,
@@ -98,19 +100,338 @@ int32_t ulorawan_join();
 int32_t ulorawan_radio_irq(const enum radio_hal_irq_flags flags);
 
 /**
- * \brief
+ * \brief Queue an application message for uplink.
  *
- * \param port
- * \param payload
- * \param size
- * \param confirm
+ * The message is queued with ULORAWAN_UPLINK_PRIORITY_NORMAL and never
+ * expires. It is sent by ulorawan_task as soon as the stack is idle and the
+ * duty cycle limits allow.
+ *
+ * \param[in] port The application port, 1 to 223.
+ * \param[in] payload The payload.
+ * \param[in] size The payload size.
+ * \param[in] confirm True for a confirmed uplink.
  *
  * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The port or payload size is invalid.
+ * \retval ULORAWAN_ERR_FULL The uplink queue is full.
  * \retval ULORAWAN_ERR_NONE Operation executed successfully.
  */
 int32_t ulorawan_send_frame(uint8_t port, const uint8_t *const payload, uint8_t size,
                             bool confirm);
 
+/**
+ * \brief Queue an application message for uplink with a priority and an
+ * optional lifetime.
+ *
+ * Messages of higher priority are sent first and may displace queued
+ * messages of lower priority when the queue is full. A message still queued
+ * when its lifetime ends is dropped rather than sent late.
+ *
+ * \param[in] port The application port, 1 to 223.
+ * \param[in] payload The payload.
+ * \param[in] size The payload size.
+ * \param[in] confirm True for a confirmed uplink.
+ * \param[in] priority The priority, higher values are sent first.
+ * \param[in] lifetime The lifetime in milliseconds, zero to never expire.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The port or payload size is invalid.
+ * \retval ULORAWAN_ERR_FULL The uplink queue is full of messages of equal or
+ * higher priority.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_send_frame_priority(uint8_t port,
+                                     const uint8_t *const payload,
+                                     uint8_t size, bool confirm,
+                                     uint8_t priority, uint32_t lifetime);
+
+/**
+ * \brief Configure the packing of small application records into uplinks.
+ *
+ * Records sent with ulorawan_send_record are packed into one payload, each
+ * prefixed with a one byte length, and sent as one unconfirmed uplink once
+ * the packed size reaches the threshold, the oldest record reaches the
+ * maximum age, the next record would not fit the current data rate or
+ * ulorawan_flush_records is called.
+ *
+ * \param[in] port The application port, 1 to 223, or zero to turn
+ * aggregation off.
+ * \param[in] threshold The packed size in bytes at which the records are
+ * sent.
+ * \param[in] max_age The longest time in milliseconds a record waits.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The port is invalid.
+ * \retval ULORAWAN_ERR_FULL Pending records could not be queued.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_set_aggregation(uint8_t port, uint8_t threshold,
+                                 uint32_t max_age);
+
+/**
+ * \brief Add an application record to the next aggregated uplink.
+ *
+ * \param[in] record The record.
+ * \param[in] size The record size.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_STATE Aggregation is off.
+ * \retval ULORAWAN_ERR_PARAMS The record is invalid or does not fit an
+ * uplink at the current data rate.
+ * \retval ULORAWAN_ERR_FULL The uplink queue is full.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_send_record(const uint8_t *const record, uint8_t size);
+
+/**
+ * \brief Queue the pending application records as one uplink.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_FULL The uplink queue is full.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_flush_records();
+
+/**
+ * \brief Switch to class B.
+ *
+ * The stack listens for a beacon for up to one beacon period, then follows
+ * the beacons and opens a receive window in each ping slot. TIMER2 is used
+ * for the beacon and ping slot schedule. The device falls back to class A
+ * when no beacon is found or the beacon is lost. Class C multicast groups
+ * are not received while the device is class B.
+ *
+ * \param[in] periodicity The ping slot periodicity, a ping slot every
+ * 2^periodicity seconds, 0 to 7.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_STATE The stack is busy.
+ * \retval ULORAWAN_ERR_PARAMS The periodicity is invalid.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_TIMER The beacon timer could not be started.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_start_class_b(uint8_t periodicity);
+
+/**
+ * \brief Switch from class B back to class A.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_RADIO The radio could not be put in standby.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_stop_class_b();
+
+/**
+ * \brief Join a multicast group.
+ *
+ * Downlinks to the group address are authenticated and decrypted with the
+ * group keys and counted with the group frame counter. Class C groups are
+ * received on the RX2 frequency and data rate, the only channel class C
+ * listens on, even while the device is class A. Class B groups are received
+ * in ping slots of their own, on the group frequency and data rate, from the
+ * next beacon on while the device is class B.
+ *
+ * \param[in] group The group.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The group is invalid, a class C group is not
+ * on the RX2 channel, a class B group has no frequency, an invalid
+ * periodicity or data rate, or its address is in use.
+ * \retval ULORAWAN_ERR_FULL ULORAWAN_MULTICAST_MAX_GROUPS have been joined.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t
+ulorawan_add_multicast(const struct ulorawan_multicast_group *const group);
+
+/**
+ * \brief Leave a multicast group.
+ *
+ * A class A device stops receiving continuously, the next ulorawan_task
+ * resumes the reception while class C groups remain.
+ *
+ * \param[in] dev_addr The group address.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS No group has the address.
+ * \retval ULORAWAN_ERR_RADIO The radio could not be put in standby.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_remove_multicast(uint32_t dev_addr);
+
+/**
+ * \brief Get the fragmented data block received on ULORAWAN_FRAG_PORT.
+ *
+ * The data block is stored in non volatile memory from
+ * ULORAWAN_FRAG_NVM_ADDRESS.
+ *
+ * \param[out] size The size of the data block.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The size is NULL.
+ * \retval ULORAWAN_ERR_STATE The data block is not reassembled yet.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_get_frag_block(uint32_t *const size);
+
+/**
+ * \brief Take a snapshot of the session before powering down RAM.
+ *
+ * The snapshot is ulorawan_snapshot_size() bytes and may be kept in
+ * retained RAM or written to NVM.
+ *
+ * \param[out] buf The buffer.
+ * \param[in] size The size of the buffer.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_STATE A transmission is in progress.
+ * \retval ULORAWAN_ERR_PARAMS The buffer is NULL or too small.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_save_snapshot(uint8_t *const buf, size_t size);
+
+/**
+ * \brief Restore the session from a snapshot after ulorawan_init.
+ *
+ * A restored session is back online without a join. Class B must be
+ * started again.
+ *
+ * \param[in] buf The snapshot.
+ * \param[in] size The size of the snapshot.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_STATE The stack is not idle.
+ * \retval ULORAWAN_ERR_PARAMS The snapshot is NULL or invalid, a join is
+ * needed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_restore_snapshot(const uint8_t *const buf, size_t size);
+
+/**
+ * \brief Set the number of uplink frame counters reserved with each write.
+ *
+ * The uplink frame counter is persisted ahead of use in blocks, larger
+ * blocks write less often but skip more counters after a reset.
+ *
+ * \param[in] block The number of frame counters, ULORAWAN_FCNT_RESERVE by
+ * default.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The block is zero.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_set_fcnt_reserve(uint16_t block);
+
+/**
+ * \brief Enable or disable adaptive data rate.
+ *
+ * \param[in] enabled True to let the network control the data rate and tx
+ * power.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_set_adr(bool enabled);
+
+#ifdef ULORAWAN_LATENCY_ENABLED
+/**
+ * \brief Get the latency histogram of a step of the state machine.
+ *
+ * The latency is the time since the previous step, so the TX to RX1 step
+ * times the uplink on air and the RX1 to RX1 step the RX1 delay.
+ *
+ * \param[in] from The state before the step.
+ * \param[in] to The state after the step.
+ * \param[out] histogram The histogram, cleared when the step has not been
+ * seen.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The histogram is NULL.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_get_latency(enum ulorawan_state from, enum ulorawan_state to,
+                             struct ulorawan_latency_histogram *const histogram);
+
+/**
+ * \brief Get the histogram of the time events waited in the queue.
+ *
+ * \param[in] type The event type.
+ * \param[out] histogram The histogram.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The histogram is NULL.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t
+ulorawan_get_queue_latency(enum ulorawan_event_type type,
+                           struct ulorawan_latency_histogram *const histogram);
+
+/**
+ * \brief Write every latency histogram as text, one line per histogram.
+ *
+ * \param[out] buf The text, truncated to the buffer.
+ * \param[in] size The buffer size.
+ * \param[out] length The length of the full text.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The buffer or length is NULL.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_dump_latency(char *const buf, size_t size,
+                              size_t *const length);
+#endif // ULORAWAN_LATENCY_ENABLED
+
+#ifdef ULORAWAN_ENERGY_ENABLED
+/**
+ * \brief Set the radio supply current in a mode.
+ *
+ * The currents come from the radio datasheet or a measurement of the board,
+ * the charge of a mode with no current set is not accounted.
+ *
+ * \param[in] mode The radio mode.
+ * \param[in] microamps The supply current in microamps.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The mode is not valid.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_set_radio_current(enum RADIO_HAL_MODE mode,
+                                   uint32_t microamps);
+
+/**
+ * \brief Get the radio energy meter.
+ *
+ * The charges are in microamp milliseconds, ulorawan_energy_nah converts
+ * them to nanoamp hours.
+ *
+ * \param[out] energy The time and charge per mode and per message.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_INIT The ulorawan stack has not been initialised.
+ * \retval ULORAWAN_ERR_PARAMS The energy is NULL.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_get_energy(struct ulorawan_energy *const energy);
+#endif // ULORAWAN_ENERGY_ENABLED
+
 /**
  * \brief Process ulorawan events
  *
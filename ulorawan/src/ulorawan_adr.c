@@ -0,0 +1,170 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan adaptive data rate implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+
+#include "log_hal.h"
+#include "ulorawan_adr.h"
+#include "ulorawan_region.h"
+
+//! The LinkADRReq value that keeps the current data rate or tx power
+#define KEEP_CURRENT 0x0F
+
+// Step the link settings back towards the defaults, returns false when
+// already at the defaults
+static bool step_back(struct ulorawan_region_params *const params) {
+  if (params->tx_power != 0) {
+    params->tx_power = 0;
+    log_hal_log_info("ADR backoff to max tx power");
+    return true;
+  }
+
+  for (uint8_t dr = params->data_rate; dr > 0; dr--) {
+    if (ulorawan_region_dr_valid(params, &params->plan.enabled, dr - 1)) {
+      params->data_rate = dr - 1;
+      log_hal_log_info("ADR backoff to DR%u", params->data_rate);
+      return true;
+    }
+  }
+
+  ulorawan_region_enable_default_channels(params);
+  log_hal_log_info("ADR backoff to default channels");
+
+  return false;
+}
+
+void ulorawan_adr_set_enabled(struct ulorawan_session *const session,
+                              bool enabled) {
+  session->adr.enabled = enabled;
+  session->adr.ack_cnt = 0;
+}
+
+void ulorawan_adr_uplink(struct ulorawan_session *const session,
+                         union ulorawan_mac_fctrl *const fctrl) {
+  struct ulorawan_adr *adr = &session->adr;
+
+  fctrl->bits.adr = adr->enabled ? 1 : 0;
+  fctrl->bits.adr_ack_req = 0;
+
+  if (!adr->enabled) {
+    return;
+  }
+
+  if (adr->ack_cnt < ULORAWAN_ADR_ACK_LIMIT + ULORAWAN_ADR_ACK_DELAY) {
+    adr->ack_cnt++;
+  }
+
+  if (adr->ack_cnt < ULORAWAN_ADR_ACK_LIMIT) {
+    return;
+  }
+
+  fctrl->bits.adr_ack_req = 1;
+
+  if (adr->ack_cnt >= ULORAWAN_ADR_ACK_LIMIT + ULORAWAN_ADR_ACK_DELAY) {
+    if (step_back(&session->region_params)) {
+      adr->ack_cnt = ULORAWAN_ADR_ACK_LIMIT;
+    } else {
+      // Nothing further to recover, stop asking for an answer
+      adr->nb_trans = 1;
+      adr->ack_cnt = 0;
+      fctrl->bits.adr_ack_req = 0;
+    }
+  }
+}
+
+void ulorawan_adr_downlink(struct ulorawan_session *const session) {
+  session->adr.ack_cnt = 0;
+}
+
+union ulorawan_mac_adr_ans
+ulorawan_adr_link_adr_req(struct ulorawan_session *const session,
+                          const struct ulorawan_mac_link_adr_req *const reqs,
+                          uint8_t count) {
+  struct ulorawan_region_params *params = &session->region_params;
+  struct ulorawan_channel_mask mask = params->plan.enabled;
+  // The data rate, tx power and redundancy of the last command apply
+  const struct ulorawan_mac_link_adr_req *last = &reqs[count - 1];
+  uint8_t dr = last->dr_tx_power.bits.data_rate;
+  uint8_t tx_power = last->dr_tx_power.bits.tx_power;
+  union ulorawan_mac_adr_ans ans;
+
+  ans.value = 0;
+  ans.bits.ch_mask_ack = 1;
+
+  // The channel masks accumulate in order, only the final mask must be valid
+  for (uint8_t i = 0; i < count; i++) {
+    if (ulorawan_region_chmask(params, &mask, reqs[i].redundancy.bits.ch_mask_ctl,
+                               reqs[i].ch_mask) != ULORAWAN_REGION_ERR_NONE) {
+      ans.bits.ch_mask_ack = 0;
+      break;
+    }
+  }
+
+  if (ans.bits.ch_mask_ack && !ulorawan_region_chmask_valid(params, &mask)) {
+    ans.bits.ch_mask_ack = 0;
+  }
+
+  if (dr == KEEP_CURRENT) {
+    dr = params->data_rate;
+  }
+
+  // The data rate must be usable on the new mask, a rejected mask leaves no
+  // mask to check against
+  if (ans.bits.ch_mask_ack && ulorawan_region_dr_valid(params, &mask, dr)) {
+    ans.bits.data_rate_ack = 1;
+  }
+
+  if (tx_power == KEEP_CURRENT) {
+    tx_power = params->tx_power;
+  }
+
+  if (tx_power < params->desc->tx_power_count) {
+    ans.bits.power_ack = 1;
+  }
+
+  if (!(ans.bits.ch_mask_ack && ans.bits.data_rate_ack &&
+        ans.bits.power_ack)) {
+    log_hal_log_error("LinkADRReq block of %u rejected [0x%02X]", count,
+                      ans.value);
+    return ans;
+  }
+
+  ulorawan_region_set_chmask(params, &mask);
+  params->data_rate = dr;
+  params->tx_power = tx_power;
+
+  if (last->redundancy.bits.nbtrans != 0) {
+    session->adr.nb_trans = last->redundancy.bits.nbtrans;
+  }
+
+  return ans;
+}
@@ -0,0 +1,111 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan adaptive data rate prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_ADR_H_
+#define ULORAWAN_ADR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+#include "ulorawan_mac_cmds.h"
+#include "ulorawan_mac_frame.h"
+
+//! The number of uplinks without a downlink before ADRACKReq is set
+#ifndef ULORAWAN_ADR_ACK_LIMIT
+#define ULORAWAN_ADR_ACK_LIMIT 64
+#endif
+
+//! The number of further uplinks without a downlink before each step back
+//! towards the default link settings
+#ifndef ULORAWAN_ADR_ACK_DELAY
+#define ULORAWAN_ADR_ACK_DELAY 32
+#endif
+
+/**
+ * \brief Enable or disable network controlled data rate and tx power.
+ *
+ * \param[in] session The session.
+ * \param[in] enabled True to enable adaptive data rate.
+ */
+void ulorawan_adr_set_enabled(struct ulorawan_session *const session,
+                              bool enabled);
+
+/**
+ * \brief Account for an uplink and set its ADR bits.
+ *
+ * Once ULORAWAN_ADR_ACK_LIMIT uplinks have been sent without a downlink the
+ * ADRACKReq bit is set. Every ULORAWAN_ADR_ACK_DELAY uplinks after that the
+ * link settings are stepped back, first to the maximum tx power, then one
+ * data rate lower at a time and finally to the default channels.
+ *
+ * \param[in] session The session.
+ * \param[out] fctrl The frame control of the uplink.
+ */
+void ulorawan_adr_uplink(struct ulorawan_session *const session,
+                         union ulorawan_mac_fctrl *const fctrl);
+
+/**
+ * \brief Account for an authenticated downlink.
+ *
+ * \param[in] session The session.
+ */
+void ulorawan_adr_downlink(struct ulorawan_session *const session);
+
+/**
+ * \brief Apply a block of contiguous LinkADRReq commands.
+ *
+ * The commands form one transaction. Their channel masks are accumulated in
+ * order and the data rate, tx power and NbTrans of the last command apply.
+ * The whole block is validated before anything is changed and is applied
+ * only when the channel mask, data rate and tx power are all accepted.
+ *
+ * \param[in] session The session.
+ * \param[in] reqs The requests in the order received.
+ * \param[in] count The number of requests, at least one.
+ *
+ * \return The LinkADRAns status for every command of the block.
+ */
+union ulorawan_mac_adr_ans
+ulorawan_adr_link_adr_req(struct ulorawan_session *const session,
+                          const struct ulorawan_mac_link_adr_req *const reqs,
+                          uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_ADR_H_ */
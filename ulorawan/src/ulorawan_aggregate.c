@@ -0,0 +1,172 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan record aggregation implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "ulorawan_aggregate.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_region.h"
+#include "ulorawan_uplink_queue.h"
+
+//! The size of the length prefix of a record
+#define LENGTH_SIZE 1
+//! The size of the frame port
+#define FPORT_SIZE 1
+
+// The largest packed size an uplink at the current data rate can carry
+static uint8_t capacity(const struct ulorawan_session *const session) {
+  const struct ulorawan_region_params *params = &session->region_params;
+  uint8_t max_payload = ulorawan_region_max_payload(params, params->data_rate);
+
+  if (max_payload <= ULORAWAN_MAC_FHDR_MIN_SIZE + FPORT_SIZE) {
+    return 0;
+  }
+
+  max_payload -= ULORAWAN_MAC_FHDR_MIN_SIZE + FPORT_SIZE;
+
+  return max_payload < ULORAWAN_UPLINK_MAX_PAYLOAD
+             ? max_payload
+             : ULORAWAN_UPLINK_MAX_PAYLOAD;
+}
+
+int32_t ulorawan_aggregate_configure(struct ulorawan_session *const session,
+                                     uint8_t port, uint8_t threshold,
+                                     uint32_t max_age) {
+  struct ulorawan_aggregate *aggregate = &session->aggregate;
+
+  if (aggregate->count != 0 && port != aggregate->port) {
+    int32_t result = ulorawan_aggregate_flush(session);
+
+    if (result != ULORAWAN_ERR_NONE) {
+      return result;
+    }
+  }
+
+  aggregate->port = port;
+  aggregate->threshold = threshold;
+  aggregate->max_age = max_age;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_aggregate_add(struct ulorawan_session *const session,
+                               const uint8_t *const record, uint8_t size,
+                               uint32_t now) {
+  struct ulorawan_aggregate *aggregate = &session->aggregate;
+  uint8_t limit = capacity(session);
+
+  if (aggregate->port == 0) {
+    return ULORAWAN_ERR_STATE;
+  }
+
+  if (LENGTH_SIZE + size > limit) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  // Start a new uplink when the record does not fit behind the pending ones
+  if (aggregate->size + LENGTH_SIZE + size > limit) {
+    int32_t result = ulorawan_aggregate_flush(session);
+
+    if (result != ULORAWAN_ERR_NONE) {
+      return result;
+    }
+  }
+
+  if (aggregate->count == 0) {
+    aggregate->first = now;
+  }
+
+  aggregate->buf[aggregate->size++] = size;
+  memcpy(&aggregate->buf[aggregate->size], record, size);
+  aggregate->size += size;
+  aggregate->count++;
+
+  if (aggregate->size >= aggregate->threshold) {
+    return ulorawan_aggregate_flush(session);
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_aggregate_flush(struct ulorawan_session *const session) {
+  struct ulorawan_aggregate *aggregate = &session->aggregate;
+
+  if (aggregate->count == 0) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  struct ulorawan_uplink_req req = {.port = aggregate->port,
+                                    .payload = aggregate->buf,
+                                    .size = aggregate->size,
+                                    .confirm = false,
+                                    .priority = ULORAWAN_UPLINK_PRIORITY_NORMAL,
+                                    .lifetime = 0};
+  int32_t result = ulorawan_uplink_queue_push(&session->uplink_queue, &req,
+                                              aggregate->first);
+
+  if (result != ULORAWAN_ERR_NONE) {
+    log_hal_log_error("Aggregated records not queued");
+    return result;
+  }
+
+  log_hal_log_debug("Aggregated [%u] records in [%u] bytes", aggregate->count,
+                    aggregate->size);
+
+  aggregate->records += aggregate->count;
+  aggregate->flushes++;
+  aggregate->count = 0;
+  aggregate->size = 0;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+uint32_t ulorawan_aggregate_poll(struct ulorawan_session *const session,
+                                 uint32_t now) {
+  struct ulorawan_aggregate *aggregate = &session->aggregate;
+
+  if (aggregate->count == 0) {
+    return 0;
+  }
+
+  int32_t remaining = (int32_t)(aggregate->first + aggregate->max_age - now);
+
+  if (remaining > 0) {
+    return (uint32_t)remaining;
+  }
+
+  // A full queue keeps the records for the next poll
+  ulorawan_aggregate_flush(session);
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan record aggregation prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_AGGREGATE_H_
+#define ULORAWAN_AGGREGATE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+/**
+ * \brief Configure the packing of application records into uplinks.
+ *
+ * Records are packed into one FRMPayload, each prefixed with a one byte
+ * length, and queued as a single uplink once the packed size reaches the
+ * threshold, the oldest record reaches the maximum age, the next record
+ * would not fit the current data rate or the records are flushed.
+ *
+ * \param[in] session The session.
+ * \param[in] port The application port of the records, zero to turn
+ * aggregation off.
+ * \param[in] threshold The packed size in bytes at which the records are
+ * sent.
+ * \param[in] max_age The longest time in milliseconds a record waits.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_FULL Pending records could not be queued.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_aggregate_configure(struct ulorawan_session *const session,
+                                     uint8_t port, uint8_t threshold,
+                                     uint32_t max_age);
+
+/**
+ * \brief Add an application record.
+ *
+ * \param[in] session The session.
+ * \param[in] record The record.
+ * \param[in] size The record size.
+ * \param[in] now The current time in milliseconds.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_STATE Aggregation is off.
+ * \retval ULORAWAN_ERR_PARAMS The record does not fit an uplink at the
+ * current data rate.
+ * \retval ULORAWAN_ERR_FULL The packed records could not be queued.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_aggregate_add(struct ulorawan_session *const session,
+                               const uint8_t *const record, uint8_t size,
+                               uint32_t now);
+
+/**
+ * \brief Queue the pending records as one uplink.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_FULL The uplink queue is full, the records are kept.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_aggregate_flush(struct ulorawan_session *const session);
+
+/**
+ * \brief Queue the pending records once the oldest has reached the maximum
+ * age.
+ *
+ * \param[in] session The session.
+ * \param[in] now The current time in milliseconds.
+ *
+ * \return The time in milliseconds until the pending records are due, zero
+ * when no records are pending.
+ */
+uint32_t ulorawan_aggregate_poll(struct ulorawan_session *const session,
+                                 uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_AGGREGATE_H_ */
@@ -0,0 +1,549 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan class B implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "crypto_hal.h"
+#include "log_hal.h"
+#include "radio_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_class_b.h"
+#include "ulorawan_cmds.h"
+#include "ulorawan_downlink.h"
+#include "ulorawan_energy.h"
+#include "ulorawan_error_codes.h"
+
+//! The offset of the GPS time in a beacon
+#define BEACON_TIME_OFFSET ULORAWAN_CLASS_B_BEACON_RFU_SIZE
+//! The offset of the CRC of the network common part of a beacon
+#define BEACON_CRC_OFFSET (BEACON_TIME_OFFSET + 4)
+//! The smallest beacon holding the network common part
+#define BEACON_MIN_SIZE (BEACON_CRC_OFFSET + 2)
+//! The beacon period in seconds
+#define BEACON_PERIOD_S (ULORAWAN_CLASS_B_BEACON_PERIOD / 1000)
+//! The AES block size
+#define BLOCK_SIZE 16
+
+static uint32_t read_u32(const uint8_t *const buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static void write_u32(uint8_t *const buf, uint32_t value) {
+  buf[0] = (uint8_t)value;
+  buf[1] = (uint8_t)(value >> 8);
+  buf[2] = (uint8_t)(value >> 16);
+  buf[3] = (uint8_t)(value >> 24);
+}
+
+// CRC-16/CCITT of the network common part of a beacon
+static uint16_t crc16(const uint8_t *const buf, size_t size) {
+  uint16_t crc = 0;
+
+  for (size_t i = 0; i < size; i++) {
+    crc ^= (uint16_t)(buf[i] << 8);
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021)
+                           : (uint16_t)(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+static uint16_t ping_nb(uint8_t periodicity) {
+  return (uint16_t)(1U << (ULORAWAN_CLASS_B_MAX_PERIODICITY - periodicity));
+}
+
+static uint16_t ping_period(uint8_t periodicity) {
+  return ULORAWAN_CLASS_B_WINDOW_SLOTS / ping_nb(periodicity);
+}
+
+// Scale a time within the beacon period to the measured local clock
+static uint32_t scale(const struct ulorawan_class_b *const class_b,
+                      uint32_t time) {
+  return (uint32_t)(((uint64_t)time * class_b->period) /
+                    ULORAWAN_CLASS_B_BEACON_PERIOD);
+}
+
+// The clock uncertainty grows with each missed beacon
+static uint32_t guard(const struct ulorawan_class_b *const class_b) {
+  return ULORAWAN_CLASS_B_GUARD +
+         (uint32_t)class_b->missed * ULORAWAN_CLASS_B_GUARD_WIDENING;
+}
+
+static int32_t start_timer(uint32_t at, uint32_t now) {
+  int32_t wait = (int32_t)(at - now);
+
+  if (timer_hal_start(TIMER2, wait > 0 ? (uint32_t)wait : 0) !=
+      TIMER_HAL_ERR_NONE) {
+    log_hal_log_error("Failed to start TIMER2");
+    return ULORAWAN_ERR_TIMER;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// The first ping slot from a slot on, past the window once the slots with
+// the offset are used up
+static uint32_t first_slot(uint32_t from, uint16_t offset,
+                           uint8_t periodicity) {
+  uint32_t period = ping_period(periodicity);
+
+  if (from <= offset) {
+    return offset;
+  }
+
+  return offset + (from - offset + period - 1) / period * period;
+}
+
+// The first ping slot from a slot on of the device or of a class B group
+static uint32_t next_ping_slot(const struct ulorawan_session *const session,
+                               uint32_t from) {
+  const struct ulorawan_class_b *class_b = &session->class_b;
+  uint32_t slot =
+      first_slot(from, class_b->ping_offset, class_b->periodicity);
+
+  for (uint8_t i = 0; i < session->multicast.count; i++) {
+    const struct ulorawan_multicast_group *group =
+        &session->multicast.groups[i];
+
+    if (group->class == DEVICE_CLASS_B) {
+      uint32_t group_slot =
+          first_slot(from, group->ping_offset, group->periodicity);
+
+      if (group_slot < slot) {
+        slot = group_slot;
+      }
+    }
+  }
+
+  return slot;
+}
+
+// Schedule the next ping slot of the current beacon period, or the next
+// beacon once the slots of the period are used up
+static int32_t schedule(struct ulorawan_session *const session) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+  uint32_t now = timer_hal_get_time();
+  uint32_t period_start =
+      class_b->last_beacon + class_b->period * class_b->missed;
+
+  for (uint32_t slot = next_ping_slot(session, class_b->next_slot);
+       slot < ULORAWAN_CLASS_B_WINDOW_SLOTS;
+       slot = next_ping_slot(session, slot + 1)) {
+    uint32_t at = period_start +
+                  scale(class_b, ULORAWAN_CLASS_B_BEACON_RESERVED +
+                                     slot * ULORAWAN_CLASS_B_SLOT_LEN) -
+                  guard(class_b);
+
+    if ((int32_t)(at - now) > 0) {
+      class_b->next_slot = (uint16_t)slot;
+      class_b->beacon_next = 0;
+      return start_timer(at, now);
+    }
+  }
+
+  class_b->next_slot = ULORAWAN_CLASS_B_WINDOW_SLOTS;
+  class_b->beacon_next = 1;
+
+  return start_timer(period_start + class_b->period - guard(class_b), now);
+}
+
+// Each class B group has ping slots of its own, derived from its address
+static int32_t begin_period(struct ulorawan_session *const session,
+                            uint32_t beacon_time) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+
+  class_b->beacon_time = beacon_time;
+  class_b->next_slot = 0;
+
+  int32_t result = ulorawan_class_b_ping_offset(
+      session->keys.dev_addr, beacon_time,
+      ping_period(class_b->periodicity), &class_b->ping_offset);
+
+  for (uint8_t i = 0;
+       result == ULORAWAN_ERR_NONE && i < session->multicast.count; i++) {
+    struct ulorawan_multicast_group *group = &session->multicast.groups[i];
+
+    if (group->class == DEVICE_CLASS_B) {
+      result = ulorawan_class_b_ping_offset(
+          group->keys.dev_addr, beacon_time, ping_period(group->periodicity),
+          &group->ping_offset);
+    }
+  }
+
+  return result;
+}
+
+static int32_t read_beacon(struct ulorawan_session *const session,
+                           uint32_t *const beacon_time) {
+  if (radio_hal_fifo_read(session->frame, &session->frame_size) !=
+      RADIO_HAL_ERR_NONE) {
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  if (session->frame_size < BEACON_MIN_SIZE ||
+      crc16(session->frame, BEACON_CRC_OFFSET) !=
+          (uint16_t)(session->frame[BEACON_CRC_OFFSET] |
+                     (session->frame[BEACON_CRC_OFFSET + 1] << 8))) {
+    log_hal_log_error("Beacon invalid");
+    return ULORAWAN_ERR_FRAME;
+  }
+
+  *beacon_time = read_u32(&session->frame[BEACON_TIME_OFFSET]);
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Follow a received beacon, the error between its arrival and the expected
+// arrival corrects the measured beacon period for the local clock drift
+static int32_t beacon_received(struct ulorawan_session *const session,
+                               uint32_t beacon_time) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+  uint32_t start = timer_hal_get_time() - ULORAWAN_CLASS_B_BEACON_AIRTIME;
+
+  if (class_b->status == CLASS_B_TRACKING) {
+    uint32_t periods = class_b->missed + 1U;
+    int32_t error =
+        (int32_t)(start - (class_b->last_beacon + class_b->period * periods));
+
+    class_b->period += error / (int32_t)periods / ULORAWAN_CLASS_B_DRIFT_GAIN;
+  } else {
+    log_hal_log_info("Beacon acquired");
+  }
+
+  class_b->status = CLASS_B_TRACKING;
+  class_b->last_beacon = start;
+  class_b->missed = 0;
+  class_b->stats.beacons++;
+
+  int32_t result = begin_period(session, beacon_time);
+
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  return schedule(session);
+}
+
+static int32_t beacon_missed(struct ulorawan_session *const session) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+
+  class_b->stats.beacons_missed++;
+
+  // The device falls back to class A once it has lost the beacon
+  if (++class_b->missed > ULORAWAN_CLASS_B_MAX_MISSED) {
+    log_hal_log_error("Beacon lost");
+    class_b->status = CLASS_B_OFF;
+    session->class = DEVICE_CLASS_A;
+    return ULORAWAN_ERR_NONE;
+  }
+
+  int32_t result =
+      begin_period(session, class_b->beacon_time + BEACON_PERIOD_S);
+
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  return schedule(session);
+}
+
+// The frequency and data rate of the next ping slot, the device keeps a
+// slot it shares with a group
+static bool ping_slot(const struct ulorawan_session *const session,
+                      uint32_t *const frequency, uint8_t *const dr) {
+  const struct ulorawan_class_b *class_b = &session->class_b;
+  uint32_t slot = class_b->next_slot;
+
+  if (first_slot(slot, class_b->ping_offset, class_b->periodicity) == slot) {
+    *frequency = class_b->ping_frequency;
+    *dr = class_b->ping_dr;
+    return true;
+  }
+
+  for (uint8_t i = 0; i < session->multicast.count; i++) {
+    const struct ulorawan_multicast_group *group =
+        &session->multicast.groups[i];
+
+    if (group->class == DEVICE_CLASS_B &&
+        first_slot(slot, group->ping_offset, group->periodicity) == slot) {
+      *frequency = group->frequency;
+      *dr = group->dr;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static int32_t open_window(struct ulorawan_session *const session) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+  uint16_t symbols =
+      (uint16_t)(class_b->missed * ULORAWAN_CLASS_B_SYMBOL_WIDENING);
+  uint32_t frequency;
+  uint8_t dr;
+
+  if (class_b->beacon_next) {
+    symbols += ULORAWAN_CLASS_B_BEACON_SYMBOLS;
+    frequency = class_b->beacon_frequency;
+  } else if (ping_slot(session, &frequency, &dr)) {
+    const struct ulorawan_region_dr *region_dr =
+        &session->region_params.desc->data_rates[dr];
+    struct radio_hal_rx_config config;
+
+    symbols += ULORAWAN_CLASS_B_PING_SYMBOLS;
+    config.modulation = region_dr->modulation;
+    config.sf = region_dr->sf;
+    config.bw = region_dr->bw;
+
+    if (radio_hal_set_rx_config(&config) != RADIO_HAL_ERR_NONE) {
+      session->state = ULORAWAN_STATE_FAULT;
+      return ULORAWAN_ERR_RADIO;
+    }
+  } else {
+    // The group of the slot was left after the slot was scheduled
+    class_b->next_slot++;
+    return schedule(session);
+  }
+
+  if (radio_hal_set_frequency(frequency) != RADIO_HAL_ERR_NONE ||
+      radio_hal_set_symbol_timeout(symbols) != RADIO_HAL_ERR_NONE ||
+      radio_hal_set_mode(MODE_RX_SINGLE) != RADIO_HAL_ERR_NONE) {
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  ULORAWAN_ENERGY_MODE(session, MODE_RX_SINGLE);
+
+  if (class_b->beacon_next) {
+    session->state = ULORAWAN_STATE_BEACON;
+  } else {
+    class_b->stats.ping_slots++;
+    session->state = ULORAWAN_STATE_PING;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_class_b_start(struct ulorawan_session *const session,
+                               uint8_t periodicity) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+
+  if (session->state != ULORAWAN_STATE_IDLE) {
+    return ULORAWAN_ERR_STATE;
+  }
+
+  if (periodicity > ULORAWAN_CLASS_B_MAX_PERIODICITY) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  if (class_b->beacon_frequency == 0) {
+    class_b->beacon_frequency = session->region_params.rx2_frequency;
+  }
+
+  // The ping slots use the RX2 channel until a PingSlotChannelReq moves them
+  if (class_b->ping_frequency == 0) {
+    class_b->ping_frequency = session->region_params.rx2_frequency;
+    class_b->ping_dr = session->region_params.rx2_dr;
+  }
+
+  class_b->periodicity = periodicity;
+  class_b->period = ULORAWAN_CLASS_B_BEACON_PERIOD;
+  class_b->missed = 0;
+  class_b->status = CLASS_B_ACQUIRING;
+  session->class = DEVICE_CLASS_B;
+
+  ulorawan_cmds_ping_slot_info_req(session, periodicity);
+
+  log_hal_log_info("Set radio mode RX Continuous");
+  if (radio_hal_set_frequency(class_b->beacon_frequency) !=
+          RADIO_HAL_ERR_NONE ||
+      radio_hal_set_mode(MODE_RX_CONT) != RADIO_HAL_ERR_NONE) {
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  ULORAWAN_ENERGY_MODE(session, MODE_RX_CONT);
+
+  session->state = ULORAWAN_STATE_BEACON;
+
+  // Give up when no beacon is heard for a whole period
+  if (timer_hal_start(TIMER2, ULORAWAN_CLASS_B_BEACON_PERIOD +
+                                  ULORAWAN_CLASS_B_GUARD) !=
+      TIMER_HAL_ERR_NONE) {
+    log_hal_log_error("Failed to start TIMER2");
+    return ULORAWAN_ERR_TIMER;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_class_b_stop(struct ulorawan_session *const session) {
+  session->class_b.status = CLASS_B_OFF;
+  session->class = DEVICE_CLASS_A;
+
+  timer_hal_stop(TIMER2);
+
+  if (session->state == ULORAWAN_STATE_BEACON ||
+      session->state == ULORAWAN_STATE_PING) {
+    session->state = ULORAWAN_STATE_IDLE;
+
+    // The beacon or ping slot reception is still running
+    if (radio_hal_set_mode(MODE_STDBY) != RADIO_HAL_ERR_NONE) {
+      session->state = ULORAWAN_STATE_FAULT;
+      return ULORAWAN_ERR_RADIO;
+    }
+
+    ULORAWAN_ENERGY_MODE(session, MODE_STDBY);
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_class_b_ping_offset(uint32_t dev_addr, uint32_t beacon_time,
+                                     uint16_t ping_period,
+                                     uint16_t *const offset) {
+  const uint8_t key[BLOCK_SIZE] = {0};
+  uint8_t block[BLOCK_SIZE] = {0};
+  uint8_t rand[BLOCK_SIZE];
+
+  write_u32(&block[0], beacon_time);
+  write_u32(&block[4], dev_addr);
+
+  if (crypto_hal_aes_encrypt(key, block, rand) != CRYPTO_HAL_ERR_NONE) {
+    return ULORAWAN_ERR_CMAC;
+  }
+
+  *offset = (uint16_t)((rand[0] + rand[1] * 256U) % ping_period);
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_class_b_timer(struct ulorawan_session *const session) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+
+  switch (class_b->status) {
+  case CLASS_B_ACQUIRING:
+    log_hal_log_error("No beacon found");
+    class_b->stats.acquisitions_failed++;
+    class_b->status = CLASS_B_OFF;
+    session->class = DEVICE_CLASS_A;
+    session->state = ULORAWAN_STATE_IDLE;
+
+    if (radio_hal_set_mode(MODE_STDBY) != RADIO_HAL_ERR_NONE) {
+      session->state = ULORAWAN_STATE_FAULT;
+      return ULORAWAN_ERR_RADIO;
+    }
+
+    ULORAWAN_ENERGY_MODE(session, MODE_STDBY);
+
+    return ULORAWAN_ERR_NONE;
+  case CLASS_B_TRACKING:
+    if (session->state == ULORAWAN_STATE_IDLE) {
+      return open_window(session);
+    }
+
+    // The radio is busy with a class A uplink
+    if (class_b->beacon_next) {
+      return beacon_missed(session);
+    }
+
+    class_b->stats.ping_slots_skipped++;
+    class_b->next_slot++;
+
+    return schedule(session);
+  default:
+    return ULORAWAN_ERR_NONE;
+  }
+}
+
+int32_t ulorawan_class_b_irq(struct ulorawan_session *const session,
+                             enum radio_hal_irq_flags flags) {
+  struct ulorawan_class_b *class_b = &session->class_b;
+  uint32_t beacon_time;
+  int32_t result = ULORAWAN_ERR_NONE;
+
+  if (!(flags & (RADIO_HAL_IRQ_RX_DONE | RADIO_HAL_IRQ_RX_TIMEOUT))) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  if (session->state == ULORAWAN_STATE_PING) {
+    session->state = ULORAWAN_STATE_IDLE;
+
+    if (flags & RADIO_HAL_IRQ_RX_DONE) {
+      log_hal_log_debug("PING state RX done");
+      result = ulorawan_downlink_handler(session);
+      if (result == ULORAWAN_ERR_NONE) {
+        class_b->stats.ping_downlinks++;
+      }
+    }
+
+    class_b->next_slot++;
+
+    int32_t scheduled = schedule(session);
+
+    return result != ULORAWAN_ERR_NONE ? result : scheduled;
+  }
+
+  if (flags & RADIO_HAL_IRQ_RX_DONE) {
+    result = read_beacon(session, &beacon_time);
+  }
+
+  if (class_b->status == CLASS_B_ACQUIRING) {
+    // Keep listening until a valid beacon is heard
+    if (!(flags & RADIO_HAL_IRQ_RX_DONE) || result != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NONE;
+    }
+
+    session->state = ULORAWAN_STATE_IDLE;
+
+    if (radio_hal_set_mode(MODE_STDBY) != RADIO_HAL_ERR_NONE) {
+      session->state = ULORAWAN_STATE_FAULT;
+      return ULORAWAN_ERR_RADIO;
+    }
+
+    ULORAWAN_ENERGY_MODE(session, MODE_STDBY);
+
+    return beacon_received(session, beacon_time);
+  }
+
+  session->state = ULORAWAN_STATE_IDLE;
+
+  if (!(flags & RADIO_HAL_IRQ_RX_DONE) || result != ULORAWAN_ERR_NONE) {
+    return beacon_missed(session);
+  }
+
+  return beacon_received(session, beacon_time);
+}
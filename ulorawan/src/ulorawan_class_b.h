@@ -0,0 +1,180 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan class B prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_CLASS_B_H_
+#define ULORAWAN_CLASS_B_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "radio_hal.h"
+#include "ulorawan_session.h"
+
+//! The beacon period in milliseconds
+#define ULORAWAN_CLASS_B_BEACON_PERIOD 128000
+//! The time in milliseconds reserved for the beacon at the start of a period
+#define ULORAWAN_CLASS_B_BEACON_RESERVED 2120
+//! The length of a ping slot in milliseconds
+#define ULORAWAN_CLASS_B_SLOT_LEN 30
+//! The number of ping slots in the beacon window
+#define ULORAWAN_CLASS_B_WINDOW_SLOTS 4096
+//! The highest ping slot periodicity
+#define ULORAWAN_CLASS_B_MAX_PERIODICITY 7
+
+//! The size of the RFU field that starts the beacon
+#ifndef ULORAWAN_CLASS_B_BEACON_RFU_SIZE
+#define ULORAWAN_CLASS_B_BEACON_RFU_SIZE 2
+#endif
+
+//! The time in milliseconds from the start of a beacon until it has been
+//! received
+#ifndef ULORAWAN_CLASS_B_BEACON_AIRTIME
+#define ULORAWAN_CLASS_B_BEACON_AIRTIME 152
+#endif
+
+//! The time in milliseconds a receive window opens before the expected
+//! start of a beacon or ping slot
+#ifndef ULORAWAN_CLASS_B_GUARD
+#define ULORAWAN_CLASS_B_GUARD 10
+#endif
+
+//! The time in milliseconds the guard grows for each missed beacon
+#ifndef ULORAWAN_CLASS_B_GUARD_WIDENING
+#define ULORAWAN_CLASS_B_GUARD_WIDENING 2
+#endif
+
+//! The number of symbols a beacon reception waits for the preamble
+#ifndef ULORAWAN_CLASS_B_BEACON_SYMBOLS
+#define ULORAWAN_CLASS_B_BEACON_SYMBOLS 8
+#endif
+
+//! The number of symbols a ping slot reception waits for the preamble
+#ifndef ULORAWAN_CLASS_B_PING_SYMBOLS
+#define ULORAWAN_CLASS_B_PING_SYMBOLS 6
+#endif
+
+//! The number of symbols a reception window grows for each missed beacon
+#ifndef ULORAWAN_CLASS_B_SYMBOL_WIDENING
+#define ULORAWAN_CLASS_B_SYMBOL_WIDENING 1
+#endif
+
+//! The number of beacons that may be missed before synchronisation is lost
+#ifndef ULORAWAN_CLASS_B_MAX_MISSED
+#define ULORAWAN_CLASS_B_MAX_MISSED 56
+#endif
+
+//! The divisor applied to the measured beacon period error, larger values
+//! smooth the drift compensation more
+#ifndef ULORAWAN_CLASS_B_DRIFT_GAIN
+#define ULORAWAN_CLASS_B_DRIFT_GAIN 4
+#endif
+
+/**
+ * \brief Start class B by acquiring a beacon.
+ *
+ * The radio listens on the beacon frequency for up to a beacon period,
+ * uplinks wait until the acquisition ends.
+ *
+ * \param[in] session The session.
+ * \param[in] periodicity The ping slot periodicity, 0 to 7.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_STATE The stack is busy.
+ * \retval ULORAWAN_ERR_PARAMS The periodicity is invalid.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_TIMER The acquisition timer could not be started.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_b_start(struct ulorawan_session *const session,
+                               uint8_t periodicity);
+
+/**
+ * \brief Stop class B.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO The radio could not be put in standby.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_b_stop(struct ulorawan_session *const session);
+
+/**
+ * \brief Compute the ping slot offset of a beacon period.
+ *
+ * \param[in] dev_addr The end-device address.
+ * \param[in] beacon_time The GPS time in seconds of the beacon.
+ * \param[in] ping_period The number of slots between ping slots.
+ * \param[out] offset The ping slot offset.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_CMAC The encryption failed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_b_ping_offset(uint32_t dev_addr, uint32_t beacon_time,
+                                     uint16_t ping_period,
+                                     uint16_t *const offset);
+
+/**
+ * \brief Open the beacon or ping slot window scheduled on TIMER2.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_TIMER The next window could not be scheduled.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_b_timer(struct ulorawan_session *const session);
+
+/**
+ * \brief Handle a radio interrupt in a beacon or ping slot window.
+ *
+ * \param[in] session The session.
+ * \param[in] flags The radio interrupt flags.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_TIMER The next window could not be scheduled.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_b_irq(struct ulorawan_session *const session,
+                             enum radio_hal_irq_flags flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_CLASS_B_H_ */
@@ -0,0 +1,139 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan class C implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "log_hal.h"
+#include "radio_hal.h"
+#include "ulorawan_class_c.h"
+#include "ulorawan_downlink.h"
+#include "ulorawan_energy.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_retrans.h"
+
+// A class A device receives its class C multicast groups continuously too,
+// class B needs the radio for its beacons and ping slots
+static bool listening(const struct ulorawan_session *const session) {
+  if (session->class == DEVICE_CLASS_C) {
+    return true;
+  }
+
+  if (session->class != DEVICE_CLASS_A) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < session->multicast.count; i++) {
+    if (session->multicast.groups[i].class == DEVICE_CLASS_C) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+int32_t ulorawan_class_c_listen(struct ulorawan_session *const session) {
+  const struct ulorawan_region_params *params = &session->region_params;
+  const struct ulorawan_region_dr *dr =
+      &params->desc->data_rates[params->rx2_dr];
+  struct radio_hal_rx_config config;
+
+  config.modulation = dr->modulation;
+  config.sf = dr->sf;
+  config.bw = dr->bw;
+
+  log_hal_log_info("Set radio mode RX Continuous");
+
+  // Class C multicast groups share the RX2 frequency and data rate with
+  // unicast downlinks
+  if (radio_hal_set_frequency(params->rx2_frequency) != RADIO_HAL_ERR_NONE ||
+      radio_hal_set_rx_config(&config) != RADIO_HAL_ERR_NONE ||
+      radio_hal_set_mode(MODE_RX_CONT) != RADIO_HAL_ERR_NONE) {
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  ULORAWAN_ENERGY_MODE(session, MODE_RX_CONT);
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_class_c_start(struct ulorawan_session *const session) {
+  if (!listening(session) || session->state != ULORAWAN_STATE_IDLE) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  int32_t result = ulorawan_class_c_listen(session);
+
+  if (result == ULORAWAN_ERR_NONE) {
+    session->state = ULORAWAN_STATE_RXC;
+  }
+
+  return result;
+}
+
+int32_t ulorawan_class_c_stop(struct ulorawan_session *const session) {
+  if (session->class == DEVICE_CLASS_C ||
+      session->state != ULORAWAN_STATE_RXC) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  session->state = ULORAWAN_STATE_IDLE;
+
+  if (radio_hal_set_mode(MODE_STDBY) != RADIO_HAL_ERR_NONE) {
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  ULORAWAN_ENERGY_MODE(session, MODE_STDBY);
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_class_c_irq(struct ulorawan_session *const session,
+                             enum radio_hal_irq_flags flags) {
+  if (!(flags & RADIO_HAL_IRQ_RX_DONE)) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  log_hal_log_debug("RXC state RX done");
+
+  // The radio keeps receiving, a rejected frame only needs to be reported
+  int32_t result = ulorawan_downlink_handler(session);
+
+  // Only a unicast downlink answers the pending uplink
+  if (result == ULORAWAN_ERR_NONE && !session->rx.multicast) {
+    ulorawan_retrans_rx_done(session, true);
+  }
+
+  return result;
+}
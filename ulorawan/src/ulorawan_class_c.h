@@ -0,0 +1,107 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan class C prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_CLASS_C_H_
+#define ULORAWAN_CLASS_C_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "radio_hal.h"
+#include "ulorawan_session.h"
+
+/**
+ * \brief Set the radio to receive continuously on the RX2 frequency and data
+ * rate, which class C multicast groups share.
+ *
+ * The session state is left to the caller, a class C device listens
+ * between the end of an uplink and RX1 as well as while idle.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_c_listen(struct ulorawan_session *const session);
+
+/**
+ * \brief Start receiving continuously when a class C device is idle.
+ *
+ * A class A device with class C multicast groups receives continuously too.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_c_start(struct ulorawan_session *const session);
+
+/**
+ * \brief Stop receiving continuously for the class C multicast groups of a
+ * class A device.
+ *
+ * A class C device keeps receiving. The next ulorawan_class_c_start resumes
+ * the reception while class C groups remain.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO The radio could not be put in standby.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_c_stop(struct ulorawan_session *const session);
+
+/**
+ * \brief Handle a radio interrupt while receiving continuously.
+ *
+ * A unicast downlink answers the pending uplink, a multicast downlink does
+ * not.
+ *
+ * \param[in] session The session.
+ * \param[in] flags The radio interrupt flags.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_class_c_irq(struct ulorawan_session *const session,
+                             enum radio_hal_irq_flags flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_CLASS_C_H_ */
@@ -0,0 +1,261 @@
+/**
+ * \file
+ *
+ * \brief The uloraWan MAC command processing implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "ulorawan_adr.h"
+#include "ulorawan_cmds.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_link_stats.h"
+#include "ulorawan_mac_cmds.h"
+#include "ulorawan_region.h"
+
+//! The PingSlotChannelAns channel frequency ok bit
+#define PING_SLOT_CH_FREQ_OK 0x01
+//! The PingSlotChannelAns data rate ok bit
+#define PING_SLOT_CH_DR_OK 0x02
+//! The BeaconFreqAns beacon frequency ok bit
+#define BEACON_FREQ_OK 0x01
+
+//! The size of each server command including the CID, zero when unknown
+static const uint8_t srv_cmd_sizes[] = {
+    [SRV_MAC_LINK_CHECK_ANS] = 3,     [SRV_MAC_LINK_ADR_REQ] = 5,
+    [SRV_MAC_DUTY_CYCLE_REQ] = 2,     [SRV_MAC_RX_PARAM_SETUP_REQ] = 5,
+    [SRV_MAC_DEV_STATUS_REQ] = 1,     [SRV_MAC_NEW_CHANNEL_REQ] = 6,
+    [SRV_MAC_RX_TIMING_SETUP_REQ] = 2, [SRV_MAC_TX_PARAM_SETUP_REQ] = 2,
+    [SRV_MAC_DL_CHANNEL_REQ] = 5,     [SRV_MAC_DEV_TIME_ANS] = 6,
+    [SRV_MAC_PING_SLOT_INFO_ANS] = 1, [SRV_MAC_PING_SLOT_CH_REQ] = 5,
+    [SVR_MAC_BEACON_FREQ_REQ] = 4};
+
+static void answer(struct ulorawan_session *const session,
+                   const uint8_t *const buf, uint8_t size) {
+  struct ulorawan_cmds *cmds = &session->cmds;
+
+  if (cmds->answers_size + size > sizeof(cmds->answers)) {
+    log_hal_log_error("MAC answer [0x%02X] dropped", buf[0]);
+    return;
+  }
+
+  memcpy(&cmds->answers[cmds->answers_size], buf, size);
+  cmds->answers_size += size;
+}
+
+// Process a block of contiguous LinkADRReq commands, returns the size of the
+// block
+static uint8_t link_adr_req(struct ulorawan_session *const session,
+                            const uint8_t *const buf, uint8_t size) {
+  const uint8_t cmd_size = srv_cmd_sizes[SRV_MAC_LINK_ADR_REQ];
+  struct ulorawan_mac_link_adr_req reqs[ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK];
+  uint8_t ans[] = {DEV_MAC_LINK_ADR_ANS, 0};
+  uint8_t count = 0;
+  uint8_t offset = 0;
+
+  while (count < ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK && offset + cmd_size <= size &&
+         buf[offset] == SRV_MAC_LINK_ADR_REQ) {
+    const uint8_t *payload = &buf[offset + 1];
+
+    reqs[count].dr_tx_power.value = payload[0];
+    reqs[count].ch_mask = (uint16_t)(payload[1] | (payload[2] << 8));
+    reqs[count].redundancy.value = payload[3];
+
+    count++;
+    offset += cmd_size;
+  }
+
+  ans[1] = ulorawan_adr_link_adr_req(session, reqs, count).value;
+
+  // Every command of the block gets the same answer
+  for (uint8_t i = 0; i < count; i++) {
+    answer(session, ans, sizeof(ans));
+  }
+
+  return offset;
+}
+
+static void link_check_ans(struct ulorawan_session *const session,
+                           const uint8_t *const payload) {
+  ulorawan_link_stats_link_check(&session->link_stats, payload[0], payload[1]);
+}
+
+static void dev_status_req(struct ulorawan_session *const session) {
+  struct ulorawan_mac_device_status_ans status;
+  uint8_t ans[1 + sizeof(status)];
+
+  status.battry_level = ULORAWAN_MAC_BATTERY_UNABLE_TO_MEASURE;
+  status.radio_status.value = 0;
+  status.radio_status.bits.snr =
+      ulorawan_link_stats_margin(&session->link_stats);
+
+  ans[0] = DEV_MAC_DEV_STATUS_ANS;
+  memcpy(&ans[1], &status, sizeof(status));
+  answer(session, ans, sizeof(ans));
+}
+
+static void duty_cycle_req(struct ulorawan_session *const session,
+                           const uint8_t *const payload) {
+  union ulorawan_mac_duty_cycle_req req;
+  const uint8_t ans[] = {DEV_MAC_DUTY_CYCLE_ANS};
+
+  req.value = payload[0];
+
+  ulorawan_region_set_max_duty_cycle(&session->region_params,
+                                     req.bits.max_duty_cycle);
+  answer(session, ans, sizeof(ans));
+}
+
+static void tx_param_setup_req(struct ulorawan_session *const session,
+                               const uint8_t *const payload) {
+  struct ulorawan_mac_tx_param_setup_req req;
+  const uint8_t ans[] = {DEV_MAC_TX_PARAM_SETUP_ANS};
+
+  req.eirp_dwell_time.value = payload[0];
+
+  // Regions without TxParamSetupReq support must not answer
+  if (ulorawan_region_set_tx_params(
+          &session->region_params, req.eirp_dwell_time.bits.uplink_dwell_time,
+          req.eirp_dwell_time.bits.downlink_dwell_time,
+          req.eirp_dwell_time.bits.max_eirp) == ULORAWAN_REGION_ERR_NONE) {
+    answer(session, ans, sizeof(ans));
+  }
+}
+
+// A frequency in MAC commands is 24 bits in steps of 100 Hz
+static uint32_t read_frequency(const uint8_t *const buf) {
+  return ((uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+          ((uint32_t)buf[2] << 16)) *
+         100;
+}
+
+static void ping_slot_ch_req(struct ulorawan_session *const session,
+                             const uint8_t *const payload) {
+  uint32_t frequency = read_frequency(payload);
+  uint8_t dr = payload[3] & 0x0F;
+  uint8_t ans[] = {DEV_MAC_PING_SLOT_CH_ANS, 0};
+
+  // Zero selects the default frequency
+  if (frequency == 0 ||
+      ulorawan_region_frequency_valid(&session->region_params, frequency)) {
+    ans[1] |= PING_SLOT_CH_FREQ_OK;
+  }
+
+  if (ulorawan_region_max_payload(&session->region_params, dr) != 0) {
+    ans[1] |= PING_SLOT_CH_DR_OK;
+  }
+
+  // Both parameters change together or not at all
+  if (ans[1] == (PING_SLOT_CH_FREQ_OK | PING_SLOT_CH_DR_OK)) {
+    session->class_b.ping_frequency =
+        frequency != 0 ? frequency : session->region_params.rx2_frequency;
+    session->class_b.ping_dr = dr;
+  }
+
+  answer(session, ans, sizeof(ans));
+}
+
+static void beacon_freq_req(struct ulorawan_session *const session,
+                            const uint8_t *const payload) {
+  uint32_t frequency = read_frequency(payload);
+  uint8_t ans[] = {SVR_MAC_BEACON_FREQ_ANS, 0};
+
+  // Zero selects the default frequency
+  if (frequency == 0 ||
+      ulorawan_region_frequency_valid(&session->region_params, frequency)) {
+    ans[1] = BEACON_FREQ_OK;
+    session->class_b.beacon_frequency =
+        frequency != 0 ? frequency : session->region_params.rx2_frequency;
+  }
+
+  answer(session, ans, sizeof(ans));
+}
+
+int32_t ulorawan_cmds_process(struct ulorawan_session *const session,
+                              const uint8_t *const buf, uint8_t size) {
+  uint8_t offset = 0;
+
+  while (offset < size) {
+    uint8_t cid = buf[offset];
+    uint8_t cmd_size =
+        cid < sizeof(srv_cmd_sizes) ? srv_cmd_sizes[cid] : 0;
+
+    if (cmd_size == 0 || offset + cmd_size > size) {
+      log_hal_log_error("MAC command [0x%02X] unreadable", cid);
+      return ULORAWAN_ERR_PARAMS;
+    }
+
+    const uint8_t *payload = &buf[offset + 1];
+
+    switch (cid) {
+    case SRV_MAC_LINK_ADR_REQ:
+      // Contiguous requests are consumed as one block
+      cmd_size = link_adr_req(session, &buf[offset], size - offset);
+      break;
+    case SRV_MAC_LINK_CHECK_ANS:
+      link_check_ans(session, payload);
+      break;
+    case SRV_MAC_DEV_STATUS_REQ:
+      dev_status_req(session);
+      break;
+    case SRV_MAC_DUTY_CYCLE_REQ:
+      duty_cycle_req(session, payload);
+      break;
+    case SRV_MAC_TX_PARAM_SETUP_REQ:
+      tx_param_setup_req(session, payload);
+      break;
+    case SRV_MAC_PING_SLOT_CH_REQ:
+      ping_slot_ch_req(session, payload);
+      break;
+    case SVR_MAC_BEACON_FREQ_REQ:
+      beacon_freq_req(session, payload);
+      break;
+    default:
+      log_hal_log_debug("MAC command [0x%02X] ignored", cid);
+      break;
+    }
+
+    offset += cmd_size;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+void ulorawan_cmds_ping_slot_info_req(struct ulorawan_session *const session,
+                                      uint8_t periodicity) {
+  const uint8_t req[] = {DEV_MAC_PING_SLOT_INFO_REQ, periodicity};
+
+  answer(session, req, sizeof(req));
+}
+
+void ulorawan_cmds_clear_answers(struct ulorawan_session *const session) {
+  session->cmds.answers_size = 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * \file
+ *
+ * \brief The uloraWan MAC command processing function prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ULORAWAN_CMDS_H_
+#define ULORAWAN_CMDS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+//! The maximum number of contiguous LinkADRReq commands handled as one block
+#ifndef ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK
+#define ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK 8
+#endif
+
+/**
+ * \brief Process the MAC commands of a downlink.
+ *
+ * Commands are processed in order until the end of the buffer or the first
+ * unknown or truncated command, which makes the remaining commands
+ * unreadable. Contiguous LinkADRReq commands are applied as one block and
+ * answered once per command. Answers are queued for the next uplink, in
+ * FOpts or as a port 0 frame ahead of it when they do not fit.
+ *
+ * \param[in] session The session.
+ * \param[in] buf The MAC commands.
+ * \param[in] size The size of the MAC commands.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_ERR_PARAMS A command could not be read.
+ */
+int32_t ulorawan_cmds_process(struct ulorawan_session *const session,
+                              const uint8_t *const buf, uint8_t size);
+
+/**
+ * \brief Queue a PingSlotInfoReq for the next uplink.
+ *
+ * \param[in] session The session.
+ * \param[in] periodicity The ping slot periodicity.
+ */
+void ulorawan_cmds_ping_slot_info_req(struct ulorawan_session *const session,
+                                      uint8_t periodicity);
+
+/**
+ * \brief Discard the queued MAC command answers once they have been sent.
+ *
+ * \param[in] session The session.
+ */
+void ulorawan_cmds_clear_answers(struct ulorawan_session *const session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_CMDS_H_ */
@@ -0,0 +1,108 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan frame crypto implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "crypto_hal.h"
+#include "ulorawan_crypto.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_mac.h"
+
+//! The size of an AES block
+#define BLOCK_SIZE 16
+//! The first byte of the blocks that generate the payload key stream
+#define A_BLOCK 0x01
+//! The first byte of the block that prefixes the frame for the MIC
+#define B0_BLOCK 0x49
+
+static void write_u32(uint8_t *const buf, uint32_t value) {
+  buf[0] = (uint8_t)value;
+  buf[1] = (uint8_t)(value >> 8);
+  buf[2] = (uint8_t)(value >> 16);
+  buf[3] = (uint8_t)(value >> 24);
+}
+
+// Both the A and B0 blocks share the layout of the direction, address and
+// frame counter
+static void init_block(uint8_t *const block, uint8_t type, uint8_t dir,
+                       uint32_t dev_addr, uint32_t fcnt) {
+  memset(block, 0, BLOCK_SIZE);
+  block[0] = type;
+  block[5] = dir;
+  write_u32(&block[6], dev_addr);
+  write_u32(&block[10], fcnt);
+}
+
+int32_t ulorawan_crypto_mic(const uint8_t *const key, uint8_t dir,
+                            uint32_t dev_addr, uint32_t fcnt,
+                            const uint8_t *const msg, size_t size,
+                            uint32_t *const mic) {
+  uint8_t block[BLOCK_SIZE + ULORAWAN_MAC_BUF_SIZE];
+
+  if (size > ULORAWAN_MAC_BUF_SIZE) {
+    return ULORAWAN_ERR_CMAC;
+  }
+
+  init_block(block, B0_BLOCK, dir, dev_addr, fcnt);
+  block[15] = (uint8_t)size;
+  memcpy(&block[BLOCK_SIZE], msg, size);
+
+  if (crypto_hal_aes_cmac(key, block, BLOCK_SIZE + size, mic) !=
+      CRYPTO_HAL_ERR_NONE) {
+    return ULORAWAN_ERR_CMAC;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_crypto_payload(const uint8_t *const key, uint8_t dir,
+                                uint32_t dev_addr, uint32_t fcnt,
+                                uint8_t *const buf, size_t size) {
+  uint8_t a[BLOCK_SIZE];
+  uint8_t s[BLOCK_SIZE];
+
+  init_block(a, A_BLOCK, dir, dev_addr, fcnt);
+
+  for (size_t offset = 0; offset < size; offset += BLOCK_SIZE) {
+    a[15] = (uint8_t)(offset / BLOCK_SIZE + 1);
+
+    if (crypto_hal_aes_encrypt(key, a, s) != CRYPTO_HAL_ERR_NONE) {
+      return ULORAWAN_ERR_CMAC;
+    }
+
+    for (size_t i = 0; i < BLOCK_SIZE && offset + i < size; i++) {
+      buf[offset + i] ^= s[i];
+    }
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
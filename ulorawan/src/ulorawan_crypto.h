@@ -0,0 +1,90 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan frame crypto prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_CRYPTO_H_
+#define ULORAWAN_CRYPTO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! The direction of an uplink frame
+#define ULORAWAN_CRYPTO_DIR_UP 0
+//! The direction of a downlink frame
+#define ULORAWAN_CRYPTO_DIR_DOWN 1
+
+/**
+ * \brief Compute the message integrity code of a data frame.
+ *
+ * \param[in] key The network session key.
+ * \param[in] dir The frame direction.
+ * \param[in] dev_addr The device address.
+ * \param[in] fcnt The full 32 bit frame counter.
+ * \param[in] msg The frame from the MHDR up to the MIC.
+ * \param[in] size The size of the frame.
+ * \param[out] mic The message integrity code.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_CMAC Computing the cmac failed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_crypto_mic(const uint8_t *const key, uint8_t dir,
+                            uint32_t dev_addr, uint32_t fcnt,
+                            const uint8_t *const msg, size_t size,
+                            uint32_t *const mic);
+
+/**
+ * \brief Encrypt or decrypt a frame payload in place.
+ *
+ * \param[in] key The application or network session key.
+ * \param[in] dir The frame direction.
+ * \param[in] dev_addr The device address.
+ * \param[in] fcnt The full 32 bit frame counter.
+ * \param[in,out] buf The frame payload.
+ * \param[in] size The size of the frame payload.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_CMAC The key stream could not be computed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_crypto_payload(const uint8_t *const key, uint8_t dir,
+                                uint32_t dev_addr, uint32_t fcnt,
+                                uint8_t *const buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_CRYPTO_H_ */
@@ -31,14 +31,198 @@
  *
  */
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "log_hal.h"
 #include "radio_hal.h"
+#include "ulorawan_adr.h"
+#include "ulorawan_cmds.h"
+#include "ulorawan_crypto.h"
+#include "ulorawan_downlink.h"
 #include "ulorawan_error_codes.h"
+#include "ulorawan_frag.h"
+#include "ulorawan_link_stats.h"
+#include "ulorawan_multicast.h"
+#include "ulorawan_retrans.h"
 #include "ulorawan_session.h"
 
+//! The offset of the device address in a data frame
+#define DEV_ADDR_OFFSET 1
+//! The offset of the frame control in a data frame
+#define FCTRL_OFFSET 5
+//! The offset of the frame counter in a data frame
+#define FCNT_OFFSET 6
+//! The offset of the frame options in a data frame
+#define FOPTS_OFFSET 8
+//! The size of the frame port
+#define FPORT_SIZE 1
+//! The size of the message integrity code
+#define MIC_SIZE 4
+
+static uint32_t read_u32(const uint8_t *const buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static int32_t verify_mic(const struct ulorawan_session *const session,
+                          const struct ulorawan_session_keys *const keys,
+                          uint32_t fcnt) {
+  size_t size = session->frame_size - MIC_SIZE;
+  uint32_t cmac;
+
+  if (ulorawan_crypto_mic(keys->nwk_s_key, ULORAWAN_CRYPTO_DIR_DOWN,
+                          keys->dev_addr, fcnt, session->frame, size,
+                          &cmac) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_CMAC;
+  }
+
+  if (cmac != read_u32(&session->frame[size])) {
+    return ULORAWAN_ERR_MIC;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Decrypt the FRMPayload in place and describe it in the session
+static int32_t read_payload(struct ulorawan_session *const session,
+                            const struct ulorawan_session_keys *const keys,
+                            uint32_t fcnt, size_t fport_offset,
+                            bool multicast) {
+  struct ulorawan_downlink_data *rx = &session->rx;
+  size_t end = session->frame_size - MIC_SIZE;
+
+  rx->dev_addr = keys->dev_addr;
+  rx->multicast = multicast;
+  rx->port = 0;
+  rx->offset = 0;
+  rx->size = 0;
+
+  if (fport_offset >= end) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  rx->port = session->frame[fport_offset];
+  rx->offset = (uint8_t)(fport_offset + FPORT_SIZE);
+  rx->size = (uint8_t)(end - rx->offset);
+
+  // Port 0 carries MAC commands encrypted with the network session key
+  if (ulorawan_crypto_payload(rx->port == 0 ? keys->nwk_s_key
+                                            : keys->app_s_key,
+                              ULORAWAN_CRYPTO_DIR_DOWN, keys->dev_addr, fcnt,
+                              &session->frame[rx->offset],
+                              rx->size) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_CMAC;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
 int32_t ulorawan_downlink_handler(struct ulorawan_session *const session) {
+  union ulorawan_mac_mhdr mhdr;
+  union ulorawan_mac_fctrl fctrl;
+  struct radio_hal_rx_status status;
+  struct ulorawan_session_keys *keys;
+  struct ulorawan_multicast_group *group = NULL;
+  uint32_t dev_addr;
+  uint32_t fcnt;
+  int32_t result;
+
   if (radio_hal_fifo_read(session->frame, &session->frame_size)) {
     return ULORAWAN_ERR_RADIO;
   }
 
+  if (session->frame_size < FOPTS_OFFSET + MIC_SIZE) {
+    log_hal_log_error("Downlink too short");
+    return ULORAWAN_ERR_FRAME;
+  }
+
+  mhdr.value = session->frame[0];
+  fctrl.value = session->frame[FCTRL_OFFSET];
+  dev_addr = read_u32(&session->frame[DEV_ADDR_OFFSET]);
+
+  // Route the frame by address before any cryptography
+  if (dev_addr == session->keys.dev_addr) {
+    keys = &session->keys;
+  } else {
+    group = ulorawan_multicast_find(&session->multicast, dev_addr);
+    keys = group != NULL ? &group->keys : NULL;
+  }
+
+  if ((mhdr.bits.ftype != FRAME_TYPE_DATA_UNCONFIRMED_DOWN &&
+       mhdr.bits.ftype != FRAME_TYPE_DATA_CONFIRMED_DOWN) ||
+      keys == NULL ||
+      session->frame_size <
+          (size_t)(FOPTS_OFFSET + fctrl.bits.fopts_len + MIC_SIZE)) {
+    log_hal_log_error("Downlink not for this device");
+    return ULORAWAN_ERR_FRAME;
+  }
+
+  // Multicast frames are unconfirmed and carry no MAC commands
+  if (group != NULL &&
+      (mhdr.bits.ftype != FRAME_TYPE_DATA_UNCONFIRMED_DOWN ||
+       fctrl.bits.fopts_len != 0 || fctrl.bits.ack ||
+       session->frame_size <= FOPTS_OFFSET + MIC_SIZE ||
+       session->frame[FOPTS_OFFSET] == 0)) {
+    log_hal_log_error("Multicast downlink invalid");
+    return ULORAWAN_ERR_FRAME;
+  }
+
+  // Extend the 16 bit frame counter from the next expected counter
+  fcnt = (keys->fcnt_down & 0xFFFF0000UL) |
+         (uint32_t)(session->frame[FCNT_OFFSET] |
+                    (session->frame[FCNT_OFFSET + 1] << 8));
+
+  if (fcnt < keys->fcnt_down) {
+    fcnt += 0x10000UL;
+  }
+
+  result = verify_mic(session, keys, fcnt);
+  if (result != ULORAWAN_ERR_NONE) {
+    log_hal_log_error("Downlink MIC check failed");
+    return result;
+  }
+
+  keys->fcnt_down = fcnt + 1;
+
+  result = read_payload(session, keys, fcnt,
+                        FOPTS_OFFSET + fctrl.bits.fopts_len, group != NULL);
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  if (session->rx.size != 0 && session->rx.port == ULORAWAN_FRAG_PORT &&
+      ulorawan_frag_process(session, &session->frame[session->rx.offset],
+                            session->rx.size) != ULORAWAN_ERR_NONE) {
+    log_hal_log_error("Fragmentation message rejected");
+  }
+
+  if (group != NULL) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  ulorawan_adr_downlink(session);
+
+  if (fctrl.bits.ack) {
+    ulorawan_retrans_ack(session);
+  }
+
+  if (radio_hal_get_rx_status(&status) == RADIO_HAL_ERR_NONE) {
+    ulorawan_link_stats_add(&session->link_stats, status.rssi, status.snr);
+  } else {
+    log_hal_log_error("Downlink signal metrics unavailable");
+  }
+
+  if (ulorawan_cmds_process(session, &session->frame[FOPTS_OFFSET],
+                            fctrl.bits.fopts_len) != ULORAWAN_ERR_NONE) {
+    log_hal_log_error("Downlink MAC commands incomplete");
+  }
+
+  if (session->rx.size != 0 && session->rx.port == 0 &&
+      ulorawan_cmds_process(session, &session->frame[session->rx.offset],
+                            session->rx.size) != ULORAWAN_ERR_NONE) {
+    log_hal_log_error("Downlink MAC commands incomplete");
+  }
+
   return ULORAWAN_ERR_NONE;
 }
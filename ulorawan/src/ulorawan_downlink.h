@@ -40,6 +40,26 @@ extern "C" {
 
 #include "ulorawan_session.h"
 
+/**
+ * \brief Read and authenticate a downlink and process its MAC commands.
+ *
+ * The frame is routed by address to the unicast session or a multicast
+ * group before its integrity is checked. The FRMPayload is decrypted in
+ * place in the session frame and described by the session rx data, whose
+ * multicast flag tells a multicast frame from a unicast one. Multicast frames
+ * carry no MAC commands and do not affect the unicast session. Payloads on ULORAWAN_FRAG_PORT are passed to the fragmented data
+ * block receiver.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ * \retval ULORAWAN_ERR_RADIO The frame could not be read.
+ * \retval ULORAWAN_ERR_FRAME The frame is not a data downlink for this
+ * device.
+ * \retval ULORAWAN_ERR_CMAC Calculating the cmac failed.
+ * \retval ULORAWAN_ERR_MIC The frame integrity check failed.
+ */
 int32_t ulorawan_downlink_handler(struct ulorawan_session *const session);
 
 #ifdef __cplusplus
@@ -0,0 +1,160 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan radio energy meter implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "timer_hal.h"
+#include "ulorawan_energy.h"
+
+#ifdef ULORAWAN_ENERGY_ENABLED
+
+//! The number of microamp milliseconds in a nanoamp hour
+#define UA_MS_PER_NAH 3600U
+
+static void account(struct ulorawan_energy_account *const account,
+                    uint64_t charge) {
+  account->count++;
+  account->charge += charge;
+  account->last = charge;
+}
+
+void ulorawan_energy_reset(struct ulorawan_energy *const energy) {
+  uint32_t current[ULORAWAN_ENERGY_MODES];
+
+  memcpy(current, energy->current, sizeof(current));
+  memset(energy, 0, sizeof(struct ulorawan_energy));
+  memcpy(energy->current, current, sizeof(current));
+
+  energy->mode = MODE_SLEEP;
+  energy->since = timer_hal_get_time();
+}
+
+void ulorawan_energy_update(struct ulorawan_energy *const energy) {
+  uint32_t now = timer_hal_get_time();
+  uint32_t elapsed = now - energy->since;
+
+  energy->time[energy->mode] += elapsed;
+  energy->charge += (uint64_t)elapsed * energy->current[energy->mode];
+  energy->since = now;
+}
+
+void ulorawan_energy_mode(struct ulorawan_energy *const energy,
+                          enum RADIO_HAL_MODE mode) {
+  if (mode >= ULORAWAN_ENERGY_MODES) {
+    return;
+  }
+
+  ulorawan_energy_update(energy);
+  energy->mode = (uint8_t)mode;
+}
+
+void ulorawan_energy_irq(struct ulorawan_energy *const energy,
+                         enum radio_hal_irq_flags flags) {
+  bool done = false;
+
+  switch (energy->mode) {
+  case MODE_TX:
+    done = (flags & RADIO_HAL_IRQ_TX_DONE) != 0;
+    break;
+  case MODE_RX_SINGLE:
+    done = (flags & (RADIO_HAL_IRQ_RX_DONE | RADIO_HAL_IRQ_RX_TIMEOUT)) != 0;
+    break;
+  case MODE_RX_CAD:
+    done = (flags & RADIO_HAL_IRQ_CAD_DONE) != 0;
+    break;
+  default:
+    break;
+  }
+
+  if (!done) {
+    return;
+  }
+
+  ulorawan_energy_mode(energy, MODE_STDBY);
+
+  // The receive windows of the exchange start once it has transmitted
+  if (flags & RADIO_HAL_IRQ_TX_DONE) {
+    energy->exchange_rx = energy->charge;
+  }
+}
+
+void ulorawan_energy_begin(struct ulorawan_energy *const energy,
+                           enum ulorawan_energy_exchange exchange) {
+  ulorawan_energy_update(energy);
+
+  energy->exchange = exchange;
+  energy->exchange_start = energy->charge;
+  energy->exchange_rx = energy->charge;
+}
+
+void ulorawan_energy_end(struct ulorawan_energy *const energy, bool downlink) {
+  uint64_t charge;
+
+  if (energy->exchange == ENERGY_EXCHANGE_NONE) {
+    return;
+  }
+
+  ulorawan_energy_update(energy);
+  charge = energy->charge - energy->exchange_start;
+
+  if (energy->exchange == ENERGY_EXCHANGE_JOIN) {
+    account(&energy->join, charge);
+  } else if (downlink) {
+    account(&energy->uplink, energy->exchange_rx - energy->exchange_start);
+    account(&energy->downlink, energy->charge - energy->exchange_rx);
+  } else {
+    account(&energy->uplink, charge);
+  }
+
+  energy->exchange = ENERGY_EXCHANGE_NONE;
+}
+
+void ulorawan_energy_step(struct ulorawan_energy *const energy,
+                          enum ulorawan_state from, enum ulorawan_state to,
+                          bool downlink) {
+  bool idle_from = from == ULORAWAN_STATE_IDLE || from == ULORAWAN_STATE_RXC;
+  bool idle_to = to == ULORAWAN_STATE_IDLE || to == ULORAWAN_STATE_RXC ||
+                 to == ULORAWAN_STATE_FAULT;
+
+  if (idle_from && (to == ULORAWAN_STATE_TX || to == ULORAWAN_STATE_CAD)) {
+    ulorawan_energy_begin(energy, ENERGY_EXCHANGE_UPLINK);
+  } else if (!idle_from && idle_to) {
+    ulorawan_energy_end(energy, downlink);
+  }
+}
+
+uint64_t ulorawan_energy_nah(uint64_t charge) {
+  return (charge + UA_MS_PER_NAH / 2) / UA_MS_PER_NAH;
+}
+
+#endif // ULORAWAN_ENERGY_ENABLED
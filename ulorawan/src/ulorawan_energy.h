@@ -0,0 +1,141 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan radio energy meter
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_ENERGY_H_
+#define ULORAWAN_ENERGY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "radio_hal.h"
+#include "ulorawan_session.h"
+
+//! Record a radio mode set by the stack
+#ifdef ULORAWAN_ENERGY_ENABLED
+#define ULORAWAN_ENERGY_MODE(session, mode)                                    \
+  ulorawan_energy_mode(&(session)->energy, mode)
+#else
+#define ULORAWAN_ENERGY_MODE(session, mode) ((void)0)
+#endif // ULORAWAN_ENERGY_ENABLED
+
+/**
+ * \brief Clear the meter and start timing the sleep mode from now.
+ *
+ * The current table is kept.
+ *
+ * \param[in] energy The energy meter.
+ */
+void ulorawan_energy_reset(struct ulorawan_energy *const energy);
+
+/**
+ * \brief Record a change of radio mode.
+ *
+ * The time and charge in the previous mode are added up to now.
+ *
+ * \param[in] energy The energy meter.
+ * \param[in] mode The new radio mode.
+ */
+void ulorawan_energy_mode(struct ulorawan_energy *const energy,
+                          enum RADIO_HAL_MODE mode);
+
+/**
+ * \brief Record the radio returning to standby by itself.
+ *
+ * The radio leaves the transmit, single receive and channel activity
+ * detection modes when they complete, continuous receive is kept.
+ *
+ * \param[in] energy The energy meter.
+ * \param[in] flags The radio interrupt flags.
+ */
+void ulorawan_energy_irq(struct ulorawan_energy *const energy,
+                         enum radio_hal_irq_flags flags);
+
+/**
+ * \brief Start accounting the radio charge to an exchange.
+ *
+ * \param[in] energy The energy meter.
+ * \param[in] exchange The kind of exchange.
+ */
+void ulorawan_energy_begin(struct ulorawan_energy *const energy,
+                           enum ulorawan_energy_exchange exchange);
+
+/**
+ * \brief Stop accounting the radio charge to the exchange in progress.
+ *
+ * When an uplink delivered a downlink, the charge from the end of the
+ * transmission is accounted to the downlink.
+ *
+ * \param[in] energy The energy meter.
+ * \param[in] downlink True when the exchange delivered a downlink.
+ */
+void ulorawan_energy_end(struct ulorawan_energy *const energy, bool downlink);
+
+/**
+ * \brief Follow the exchanges from the steps of the state machine.
+ *
+ * An uplink starts when the stack leaves idle to transmit and ends when the
+ * stack is back to idle or class C reception.
+ *
+ * \param[in] energy The energy meter.
+ * \param[in] from The state before the step.
+ * \param[in] to The state after the step.
+ * \param[in] downlink True when the step handled a downlink.
+ */
+void ulorawan_energy_step(struct ulorawan_energy *const energy,
+                          enum ulorawan_state from, enum ulorawan_state to,
+                          bool downlink);
+
+/**
+ * \brief Add the time and charge of the radio mode up to now.
+ *
+ * \param[in] energy The energy meter.
+ */
+void ulorawan_energy_update(struct ulorawan_energy *const energy);
+
+/**
+ * \brief Convert a charge to nanoamp hours, thousandths of a microamp hour.
+ *
+ * \param[in] charge The charge in microamp milliseconds.
+ *
+ * \return The charge in nanoamp hours, rounded to the nearest.
+ */
+uint64_t ulorawan_energy_nah(uint64_t charge);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_ENERGY_H_ */
@@ -66,6 +66,12 @@ extern "C" {
 #define ULORAWAN_ERR_REGION -12
 //! Error timer error.
 #define ULORAWAN_ERR_TIMER -13
+//! Error frame rejected.
+#define ULORAWAN_ERR_FRAME -14
+//! Error frame integrity check failed.
+#define ULORAWAN_ERR_MIC -15
+//! Error uplink queue full.
+#define ULORAWAN_ERR_FULL -16
 
 #ifdef __cplusplus
 }
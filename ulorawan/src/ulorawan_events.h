@@ -38,6 +38,8 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 //! The ulorawan event type
 enum ulorawan_event_type {
     //! Radio Irq 
@@ -55,6 +57,10 @@ struct ulorawan_event
         enum radio_hal_irq_flags flags;
         enum timer_hal_timer timer;
     } data;
+#ifdef ULORAWAN_LATENCY_ENABLED
+    //! The time in milliseconds the event was queued
+    uint32_t time;
+#endif // ULORAWAN_LATENCY_ENABLED
 };
 
 #ifdef __cplusplus
@@ -0,0 +1,92 @@
+/**
+ * \file
+ *
+ * \brief Uplink frame counter reservation.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+
+#include "log_hal.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_fcnt.h"
+#include "ulorawan_store.h"
+
+int32_t ulorawan_fcnt_restore(struct ulorawan_session *const session) {
+  struct ulorawan_fcnt *fcnt = &session->fcnt;
+  uint8_t record[4];
+  int32_t result;
+
+  result = ulorawan_store_get(&session->store, ULORAWAN_STORE_KEY_FCNT_UP,
+                              record, sizeof(record));
+  if (result == ULORAWAN_ERR_NVM) {
+    return result;
+  }
+
+  if (result == ULORAWAN_ERR_NONE) {
+    fcnt->reserved = (uint32_t)record[0] | ((uint32_t)record[1] << 8) |
+                     ((uint32_t)record[2] << 16) | ((uint32_t)record[3] << 24);
+    session->keys.fcnt_up = fcnt->reserved;
+    log_hal_log_info("Uplink frame counter resumed at [%u]", fcnt->reserved);
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_fcnt_reserve(struct ulorawan_session *const session) {
+  struct ulorawan_fcnt *fcnt = &session->fcnt;
+  uint32_t reserved = session->keys.fcnt_up + fcnt->block;
+  uint8_t record[4];
+  int32_t result;
+
+  if (session->keys.fcnt_up < fcnt->reserved) {
+    fcnt->stats.saved++;
+    return ULORAWAN_ERR_NONE;
+  }
+
+  record[0] = (uint8_t)reserved;
+  record[1] = (uint8_t)(reserved >> 8);
+  record[2] = (uint8_t)(reserved >> 16);
+  record[3] = (uint8_t)(reserved >> 24);
+
+  result = ulorawan_store_put(&session->store, ULORAWAN_STORE_KEY_FCNT_UP,
+                              record, sizeof(record));
+  if (result == ULORAWAN_ERR_NONE) {
+    result = ulorawan_store_flush(&session->store);
+  }
+
+  if (result != ULORAWAN_ERR_NONE) {
+    log_hal_log_error("Uplink frame counters not reserved");
+    return result;
+  }
+
+  fcnt->reserved = reserved;
+  fcnt->stats.reservations++;
+
+  return ULORAWAN_ERR_NONE;
+}
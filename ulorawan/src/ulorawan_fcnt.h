@@ -0,0 +1,77 @@
+/**
+ * \file
+ *
+ * \brief Uplink frame counter reservation.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_FCNT_H_
+#define ULORAWAN_FCNT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+/**
+ * \brief Resume the uplink frame counter from the stored reservation.
+ *
+ * Every counter below the reservation may have been used before the reset,
+ * so counting resumes from it.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NVM The session store could not be read.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_fcnt_restore(struct ulorawan_session *const session);
+
+/**
+ * \brief Make sure the next uplink frame counter is reserved.
+ *
+ * When the counter reaches the reservation the next block of counters is
+ * reserved and written to the store before the uplink is sent.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_STATE The session store is not mounted.
+ * \retval ULORAWAN_ERR_NVM The reservation could not be written.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_fcnt_reserve(struct ulorawan_session *const session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_FCNT_H_ */
@@ -0,0 +1,574 @@
+/**
+ * \file
+ *
+ * \brief Fragmented data block transport.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "nvm_hal.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_frag.h"
+#include "ulorawan_uplink_queue.h"
+
+//! The package version command
+#define CMD_PACKAGE_VERSION 0x00
+//! The fragmentation session status command
+#define CMD_SESSION_STATUS 0x01
+//! The fragmentation session setup command
+#define CMD_SESSION_SETUP 0x02
+//! The fragmentation session delete command
+#define CMD_SESSION_DELETE 0x03
+//! The data fragment command
+#define CMD_DATA_FRAGMENT 0x08
+
+//! The fragmented data block transport package identifier
+#define PACKAGE_IDENTIFIER 3
+//! The fragmented data block transport package version
+#define PACKAGE_VERSION 1
+
+//! The size of the session status request parameters
+#define STATUS_REQ_SIZE 1
+//! The size of the session setup request parameters
+#define SETUP_REQ_SIZE 10
+//! The size of the session delete request parameters
+#define DELETE_REQ_SIZE 1
+//! The size of the data fragment index
+#define FRAGMENT_INDEX_SIZE 2
+//! The largest size of the answers to one message
+#define ANSWERS_MAX_SIZE 16
+
+//! The setup status bit for an unsupported coding algorithm
+#define SETUP_ENCODING_UNSUPPORTED 0x01
+//! The setup status bit for a data block too large for the memory
+#define SETUP_NOT_ENOUGH_MEMORY 0x02
+//! The setup and delete status bit for an unsupported session index
+#define SESSION_INDEX_UNSUPPORTED 0x04
+
+// The number of 32 bit words holding a fragment
+static size_t words(const struct ulorawan_frag *const frag) {
+  return ULORAWAN_FRAG_WORDS(frag->frag_size * 8U);
+}
+
+static uint8_t popcount(uint32_t x) {
+  x = x - ((x >> 1) & 0x55555555UL);
+  x = (x & 0x33333333UL) + ((x >> 2) & 0x33333333UL);
+  x = (x + (x >> 4)) & 0x0F0F0F0FUL;
+  return (uint8_t)((x * 0x01010101UL) >> 24);
+}
+
+static uint8_t lowest_bit(uint32_t x) { return popcount((x & (0UL - x)) - 1); }
+
+static void xor_words(uint32_t *const dst, const uint32_t *const src,
+                      size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] ^= src[i];
+  }
+}
+
+// The pseudo random sequence generating the parity lines
+static uint32_t prbs23(uint32_t x) {
+  uint32_t b0 = x & 1;
+  uint32_t b1 = (x & 0x20) >> 5;
+
+  return (x >> 1) + ((b0 ^ b1) << 22);
+}
+
+// The uncoded fragments combined into coded fragment n of m
+static void parity_line(uint32_t *const line, uint16_t n, uint16_t m) {
+  // Powers of two widen the modulus so every fragment can be drawn
+  uint32_t modulus = m + ((m & (m - 1)) == 0 ? 1 : 0);
+  uint32_t x = 1 + 1001UL * n;
+
+  memset(line, 0, ULORAWAN_FRAG_WORDS(m) * sizeof(uint32_t));
+
+  for (uint16_t i = 0; i < m / 2; i++) {
+    uint32_t r;
+
+    do {
+      x = prbs23(x);
+      r = x % modulus;
+    } while (r >= m);
+
+    line[r / 32] |= 1UL << (r % 32);
+  }
+}
+
+static uint32_t fragment_address(const struct ulorawan_frag *const frag,
+                                 uint16_t n) {
+  return ULORAWAN_FRAG_NVM_ADDRESS + (uint32_t)(n - 1) * frag->frag_size;
+}
+
+static uint32_t row_address(const struct ulorawan_frag *const frag,
+                            uint16_t lead) {
+  return ULORAWAN_FRAG_NVM_ADDRESS +
+         ((uint32_t)frag->nb_frag + lead) * frag->frag_size;
+}
+
+// Erase the sectors the session writes, each byte is then programmed once
+static int32_t erase(const struct ulorawan_frag *const frag) {
+  uint32_t end = row_address(frag, ULORAWAN_FRAG_MAX_LOST);
+
+  for (uint32_t address = ULORAWAN_FRAG_NVM_ADDRESS; address < end;
+       address += NVM_HAL_SECTOR_SIZE) {
+    if (nvm_hal_erase(address) != NVM_HAL_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+static int32_t read_scratch(struct ulorawan_frag *const frag,
+                            uint32_t address) {
+  if (nvm_hal_read(address, (uint8_t *)frag->scratch, frag->frag_size) !=
+      NVM_HAL_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+static int32_t write_data(struct ulorawan_frag *const frag, uint32_t address) {
+  if (nvm_hal_write(address, (const uint8_t *)frag->data, frag->frag_size) !=
+      NVM_HAL_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Back substitute from the last lost fragment, each row then only refers to
+// fragments already solved
+static int32_t solve(struct ulorawan_frag *const frag) {
+  const size_t row_words = ULORAWAN_FRAG_WORDS(frag->lost);
+
+  for (uint16_t lead = frag->lost; lead-- > 0;) {
+    const uint32_t *row = frag->matrix[lead];
+
+    if (read_scratch(frag, row_address(frag, lead)) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    memcpy(frag->data, frag->scratch, words(frag) * sizeof(uint32_t));
+
+    for (size_t w = lead / 32; w < row_words; w++) {
+      uint32_t bits = row[w];
+
+      if (w == lead / 32) {
+        bits &= ~((2UL << (lead % 32)) - 1);
+      }
+
+      while (bits != 0) {
+        uint16_t j = (uint16_t)(w * 32 + lowest_bit(bits));
+
+        bits &= bits - 1;
+
+        if (read_scratch(frag, fragment_address(frag, frag->lost_index[j])) !=
+            ULORAWAN_ERR_NONE) {
+          return ULORAWAN_ERR_NVM;
+        }
+
+        xor_words(frag->data, frag->scratch, words(frag));
+      }
+    }
+
+    if (write_data(frag, fragment_address(frag, frag->lost_index[lead])) !=
+        ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+  }
+
+  frag->stats.recovered += frag->lost;
+  frag->complete = 1;
+
+  log_hal_log_info("Recovered [%u] lost fragments", frag->lost);
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Eliminate the row against the stored rows and keep it when it is new
+static int32_t reduce(struct ulorawan_frag *const frag, uint32_t *const row) {
+  const size_t row_words = ULORAWAN_FRAG_WORDS(frag->lost);
+
+  for (size_t w = 0; w < row_words;) {
+    if (row[w] == 0) {
+      w++;
+      continue;
+    }
+
+    uint16_t lead = (uint16_t)(w * 32 + lowest_bit(row[w]));
+    uint32_t *stored = frag->matrix[lead];
+
+    if ((stored[lead / 32] & (1UL << (lead % 32))) == 0) {
+      memcpy(stored, row, row_words * sizeof(uint32_t));
+
+      if (write_data(frag, row_address(frag, lead)) != ULORAWAN_ERR_NONE) {
+        return ULORAWAN_ERR_NVM;
+      }
+
+      if (++frag->rows == frag->lost) {
+        return solve(frag);
+      }
+
+      return ULORAWAN_ERR_NONE;
+    }
+
+    if (read_scratch(frag, row_address(frag, lead)) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    xor_words(row, stored, row_words);
+    xor_words(frag->data, frag->scratch, words(frag));
+  }
+
+  frag->stats.redundant++;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Freeze the lost fragments once the coded fragments start
+static void start_coding(struct ulorawan_frag *const frag) {
+  uint16_t lost = 0;
+
+  for (size_t w = 0; w < ULORAWAN_FRAG_WORDS(frag->nb_frag); w++) {
+    uint32_t bits = frag->missing[w];
+
+    while (bits != 0) {
+      if (lost < ULORAWAN_FRAG_MAX_LOST) {
+        frag->lost_index[lost] = (uint16_t)(w * 32 + lowest_bit(bits) + 1);
+      }
+
+      bits &= bits - 1;
+      lost++;
+    }
+  }
+
+  frag->lost = lost;
+  frag->overflow = lost > ULORAWAN_FRAG_MAX_LOST;
+
+  if (frag->overflow) {
+    log_hal_log_error("[%u] lost fragments cannot be recovered", lost);
+  }
+}
+
+// Map a parity line onto the lost fragments, folding in the received ones
+static int32_t fold_line(struct ulorawan_frag *const frag,
+                         uint32_t *const row) {
+  uint16_t rank = 0;
+
+  for (size_t w = 0; w < ULORAWAN_FRAG_WORDS(frag->nb_frag); w++) {
+    uint32_t lost = frag->line[w] & frag->missing[w];
+    uint32_t received = frag->line[w] & ~frag->missing[w];
+
+    while (lost != 0) {
+      uint8_t bit = lowest_bit(lost);
+      uint16_t j =
+          (uint16_t)(rank + popcount(frag->missing[w] & ((1UL << bit) - 1)));
+
+      row[j / 32] |= 1UL << (j % 32);
+      lost &= lost - 1;
+    }
+
+    while (received != 0) {
+      uint16_t n = (uint16_t)(w * 32 + lowest_bit(received) + 1);
+
+      if (read_scratch(frag, fragment_address(frag, n)) != ULORAWAN_ERR_NONE) {
+        return ULORAWAN_ERR_NVM;
+      }
+
+      xor_words(frag->data, frag->scratch, words(frag));
+      received &= received - 1;
+    }
+
+    rank = (uint16_t)(rank + popcount(frag->missing[w]));
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+static int32_t data_fragment(struct ulorawan_frag *const frag, uint16_t n,
+                             const uint8_t *const data) {
+  uint32_t row[ULORAWAN_FRAG_WORDS(ULORAWAN_FRAG_MAX_LOST)] = {0};
+  uint16_t bit = (uint16_t)(n - 1);
+
+  frag->fragments++;
+  frag->stats.received++;
+
+  if (frag->complete || frag->overflow) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  memcpy(frag->data, data, frag->frag_size);
+
+  if (n <= frag->nb_frag) {
+    uint32_t mask = 1UL << (bit % 32);
+
+    if ((frag->missing[bit / 32] & mask) == 0) {
+      frag->stats.redundant++;
+      return ULORAWAN_ERR_NONE;
+    }
+
+    if (frag->lost == 0) {
+      if (write_data(frag, fragment_address(frag, n)) != ULORAWAN_ERR_NONE) {
+        return ULORAWAN_ERR_NVM;
+      }
+
+      frag->missing[bit / 32] &= ~mask;
+      frag->complete = ++frag->received == frag->nb_frag;
+
+      return ULORAWAN_ERR_NONE;
+    }
+
+    // A late uncoded fragment is a row with one lost fragment
+    uint16_t j = popcount(frag->missing[bit / 32] & (mask - 1));
+
+    for (size_t w = 0; w < bit / 32; w++) {
+      j = (uint16_t)(j + popcount(frag->missing[w]));
+    }
+
+    row[j / 32] |= 1UL << (j % 32);
+
+    return reduce(frag, row);
+  }
+
+  if (frag->lost == 0) {
+    start_coding(frag);
+
+    if (frag->overflow) {
+      return ULORAWAN_ERR_NONE;
+    }
+  }
+
+  parity_line(frag->line, (uint16_t)(n - frag->nb_frag), frag->nb_frag);
+
+  if (fold_line(frag, row) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  return reduce(frag, row);
+}
+
+static uint8_t session_setup(struct ulorawan_frag *const frag,
+                             const uint8_t *const req) {
+  uint8_t index = (req[0] >> 4) & 0x03;
+  uint16_t nb_frag = (uint16_t)(req[1] | (req[2] << 8));
+  uint8_t frag_size = req[3];
+  uint8_t algo = (req[4] >> 3) & 0x07;
+  uint8_t status = 0;
+
+  if (index != 0) {
+    status |= SESSION_INDEX_UNSUPPORTED;
+  }
+
+  if (algo != 0) {
+    status |= SETUP_ENCODING_UNSUPPORTED;
+  }
+
+  if (nb_frag == 0 || nb_frag > ULORAWAN_FRAG_MAX_NB || frag_size == 0 ||
+      frag_size > ULORAWAN_FRAG_MAX_SIZE ||
+      ((uint32_t)nb_frag + ULORAWAN_FRAG_MAX_LOST) * frag_size >
+          ULORAWAN_FRAG_NVM_SIZE) {
+    status |= SETUP_NOT_ENOUGH_MEMORY;
+  }
+
+  if (status != 0) {
+    return (uint8_t)(status | (index << 6));
+  }
+
+  struct ulorawan_frag_stats stats = frag->stats;
+
+  memset(frag, 0, sizeof(*frag));
+  frag->stats = stats;
+  frag->active = 1;
+  frag->mc_group_mask = req[0] & 0x0F;
+  frag->nb_frag = nb_frag;
+  frag->frag_size = frag_size;
+  frag->padding = req[5];
+  frag->descriptor = (uint32_t)req[6] | ((uint32_t)req[7] << 8) |
+                     ((uint32_t)req[8] << 16) | ((uint32_t)req[9] << 24);
+
+  for (uint16_t i = 0; i < nb_frag; i++) {
+    frag->missing[i / 32] |= 1UL << (i % 32);
+  }
+
+  // The memory still holds the fragments of the previous session
+  if (erase(frag) != ULORAWAN_ERR_NONE) {
+    log_hal_log_error("Fragmentation memory not erased");
+    frag->active = 0;
+    return (uint8_t)(SETUP_NOT_ENOUGH_MEMORY | (index << 6));
+  }
+
+  log_hal_log_info("Fragmentation session of [%u] fragments of [%u] bytes",
+                   nb_frag, frag_size);
+
+  return 0;
+}
+
+// The number of fragments still needed to reassemble the data block
+static uint16_t missing(const struct ulorawan_frag *const frag) {
+  if (frag->complete) {
+    return 0;
+  }
+
+  return frag->lost == 0 ? (uint16_t)(frag->nb_frag - frag->received)
+                         : (uint16_t)(frag->lost - frag->rows);
+}
+
+int32_t ulorawan_frag_process(struct ulorawan_session *const session,
+                              const uint8_t *const buf, uint8_t size) {
+  struct ulorawan_frag *frag = &session->frag;
+  uint8_t answers[ANSWERS_MAX_SIZE];
+  uint8_t answers_size = 0;
+  uint8_t pos = 0;
+  int32_t result = ULORAWAN_ERR_NONE;
+
+  while (pos < size && result == ULORAWAN_ERR_NONE) {
+    uint8_t cid = buf[pos++];
+    uint8_t remaining = (uint8_t)(size - pos);
+    const uint8_t *req = &buf[pos];
+
+    if (cid == CMD_PACKAGE_VERSION) {
+      if (answers_size + 3 > ANSWERS_MAX_SIZE) {
+        result = ULORAWAN_ERR_FRAME;
+        break;
+      }
+
+      answers[answers_size++] = CMD_PACKAGE_VERSION;
+      answers[answers_size++] = PACKAGE_IDENTIFIER;
+      answers[answers_size++] = PACKAGE_VERSION;
+    } else if (cid == CMD_SESSION_STATUS) {
+      if (remaining < STATUS_REQ_SIZE) {
+        result = ULORAWAN_ERR_FRAME;
+        break;
+      }
+
+      uint8_t index = (req[0] >> 1) & 0x03;
+      uint16_t count = missing(frag);
+
+      pos += STATUS_REQ_SIZE;
+
+      // Without the participants bit only devices still missing data answer
+      if (index != 0 || !frag->active ||
+          ((req[0] & 0x01) == 0 && count == 0)) {
+        continue;
+      }
+
+      if (answers_size + 5 > ANSWERS_MAX_SIZE) {
+        result = ULORAWAN_ERR_FRAME;
+        break;
+      }
+
+      answers[answers_size++] = CMD_SESSION_STATUS;
+      answers[answers_size++] = (uint8_t)frag->fragments;
+      answers[answers_size++] = (uint8_t)((frag->fragments >> 8) & 0x3F);
+      answers[answers_size++] = count > 0xFF ? 0xFF : (uint8_t)count;
+      answers[answers_size++] = frag->overflow;
+    } else if (cid == CMD_SESSION_SETUP) {
+      if (remaining < SETUP_REQ_SIZE || answers_size + 2 > ANSWERS_MAX_SIZE) {
+        result = ULORAWAN_ERR_FRAME;
+        break;
+      }
+
+      answers[answers_size++] = CMD_SESSION_SETUP;
+      answers[answers_size++] = session_setup(frag, req);
+      pos += SETUP_REQ_SIZE;
+    } else if (cid == CMD_SESSION_DELETE) {
+      if (remaining < DELETE_REQ_SIZE || answers_size + 2 > ANSWERS_MAX_SIZE) {
+        result = ULORAWAN_ERR_FRAME;
+        break;
+      }
+
+      uint8_t index = req[0] & 0x03;
+
+      answers[answers_size++] = CMD_SESSION_DELETE;
+
+      if (index != 0 || !frag->active) {
+        answers[answers_size++] = (uint8_t)(SESSION_INDEX_UNSUPPORTED | index);
+      } else {
+        answers[answers_size++] = 0;
+        frag->active = 0;
+      }
+
+      pos += DELETE_REQ_SIZE;
+    } else if (cid == CMD_DATA_FRAGMENT) {
+      // The fragment takes the rest of the message
+      if (remaining < FRAGMENT_INDEX_SIZE) {
+        result = ULORAWAN_ERR_FRAME;
+        break;
+      }
+
+      uint16_t value = (uint16_t)(req[0] | (req[1] << 8));
+      uint16_t n = value & 0x3FFF;
+
+      pos = size;
+
+      if ((value >> 14) != 0 || !frag->active) {
+        continue;
+      }
+
+      if (n == 0 || remaining != FRAGMENT_INDEX_SIZE + frag->frag_size) {
+        result = ULORAWAN_ERR_FRAME;
+        break;
+      }
+
+      result = data_fragment(frag, n, &req[FRAGMENT_INDEX_SIZE]);
+    } else {
+      log_hal_log_error("Unknown fragmentation command [0x%02X]", cid);
+      result = ULORAWAN_ERR_FRAME;
+    }
+  }
+
+  if (answers_size != 0) {
+    struct ulorawan_uplink_req answer = {
+        .port = ULORAWAN_FRAG_PORT,
+        .payload = answers,
+        .size = answers_size,
+        .confirm = false,
+        .priority = ULORAWAN_UPLINK_PRIORITY_NORMAL,
+        .lifetime = 0};
+
+    if (ulorawan_uplink_queue_push(&session->uplink_queue, &answer, 0) !=
+        ULORAWAN_ERR_NONE) {
+      log_hal_log_error("Fragmentation answers not queued");
+    }
+  }
+
+  return result;
+}
+
+uint32_t ulorawan_frag_block_size(const struct ulorawan_frag *const frag) {
+  if (!frag->active || !frag->complete) {
+    return 0;
+  }
+
+  return (uint32_t)frag->nb_frag * frag->frag_size - frag->padding;
+}
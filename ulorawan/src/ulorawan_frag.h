@@ -0,0 +1,95 @@
+/**
+ * \file
+ *
+ * \brief Fragmented data block transport.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_FRAG_H_
+#define ULORAWAN_FRAG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+//! The port of the fragmented data block transport
+#define ULORAWAN_FRAG_PORT 201
+
+//! The non volatile memory address of the data block, sector aligned
+#ifndef ULORAWAN_FRAG_NVM_ADDRESS
+#define ULORAWAN_FRAG_NVM_ADDRESS 0
+#endif
+
+//! The non volatile memory reserved for the data block and the coded rows
+#ifndef ULORAWAN_FRAG_NVM_SIZE
+#define ULORAWAN_FRAG_NVM_SIZE 0x20000UL
+#endif
+
+/**
+ * \brief Process a fragmentation message.
+ *
+ * Handles the package version, session setup, status and delete requests
+ * and the data fragments, queueing the answers on the fragmentation port.
+ * Uncoded fragments are written to their place in the data block. Coded
+ * fragments are reduced against the fragments received so far and stored
+ * as rows over the lost fragments, which are solved once there are as many
+ * rows as lost fragments.
+ *
+ * The data block area must be erased before a session is set up, each byte
+ * of it is written once.
+ *
+ * \param[in] session The session.
+ * \param[in] buf The decrypted application payload.
+ * \param[in] size The size of the payload.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_FRAME The message is malformed.
+ * \retval ULORAWAN_ERR_NVM The data block could not be read or written.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_frag_process(struct ulorawan_session *const session,
+                              const uint8_t *const buf, uint8_t size);
+
+/**
+ * \brief Get the size of the reassembled data block.
+ *
+ * \param[in] frag The fragmented data block receiver.
+ *
+ * \return The size of the data block, zero until it is reassembled.
+ */
+uint32_t ulorawan_frag_block_size(const struct ulorawan_frag *const frag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_FRAG_H_ */
@@ -31,15 +31,46 @@
  *
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "log_hal.h"
 #include "radio_hal.h"
 #include "timer_hal.h"
+#include "ulorawan_class_b.h"
+#include "ulorawan_class_c.h"
 #include "ulorawan_downlink.h"
 #include "ulorawan_error_codes.h"
+#include "ulorawan_lbt.h"
+#include "ulorawan_region.h"
+#include "ulorawan_retrans.h"
 #include "ulorawan_session.h"
 
+// A frame the downlink handler rejects is not a downlink, the exchange goes on
+// as if the window had timed out
+static bool rejected(int32_t result) {
+  return result == ULORAWAN_ERR_FRAME || result == ULORAWAN_ERR_MIC;
+}
+
+// Move on from RX1 when it closed without a downlink
+static int32_t rx1_closed(struct ulorawan_session *const session) {
+  int32_t result = ULORAWAN_ERR_NONE;
+
+  if (session->class == DEVICE_CLASS_C) {
+    // The RX2 window of class C lasts until the next uplink
+    result = ulorawan_class_c_listen(session);
+    if (result == ULORAWAN_ERR_NONE) {
+      session->state = ULORAWAN_STATE_RXC;
+      ulorawan_retrans_rx_done(session, false);
+    }
+  } else {
+    session->state = ULORAWAN_STATE_RX2;
+    // TODO Configure Radio
+  }
+
+  return result;
+}
+
 int32_t ulorawan_radio_irq_handler(struct ulorawan_session *const session,
                                    enum radio_hal_irq_flags flags) {
   log_hal_log_debug("Session state [0x%02X] flags: [0x%02X]", session->state,
@@ -57,6 +88,9 @@ int32_t ulorawan_radio_irq_handler(struct ulorawan_session *const session,
     if (flags & RADIO_HAL_IRQ_TX_DONE) {
       log_hal_log_debug("TX state TX done");
 
+      ulorawan_region_record_tx(&session->region_params, session->channel.band,
+                                session->tx_start, timer_hal_get_time());
+
       if (timer_hal_start(TIMER0, session->region_params.rx_delay_1) !=
               TIMER_HAL_ERR_NONE ||
           timer_hal_start(TIMER1, session->region_params.rx_delay_2) !=
@@ -67,25 +101,39 @@ int32_t ulorawan_radio_irq_handler(struct ulorawan_session *const session,
       }
 
       session->state = ULORAWAN_STATE_RX1;
+
+      // Class C listens on RX2 until RX1 opens
+      if (result == ULORAWAN_ERR_NONE &&
+          session->class == DEVICE_CLASS_C) {
+        result = ulorawan_class_c_listen(session);
+      }
     }
     break;
   case ULORAWAN_STATE_RX1:
     if (flags & RADIO_HAL_IRQ_RX_TIMEOUT) {
-      session->state = ULORAWAN_STATE_RX2;
       log_hal_log_debug("RX1 state RX timeout");
-      // TODO Configure Radio
+      result = rx1_closed(session);
     } else if (flags & RADIO_HAL_IRQ_RX_DONE) {
       log_hal_log_debug("RX1 state RX done");
 
-      if (timer_hal_stop(TIMER1) != TIMER_HAL_ERR_NONE) {
+      // RX2 is only cancelled once the frame is accepted
+      result = ulorawan_downlink_handler(session);
+      if (result != ULORAWAN_ERR_NONE) {
+        log_hal_log_warn("RX1 downlink not accepted [%i]", result);
+        int32_t closed = rx1_closed(session);
+        if (rejected(result) || closed != ULORAWAN_ERR_NONE) {
+          result = closed;
+        }
+      } else if (session->rx.multicast) {
+        // A multicast frame does not answer the uplink, RX2 is still due
+        result = rx1_closed(session);
+      } else if (timer_hal_stop(TIMER1) != TIMER_HAL_ERR_NONE) {
         log_hal_log_error("Failed to stop TIMER1");
         result = ULORAWAN_ERR_TIMER;
         session->state = ULORAWAN_STATE_FAULT;
       } else {
-        result = ulorawan_downlink_handler(session);
-        if (result == ULORAWAN_ERR_NONE) {
-          session->state = ULORAWAN_STATE_IDLE;
-        }
+        session->state = ULORAWAN_STATE_IDLE;
+        ulorawan_retrans_rx_done(session, true);
       }
     }
     break;
@@ -93,14 +141,37 @@ int32_t ulorawan_radio_irq_handler(struct ulorawan_session *const session,
     if (flags & RADIO_HAL_IRQ_RX_TIMEOUT) {
       log_hal_log_debug("RX2 state RX timeout");
       session->state = ULORAWAN_STATE_IDLE;
+      ulorawan_retrans_rx_done(session, false);
     } else if (flags & RADIO_HAL_IRQ_RX_DONE) {
       log_hal_log_debug("RX2 state RX done");
       result = ulorawan_downlink_handler(session);
+      session->state = ULORAWAN_STATE_IDLE;
       if (result == ULORAWAN_ERR_NONE) {
-        session->state = ULORAWAN_STATE_IDLE;
+        ulorawan_retrans_rx_done(session, !session->rx.multicast);
+      } else {
+        log_hal_log_warn("RX2 downlink not accepted [%i]", result);
+        ulorawan_retrans_rx_done(session, false);
+        if (rejected(result)) {
+          result = ULORAWAN_ERR_NONE;
+        }
       }
     }
     break;
+  case ULORAWAN_STATE_RXC:
+    result = ulorawan_class_c_irq(session, flags);
+    break;
+  case ULORAWAN_STATE_BEACON:
+  case ULORAWAN_STATE_PING:
+    result = ulorawan_class_b_irq(session, flags);
+    break;
+#ifdef ULORAWAN_LBT_ENABLED
+  case ULORAWAN_STATE_CAD:
+    if (flags & RADIO_HAL_IRQ_CAD_DONE) {
+      log_hal_log_debug("CAD state CAD done");
+      result = ulorawan_lbt_cad_done(session, flags);
+    }
+    break;
+#endif // ULORAWAN_LBT_ENABLED
   default:
     break;
   }
@@ -0,0 +1,222 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan state machine latency instrumentation implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "timer_hal.h"
+#include "ulorawan_latency.h"
+
+#ifdef ULORAWAN_LATENCY_ENABLED
+
+//! The names of the states in the dump
+static const char *const state_names[] = {"INIT", "IDLE",   "TX",   "RX1",
+                                          "RX2",  "CAD",    "RXC",  "BEACON",
+                                          "PING", "FAULT"};
+
+static uint8_t bucket(uint32_t latency) {
+  uint8_t index = 0;
+
+  while (latency != 0 && index < ULORAWAN_LATENCY_BUCKETS - 1) {
+    latency >>= 1;
+    index++;
+  }
+
+  return index;
+}
+
+static void add(struct ulorawan_latency_histogram *const histogram,
+                uint32_t latency) {
+  histogram->count++;
+  histogram->total += latency;
+
+  if (latency > histogram->max) {
+    histogram->max = latency;
+  }
+
+  // The bucket saturates rather than wrapping to an empty bucket
+  if (histogram->buckets[bucket(latency)] != UINT16_MAX) {
+    histogram->buckets[bucket(latency)]++;
+  }
+}
+
+static const char *state_name(uint8_t state) {
+  return state < sizeof(state_names) / sizeof(state_names[0])
+             ? state_names[state]
+             : "?";
+}
+
+// Append to the text, the length grows past the buffer so the caller learns
+// the full size
+static void append(char *const buf, size_t size, size_t *const length,
+                   const char *fmt, ...) {
+  va_list args;
+  int written;
+
+  va_start(args, fmt);
+  written = vsnprintf(*length < size ? &buf[*length] : NULL,
+                      *length < size ? size - *length : 0, fmt, args);
+  va_end(args);
+
+  if (written > 0) {
+    *length += (size_t)written;
+  }
+}
+
+static void dump_histogram(
+    const struct ulorawan_latency_histogram *const histogram,
+    const char *const from, const char *const to, char *const buf,
+    size_t size, size_t *const length) {
+  append(buf, size, length, "%s>%s n=%lu mean=%lu max=%lu ", from, to,
+         (unsigned long)histogram->count,
+         (unsigned long)(histogram->count != 0
+                             ? histogram->total / histogram->count
+                             : 0),
+         (unsigned long)histogram->max);
+
+  for (uint8_t i = 0; i < ULORAWAN_LATENCY_BUCKETS; i++) {
+    append(buf, size, length, i == 0 ? "%u" : ",%u", histogram->buckets[i]);
+  }
+
+  append(buf, size, length, "\n");
+}
+
+void ulorawan_latency_reset(struct ulorawan_latency *const latency) {
+  memset(latency, 0, sizeof(struct ulorawan_latency));
+  latency->last = timer_hal_get_time();
+}
+
+void ulorawan_latency_enqueue(struct ulorawan_event *const event) {
+  event->time = timer_hal_get_time();
+}
+
+void ulorawan_latency_dequeue(struct ulorawan_latency *const latency,
+                              const struct ulorawan_event *const event) {
+  uint32_t waited = timer_hal_get_time() - event->time;
+
+  add(event->type == EVENT_TYPE_RADIO_IRQ ? &latency->radio_queue
+                                          : &latency->timer_queue,
+      waited);
+}
+
+void ulorawan_latency_step(struct ulorawan_latency *const latency,
+                           enum ulorawan_state from, enum ulorawan_state to) {
+  uint32_t now = timer_hal_get_time();
+  uint32_t elapsed = now - latency->last;
+  struct ulorawan_latency_step *step = NULL;
+
+  latency->last = now;
+
+  for (uint8_t i = 0; i < latency->count; i++) {
+    if (latency->steps[i].from == from && latency->steps[i].to == to) {
+      step = &latency->steps[i];
+      break;
+    }
+  }
+
+  if (step == NULL) {
+    if (latency->count == ULORAWAN_LATENCY_MAX_STEPS) {
+      latency->overflow++;
+      return;
+    }
+
+    step = &latency->steps[latency->count++];
+    step->from = (uint8_t)from;
+    step->to = (uint8_t)to;
+  }
+
+  add(&step->histogram, elapsed);
+}
+
+const struct ulorawan_latency_histogram *
+ulorawan_latency_find(const struct ulorawan_latency *const latency,
+                      enum ulorawan_state from, enum ulorawan_state to) {
+  for (uint8_t i = 0; i < latency->count; i++) {
+    if (latency->steps[i].from == from && latency->steps[i].to == to) {
+      return &latency->steps[i].histogram;
+    }
+  }
+
+  return NULL;
+}
+
+uint32_t ulorawan_latency_percentile(
+    const struct ulorawan_latency_histogram *const histogram, uint8_t percent) {
+  // The rank of the sample at the percentile, rounded up
+  uint32_t rank =
+      (uint32_t)(((uint64_t)histogram->count * percent + 99U) / 100U);
+  uint32_t seen = 0;
+
+  if (histogram->count == 0) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < ULORAWAN_LATENCY_BUCKETS - 1; i++) {
+    seen += histogram->buckets[i];
+    if (seen >= rank) {
+      uint32_t upper = (1UL << i) - 1U;
+
+      return upper < histogram->max ? upper : histogram->max;
+    }
+  }
+
+  return histogram->max;
+}
+
+size_t ulorawan_latency_dump(const struct ulorawan_latency *const latency,
+                             char *const buf, size_t size) {
+  size_t length = 0;
+
+  if (size != 0) {
+    buf[0] = '\0';
+  }
+
+  for (uint8_t i = 0; i < latency->count; i++) {
+    dump_histogram(&latency->steps[i].histogram,
+                   state_name(latency->steps[i].from),
+                   state_name(latency->steps[i].to), buf, size, &length);
+  }
+
+  dump_histogram(&latency->radio_queue, "QUEUE", "RADIO", buf, size, &length);
+  dump_histogram(&latency->timer_queue, "QUEUE", "TIMER", buf, size, &length);
+
+  if (latency->overflow != 0) {
+    append(buf, size, &length, "OVERFLOW n=%lu\n",
+           (unsigned long)latency->overflow);
+  }
+
+  return length;
+}
+
+#endif // ULORAWAN_LATENCY_ENABLED
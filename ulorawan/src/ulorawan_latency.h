@@ -0,0 +1,128 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan state machine latency instrumentation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_LATENCY_H_
+#define ULORAWAN_LATENCY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "radio_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_events.h"
+#include "ulorawan_session.h"
+
+/**
+ * \brief Clear the histograms and start timing the steps from now.
+ *
+ * \param[in] latency The latency instrumentation.
+ */
+void ulorawan_latency_reset(struct ulorawan_latency *const latency);
+
+/**
+ * \brief Stamp an event with the time it is queued.
+ *
+ * \param[in] event The event.
+ */
+void ulorawan_latency_enqueue(struct ulorawan_event *const event);
+
+/**
+ * \brief Record the time an event waited in the queue.
+ *
+ * \param[in] latency The latency instrumentation.
+ * \param[in] event The event taken from the queue.
+ */
+void ulorawan_latency_dequeue(struct ulorawan_latency *const latency,
+                              const struct ulorawan_event *const event);
+
+/**
+ * \brief Record the time since the previous step of the state machine.
+ *
+ * A step is an event handled, whether or not it changed the state, or a
+ * change of state made by the task, such as an uplink starting.
+ *
+ * \param[in] latency The latency instrumentation.
+ * \param[in] from The state before the step.
+ * \param[in] to The state after the step.
+ */
+void ulorawan_latency_step(struct ulorawan_latency *const latency,
+                           enum ulorawan_state from, enum ulorawan_state to);
+
+/**
+ * \brief Find the histogram of a step of the state machine.
+ *
+ * \param[in] latency The latency instrumentation.
+ * \param[in] from The state before the step.
+ * \param[in] to The state after the step.
+ *
+ * \return The histogram, NULL when the step has not been seen.
+ */
+const struct ulorawan_latency_histogram *
+ulorawan_latency_find(const struct ulorawan_latency *const latency,
+                      enum ulorawan_state from, enum ulorawan_state to);
+
+/**
+ * \brief Get an upper bound of a percentile of a histogram.
+ *
+ * \param[in] histogram The histogram.
+ * \param[in] percent The percentile, 1 to 100.
+ *
+ * \return The upper bound in milliseconds of the bucket holding the
+ * percentile, the longest sample for the last bucket, zero when empty.
+ */
+uint32_t ulorawan_latency_percentile(
+    const struct ulorawan_latency_histogram *const histogram, uint8_t percent);
+
+/**
+ * \brief Write the histograms as text, one line per histogram.
+ *
+ * Each line holds the name, the count, the mean, the longest sample and the
+ * bucket counts, for example "TX>RX1 n=4 mean=1490 max=1502 0,...,4,0".
+ *
+ * \param[in] latency The latency instrumentation.
+ * \param[out] buf The text, truncated to the buffer.
+ * \param[in] size The buffer size.
+ *
+ * \return The length of the full text.
+ */
+size_t ulorawan_latency_dump(const struct ulorawan_latency *const latency,
+                             char *const buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_LATENCY_H_ */
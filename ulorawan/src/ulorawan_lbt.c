@@ -0,0 +1,156 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan listen before talk function implementations
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdint.h>
+
+#include "log_hal.h"
+#include "radio_hal.h"
+#include "rand_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_energy.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_lbt.h"
+#include "ulorawan_region.h"
+#include "ulorawan_session.h"
+#include "ulorawan_tx.h"
+
+#ifdef ULORAWAN_LBT_ENABLED
+
+static int32_t ulorawan_lbt_cad(struct ulorawan_session *const session);
+
+static int32_t ulorawan_lbt_backoff(struct ulorawan_session *const session);
+
+static void ulorawan_lbt_stop(struct ulorawan_session *const session);
+
+int32_t ulorawan_lbt_start(struct ulorawan_session *const session) {
+  session->lbt.start = timer_hal_get_time();
+  session->lbt.attempts = 0;
+
+  return ulorawan_lbt_cad(session);
+}
+
+int32_t ulorawan_lbt_cad_done(struct ulorawan_session *const session,
+                              enum radio_hal_irq_flags flags) {
+  if (!(flags & RADIO_HAL_IRQ_CAD_DETECTED)) {
+    log_hal_log_debug("CAD channel clear");
+    ulorawan_lbt_stop(session);
+    return ulorawan_tx_transmit(session);
+  }
+
+  log_hal_log_debug("CAD channel busy [%u]", session->channel.frequency);
+  session->lbt.stats.cad_hits++;
+
+  if (++session->lbt.attempts >= ULORAWAN_LBT_MAX_ATTEMPTS) {
+    log_hal_log_error("No clear channel found");
+    session->lbt.stats.failures++;
+    ulorawan_lbt_stop(session);
+    session->state = ULORAWAN_STATE_IDLE;
+    return ULORAWAN_ERR_NO_CHANNEL;
+  }
+
+  struct ulorawan_channel channel;
+
+  if (ulorawan_region_get_channel(&session->region_params, &channel) ==
+          ULORAWAN_REGION_ERR_NONE &&
+      channel.frequency != session->channel.frequency) {
+    session->lbt.stats.channel_changes++;
+    session->channel = channel;
+
+    if (radio_hal_set_frequency(channel.frequency) != RADIO_HAL_ERR_NONE) {
+      session->state = ULORAWAN_STATE_FAULT;
+      return ULORAWAN_ERR_RADIO;
+    }
+
+    return ulorawan_lbt_cad(session);
+  }
+
+  return ulorawan_lbt_backoff(session);
+}
+
+int32_t ulorawan_lbt_backoff_expired(struct ulorawan_session *const session) {
+  log_hal_log_debug("CAD backoff expired");
+
+  return ulorawan_lbt_cad(session);
+}
+
+int32_t ulorawan_lbt_cad(struct ulorawan_session *const session) {
+  log_hal_log_info("Set radio mode RX CAD");
+  if (radio_hal_set_mode(MODE_RX_CAD) != RADIO_HAL_ERR_NONE) {
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  ULORAWAN_ENERGY_MODE(session, MODE_RX_CAD);
+
+  session->lbt.stats.cad_count++;
+  session->state = ULORAWAN_STATE_CAD;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_lbt_backoff(struct ulorawan_session *const session) {
+  uint32_t value;
+
+  if (rand_hal_get_random(&value) != RAND_HAL_ERR_NONE) {
+    value = 0;
+  }
+
+  uint32_t backoff =
+      ULORAWAN_LBT_BACKOFF_MIN +
+      (value % (ULORAWAN_LBT_BACKOFF_MAX - ULORAWAN_LBT_BACKOFF_MIN + 1));
+
+  log_hal_log_debug("CAD backoff [%u]", backoff);
+
+  if (radio_hal_set_mode(MODE_STDBY) != RADIO_HAL_ERR_NONE) {
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  ULORAWAN_ENERGY_MODE(session, MODE_STDBY);
+
+  if (timer_hal_start(TIMER0, backoff) != TIMER_HAL_ERR_NONE) {
+    log_hal_log_error("Failed to start TIMER0");
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_TIMER;
+  }
+
+  session->lbt.stats.backoffs++;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+void ulorawan_lbt_stop(struct ulorawan_session *const session) {
+  session->lbt.stats.time_spent += timer_hal_get_time() - session->lbt.start;
+}
+
+#endif // ULORAWAN_LBT_ENABLED
@@ -0,0 +1,109 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan listen before talk prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ULORAWAN_LBT_H_
+#define ULORAWAN_LBT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "radio_hal.h"
+#include "ulorawan_session.h"
+
+//! The maximum number of channel activity detections before an uplink is
+//! abandoned
+#ifndef ULORAWAN_LBT_MAX_ATTEMPTS
+#define ULORAWAN_LBT_MAX_ATTEMPTS 8
+#endif
+
+//! The minimum random backoff in milliseconds after activity is detected
+#ifndef ULORAWAN_LBT_BACKOFF_MIN
+#define ULORAWAN_LBT_BACKOFF_MIN 10
+#endif
+
+//! The maximum random backoff in milliseconds after activity is detected
+#ifndef ULORAWAN_LBT_BACKOFF_MAX
+#define ULORAWAN_LBT_BACKOFF_MAX 100
+#endif
+
+/**
+ * \brief Start listen before talk for the pending uplink.
+ *
+ * Channel activity detection is started on the session channel. The uplink
+ * is transmitted once a channel is found to be clear.
+ *
+ * \param[in] session The session with a pending uplink.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO The radio mode could not be set.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_lbt_start(struct ulorawan_session *const session);
+
+/**
+ * \brief Handle the completion of a channel activity detection.
+ *
+ * A clear channel transmits the pending uplink. A busy channel re-picks a
+ * channel, or when no other channel is available applies a random backoff.
+ *
+ * \param[in] session The session with a pending uplink.
+ * \param[in] flags The radio irq flags.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NO_CHANNEL No clear channel found, uplink abandoned.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_TIMER The backoff timer could not be started.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_lbt_cad_done(struct ulorawan_session *const session,
+                              enum radio_hal_irq_flags flags);
+
+/**
+ * \brief Handle the expiry of a listen before talk backoff.
+ *
+ * \param[in] session The session with a pending uplink.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO The radio mode could not be set.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_lbt_backoff_expired(struct ulorawan_session *const session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_LBT_H_ */
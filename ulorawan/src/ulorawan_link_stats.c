@@ -0,0 +1,146 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan link quality statistics implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ulorawan_link_stats.h"
+
+//! The lowest margin a DevStatusAns can carry
+#define MARGIN_MIN -32
+//! The highest margin a DevStatusAns can carry
+#define MARGIN_MAX 31
+
+static uint8_t wrap(uint8_t position) {
+  return position % ULORAWAN_LINK_STATS_DEPTH;
+}
+
+// Add a sample at the window head, the minimum queue keeps the positions of
+// samples that can still become the minimum in increasing sample order so
+// the front is always the minimum
+static void series_add(struct ulorawan_link_series *const series, uint8_t head,
+                       bool full, int16_t sample) {
+  if (full) {
+    int16_t oldest = series->samples[head];
+
+    series->sum -= oldest;
+    series->sum_sq -= (uint32_t)(oldest * oldest);
+
+    if (series->min_count > 0 && series->min_queue[series->min_first] == head) {
+      series->min_first = wrap(series->min_first + 1);
+      series->min_count--;
+    }
+  }
+
+  while (series->min_count > 0 &&
+         series->samples[series->min_queue[wrap(series->min_first +
+                                                series->min_count - 1)]] >=
+             sample) {
+    series->min_count--;
+  }
+
+  series->min_queue[wrap(series->min_first + series->min_count)] = head;
+  series->min_count++;
+
+  series->samples[head] = sample;
+  series->sum += sample;
+  series->sum_sq += (uint32_t)(sample * sample);
+}
+
+void ulorawan_link_stats_add(struct ulorawan_link_stats *const stats,
+                             int16_t rssi, int8_t snr) {
+  bool full = stats->count == ULORAWAN_LINK_STATS_DEPTH;
+
+  series_add(&stats->rssi, stats->head, full, rssi);
+  series_add(&stats->snr, stats->head, full, snr);
+
+  stats->head = wrap(stats->head + 1);
+  stats->last_snr = snr;
+
+  if (!full) {
+    stats->count++;
+  }
+}
+
+uint8_t ulorawan_link_stats_count(const struct ulorawan_link_stats *const stats) {
+  return stats->count;
+}
+
+int16_t ulorawan_link_stats_mean(const struct ulorawan_link_stats *const stats,
+                                 const struct ulorawan_link_series *const series) {
+  if (stats->count == 0) {
+    return 0;
+  }
+
+  return (int16_t)(series->sum / stats->count);
+}
+
+int16_t ulorawan_link_stats_min(const struct ulorawan_link_stats *const stats,
+                                const struct ulorawan_link_series *const series) {
+  if (stats->count == 0) {
+    return 0;
+  }
+
+  return series->samples[series->min_queue[series->min_first]];
+}
+
+uint32_t
+ulorawan_link_stats_variance(const struct ulorawan_link_stats *const stats,
+                             const struct ulorawan_link_series *const series) {
+  if (stats->count == 0) {
+    return 0;
+  }
+
+  // n * sum(x^2) - sum(x)^2 is never negative and keeps the division last
+  int64_t spread = (int64_t)stats->count * series->sum_sq -
+                   (int64_t)series->sum * series->sum;
+
+  return (uint32_t)(spread / ((int64_t)stats->count * stats->count));
+}
+
+int8_t ulorawan_link_stats_margin(const struct ulorawan_link_stats *const stats) {
+  if (stats->last_snr < MARGIN_MIN) {
+    return MARGIN_MIN;
+  }
+
+  if (stats->last_snr > MARGIN_MAX) {
+    return MARGIN_MAX;
+  }
+
+  return stats->last_snr;
+}
+
+void ulorawan_link_stats_link_check(struct ulorawan_link_stats *const stats,
+                                    uint8_t margin, uint8_t gw_cnt) {
+  stats->link_margin = margin;
+  stats->link_gw_cnt = gw_cnt;
+}
@@ -0,0 +1,121 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan link quality statistics prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_LINK_STATS_H_
+#define ULORAWAN_LINK_STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+/**
+ * \brief Add the signal metrics of a downlink, replacing the oldest sample
+ * once the window is full.
+ *
+ * \param[in] stats The link statistics.
+ * \param[in] rssi The received signal strength in dBm.
+ * \param[in] snr The signal to noise ratio in dB.
+ */
+void ulorawan_link_stats_add(struct ulorawan_link_stats *const stats,
+                             int16_t rssi, int8_t snr);
+
+/**
+ * \brief Get the number of samples in the window.
+ *
+ * \param[in] stats The link statistics.
+ *
+ * \return The number of samples.
+ */
+uint8_t ulorawan_link_stats_count(const struct ulorawan_link_stats *const stats);
+
+/**
+ * \brief Get the mean of a series over the window.
+ *
+ * \param[in] stats The link statistics.
+ * \param[in] series The series of the link statistics.
+ *
+ * \return The mean rounded towards zero, zero when the window is empty.
+ */
+int16_t ulorawan_link_stats_mean(const struct ulorawan_link_stats *const stats,
+                                 const struct ulorawan_link_series *const series);
+
+/**
+ * \brief Get the minimum of a series over the window.
+ *
+ * \param[in] stats The link statistics.
+ * \param[in] series The series of the link statistics.
+ *
+ * \return The minimum, zero when the window is empty.
+ */
+int16_t ulorawan_link_stats_min(const struct ulorawan_link_stats *const stats,
+                                const struct ulorawan_link_series *const series);
+
+/**
+ * \brief Get the population variance of a series over the window.
+ *
+ * \param[in] stats The link statistics.
+ * \param[in] series The series of the link statistics.
+ *
+ * \return The variance, zero when the window is empty.
+ */
+uint32_t
+ulorawan_link_stats_variance(const struct ulorawan_link_stats *const stats,
+                             const struct ulorawan_link_series *const series);
+
+/**
+ * \brief Get the DevStatusAns margin from the last downlink.
+ *
+ * \param[in] stats The link statistics.
+ *
+ * \return The signal to noise ratio of the last downlink clamped to -32..31.
+ */
+int8_t ulorawan_link_stats_margin(const struct ulorawan_link_stats *const stats);
+
+/**
+ * \brief Record the result of a LinkCheckAns.
+ *
+ * \param[in] stats The link statistics.
+ * \param[in] margin The demodulation margin in dB.
+ * \param[in] gw_cnt The number of gateways that received the LinkCheckReq.
+ */
+void ulorawan_link_stats_link_check(struct ulorawan_link_stats *const stats,
+                                    uint8_t margin, uint8_t gw_cnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_LINK_STATS_H_ */
@@ -0,0 +1,109 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan multicast implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "ulorawan_error_codes.h"
+#include "ulorawan_multicast.h"
+
+// The position of the address in the ordered groups, or where it belongs
+static uint8_t search(const struct ulorawan_multicast *const multicast,
+                      uint32_t dev_addr) {
+  uint8_t low = 0;
+  uint8_t high = multicast->count;
+
+  while (low < high) {
+    uint8_t mid = (uint8_t)((low + high) / 2);
+
+    if (multicast->groups[mid].keys.dev_addr < dev_addr) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+int32_t
+ulorawan_multicast_add(struct ulorawan_multicast *const multicast,
+                       const struct ulorawan_multicast_group *const group) {
+  uint8_t index = search(multicast, group->keys.dev_addr);
+
+  if (index < multicast->count &&
+      multicast->groups[index].keys.dev_addr == group->keys.dev_addr) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  if (multicast->count == ULORAWAN_MULTICAST_MAX_GROUPS) {
+    return ULORAWAN_ERR_FULL;
+  }
+
+  memmove(&multicast->groups[index + 1], &multicast->groups[index],
+          (multicast->count - index) * sizeof(multicast->groups[0]));
+  multicast->groups[index] = *group;
+  // A class B group has no ping slot until the next beacon period
+  multicast->groups[index].ping_offset = UINT16_MAX;
+  multicast->count++;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_multicast_remove(struct ulorawan_multicast *const multicast,
+                                  uint32_t dev_addr) {
+  uint8_t index = search(multicast, dev_addr);
+
+  if (index == multicast->count ||
+      multicast->groups[index].keys.dev_addr != dev_addr) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  multicast->count--;
+  memmove(&multicast->groups[index], &multicast->groups[index + 1],
+          (multicast->count - index) * sizeof(multicast->groups[0]));
+
+  return ULORAWAN_ERR_NONE;
+}
+
+struct ulorawan_multicast_group *
+ulorawan_multicast_find(struct ulorawan_multicast *const multicast,
+                        uint32_t dev_addr) {
+  uint8_t index = search(multicast, dev_addr);
+
+  if (index == multicast->count ||
+      multicast->groups[index].keys.dev_addr != dev_addr) {
+    return NULL;
+  }
+
+  return &multicast->groups[index];
+}
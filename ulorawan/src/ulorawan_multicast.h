@@ -0,0 +1,88 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan multicast prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_MULTICAST_H_
+#define ULORAWAN_MULTICAST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+/**
+ * \brief Add a multicast group.
+ *
+ * \param[in] multicast The multicast groups.
+ * \param[in] group The group.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_PARAMS The group address is already in use.
+ * \retval ULORAWAN_ERR_FULL No more groups can be added.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t
+ulorawan_multicast_add(struct ulorawan_multicast *const multicast,
+                       const struct ulorawan_multicast_group *const group);
+
+/**
+ * \brief Remove a multicast group.
+ *
+ * \param[in] multicast The multicast groups.
+ * \param[in] dev_addr The group address.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_PARAMS No group has the address.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_multicast_remove(struct ulorawan_multicast *const multicast,
+                                  uint32_t dev_addr);
+
+/**
+ * \brief Find a multicast group by address.
+ *
+ * \param[in] multicast The multicast groups.
+ * \param[in] dev_addr The group address.
+ *
+ * \return The group, NULL when no group has the address.
+ */
+struct ulorawan_multicast_group *
+ulorawan_multicast_find(struct ulorawan_multicast *const multicast,
+                        uint32_t dev_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_MULTICAST_H_ */
@@ -0,0 +1,130 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink retransmission implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+
+#include "log_hal.h"
+#include "rand_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_retrans.h"
+
+// The ACK_TIMEOUT with a random deviation of up to ACK_TIMEOUT_RND either
+// way, so devices that lost the same downlink do not retransmit together
+static uint32_t backoff() {
+  uint32_t value;
+
+  if (rand_hal_get_random(&value) != RAND_HAL_ERR_NONE) {
+    value = ULORAWAN_RETRANS_ACK_TIMEOUT_RND;
+  }
+
+  return ULORAWAN_RETRANS_ACK_TIMEOUT - ULORAWAN_RETRANS_ACK_TIMEOUT_RND +
+         value % (2 * ULORAWAN_RETRANS_ACK_TIMEOUT_RND + 1);
+}
+
+static void complete(struct ulorawan_session *const session, uint32_t now) {
+  struct ulorawan_retrans *retrans = &session->retrans;
+  struct ulorawan_retrans_stats *stats = &retrans->stats;
+  uint32_t latency = now - retrans->first;
+
+  stats->last_attempts = retrans->attempts;
+  stats->last_latency = latency;
+
+  if (!retrans->confirm) {
+    stats->unconfirmed++;
+  } else if (retrans->acked) {
+    stats->acked++;
+    stats->total_latency += latency;
+    if (latency > stats->max_latency) {
+      stats->max_latency = latency;
+    }
+    log_hal_log_info("Uplink acknowledged after [%u] attempts in [%u] ms",
+                     retrans->attempts, latency);
+  } else {
+    stats->unacked++;
+    log_hal_log_error("Uplink not acknowledged after [%u] attempts",
+                      retrans->attempts);
+  }
+
+  retrans->active = 0;
+}
+
+void ulorawan_retrans_start(struct ulorawan_session *const session,
+                            bool confirm, uint8_t dr, uint32_t now) {
+  struct ulorawan_retrans *retrans = &session->retrans;
+  uint8_t nb_trans = session->adr.nb_trans;
+
+  if (confirm && nb_trans < ULORAWAN_RETRANS_CONFIRMED_NB_TRANS) {
+    nb_trans = ULORAWAN_RETRANS_CONFIRMED_NB_TRANS;
+  }
+
+  retrans->active = 1;
+  retrans->confirm = confirm;
+  retrans->acked = 0;
+  retrans->dr = dr;
+  retrans->attempts = 1;
+  retrans->max_attempts = nb_trans != 0 ? nb_trans : 1;
+  retrans->first = now;
+  retrans->next = now;
+}
+
+void ulorawan_retrans_ack(struct ulorawan_session *const session) {
+  if (session->retrans.active && session->retrans.confirm) {
+    session->retrans.acked = 1;
+  }
+}
+
+void ulorawan_retrans_rx_done(struct ulorawan_session *const session,
+                              bool downlink) {
+  struct ulorawan_retrans *retrans = &session->retrans;
+
+  if (!retrans->active) {
+    return;
+  }
+
+  uint32_t now = timer_hal_get_time();
+
+  if (retrans->acked || (downlink && !retrans->confirm) ||
+      retrans->attempts >= retrans->max_attempts) {
+    complete(session, now);
+    return;
+  }
+
+  retrans->next = now + backoff();
+
+  log_hal_log_debug("Uplink retransmission [%u] due in [%u] ms",
+                    retrans->attempts + 1, retrans->next - now);
+}
+
+void ulorawan_retrans_attempt(struct ulorawan_session *const session) {
+  session->retrans.attempts++;
+  session->retrans.stats.retransmissions++;
+}
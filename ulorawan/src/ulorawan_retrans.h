@@ -0,0 +1,106 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink retransmission prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_RETRANS_H_
+#define ULORAWAN_RETRANS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+//! The number of transmissions of a confirmed uplink without an
+//! acknowledgement before it is given up, unless NbTrans is higher
+#ifndef ULORAWAN_RETRANS_CONFIRMED_NB_TRANS
+#define ULORAWAN_RETRANS_CONFIRMED_NB_TRANS 8
+#endif
+
+//! The delay in milliseconds after the receive windows close before an
+//! uplink is transmitted again (ACK_TIMEOUT)
+#ifndef ULORAWAN_RETRANS_ACK_TIMEOUT
+#define ULORAWAN_RETRANS_ACK_TIMEOUT 2000
+#endif
+
+//! The largest random deviation in milliseconds from the ACK_TIMEOUT
+#ifndef ULORAWAN_RETRANS_ACK_TIMEOUT_RND
+#define ULORAWAN_RETRANS_ACK_TIMEOUT_RND 1000
+#endif
+
+/**
+ * \brief Start tracking the transmissions of a new uplink.
+ *
+ * \param[in] session The session.
+ * \param[in] confirm True for a confirmed uplink.
+ * \param[in] dr The data rate of the uplink.
+ * \param[in] now The current time in milliseconds.
+ */
+void ulorawan_retrans_start(struct ulorawan_session *const session,
+                            bool confirm, uint8_t dr, uint32_t now);
+
+/**
+ * \brief Record the acknowledgement of the pending uplink.
+ *
+ * \param[in] session The session.
+ */
+void ulorawan_retrans_ack(struct ulorawan_session *const session);
+
+/**
+ * \brief Decide whether the pending uplink is transmitted again once its
+ * receive windows have closed.
+ *
+ * The uplink completes when it was acknowledged, when a downlink was
+ * received for an unconfirmed uplink or when its transmissions are used
+ * up. Otherwise the next transmission is due after the randomised
+ * ACK_TIMEOUT.
+ *
+ * \param[in] session The session.
+ * \param[in] downlink True when a valid downlink was received.
+ */
+void ulorawan_retrans_rx_done(struct ulorawan_session *const session,
+                              bool downlink);
+
+/**
+ * \brief Record the next transmission of the pending uplink.
+ *
+ * \param[in] session The session.
+ */
+void ulorawan_retrans_attempt(struct ulorawan_session *const session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_RETRANS_H_ */
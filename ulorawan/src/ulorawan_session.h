@@ -54,6 +54,14 @@ enum ulorawan_state {
   ULORAWAN_STATE_RX1,
   //! The ulorawan stack is in second receive window state
   ULORAWAN_STATE_RX2,
+  //! The ulorawan stack is listening before talk
+  ULORAWAN_STATE_CAD,
+  //! The ulorawan stack is receiving continuously on RX2 (class C)
+  ULORAWAN_STATE_RXC,
+  //! The ulorawan stack is receiving a beacon (class B)
+  ULORAWAN_STATE_BEACON,
+  //! The ulorawan stack is receiving in a ping slot (class B)
+  ULORAWAN_STATE_PING,
   //! The ulorawan stack is a fault state
   ULORAWAN_STATE_FAULT
 };
@@ -68,6 +76,571 @@ enum ulorawan_device_class {
   DEVICE_CLASS_C
 };
 
+//! The listen before talk statistics
+struct ulorawan_lbt_stats {
+  //! The number of channel activity detections performed
+  uint32_t cad_count;
+  //! The number of channel activity detections that found activity
+  uint32_t cad_hits;
+  //! The number of times a different channel was picked
+  uint32_t channel_changes;
+  //! The number of random backoffs applied
+  uint32_t backoffs;
+  //! The number of uplinks abandoned after too many busy channels
+  uint32_t failures;
+  //! The total time in milliseconds spent listening before talk
+  uint32_t time_spent;
+};
+
+//! The listen before talk context
+struct ulorawan_lbt {
+  //! The time the current listen before talk started
+  uint32_t start;
+  //! The number of busy channels found for the current uplink
+  uint8_t attempts;
+  //! The listen before talk statistics
+  struct ulorawan_lbt_stats stats;
+};
+
+//! The keys and frame counters of an activated session
+struct ulorawan_session_keys {
+  //! The end-device address
+  uint32_t dev_addr;
+  //! The network session key
+  uint8_t nwk_s_key[ULORAWAN_NWK_S_KEY_SIZE];
+  //! The application session key
+  uint8_t app_s_key[ULORAWAN_APP_S_KEY_SIZE];
+  //! The uplink frame counter
+  uint32_t fcnt_up;
+  //! The downlink frame counter
+  uint32_t fcnt_down;
+};
+
+//! The number of multicast groups the device can belong to
+#ifndef ULORAWAN_MULTICAST_MAX_GROUPS
+#define ULORAWAN_MULTICAST_MAX_GROUPS 4
+#endif
+
+//! A multicast group
+struct ulorawan_multicast_group {
+  //! The group address, keys and downlink frame counter
+  struct ulorawan_session_keys keys;
+  //! The class the group is received in, class B or class C
+  enum ulorawan_device_class class;
+  //! The receive frequency in Hz, the RX2 frequency for a class C group
+  uint32_t frequency;
+  //! The receive data rate, the RX2 data rate for a class C group
+  uint8_t dr;
+  //! The class B ping slot periodicity
+  uint8_t periodicity;
+  //! The class B ping slot offset in the current beacon period, set by the
+  //! stack
+  uint16_t ping_offset;
+};
+
+//! The multicast groups
+struct ulorawan_multicast {
+  //! The groups ordered by address
+  struct ulorawan_multicast_group groups[ULORAWAN_MULTICAST_MAX_GROUPS];
+  //! The number of groups
+  uint8_t count;
+};
+
+//! The application payload of the last downlink
+struct ulorawan_downlink_data {
+  //! The address the downlink was sent to
+  uint32_t dev_addr;
+  //! Non zero when the downlink was sent to a multicast group
+  uint8_t multicast;
+  //! The frame port
+  uint8_t port;
+  //! The offset of the decrypted payload in the session frame
+  uint8_t offset;
+  //! The payload size, zero when the downlink carried no payload
+  uint8_t size;
+};
+
+//! The largest number of fragments in a fragmented data block
+#ifndef ULORAWAN_FRAG_MAX_NB
+#define ULORAWAN_FRAG_MAX_NB 512
+#endif
+
+//! The largest fragment size
+#ifndef ULORAWAN_FRAG_MAX_SIZE
+#define ULORAWAN_FRAG_MAX_SIZE 232
+#endif
+
+//! The largest number of lost fragments forward error correction recovers
+#ifndef ULORAWAN_FRAG_MAX_LOST
+#define ULORAWAN_FRAG_MAX_LOST 64
+#endif
+
+//! The number of 32 bit words holding a bit vector
+#define ULORAWAN_FRAG_WORDS(bits) (((bits) + 31U) / 32U)
+
+//! The fragmentation counters
+struct ulorawan_frag_stats {
+  //! The number of fragments received, uncoded and coded
+  uint32_t received;
+  //! The number of fragments that carried no new information
+  uint32_t redundant;
+  //! The number of lost fragments recovered by forward error correction
+  uint32_t recovered;
+};
+
+//! The fragmented data block receiver
+struct ulorawan_frag {
+  //! Non zero when a fragmentation session is set up
+  uint8_t active;
+  //! Non zero once the data block is reassembled
+  uint8_t complete;
+  //! Non zero when more fragments were lost than can be recovered
+  uint8_t overflow;
+  //! The multicast groups the session is sent to
+  uint8_t mc_group_mask;
+  //! The number of uncoded fragments in the data block
+  uint16_t nb_frag;
+  //! The fragment size
+  uint8_t frag_size;
+  //! The padding bytes at the end of the last fragment
+  uint8_t padding;
+  //! The data block descriptor
+  uint32_t descriptor;
+  //! The number of fragments received in the session
+  uint16_t fragments;
+  //! The number of uncoded fragments received before the coded ones
+  uint16_t received;
+  //! The number of lost fragments, zero until coded fragments arrive
+  uint16_t lost;
+  //! The number of reduced rows stored
+  uint16_t rows;
+  //! The fragments missing when the coded fragments started
+  uint32_t missing[ULORAWAN_FRAG_WORDS(ULORAWAN_FRAG_MAX_NB)];
+  //! The parity line of the current coded fragment
+  uint32_t line[ULORAWAN_FRAG_WORDS(ULORAWAN_FRAG_MAX_NB)];
+  //! The reduced rows over the lost fragments, indexed by their first bit
+  uint32_t matrix[ULORAWAN_FRAG_MAX_LOST]
+                 [ULORAWAN_FRAG_WORDS(ULORAWAN_FRAG_MAX_LOST)];
+  //! The fragment numbers of the lost fragments in ascending order
+  uint16_t lost_index[ULORAWAN_FRAG_MAX_LOST];
+  //! The data of the row being reduced
+  uint32_t data[ULORAWAN_FRAG_WORDS(ULORAWAN_FRAG_MAX_SIZE * 8)];
+  //! The data read back from non volatile memory
+  uint32_t scratch[ULORAWAN_FRAG_WORDS(ULORAWAN_FRAG_MAX_SIZE * 8)];
+  //! The fragmentation counters
+  struct ulorawan_frag_stats stats;
+};
+
+//! The number of keys the session store holds
+#ifndef ULORAWAN_STORE_MAX_KEYS
+#define ULORAWAN_STORE_MAX_KEYS 8
+#endif
+
+//! The size of the buffer coalescing session store writes
+#ifndef ULORAWAN_STORE_BUF_SIZE
+#define ULORAWAN_STORE_BUF_SIZE 64
+#endif
+
+//! The session store counters
+struct ulorawan_store_stats {
+  //! The number of records written
+  uint32_t records;
+  //! The number of bytes written
+  uint32_t bytes;
+  //! The number of writes merged into a record not yet written
+  uint32_t coalesced;
+  //! The number of writes skipped because the value was already stored
+  uint32_t unchanged;
+  //! The number of times the records were compacted into a new sector
+  uint32_t compactions;
+  //! The number of sectors erased
+  uint32_t erases;
+};
+
+//! The log structured session store
+struct ulorawan_store {
+  //! Non zero once the store is mounted
+  uint8_t mounted;
+  //! The sector records are appended to
+  uint8_t sector;
+  //! The sequence number of the sector, the highest is the latest
+  uint32_t sequence;
+  //! The offset in the sector of the next record
+  uint16_t offset;
+  //! The offset of the latest record of each key, zero when there is none
+  uint16_t index[ULORAWAN_STORE_MAX_KEYS];
+  //! The records waiting to be written
+  uint8_t staged[ULORAWAN_STORE_BUF_SIZE];
+  //! The size of the records waiting to be written
+  uint8_t staged_size;
+  //! The session store counters
+  struct ulorawan_store_stats stats;
+};
+
+//! The number of uplink frame counters reserved with each write
+#ifndef ULORAWAN_FCNT_RESERVE
+#define ULORAWAN_FCNT_RESERVE 100
+#endif
+
+//! The frame counter reservation counters
+struct ulorawan_fcnt_stats {
+  //! The number of reservations written
+  uint32_t reservations;
+  //! The number of uplinks sent within a reservation without a write
+  uint32_t saved;
+};
+
+//! The uplink frame counters persisted ahead of use
+struct ulorawan_fcnt {
+  //! The first uplink frame counter not covered by the stored reservation
+  uint32_t reserved;
+  //! The number of frame counters reserved with each write
+  uint16_t block;
+  //! The frame counter reservation counters
+  struct ulorawan_fcnt_stats stats;
+};
+
+//! The largest size of the MAC command answers to one downlink, answers that
+//! do not fit in FOpts are sent on port 0
+#ifndef ULORAWAN_CMDS_MAX_ANSWERS_SIZE
+#define ULORAWAN_CMDS_MAX_ANSWERS_SIZE 32
+#endif
+
+//! The MAC command context
+struct ulorawan_cmds {
+  //! The MAC command answers to send with the next uplink
+  uint8_t answers[ULORAWAN_CMDS_MAX_ANSWERS_SIZE];
+  //! The size of the MAC command answers
+  uint8_t answers_size;
+};
+
+//! The number of application messages the uplink queue holds
+#ifndef ULORAWAN_UPLINK_QUEUE_DEPTH
+#define ULORAWAN_UPLINK_QUEUE_DEPTH 4
+#endif
+
+//! The largest application payload the uplink queue accepts
+#ifndef ULORAWAN_UPLINK_MAX_PAYLOAD
+#define ULORAWAN_UPLINK_MAX_PAYLOAD 242
+#endif
+
+//! A queued application message
+struct ulorawan_uplink_msg {
+  //! The time in milliseconds after which the message is dropped
+  uint32_t expiry;
+  //! Non zero when the message has an expiry time
+  uint8_t expires;
+  //! Non zero for a confirmed uplink
+  uint8_t confirm;
+  //! The priority, higher values are sent first
+  uint8_t priority;
+  //! The application port
+  uint8_t port;
+  //! The payload size
+  uint8_t size;
+  //! The payload
+  uint8_t payload[ULORAWAN_UPLINK_MAX_PAYLOAD];
+};
+
+//! The uplink queue counters
+struct ulorawan_uplink_stats {
+  //! The number of messages queued
+  uint32_t queued;
+  //! The number of messages handed to the radio
+  uint32_t sent;
+  //! The number of messages dropped or refused because the queue was full
+  uint32_t dropped_full;
+  //! The number of messages dropped after their expiry time
+  uint32_t dropped_expired;
+  //! The number of messages dropped because no data rate could carry them
+  uint32_t dropped_size;
+  //! The highest number of messages queued at once
+  uint8_t high_water;
+};
+
+//! The bounded priority queue of application messages
+struct ulorawan_uplink_queue {
+  //! The message slots
+  struct ulorawan_uplink_msg msgs[ULORAWAN_UPLINK_QUEUE_DEPTH];
+  //! The slots in use, highest priority first and in order of arrival
+  uint8_t order[ULORAWAN_UPLINK_QUEUE_DEPTH];
+  //! The number of messages queued
+  uint8_t count;
+  //! The queue counters
+  struct ulorawan_uplink_stats stats;
+};
+
+//! The application records packed into one uplink
+struct ulorawan_aggregate {
+  //! The application port of the records, zero when aggregation is off
+  uint8_t port;
+  //! The packed size in bytes at which the records are sent
+  uint8_t threshold;
+  //! The longest time in milliseconds a record waits to be sent
+  uint32_t max_age;
+  //! The time in milliseconds the oldest pending record was added
+  uint32_t first;
+  //! The size of the packed records
+  uint8_t size;
+  //! The records, each prefixed with its length
+  uint8_t buf[ULORAWAN_UPLINK_MAX_PAYLOAD];
+  //! The number of pending records
+  uint8_t count;
+  //! The number of records sent
+  uint32_t records;
+  //! The number of uplinks the records were sent in
+  uint32_t flushes;
+};
+
+//! The number of recent downlinks kept for the link statistics
+#ifndef ULORAWAN_LINK_STATS_DEPTH
+#define ULORAWAN_LINK_STATS_DEPTH 16
+#endif
+
+//! A rolling window of signal metric samples
+struct ulorawan_link_series {
+  //! The samples, oldest first from the window head
+  int16_t samples[ULORAWAN_LINK_STATS_DEPTH];
+  //! The sum of the samples in the window
+  int32_t sum;
+  //! The sum of the squared samples in the window
+  uint32_t sum_sq;
+  //! The window positions of increasing samples, the front holds the minimum
+  uint8_t min_queue[ULORAWAN_LINK_STATS_DEPTH];
+  //! The position of the front of the minimum queue
+  uint8_t min_first;
+  //! The number of positions in the minimum queue
+  uint8_t min_count;
+};
+
+//! The link quality statistics
+struct ulorawan_link_stats {
+  //! The received signal strength of recent downlinks in dBm
+  struct ulorawan_link_series rssi;
+  //! The signal to noise ratio of recent downlinks in dB
+  struct ulorawan_link_series snr;
+  //! The window position the next sample is written to
+  uint8_t head;
+  //! The number of samples in the window
+  uint8_t count;
+  //! The signal to noise ratio of the last downlink in dB
+  int8_t last_snr;
+  //! The demodulation margin of the last LinkCheckAns in dB
+  uint8_t link_margin;
+  //! The gateway count of the last LinkCheckAns
+  uint8_t link_gw_cnt;
+};
+
+//! The retransmission counters
+struct ulorawan_retrans_stats {
+  //! The number of confirmed uplinks acknowledged by the network
+  uint32_t acked;
+  //! The number of confirmed uplinks given up without an acknowledgement
+  uint32_t unacked;
+  //! The number of unconfirmed uplinks completed
+  uint32_t unconfirmed;
+  //! The number of transmissions repeated
+  uint32_t retransmissions;
+  //! The number of transmissions of the last completed uplink
+  uint8_t last_attempts;
+  //! The time in milliseconds from the first transmission of the last
+  //! completed uplink until it completed
+  uint32_t last_latency;
+  //! The longest time in milliseconds a confirmed uplink took to be
+  //! acknowledged
+  uint32_t max_latency;
+  //! The total time in milliseconds confirmed uplinks took to be
+  //! acknowledged
+  uint32_t total_latency;
+};
+
+//! The retransmission context of the pending uplink
+struct ulorawan_retrans {
+  //! Non zero while the pending uplink may be transmitted again
+  uint8_t active;
+  //! Non zero for a confirmed uplink
+  uint8_t confirm;
+  //! Non zero once the network acknowledged the uplink
+  uint8_t acked;
+  //! The data rate of the uplink
+  uint8_t dr;
+  //! The number of transmissions so far
+  uint8_t attempts;
+  //! The maximum number of transmissions
+  uint8_t max_attempts;
+  //! The time in milliseconds of the first transmission
+  uint32_t first;
+  //! The time in milliseconds after which the next transmission is due
+  uint32_t next;
+  //! The retransmission counters
+  struct ulorawan_retrans_stats stats;
+};
+
+//! The class B beacon synchronisation status
+enum ulorawan_class_b_status {
+  //! Class B is not running
+  CLASS_B_OFF,
+  //! Listening for a first beacon
+  CLASS_B_ACQUIRING,
+  //! Following the beacons and opening ping slots
+  CLASS_B_TRACKING
+};
+
+//! The class B counters
+struct ulorawan_class_b_stats {
+  //! The number of beacons received
+  uint32_t beacons;
+  //! The number of beacons missed while tracking
+  uint32_t beacons_missed;
+  //! The number of beacon acquisitions that found no beacon
+  uint32_t acquisitions_failed;
+  //! The number of ping slots opened
+  uint32_t ping_slots;
+  //! The number of ping slots skipped because the radio was busy
+  uint32_t ping_slots_skipped;
+  //! The number of downlinks received in ping slots
+  uint32_t ping_downlinks;
+};
+
+//! The class B context
+struct ulorawan_class_b {
+  //! The beacon synchronisation status
+  enum ulorawan_class_b_status status;
+  //! The ping slot periodicity, 2^periodicity seconds between ping slots
+  uint8_t periodicity;
+  //! Non zero when the next scheduled window is a beacon
+  uint8_t beacon_next;
+  //! The number of beacons missed since the last one received
+  uint8_t missed;
+  //! The ping slot offset in the current beacon period
+  uint16_t ping_offset;
+  //! The slot of the next ping slot of the device or of a class B multicast
+  //! group in the current beacon period
+  uint16_t next_slot;
+  //! The data rate of the ping slots
+  uint8_t ping_dr;
+  //! The ping slot frequency in Hz
+  uint32_t ping_frequency;
+  //! The beacon frequency in Hz
+  uint32_t beacon_frequency;
+  //! The GPS time in seconds of the current beacon period
+  uint32_t beacon_time;
+  //! The time in milliseconds the last received beacon started
+  uint32_t last_beacon;
+  //! The measured beacon period in milliseconds of the local clock
+  uint32_t period;
+  //! The class B counters
+  struct ulorawan_class_b_stats stats;
+};
+
+//! The adaptive data rate context
+struct ulorawan_adr {
+  //! Non zero when the network may control the data rate and tx power
+  uint8_t enabled;
+  //! The number of uplinks since the last downlink (ADR_ACK_CNT)
+  uint16_t ack_cnt;
+  //! The number of transmissions of each unconfirmed uplink
+  uint8_t nb_trans;
+};
+
+//! The number of buckets of a latency histogram
+#ifndef ULORAWAN_LATENCY_BUCKETS
+#define ULORAWAN_LATENCY_BUCKETS 16
+#endif
+
+//! The number of state machine steps the latency is recorded for
+#ifndef ULORAWAN_LATENCY_MAX_STEPS
+#define ULORAWAN_LATENCY_MAX_STEPS 16
+#endif
+
+//! A log scale histogram of latencies in milliseconds
+struct ulorawan_latency_histogram {
+  //! The number of samples
+  uint32_t count;
+  //! The sum of the samples
+  uint32_t total;
+  //! The longest sample
+  uint32_t max;
+  //! Bucket 0 counts the samples under 1 ms, bucket n those from 2^(n-1) up
+  //! to 2^n ms and the last bucket everything longer
+  uint16_t buckets[ULORAWAN_LATENCY_BUCKETS];
+};
+
+//! The latency of a step of the state machine from one state to another
+struct ulorawan_latency_step {
+  //! The state before the step
+  uint8_t from;
+  //! The state after the step
+  uint8_t to;
+  //! The time since the previous step
+  struct ulorawan_latency_histogram histogram;
+};
+
+//! The state machine latency instrumentation
+struct ulorawan_latency {
+  //! The time of the last step
+  uint32_t last;
+  //! The number of steps recorded
+  uint8_t count;
+  //! The number of samples lost with every step in use
+  uint32_t overflow;
+  //! The steps, in the order first seen
+  struct ulorawan_latency_step steps[ULORAWAN_LATENCY_MAX_STEPS];
+  //! The time radio interrupts waited in the event queue
+  struct ulorawan_latency_histogram radio_queue;
+  //! The time timer expiries waited in the event queue
+  struct ulorawan_latency_histogram timer_queue;
+};
+
+//! The number of radio modes, one per RADIO_HAL_MODE
+#define ULORAWAN_ENERGY_MODES 8
+
+//! The kind of exchange the radio charge is accounted to
+enum ulorawan_energy_exchange {
+  //! No exchange in progress
+  ENERGY_EXCHANGE_NONE,
+  //! An uplink and its receive windows when they deliver no downlink
+  ENERGY_EXCHANGE_UPLINK,
+  //! A join request and the join accept windows
+  ENERGY_EXCHANGE_JOIN
+};
+
+//! The radio charge of a kind of message
+struct ulorawan_energy_account {
+  //! The number of messages
+  uint32_t count;
+  //! The total charge in microamp milliseconds
+  uint64_t charge;
+  //! The charge of the last message in microamp milliseconds
+  uint64_t last;
+};
+
+//! The radio energy meter
+struct ulorawan_energy {
+  //! The current drawn in each radio mode in microamps
+  uint32_t current[ULORAWAN_ENERGY_MODES];
+  //! The time in milliseconds spent in each radio mode
+  uint64_t time[ULORAWAN_ENERGY_MODES];
+  //! The total charge in microamp milliseconds
+  uint64_t charge;
+  //! The radio mode
+  uint8_t mode;
+  //! The time the radio mode was entered
+  uint32_t since;
+  //! The exchange in progress
+  enum ulorawan_energy_exchange exchange;
+  //! The total charge when the exchange started
+  uint64_t exchange_start;
+  //! The total charge when the exchange stopped transmitting
+  uint64_t exchange_rx;
+  //! The charge of uplinks, including receive windows without a downlink
+  struct ulorawan_energy_account uplink;
+  //! The charge of the receive windows that delivered a downlink
+  struct ulorawan_energy_account downlink;
+  //! The charge of joins
+  struct ulorawan_energy_account join;
+};
+
 //! The ulorawan session
 struct ulorawan_session {
   //! The last frame size
@@ -80,8 +653,52 @@ struct ulorawan_session {
   enum ulorawan_device_class class;
   //! The device security context
   struct ulorawan_device_security security;
+  //! The session keys and frame counters
+  struct ulorawan_session_keys keys;
+  //! The multicast groups
+  struct ulorawan_multicast multicast;
+  //! The application payload of the last downlink
+  struct ulorawan_downlink_data rx;
+  //! The fragmented data block receiver
+  struct ulorawan_frag frag;
+  //! The persistent session store
+  struct ulorawan_store store;
+  //! The uplink frame counter reservation
+  struct ulorawan_fcnt fcnt;
+  //! The MAC command context
+  struct ulorawan_cmds cmds;
+  //! The adaptive data rate context
+  struct ulorawan_adr adr;
+  //! The link quality statistics
+  struct ulorawan_link_stats link_stats;
   //! The region parameters
   struct ulorawan_region_params region_params;
+  //! The channel selected for the pending uplink
+  struct ulorawan_channel channel;
+  //! The application messages waiting to be sent
+  struct ulorawan_uplink_queue uplink_queue;
+  //! The application records waiting to be packed into an uplink
+  struct ulorawan_aggregate aggregate;
+  //! The pending uplink frame
+  struct ulorawan_mac_frame_context uplink;
+  //! The retransmission context of the pending uplink
+  struct ulorawan_retrans retrans;
+  //! The class B context
+  struct ulorawan_class_b class_b;
+  //! The time in milliseconds the pending uplink started transmitting
+  uint32_t tx_start;
+#ifdef ULORAWAN_LBT_ENABLED
+  //! The listen before talk context
+  struct ulorawan_lbt lbt;
+#endif // ULORAWAN_LBT_ENABLED
+#ifdef ULORAWAN_LATENCY_ENABLED
+  //! The state machine latency instrumentation
+  struct ulorawan_latency latency;
+#endif // ULORAWAN_LATENCY_ENABLED
+#ifdef ULORAWAN_ENERGY_ENABLED
+  //! The radio energy meter
+  struct ulorawan_energy energy;
+#endif // ULORAWAN_ENERGY_ENABLED
 };
 
 #ifdef __cplusplus
@@ -0,0 +1,179 @@
+/**
+ * \file
+ *
+ * \brief Warm boot session snapshot.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_snapshot.h"
+
+//! The magic number starting a snapshot
+#define SNAPSHOT_MAGIC 0x5355
+//! The size of the header, the magic number, version, region and body size
+#define HEADER_SIZE 6
+//! The size of the CRC ending the snapshot
+#define CRC_SIZE 4
+
+//! A session field stored in the snapshot
+struct field {
+  //! The offset of the field in the session
+  size_t offset;
+  //! The size of the field
+  size_t size;
+};
+
+#define FIELD(name)                                                            \
+  {                                                                            \
+    offsetof(struct ulorawan_session, name),                                   \
+        sizeof(((struct ulorawan_session *)0)->name)                           \
+  }
+
+static const struct field fields[] = {
+    FIELD(class), FIELD(keys), FIELD(multicast),     FIELD(cmds),
+    FIELD(adr),   FIELD(fcnt), FIELD(region_params),
+};
+
+static size_t body_size(void) {
+  size_t size = 0;
+
+  for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+    size += fields[i].size;
+  }
+
+  return size;
+}
+
+static uint32_t crc32(const uint8_t *const buf, size_t size) {
+  uint32_t crc = 0xFFFFFFFFUL;
+
+  for (size_t i = 0; i < size; i++) {
+    crc ^= buf[i];
+
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+    }
+  }
+
+  return ~crc;
+}
+
+static uint32_t max_u32(uint32_t a, uint32_t b) { return a > b ? a : b; }
+
+size_t ulorawan_snapshot_size(void) {
+  return HEADER_SIZE + body_size() + CRC_SIZE;
+}
+
+int32_t ulorawan_snapshot_save(const struct ulorawan_session *const session,
+                               uint8_t *const buf, size_t size) {
+  const uint8_t *src = (const uint8_t *)session;
+  size_t body = body_size();
+  size_t pos = HEADER_SIZE;
+  uint32_t crc;
+
+  if (size < ulorawan_snapshot_size()) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  buf[0] = (uint8_t)SNAPSHOT_MAGIC;
+  buf[1] = (uint8_t)(SNAPSHOT_MAGIC >> 8);
+  buf[2] = ULORAWAN_SNAPSHOT_VERSION;
+  buf[3] = (uint8_t)session->region_params.region;
+  buf[4] = (uint8_t)body;
+  buf[5] = (uint8_t)(body >> 8);
+
+  for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+    memcpy(&buf[pos], &src[fields[i].offset], fields[i].size);
+    pos += fields[i].size;
+  }
+
+  crc = crc32(buf, pos);
+  buf[pos++] = (uint8_t)crc;
+  buf[pos++] = (uint8_t)(crc >> 8);
+  buf[pos++] = (uint8_t)(crc >> 16);
+  buf[pos] = (uint8_t)(crc >> 24);
+
+  log_hal_log_debug("Snapshot of [%u] bytes", (unsigned)(pos + 1));
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_snapshot_restore(struct ulorawan_session *const session,
+                                  const uint8_t *const buf, size_t size) {
+  uint8_t *dst = (uint8_t *)session;
+  size_t body = body_size();
+  size_t pos = HEADER_SIZE;
+
+  if (size < ulorawan_snapshot_size() ||
+      (buf[0] | (buf[1] << 8)) != SNAPSHOT_MAGIC ||
+      buf[2] != ULORAWAN_SNAPSHOT_VERSION ||
+      buf[3] != (uint8_t)session->region_params.region ||
+      (buf[4] | ((size_t)buf[5] << 8)) != body) {
+    log_hal_log_error("Snapshot not for this firmware");
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  uint32_t crc = (uint32_t)buf[HEADER_SIZE + body] |
+                 ((uint32_t)buf[HEADER_SIZE + body + 1] << 8) |
+                 ((uint32_t)buf[HEADER_SIZE + body + 2] << 16) |
+                 ((uint32_t)buf[HEADER_SIZE + body + 3] << 24);
+
+  if (crc != crc32(buf, HEADER_SIZE + body)) {
+    log_hal_log_error("Snapshot corrupted");
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  // Counters persisted after the snapshot was taken take precedence
+  const struct ulorawan_region_desc *desc = session->region_params.desc;
+  uint32_t fcnt_up = session->keys.fcnt_up;
+  uint32_t fcnt_down = session->keys.fcnt_down;
+  uint32_t reserved = session->fcnt.reserved;
+  // The duty cycle release times are on the timer of the boot that took the
+  // snapshot, the accounting of this boot is kept
+  struct ulorawan_duty_cycle duty_cycle = session->region_params.duty_cycle;
+
+  for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+    memcpy(&dst[fields[i].offset], &buf[pos], fields[i].size);
+    pos += fields[i].size;
+  }
+
+  session->region_params.desc = desc;
+  session->keys.fcnt_down = max_u32(session->keys.fcnt_down, fcnt_down);
+  session->keys.fcnt_up = max_u32(session->keys.fcnt_up, fcnt_up);
+  session->fcnt.reserved = max_u32(session->fcnt.reserved, reserved);
+
+  // Only the aggregated limit set by the network carries over
+  duty_cycle.aggregated = session->region_params.duty_cycle.aggregated;
+  session->region_params.duty_cycle = duty_cycle;
+
+  return ULORAWAN_ERR_NONE;
+}
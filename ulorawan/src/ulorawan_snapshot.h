@@ -0,0 +1,98 @@
+/**
+ * \file
+ *
+ * \brief Warm boot session snapshot.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_SNAPSHOT_H_
+#define ULORAWAN_SNAPSHOT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+//! The snapshot format version, changed whenever the stored fields change
+#define ULORAWAN_SNAPSHOT_VERSION 1
+
+/**
+ * \brief Get the size of a session snapshot.
+ *
+ * \return The size in bytes of the header, the session fields and the CRC.
+ */
+size_t ulorawan_snapshot_size(void);
+
+/**
+ * \brief Write a snapshot of the session.
+ *
+ * The keys, frame counters, multicast groups, pending MAC command answers,
+ * adaptive data rate and region parameters are stored. Frame buffers,
+ * queued uplinks, link statistics and the radio state machine are not.
+ *
+ * \param[in] session The session.
+ * \param[out] buf The buffer, in retained RAM or to be written to NVM.
+ * \param[in] size The size of the buffer.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_PARAMS The buffer is smaller than the snapshot.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_snapshot_save(const struct ulorawan_session *const session,
+                               uint8_t *const buf, size_t size);
+
+/**
+ * \brief Restore the session from a snapshot.
+ *
+ * The session is left unchanged unless the snapshot is intact, of the
+ * current version and layout, and taken in the same region. Frame counters
+ * and the uplink counter reservation never move behind those restored from
+ * the session store. The duty cycle release times of the session are kept,
+ * those of the snapshot are on the timer of an earlier boot. Only the latest
+ * snapshot may be restored.
+ *
+ * \param[in] session The session.
+ * \param[in] buf The snapshot.
+ * \param[in] size The size of the snapshot.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_PARAMS The snapshot is invalid.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_snapshot_restore(struct ulorawan_session *const session,
+                                  const uint8_t *const buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_SNAPSHOT_H_ */
@@ -0,0 +1,564 @@
+/**
+ * \file
+ *
+ * \brief Log structured session store.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "nvm_hal.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_store.h"
+
+//! The magic number marking a committed sector
+#define SECTOR_MAGIC 0x554C5354UL
+//! The size of the sector header, the magic number and sequence number
+#define HEADER_SIZE 8
+//! The size of the record header, the key, size and checksum
+#define RECORD_HEADER_SIZE 3
+//! The key of unwritten memory
+#define KEY_FREE 0xFF
+//! The size of the chunks records are checked and copied in
+#define CHUNK_SIZE 16
+//! The size of the session record
+#define SESSION_RECORD_SIZE                                                    \
+  (4 + ULORAWAN_NWK_S_KEY_SIZE + ULORAWAN_APP_S_KEY_SIZE)
+
+static uint16_t record_size(uint8_t size) {
+  uint16_t length = RECORD_HEADER_SIZE + size;
+
+  return (uint16_t)((length + ULORAWAN_STORE_ALIGN - 1) /
+                    ULORAWAN_STORE_ALIGN * ULORAWAN_STORE_ALIGN);
+}
+
+static uint32_t sector_address(uint8_t sector) {
+  return ULORAWAN_STORE_NVM_ADDRESS + (uint32_t)sector * NVM_HAL_SECTOR_SIZE;
+}
+
+static void write_u32(uint8_t *const buf, uint32_t value) {
+  buf[0] = (uint8_t)value;
+  buf[1] = (uint8_t)(value >> 8);
+  buf[2] = (uint8_t)(value >> 16);
+  buf[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t read_u32(const uint8_t *const buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static uint8_t crc8(uint8_t crc, const uint8_t *const buf, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    crc ^= buf[i];
+
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+static int32_t nvm_read(uint32_t address, uint8_t *const buf, size_t size) {
+  return nvm_hal_read(address, buf, size) == NVM_HAL_ERR_NONE
+             ? ULORAWAN_ERR_NONE
+             : ULORAWAN_ERR_NVM;
+}
+
+static int32_t nvm_write(uint32_t address, const uint8_t *const buf,
+                         size_t size) {
+  return nvm_hal_write(address, buf, size) == NVM_HAL_ERR_NONE
+             ? ULORAWAN_ERR_NONE
+             : ULORAWAN_ERR_NVM;
+}
+
+// Check the record at the address, its header is already read
+static int32_t check_record(uint32_t address, const uint8_t *const header,
+                            bool *const valid) {
+  uint8_t chunk[CHUNK_SIZE];
+  uint8_t crc = crc8(0, header, 2);
+
+  for (uint8_t pos = 0; pos < header[1];) {
+    uint8_t size = (uint8_t)(header[1] - pos) < CHUNK_SIZE
+                       ? (uint8_t)(header[1] - pos)
+                       : CHUNK_SIZE;
+
+    if (nvm_read(address + RECORD_HEADER_SIZE + pos, chunk, size) !=
+        ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    crc = crc8(crc, chunk, size);
+    pos = (uint8_t)(pos + size);
+  }
+
+  *valid = crc == header[2];
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Index the records of the current sector and find its end
+static int32_t scan(struct ulorawan_store *const store) {
+  uint32_t base = sector_address(store->sector);
+  uint16_t offset = HEADER_SIZE;
+
+  memset(store->index, 0, sizeof(store->index));
+
+  while (offset + RECORD_HEADER_SIZE <= NVM_HAL_SECTOR_SIZE) {
+    uint8_t header[RECORD_HEADER_SIZE];
+    bool valid = false;
+
+    if (nvm_read(base + offset, header, sizeof(header)) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    if (header[0] == KEY_FREE) {
+      break;
+    }
+
+    if (header[0] < ULORAWAN_STORE_MAX_KEYS &&
+        offset + record_size(header[1]) <= NVM_HAL_SECTOR_SIZE &&
+        check_record(base + offset, header, &valid) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    // A torn write ends the sector, the next flush compacts past it
+    if (!valid) {
+      log_hal_log_error("Store record at [0x%04X] invalid", offset);
+      offset = NVM_HAL_SECTOR_SIZE;
+      break;
+    }
+
+    store->index[header[0]] = offset;
+    offset = (uint16_t)(offset + record_size(header[1]));
+  }
+
+  store->offset = offset;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+static int32_t commit_sector(uint8_t sector, uint32_t sequence) {
+  uint8_t header[HEADER_SIZE];
+
+  write_u32(header, SECTOR_MAGIC);
+  write_u32(&header[4], sequence);
+
+  return nvm_write(sector_address(sector), header, sizeof(header));
+}
+
+static int32_t erase_sector(struct ulorawan_store *const store,
+                            uint8_t sector) {
+  if (nvm_hal_erase(sector_address(sector)) != NVM_HAL_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  store->stats.erases++;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_store_init(struct ulorawan_store *const store) {
+  bool found = false;
+
+  memset(store, 0, sizeof(*store));
+
+  for (uint8_t sector = 0; sector < ULORAWAN_STORE_SECTORS; sector++) {
+    uint8_t header[HEADER_SIZE];
+
+    if (nvm_read(sector_address(sector), header, sizeof(header)) !=
+        ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    uint32_t sequence = read_u32(&header[4]);
+
+    if (read_u32(header) == SECTOR_MAGIC &&
+        (!found || (int32_t)(sequence - store->sequence) > 0)) {
+      store->sector = sector;
+      store->sequence = sequence;
+      found = true;
+    }
+  }
+
+  if (!found) {
+    log_hal_log_info("Formatting session store");
+
+    if (erase_sector(store, 0) != ULORAWAN_ERR_NONE ||
+        commit_sector(0, 1) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    store->sequence = 1;
+  }
+
+  if (scan(store) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  store->mounted = 1;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// The offset of the staged record of a key, or the staged size when none
+static uint8_t find_staged(const struct ulorawan_store *const store,
+                           uint8_t key) {
+  uint8_t pos = 0;
+
+  while (pos < store->staged_size && store->staged[pos] != key) {
+    pos = (uint8_t)(pos + record_size(store->staged[pos + 1]));
+  }
+
+  return pos;
+}
+
+// Compare a value with the stored record of its key
+static int32_t stored_equal(const struct ulorawan_store *const store,
+                            uint8_t key, const uint8_t *const value,
+                            uint8_t size, bool *const equal) {
+  uint32_t address = sector_address(store->sector) + store->index[key];
+  uint8_t chunk[CHUNK_SIZE];
+
+  *equal = false;
+
+  if (store->index[key] == 0) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  if (nvm_read(address, chunk, RECORD_HEADER_SIZE) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  if (chunk[1] != size) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  for (uint8_t pos = 0; pos < size;) {
+    uint8_t length =
+        (uint8_t)(size - pos) < CHUNK_SIZE ? (uint8_t)(size - pos) : CHUNK_SIZE;
+
+    if (nvm_read(address + RECORD_HEADER_SIZE + pos, chunk, length) !=
+        ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    if (memcmp(chunk, &value[pos], length) != 0) {
+      return ULORAWAN_ERR_NONE;
+    }
+
+    pos = (uint8_t)(pos + length);
+  }
+
+  *equal = true;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_store_put(struct ulorawan_store *const store, uint8_t key,
+                           const uint8_t *const value, uint8_t size) {
+  if (!store->mounted) {
+    return ULORAWAN_ERR_STATE;
+  }
+
+  if (key >= ULORAWAN_STORE_MAX_KEYS ||
+      record_size(size) > ULORAWAN_STORE_BUF_SIZE) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  uint8_t pos = find_staged(store, key);
+
+  if (pos < store->staged_size) {
+    uint8_t length = (uint8_t)record_size(store->staged[pos + 1]);
+
+    store->stats.coalesced++;
+
+    if (store->staged[pos + 1] == size) {
+      memcpy(&store->staged[pos + RECORD_HEADER_SIZE], value, size);
+      return ULORAWAN_ERR_NONE;
+    }
+
+    memmove(&store->staged[pos], &store->staged[pos + length],
+            store->staged_size - pos - length);
+    store->staged_size = (uint8_t)(store->staged_size - length);
+  } else {
+    bool equal;
+
+    if (stored_equal(store, key, value, size, &equal) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    if (equal) {
+      store->stats.unchanged++;
+      return ULORAWAN_ERR_NONE;
+    }
+  }
+
+  if (store->staged_size + record_size(size) > ULORAWAN_STORE_BUF_SIZE) {
+    int32_t result = ulorawan_store_flush(store);
+
+    if (result != ULORAWAN_ERR_NONE) {
+      return result;
+    }
+  }
+
+  uint8_t *record = &store->staged[store->staged_size];
+
+  memset(record, 0xFF, record_size(size));
+  record[0] = key;
+  record[1] = size;
+  memcpy(&record[RECORD_HEADER_SIZE], value, size);
+  store->staged_size = (uint8_t)(store->staged_size + record_size(size));
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_store_get(struct ulorawan_store *const store, uint8_t key,
+                           uint8_t *const value, uint8_t size) {
+  if (!store->mounted) {
+    return ULORAWAN_ERR_STATE;
+  }
+
+  if (key >= ULORAWAN_STORE_MAX_KEYS) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  uint8_t pos = find_staged(store, key);
+
+  if (pos < store->staged_size) {
+    if (store->staged[pos + 1] != size) {
+      return ULORAWAN_ERR_PARAMS;
+    }
+
+    memcpy(value, &store->staged[pos + RECORD_HEADER_SIZE], size);
+
+    return ULORAWAN_ERR_NONE;
+  }
+
+  uint32_t address = sector_address(store->sector) + store->index[key];
+  uint8_t header[RECORD_HEADER_SIZE];
+
+  if (store->index[key] == 0) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  if (nvm_read(address, header, sizeof(header)) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  if (header[1] != size) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  return nvm_read(address + RECORD_HEADER_SIZE, value, size);
+}
+
+// Checksum the staged records and index them from the offset
+static void seal_staged(struct ulorawan_store *const store, uint16_t offset,
+                        uint16_t *const index) {
+  for (uint8_t pos = 0; pos < store->staged_size;) {
+    uint8_t *record = &store->staged[pos];
+
+    record[2] = crc8(crc8(0, record, 2), &record[RECORD_HEADER_SIZE], record[1]);
+    index[record[0]] = (uint16_t)(offset + pos);
+    store->stats.records++;
+    pos = (uint8_t)(pos + record_size(record[1]));
+  }
+}
+
+static int32_t copy_record(uint32_t from, uint32_t to, uint16_t size) {
+  uint8_t chunk[CHUNK_SIZE];
+
+  for (uint16_t pos = 0; pos < size; pos += CHUNK_SIZE) {
+    size_t length = size - pos < CHUNK_SIZE ? (size_t)(size - pos) : CHUNK_SIZE;
+
+    if (nvm_read(from + pos, chunk, length) != ULORAWAN_ERR_NONE ||
+        nvm_write(to + pos, chunk, length) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Move the latest records and the staged ones to the next sector
+static int32_t compact(struct ulorawan_store *const store) {
+  uint8_t next = (uint8_t)((store->sector + 1) % ULORAWAN_STORE_SECTORS);
+  uint32_t from = sector_address(store->sector);
+  uint32_t to = sector_address(next);
+  uint16_t index[ULORAWAN_STORE_MAX_KEYS] = {0};
+  uint16_t offset = HEADER_SIZE;
+
+  if (erase_sector(store, next) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  for (uint8_t key = 0; key < ULORAWAN_STORE_MAX_KEYS; key++) {
+    uint8_t header[RECORD_HEADER_SIZE];
+
+    if (store->index[key] == 0 || find_staged(store, key) < store->staged_size) {
+      continue;
+    }
+
+    if (nvm_read(from + store->index[key], header, sizeof(header)) !=
+        ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    uint16_t size = record_size(header[1]);
+
+    if (copy_record(from + store->index[key], to + offset, size) !=
+        ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    index[key] = offset;
+    offset = (uint16_t)(offset + size);
+    store->stats.bytes += size;
+  }
+
+  seal_staged(store, offset, index);
+
+  if (nvm_write(to + offset, store->staged, store->staged_size) !=
+          ULORAWAN_ERR_NONE ||
+      commit_sector(next, store->sequence + 1) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_NVM;
+  }
+
+  log_hal_log_info("Store compacted into sector [%u]", next);
+
+  memcpy(store->index, index, sizeof(index));
+  store->sector = next;
+  store->sequence++;
+  store->offset = (uint16_t)(offset + store->staged_size);
+  store->stats.bytes += store->staged_size + HEADER_SIZE;
+  store->stats.compactions++;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_store_flush(struct ulorawan_store *const store) {
+  if (!store->mounted) {
+    return ULORAWAN_ERR_STATE;
+  }
+
+  if (store->staged_size == 0) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  if (store->offset + store->staged_size > NVM_HAL_SECTOR_SIZE) {
+    if (compact(store) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+  } else {
+    uint16_t index[ULORAWAN_STORE_MAX_KEYS];
+
+    memcpy(index, store->index, sizeof(index));
+    seal_staged(store, store->offset, index);
+
+    if (nvm_write(sector_address(store->sector) + store->offset,
+                  store->staged, store->staged_size) != ULORAWAN_ERR_NONE) {
+      return ULORAWAN_ERR_NVM;
+    }
+
+    memcpy(store->index, index, sizeof(index));
+    store->offset = (uint16_t)(store->offset + store->staged_size);
+    store->stats.bytes += store->staged_size;
+  }
+
+  store->staged_size = 0;
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_store_load_session(struct ulorawan_session *const session) {
+  uint8_t record[SESSION_RECORD_SIZE];
+  int32_t result;
+
+  result = ulorawan_store_get(&session->store, ULORAWAN_STORE_KEY_FCNT_DOWN,
+                              record, 4);
+  if (result == ULORAWAN_ERR_NVM) {
+    return result;
+  }
+
+  if (result == ULORAWAN_ERR_NONE) {
+    session->keys.fcnt_down = read_u32(record);
+  }
+
+  if (session->security.type != ACTIVATION_OTAA) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  result = ulorawan_store_get(&session->store, ULORAWAN_STORE_KEY_SESSION,
+                              record, sizeof(record));
+  if (result == ULORAWAN_ERR_NVM) {
+    return result;
+  }
+
+  if (result == ULORAWAN_ERR_NONE) {
+    session->keys.dev_addr = read_u32(record);
+    memcpy(session->keys.nwk_s_key, &record[4], ULORAWAN_NWK_S_KEY_SIZE);
+    memcpy(session->keys.app_s_key, &record[4 + ULORAWAN_NWK_S_KEY_SIZE],
+           ULORAWAN_APP_S_KEY_SIZE);
+    log_hal_log_info("Session [0x%08X] restored", session->keys.dev_addr);
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+int32_t ulorawan_store_save_session(struct ulorawan_session *const session) {
+  uint8_t record[SESSION_RECORD_SIZE];
+  int32_t result;
+
+  if (session->keys.dev_addr != 0) {
+    write_u32(record, session->keys.dev_addr);
+    memcpy(&record[4], session->keys.nwk_s_key, ULORAWAN_NWK_S_KEY_SIZE);
+    memcpy(&record[4 + ULORAWAN_NWK_S_KEY_SIZE], session->keys.app_s_key,
+           ULORAWAN_APP_S_KEY_SIZE);
+
+    result = ulorawan_store_put(&session->store, ULORAWAN_STORE_KEY_SESSION,
+                                record, sizeof(record));
+    if (result != ULORAWAN_ERR_NONE) {
+      return result;
+    }
+  }
+
+  write_u32(record, session->keys.fcnt_down);
+
+  result = ulorawan_store_put(&session->store, ULORAWAN_STORE_KEY_FCNT_DOWN,
+                              record, 4);
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  return ulorawan_store_flush(&session->store);
+}
@@ -0,0 +1,168 @@
+/**
+ * \file
+ *
+ * \brief Log structured session store.
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_STORE_H_
+#define ULORAWAN_STORE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+//! The non volatile memory address of the session store
+#ifndef ULORAWAN_STORE_NVM_ADDRESS
+#define ULORAWAN_STORE_NVM_ADDRESS 0x20000UL
+#endif
+
+//! The number of sectors the session store rotates through
+#ifndef ULORAWAN_STORE_SECTORS
+#define ULORAWAN_STORE_SECTORS 4
+#endif
+
+//! The smallest unit the non volatile memory programs, records are padded to
+//! a multiple of it
+#ifndef ULORAWAN_STORE_ALIGN
+#define ULORAWAN_STORE_ALIGN 4
+#endif
+
+//! The keys of the session store records
+enum ulorawan_store_key {
+  //! The device address and session keys
+  ULORAWAN_STORE_KEY_SESSION,
+  //! The next expected downlink frame counter
+  ULORAWAN_STORE_KEY_FCNT_DOWN,
+  //! The first uplink frame counter not reserved
+  ULORAWAN_STORE_KEY_FCNT_UP,
+};
+
+/**
+ * \brief Mount the session store.
+ *
+ * The sector with the highest sequence number is scanned to index the latest
+ * record of each key. A store without a valid sector is formatted.
+ *
+ * \param[in] store The session store.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NVM The non volatile memory could not be accessed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_store_init(struct ulorawan_store *const store);
+
+/**
+ * \brief Stage a record to be written with the next flush.
+ *
+ * A record replaces a staged record of the same key and is dropped when the
+ * stored record already holds the value.
+ *
+ * \param[in] store The session store.
+ * \param[in] key The record key, less than ULORAWAN_STORE_MAX_KEYS.
+ * \param[in] value The record value.
+ * \param[in] size The size of the value.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_STATE The store is not mounted.
+ * \retval ULORAWAN_ERR_PARAMS The key or size is invalid.
+ * \retval ULORAWAN_ERR_NVM The non volatile memory could not be accessed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_store_put(struct ulorawan_store *const store, uint8_t key,
+                           const uint8_t *const value, uint8_t size);
+
+/**
+ * \brief Read the latest record of a key.
+ *
+ * \param[in] store The session store.
+ * \param[in] key The record key.
+ * \param[out] value The record value.
+ * \param[in] size The expected size of the value.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_STATE The store is not mounted.
+ * \retval ULORAWAN_ERR_PARAMS There is no record of the key and size.
+ * \retval ULORAWAN_ERR_NVM The non volatile memory could not be accessed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_store_get(struct ulorawan_store *const store, uint8_t key,
+                           uint8_t *const value, uint8_t size);
+
+/**
+ * \brief Write the staged records.
+ *
+ * The records are appended to the current sector in one write. When they do
+ * not fit the latest record of each key and the staged records are
+ * compacted into the next sector, which is committed by writing its header
+ * last, so erases rotate through all the sectors.
+ *
+ * \param[in] store The session store.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_STATE The store is not mounted.
+ * \retval ULORAWAN_ERR_NVM The non volatile memory could not be accessed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_store_flush(struct ulorawan_store *const store);
+
+/**
+ * \brief Restore the session from the store.
+ *
+ * The downlink frame counter is restored, and for over the air activation
+ * the device address and session keys, so the device need not rejoin.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NVM The non volatile memory could not be accessed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_store_load_session(struct ulorawan_session *const session);
+
+/**
+ * \brief Stage the changed session state and flush it to the store.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_STATE The store is not mounted.
+ * \retval ULORAWAN_ERR_NVM The non volatile memory could not be accessed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_store_save_session(struct ulorawan_session *const session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_STORE_H_ */
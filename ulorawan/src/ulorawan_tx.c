@@ -0,0 +1,99 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink transmit function implementations
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdint.h>
+
+#include "log_hal.h"
+#include "radio_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_energy.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_lbt.h"
+#include "ulorawan_region.h"
+#include "ulorawan_tx.h"
+
+int32_t ulorawan_tx_start(struct ulorawan_session *const session) {
+  const struct ulorawan_region_params *params = &session->region_params;
+  const struct ulorawan_region_dr *dr =
+      &params->desc->data_rates[session->retrans.dr];
+  struct radio_hal_tx_config config;
+
+  if (radio_hal_set_frequency(session->channel.frequency) !=
+      RADIO_HAL_ERR_NONE) {
+    log_hal_log_error("Failed to set frequency");
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  // The data rate of the uplink may be faster than the ADR data rate to fit
+  // the dwell time
+  config.modulation = dr->modulation;
+  config.sf = dr->sf;
+  config.bw = dr->bw;
+  config.eirp = ulorawan_region_get_eirp(params, params->tx_power);
+
+  if (radio_hal_set_tx_config(&config) != RADIO_HAL_ERR_NONE) {
+    log_hal_log_error("Failed to set DR%u at [%i] dBm", session->retrans.dr,
+                      config.eirp);
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+#ifdef ULORAWAN_LBT_ENABLED
+  return ulorawan_lbt_start(session);
+#else
+  return ulorawan_tx_transmit(session);
+#endif // ULORAWAN_LBT_ENABLED
+}
+
+int32_t ulorawan_tx_transmit(struct ulorawan_session *const session) {
+  if (radio_hal_fifo_write(session->uplink.buf, session->uplink.eof) !=
+      RADIO_HAL_ERR_NONE) {
+    log_hal_log_error("Failed to write fifo");
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  log_hal_log_info("Set radio mode TX");
+  if (radio_hal_set_mode(MODE_TX) != RADIO_HAL_ERR_NONE) {
+    session->state = ULORAWAN_STATE_FAULT;
+    return ULORAWAN_ERR_RADIO;
+  }
+
+  ULORAWAN_ENERGY_MODE(session, MODE_TX);
+
+  session->tx_start = timer_hal_get_time();
+  session->state = ULORAWAN_STATE_TX;
+
+  return ULORAWAN_ERR_NONE;
+}
@@ -0,0 +1,77 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink transmit prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ULORAWAN_TX_H_
+#define ULORAWAN_TX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+/**
+ * \brief Start the transmission of the pending uplink on the session channel.
+ *
+ * The radio is set to the data rate of the uplink and to the EIRP of the tx
+ * power level limited by the maximum EIRP.
+ *
+ * When listen before talk is enabled the uplink is only transmitted once the
+ * channel has been found to be clear.
+ *
+ * \param[in] session The session with a pending uplink.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_tx_start(struct ulorawan_session *const session);
+
+/**
+ * \brief Transmit the pending uplink immediately.
+ *
+ * \param[in] session The session with a pending uplink.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_tx_transmit(struct ulorawan_session *const session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_TX_H_ */
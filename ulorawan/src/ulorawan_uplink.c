@@ -0,0 +1,278 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "timer_hal.h"
+#include "ulorawan_adr.h"
+#include "ulorawan_aggregate.h"
+#include "ulorawan_cmds.h"
+#include "ulorawan_crypto.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_fcnt.h"
+#include "ulorawan_retrans.h"
+#include "ulorawan_tx.h"
+#include "ulorawan_uplink.h"
+#include "ulorawan_uplink_queue.h"
+
+//! The size of the frame port
+#define FPORT_SIZE 1
+
+//! The frame port of MAC commands
+#define FPORT_MAC 0
+
+// Build an uplink frame, the MAC command answers are sent in FOpts unless
+// they are the payload of a port 0 frame
+static int32_t build_frame(struct ulorawan_session *const session,
+                           bool confirm, uint8_t port,
+                           const uint8_t *const payload, uint8_t size) {
+  struct ulorawan_mac_frame_context *ctx = &session->uplink;
+  struct ulorawan_session_keys *keys = &session->keys;
+  enum ulorawan_mac_ftype ftype = confirm ? FRAME_TYPE_DATA_CONFIRMED_UP
+                                          : FRAME_TYPE_DATA_UNCONFIRMED_UP;
+  union ulorawan_mac_mhdr mhdr = ULORAWAN_MHDR_INIT(ftype, LORAWAN_MAJOR_R1);
+  uint8_t fopts_len = port != FPORT_MAC ? session->cmds.answers_size : 0;
+  struct ulorawan_mac_fhdr fhdr;
+  size_t payload_offset;
+  uint32_t mic;
+
+  fhdr.dev_addr = keys->dev_addr;
+  fhdr.fctrl.value = 0;
+  ulorawan_adr_uplink(session, &fhdr.fctrl);
+  fhdr.fctrl.bits.fpending_classb =
+      session->class_b.status == CLASS_B_TRACKING;
+  fhdr.fctrl.bits.fopts_len = fopts_len;
+  fhdr.fcnt = (uint16_t)keys->fcnt_up;
+  memcpy(fhdr.fopts, session->cmds.answers, fopts_len);
+
+  ctx->eof = 0;
+
+  if (ulorawan_mac_write_mhdr(ctx, &mhdr) != ULORAWAN_MAC_ERR_NONE ||
+      ulorawan_mac_write_fhdr(ctx, &fhdr) != ULORAWAN_MAC_ERR_NONE ||
+      ulorawan_mac_write_fport(ctx, port) != ULORAWAN_MAC_ERR_NONE) {
+    return ULORAWAN_ERR_CTX;
+  }
+
+  payload_offset = ctx->eof;
+  ulorawan_mac_write_frmpayload(ctx, payload, size);
+
+  if (ulorawan_crypto_payload(port != FPORT_MAC ? keys->app_s_key
+                                                : keys->nwk_s_key,
+                              ULORAWAN_CRYPTO_DIR_UP, keys->dev_addr,
+                              keys->fcnt_up, &ctx->buf[payload_offset],
+                              size) != ULORAWAN_ERR_NONE ||
+      ulorawan_crypto_mic(keys->nwk_s_key, ULORAWAN_CRYPTO_DIR_UP,
+                          keys->dev_addr, keys->fcnt_up, ctx->buf, ctx->eof,
+                          &mic) != ULORAWAN_ERR_NONE) {
+    return ULORAWAN_ERR_CMAC;
+  }
+
+  ulorawan_mac_write_mic(ctx, mic);
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Select a channel for the data rate of the message, the uplink data rate
+// chosen by ADR is left unchanged
+static int32_t select_channel(struct ulorawan_session *const session,
+                              uint8_t dr) {
+  struct ulorawan_region_params *params = &session->region_params;
+  uint8_t data_rate = params->data_rate;
+  int32_t result;
+
+  params->data_rate = dr;
+  result = ulorawan_region_get_channel(params, &session->channel);
+  params->data_rate = data_rate;
+
+  return result;
+}
+
+// Wait for the duty cycle limits to allow an uplink at the data rate
+static int32_t defer(struct ulorawan_session *const session, uint8_t dr,
+                     uint32_t now) {
+  int32_t wait =
+      (int32_t)(ulorawan_region_next_tx_time(&session->region_params) - now);
+
+  // Only logged
+  (void)dr;
+
+  if (wait <= 0) {
+    log_hal_log_error("No channel for DR%u", dr);
+    return ULORAWAN_ERR_NO_CHANNEL;
+  }
+
+  log_hal_log_debug("Uplink deferred [%i] ms by duty cycle", wait);
+
+  if (timer_hal_start(TIMER0, (uint32_t)wait) != TIMER_HAL_ERR_NONE) {
+    return ULORAWAN_ERR_TIMER;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+// Transmit the pending uplink again with the same frame counter on a newly
+// selected channel once its backoff has passed
+static int32_t retransmit(struct ulorawan_session *const session,
+                          uint32_t now) {
+  struct ulorawan_retrans *retrans = &session->retrans;
+  int32_t wait = (int32_t)(retrans->next - now);
+
+  if (wait > 0) {
+    if (timer_hal_start(TIMER0, (uint32_t)wait) != TIMER_HAL_ERR_NONE) {
+      return ULORAWAN_ERR_TIMER;
+    }
+
+    return ULORAWAN_ERR_NONE;
+  }
+
+  if (select_channel(session, retrans->dr) != ULORAWAN_REGION_ERR_NONE) {
+    return defer(session, retrans->dr, now);
+  }
+
+  ulorawan_retrans_attempt(session);
+
+  return ulorawan_tx_start(session);
+}
+
+// Send the MAC command answers that do not fit in FOpts as the payload of a
+// port 0 frame ahead of the next message
+static int32_t send_answers(struct ulorawan_session *const session,
+                            uint32_t now) {
+  struct ulorawan_cmds *cmds = &session->cmds;
+  uint8_t dr;
+  int32_t result;
+
+  if (ulorawan_region_fit_payload(&session->region_params,
+                                  ULORAWAN_MAC_FHDR_MIN_SIZE + FPORT_SIZE +
+                                      cmds->answers_size,
+                                  &dr) != ULORAWAN_REGION_ERR_NONE) {
+    log_hal_log_error("MAC answers of [%u] bytes too large", cmds->answers_size);
+    ulorawan_cmds_clear_answers(session);
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  if (select_channel(session, dr) != ULORAWAN_REGION_ERR_NONE) {
+    return defer(session, dr, now);
+  }
+
+  result = ulorawan_fcnt_reserve(session);
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  result = build_frame(session, false, FPORT_MAC, cmds->answers,
+                       cmds->answers_size);
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  ulorawan_retrans_start(session, false, dr, now);
+  ulorawan_cmds_clear_answers(session);
+  session->keys.fcnt_up++;
+
+  return ulorawan_tx_start(session);
+}
+
+int32_t ulorawan_uplink_dispatch(struct ulorawan_session *const session) {
+  struct ulorawan_uplink_queue *queue = &session->uplink_queue;
+  struct ulorawan_uplink_msg *msg;
+  uint32_t now;
+  uint32_t flush_wait;
+  uint8_t dr;
+  int32_t result;
+
+  if (session->state != ULORAWAN_STATE_IDLE &&
+      session->state != ULORAWAN_STATE_RXC) {
+    return ULORAWAN_ERR_NONE;
+  }
+
+  now = timer_hal_get_time();
+
+  if (session->retrans.active) {
+    return retransmit(session, now);
+  }
+
+  flush_wait = ulorawan_aggregate_poll(session, now);
+
+  if (ulorawan_uplink_queue_expire(queue, now) != 0) {
+    log_hal_log_info("Expired uplinks dropped");
+  }
+
+  msg = ulorawan_uplink_queue_peek(queue);
+  if (msg == NULL) {
+    // Wake up to send the pending records once they are due
+    if (flush_wait != 0 &&
+        timer_hal_start(TIMER0, flush_wait) != TIMER_HAL_ERR_NONE) {
+      return ULORAWAN_ERR_TIMER;
+    }
+
+    return ULORAWAN_ERR_NONE;
+  }
+
+  if (session->cmds.answers_size > ULORAWAN_MAC_FHDR_F_OPTS_MAX_SIZE) {
+    return send_answers(session, now);
+  }
+
+  if (ulorawan_region_fit_payload(&session->region_params,
+                                  ULORAWAN_MAC_FHDR_MIN_SIZE + session->cmds.answers_size +
+                                      FPORT_SIZE + msg->size,
+                                  &dr) != ULORAWAN_REGION_ERR_NONE) {
+    log_hal_log_error("Uplink of [%u] bytes too large", msg->size);
+    ulorawan_uplink_queue_drop(queue);
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  if (select_channel(session, dr) != ULORAWAN_REGION_ERR_NONE) {
+    return defer(session, dr, now);
+  }
+
+  // The frame counter must be persisted before it goes on air
+  result = ulorawan_fcnt_reserve(session);
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  result = build_frame(session, msg->confirm, msg->port, msg->payload,
+                       msg->size);
+  if (result != ULORAWAN_ERR_NONE) {
+    return result;
+  }
+
+  ulorawan_retrans_start(session, msg->confirm, dr, now);
+  ulorawan_uplink_queue_pop(queue);
+  ulorawan_cmds_clear_answers(session);
+  session->keys.fcnt_up++;
+
+  return ulorawan_tx_start(session);
+}
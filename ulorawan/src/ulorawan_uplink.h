@@ -0,0 +1,74 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_UPLINK_H_
+#define ULORAWAN_UPLINK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+/**
+ * \brief Send the next queued application message when the stack is idle
+ * or receiving continuously.
+ *
+ * A pending uplink that has to be transmitted again is sent before any
+ * queued message, with the same frame counter on a newly selected channel
+ * once its backoff has passed.
+ *
+ * Expired messages are dropped first and aggregated records that are due
+ * are queued. When the duty cycle limits do not allow an uplink TIMER0 is
+ * started to retry once they do, when only aggregated records are pending
+ * it is started to send them once they are due.
+ *
+ * \param[in] session The session.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_NO_CHANNEL No channel supports the data rate.
+ * \retval ULORAWAN_ERR_PARAMS No data rate can carry the next message, it
+ * has been dropped.
+ * \retval ULORAWAN_ERR_TIMER The retry timer could not be started.
+ * \retval ULORAWAN_ERR_CMAC Encrypting or signing the frame failed.
+ * \retval ULORAWAN_ERR_RADIO A radio operation failed.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_uplink_dispatch(struct ulorawan_session *const session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_UPLINK_H_ */
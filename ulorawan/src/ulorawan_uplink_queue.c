@@ -0,0 +1,177 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink queue implementation
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_hal.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_uplink_queue.h"
+
+#if ULORAWAN_UPLINK_QUEUE_DEPTH > 32
+#error "ULORAWAN_UPLINK_QUEUE_DEPTH must not exceed 32"
+#endif
+
+// Remove the message at a position of the order
+static void remove_at(struct ulorawan_uplink_queue *const queue,
+                      uint8_t position) {
+  queue->count--;
+  memmove(&queue->order[position], &queue->order[position + 1],
+          queue->count - position);
+}
+
+// Find a slot that is not in use, the queue must not be full
+static uint8_t free_slot(const struct ulorawan_uplink_queue *const queue) {
+  uint32_t used = 0;
+
+  for (uint8_t i = 0; i < queue->count; i++) {
+    used |= 1UL << queue->order[i];
+  }
+
+  uint8_t slot = 0;
+
+  while (used & (1UL << slot)) {
+    slot++;
+  }
+
+  return slot;
+}
+
+int32_t ulorawan_uplink_queue_push(struct ulorawan_uplink_queue *const queue,
+                                   const struct ulorawan_uplink_req *const req,
+                                   uint32_t now) {
+  if (req->size > ULORAWAN_UPLINK_MAX_PAYLOAD) {
+    return ULORAWAN_ERR_PARAMS;
+  }
+
+  if (queue->count == ULORAWAN_UPLINK_QUEUE_DEPTH) {
+    uint8_t last = queue->order[queue->count - 1];
+
+    queue->stats.dropped_full++;
+
+    if (queue->msgs[last].priority >= req->priority) {
+      log_hal_log_error("Uplink queue full");
+      return ULORAWAN_ERR_FULL;
+    }
+
+    log_hal_log_info("Uplink queue full, dropped port [%u]",
+                     queue->msgs[last].port);
+    remove_at(queue, queue->count - 1);
+  }
+
+  uint8_t slot = free_slot(queue);
+  struct ulorawan_uplink_msg *msg = &queue->msgs[slot];
+
+  msg->port = req->port;
+  msg->size = req->size;
+  msg->confirm = req->confirm ? 1 : 0;
+  msg->priority = req->priority;
+  msg->expires = req->lifetime != 0;
+  msg->expiry = now + req->lifetime;
+  memcpy(msg->payload, req->payload, req->size);
+
+  // Insert behind every message of equal or higher priority
+  uint8_t position = queue->count;
+
+  while (position > 0 &&
+         queue->msgs[queue->order[position - 1]].priority < req->priority) {
+    position--;
+  }
+
+  memmove(&queue->order[position + 1], &queue->order[position],
+          queue->count - position);
+  queue->order[position] = slot;
+  queue->count++;
+
+  queue->stats.queued++;
+
+  if (queue->count > queue->stats.high_water) {
+    queue->stats.high_water = queue->count;
+  }
+
+  return ULORAWAN_ERR_NONE;
+}
+
+struct ulorawan_uplink_msg *
+ulorawan_uplink_queue_peek(struct ulorawan_uplink_queue *const queue) {
+  if (queue->count == 0) {
+    return NULL;
+  }
+
+  return &queue->msgs[queue->order[0]];
+}
+
+void ulorawan_uplink_queue_pop(struct ulorawan_uplink_queue *const queue) {
+  if (queue->count == 0) {
+    return;
+  }
+
+  remove_at(queue, 0);
+  queue->stats.sent++;
+}
+
+void ulorawan_uplink_queue_drop(struct ulorawan_uplink_queue *const queue) {
+  if (queue->count == 0) {
+    return;
+  }
+
+  remove_at(queue, 0);
+  queue->stats.dropped_size++;
+}
+
+uint8_t ulorawan_uplink_queue_expire(struct ulorawan_uplink_queue *const queue,
+                                     uint32_t now) {
+  uint8_t dropped = 0;
+  uint8_t position = 0;
+
+  while (position < queue->count) {
+    const struct ulorawan_uplink_msg *msg =
+        &queue->msgs[queue->order[position]];
+
+    // The difference keeps the comparison valid across a clock wrap
+    if (msg->expires && (int32_t)(now - msg->expiry) >= 0) {
+      remove_at(queue, position);
+      dropped++;
+    } else {
+      position++;
+    }
+  }
+
+  queue->stats.dropped_expired += dropped;
+
+  return dropped;
+}
+
+uint8_t
+ulorawan_uplink_queue_count(const struct ulorawan_uplink_queue *const queue) {
+  return queue->count;
+}
@@ -0,0 +1,134 @@
+/**
+ * \file
+ *
+ * \brief The ulorawan uplink queue prototypes
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ULORAWAN_UPLINK_QUEUE_H_
+#define ULORAWAN_UPLINK_QUEUE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ulorawan_session.h"
+
+//! The priority of messages sent with ulorawan_send_frame
+#define ULORAWAN_UPLINK_PRIORITY_NORMAL 128
+
+//! An application message to queue
+struct ulorawan_uplink_req {
+  //! The application port
+  uint8_t port;
+  //! The payload
+  const uint8_t *payload;
+  //! The payload size
+  uint8_t size;
+  //! True for a confirmed uplink
+  bool confirm;
+  //! The priority, higher values are sent first
+  uint8_t priority;
+  //! The time in milliseconds the message stays valid, zero to never expire
+  uint32_t lifetime;
+};
+
+/**
+ * \brief Queue an application message.
+ *
+ * Messages are ordered by priority and then by arrival. When the queue is
+ * full the newest message of the lowest priority is dropped to make room
+ * for a message of higher priority.
+ *
+ * \param[in] queue The uplink queue.
+ * \param[in] req The message to queue.
+ * \param[in] now The current time in milliseconds.
+ *
+ * \return Operation status.
+ * \retval ULORAWAN_ERR_PARAMS The payload is too large.
+ * \retval ULORAWAN_ERR_FULL The queue is full of messages of equal or higher
+ * priority.
+ * \retval ULORAWAN_ERR_NONE Operation executed successfully.
+ */
+int32_t ulorawan_uplink_queue_push(struct ulorawan_uplink_queue *const queue,
+                                   const struct ulorawan_uplink_req *const req,
+                                   uint32_t now);
+
+/**
+ * \brief Get the next message to send.
+ *
+ * \param[in] queue The uplink queue.
+ *
+ * \return The message, NULL when the queue is empty.
+ */
+struct ulorawan_uplink_msg *
+ulorawan_uplink_queue_peek(struct ulorawan_uplink_queue *const queue);
+
+/**
+ * \brief Remove the next message once it has been sent.
+ *
+ * \param[in] queue The uplink queue.
+ */
+void ulorawan_uplink_queue_pop(struct ulorawan_uplink_queue *const queue);
+
+/**
+ * \brief Drop the next message because no data rate can carry it.
+ *
+ * \param[in] queue The uplink queue.
+ */
+void ulorawan_uplink_queue_drop(struct ulorawan_uplink_queue *const queue);
+
+/**
+ * \brief Drop the messages whose expiry time has passed.
+ *
+ * \param[in] queue The uplink queue.
+ * \param[in] now The current time in milliseconds.
+ *
+ * \return The number of messages dropped.
+ */
+uint8_t ulorawan_uplink_queue_expire(struct ulorawan_uplink_queue *const queue,
+                                     uint32_t now);
+
+/**
+ * \brief Get the number of queued messages.
+ *
+ * \param[in] queue The uplink queue.
+ *
+ * \return The number of messages.
+ */
+uint8_t
+ulorawan_uplink_queue_count(const struct ulorawan_uplink_queue *const queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULORAWAN_UPLINK_QUEUE_H_ */
@@ -0,0 +1,190 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+// Record the messages of info and above for this test
+#define LOG_HAL_DEFERRED
+#define LOG_HAL_LEVEL 2
+
+#include "unity.h"
+#include "log_hal.h"
+#include "log_hal_deferred.h"
+
+static uint32_t evaluated;
+
+static uint32_t argument(uint32_t value)
+{
+    evaluated++;
+    return value;
+}
+
+void setUp(void)
+{
+    evaluated = 0;
+    log_hal_deferred_init();
+}
+
+void tearDown(void) {}
+
+void test_log_hal_deferred_read_empty()
+{
+    // Arrange
+    struct log_hal_record record;
+
+    // Act
+    int32_t result = log_hal_deferred_read(&record);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT32(LOG_HAL_DEFERRED_ERR_EMPTY, result);
+}
+
+void test_log_hal_deferred_write_read()
+{
+    // Arrange
+    struct log_hal_record record;
+    char text[64];
+
+    log_hal_log_info("Uplink of [%u] bytes on port [%u]", 51, 2);
+
+    // Act
+    int32_t result = log_hal_deferred_read(&record);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT32(LOG_HAL_DEFERRED_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(LOG_HAL_INFO, record.level);
+    TEST_ASSERT_EQUAL_UINT8(2, record.nargs);
+    TEST_ASSERT_EQUAL_UINT32(51, record.args[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, record.args[1]);
+    TEST_ASSERT_EQUAL(32, log_hal_deferred_format(&record, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("Uplink of [51] bytes on port [2]", text);
+    TEST_ASSERT_EQUAL_INT32(LOG_HAL_DEFERRED_ERR_EMPTY,
+                            log_hal_deferred_read(&record));
+}
+
+void test_log_hal_deferred_format_arguments()
+{
+    // Arrange
+    struct log_hal_record record;
+    char text[64];
+
+    log_hal_log_error("Fixed");
+    log_hal_log_warn("[%i] [0x%04X] [%u] [0x%02X]", -20, 0xBEEF, 7, 0x3C);
+
+    // Act
+    log_hal_deferred_read(&record);
+    log_hal_deferred_format(&record, text, sizeof(text));
+    TEST_ASSERT_EQUAL_UINT8(0, record.nargs);
+    TEST_ASSERT_EQUAL_STRING("Fixed", text);
+
+    log_hal_deferred_read(&record);
+    log_hal_deferred_format(&record, text, sizeof(text));
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(LOG_HAL_WARN, record.level);
+    TEST_ASSERT_EQUAL_UINT8(4, record.nargs);
+    TEST_ASSERT_EQUAL_STRING("[-20] [0xBEEF] [7] [0x3C]", text);
+}
+
+void test_log_hal_deferred_level_filtered()
+{
+    // Arrange
+    struct log_hal_deferred_stats stats;
+    struct log_hal_record record;
+
+    // Act
+    log_hal_log_trace("Trace [%u]", argument(1));
+    log_hal_log_debug("Debug [%u]", argument(2));
+    log_hal_log_info("Info [%u]", argument(3));
+
+    // Assert
+    log_hal_deferred_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, evaluated);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.written);
+    TEST_ASSERT_EQUAL_INT32(LOG_HAL_DEFERRED_ERR_NONE,
+                            log_hal_deferred_read(&record));
+    TEST_ASSERT_EQUAL_UINT32(3, record.args[0]);
+}
+
+void test_log_hal_deferred_full_drops()
+{
+    // Arrange
+    struct log_hal_deferred_stats stats;
+    struct log_hal_record record;
+
+    for (uint32_t i = 0; i < LOG_HAL_DEFERRED_RING_SIZE + 3; i++) {
+        log_hal_log_info("Message [%u]", i);
+    }
+
+    // Act
+    log_hal_deferred_get_stats(&stats);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(LOG_HAL_DEFERRED_RING_SIZE, stats.written);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.dropped);
+
+    for (uint32_t i = 0; i < LOG_HAL_DEFERRED_RING_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT32(LOG_HAL_DEFERRED_ERR_NONE,
+                                log_hal_deferred_read(&record));
+        TEST_ASSERT_EQUAL_UINT32(i, record.args[0]);
+    }
+    TEST_ASSERT_EQUAL_INT32(LOG_HAL_DEFERRED_ERR_EMPTY,
+                            log_hal_deferred_read(&record));
+}
+
+void test_log_hal_deferred_wraps_in_order()
+{
+    // Arrange
+    struct log_hal_deferred_stats stats;
+    struct log_hal_record record;
+    uint32_t next = 0;
+
+    // Act
+    for (uint32_t i = 0; i < 5 * LOG_HAL_DEFERRED_RING_SIZE; i++) {
+        log_hal_log_info("Message [%u]", i);
+
+        if (i % 3 == 2) {
+            while (log_hal_deferred_read(&record) == LOG_HAL_DEFERRED_ERR_NONE) {
+                TEST_ASSERT_EQUAL_UINT32(next++, record.args[0]);
+            }
+        }
+    }
+
+    while (log_hal_deferred_read(&record) == LOG_HAL_DEFERRED_ERR_NONE) {
+        TEST_ASSERT_EQUAL_UINT32(next++, record.args[0]);
+    }
+
+    // Assert
+    log_hal_deferred_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(5 * LOG_HAL_DEFERRED_RING_SIZE, next);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+}
@@ -0,0 +1,199 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "nvm_hal.h"
+#include "nvm_hal_linux.h"
+#include "ulorawan_session.h"
+#include "ulorawan_store.h"
+#include "ulorawan_error_codes.h"
+
+TEST_FILE("log_console.c")
+
+#define DEVICE_SIZE                                                            \
+    (ULORAWAN_STORE_NVM_ADDRESS + ULORAWAN_STORE_SECTORS * NVM_HAL_SECTOR_SIZE)
+
+static char path[] = "/tmp/nvm_hal_linux_XXXXXX";
+static char file[sizeof(path)];
+
+void setUp(void)
+{
+    memcpy(file, path, sizeof(path));
+    close(mkstemp(file));
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_NONE, nvm_hal_linux_open(file, DEVICE_SIZE, 2));
+}
+
+void tearDown(void)
+{
+    nvm_hal_linux_close();
+    unlink(file);
+}
+
+void test_nvm_hal_linux_open_erased()
+{
+    // Arrange
+    const uint8_t erased[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t buf[4];
+    uint16_t nonce = 1;
+
+    // Act
+    int32_t result = nvm_hal_read(DEVICE_SIZE - sizeof(buf), buf, sizeof(buf));
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(erased, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_NONE, nvm_hal_read_join_nonce(&nonce));
+    TEST_ASSERT_EQUAL_UINT16(0, nonce);
+}
+
+void test_nvm_hal_linux_out_of_range()
+{
+    // Arrange
+    uint8_t buf[4];
+
+    // Act
+    int32_t result = nvm_hal_read(DEVICE_SIZE - 2, buf, sizeof(buf));
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_FAIL, result);
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_FAIL, nvm_hal_erase(100));
+}
+
+void test_nvm_hal_linux_program_clears_bits()
+{
+    // Arrange
+    const uint8_t first = 0x0F;
+    const uint8_t second = 0x07;
+    const uint8_t invalid = 0xF0;
+    struct nvm_hal_linux_stats stats;
+    uint8_t value;
+
+    // Act
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_NONE, nvm_hal_write(10, &first, 1));
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_NONE, nvm_hal_write(10, &second, 1));
+    int32_t result = nvm_hal_write(10, &invalid, 1);
+
+    // Assert
+    nvm_hal_read(10, &value, 1);
+    nvm_hal_linux_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_FAIL, result);
+    TEST_ASSERT_EQUAL_HEX8(0x07, value);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.writes);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.program_errors);
+}
+
+void test_nvm_hal_linux_erase_persisted()
+{
+    // Arrange
+    const uint8_t zero = 0x00;
+    uint8_t value;
+    nvm_hal_write(NVM_HAL_SECTOR_SIZE, &zero, 1);
+    nvm_hal_write(0, &zero, 1);
+
+    // Act
+    int32_t result = nvm_hal_erase(NVM_HAL_SECTOR_SIZE);
+    nvm_hal_erase(NVM_HAL_SECTOR_SIZE);
+    nvm_hal_linux_close();
+    nvm_hal_linux_open(file, DEVICE_SIZE, 2);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_NONE, result);
+    nvm_hal_read(NVM_HAL_SECTOR_SIZE, &value, 1);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, value);
+    nvm_hal_read(0, &value, 1);
+    TEST_ASSERT_EQUAL_HEX8(0x00, value);
+    TEST_ASSERT_EQUAL_UINT32(2, nvm_hal_linux_erase_count(1));
+    TEST_ASSERT_EQUAL_UINT32(0, nvm_hal_linux_erase_count(0));
+}
+
+void test_nvm_hal_linux_devices_independent()
+{
+    // Arrange
+    const uint8_t zero = 0x00;
+    uint8_t value;
+    nvm_hal_write(0, &zero, 1);
+    nvm_hal_write_join_nonce(7);
+
+    // Act
+    int32_t result = nvm_hal_linux_select(1);
+
+    // Assert
+    uint16_t nonce;
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_NONE, result);
+    nvm_hal_read(0, &value, 1);
+    nvm_hal_read_join_nonce(&nonce);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, value);
+    TEST_ASSERT_EQUAL_UINT16(0, nonce);
+    TEST_ASSERT_EQUAL_INT32(NVM_HAL_ERR_FAIL, nvm_hal_linux_select(2));
+}
+
+void test_nvm_hal_linux_store_soak()
+{
+    // Arrange
+    static struct ulorawan_session session;
+    struct nvm_hal_linux_stats stats;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+
+    memset(&session, 0, sizeof(session));
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, ulorawan_store_init(&session.store));
+
+    // Act
+    for (uint32_t fcnt = 1; fcnt <= 8000; fcnt++)
+    {
+        session.keys.fcnt_down = fcnt;
+        TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, ulorawan_store_save_session(&session));
+    }
+
+    // Assert
+    nvm_hal_linux_get_stats(&stats);
+    for (uint32_t sector = 0; sector < ULORAWAN_STORE_SECTORS; sector++)
+    {
+        uint32_t count = nvm_hal_linux_erase_count(
+            (ULORAWAN_STORE_NVM_ADDRESS / NVM_HAL_SECTOR_SIZE) + sector);
+        min = count < min ? count : min;
+        max = count > max ? count : max;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, stats.program_errors);
+    TEST_ASSERT_TRUE(stats.erases >= 15);
+    TEST_ASSERT_TRUE(max - min <= 1);
+    TEST_ASSERT_TRUE(stats.bytes_written < 8000 * 16);
+
+    memset(&session, 0, sizeof(session));
+    ulorawan_store_init(&session.store);
+    ulorawan_store_load_session(&session);
+    TEST_ASSERT_EQUAL_UINT32(8000, session.keys.fcnt_down);
+}
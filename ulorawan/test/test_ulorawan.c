@@ -41,17 +41,45 @@
 #include "mock_radio_hal.h"
 #include "mock_crypto_hal.h"
 #include "mock_osal_queue.h"
+#include "mock_ulorawan_adr.h"
+#include "mock_ulorawan_aggregate.h"
+#include "mock_ulorawan_class_b.h"
+#include "mock_ulorawan_class_c.h"
+#include "mock_ulorawan_energy.h"
 #include "mock_ulorawan_mac.h"
 #include "mock_ulorawan_irq.h"
+#include "mock_ulorawan_latency.h"
+#include "mock_ulorawan_lbt.h"
+#include "mock_ulorawan_fcnt.h"
+#include "mock_ulorawan_frag.h"
+#include "mock_ulorawan_multicast.h"
 #include "mock_ulorawan_region.h"
+#include "mock_ulorawan_snapshot.h"
+#include "mock_ulorawan_store.h"
+#include "mock_ulorawan_uplink.h"
+#include "mock_ulorawan_uplink_queue.h"
+#include "mock_timer_hal.h"
 
 TEST_FILE("log_console.c")
 
 static struct ulorawan_device_security device_security;
 
-static void ulorawan_task_timer_expire(enum ulorawan_state state, enum timer_hal_timer timer);
+static void ulorawan_task_timer_expire(enum ulorawan_state state, enum timer_hal_timer timer,
+                                       uint32_t frequency);
 
-void setUp(void) {}
+void setUp(void)
+{
+    // The latency instrumentation is covered by its own tests
+    ulorawan_latency_reset_Ignore();
+    ulorawan_latency_enqueue_Ignore();
+    ulorawan_latency_dequeue_Ignore();
+    ulorawan_latency_step_Ignore();
+    // So is the energy meter
+    ulorawan_energy_reset_Ignore();
+    ulorawan_energy_mode_Ignore();
+    ulorawan_energy_irq_Ignore();
+    ulorawan_energy_step_Ignore();
+}
 
 void tearDown(void) {}
 
@@ -112,6 +140,25 @@ void test_ulorawan_init_error_region()
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, ulorawan_get_session()->state);
 }
 
+void test_ulorawan_init_error_store()
+{
+    // Arrange
+    osal_queue_create_ExpectAnyArgsAndReturn(OSAL_QUEUE_ERR_NONE);
+
+    radio_hal_set_mode_ExpectAndReturn(MODE_SLEEP, RADIO_HAL_ERR_NONE);
+
+    ulorawan_region_init_params_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+
+    ulorawan_store_init_ExpectAndReturn(&ulorawan_get_session()->store, ULORAWAN_ERR_NVM);
+
+    // Act
+    uint32_t result = ulorawan_init(DEVICE_CLASS_A, device_security);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NVM, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, ulorawan_get_session()->state);
+}
+
 void test_ulorawan_init_success()
 {
     // Arrange
@@ -121,6 +168,10 @@ void test_ulorawan_init_success()
 
     ulorawan_region_init_params_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
 
+    ulorawan_store_init_ExpectAndReturn(&ulorawan_get_session()->store, ULORAWAN_ERR_NONE);
+    ulorawan_store_load_session_ExpectAndReturn(ulorawan_get_session(), ULORAWAN_ERR_NONE);
+    ulorawan_fcnt_restore_ExpectAndReturn(ulorawan_get_session(), ULORAWAN_ERR_NONE);
+
     // Act
     uint32_t result = ulorawan_init(DEVICE_CLASS_B, device_security);
 
@@ -129,6 +180,7 @@ void test_ulorawan_init_success()
     
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
     TEST_ASSERT_EQUAL_HEX8(DEVICE_CLASS_B, session_ptr->class);
+    TEST_ASSERT_EQUAL_UINT16(ULORAWAN_FCNT_RESERVE, session_ptr->fcnt.block);
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, ulorawan_get_session()->state);
 }
 
@@ -168,7 +220,7 @@ void test_ulorawan_join_error_nochannel()
 
     struct ulorawan_channel channel;
 
-    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_FAIL);
+    ulorawan_region_get_join_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_FAIL);
 
     // Act
     uint32_t result = ulorawan_join();
@@ -185,7 +237,7 @@ void test_ulorawan_join_error_nonce()
     session_ptr->security.type = ACTIVATION_OTAA;
 
     struct ulorawan_channel channel;
-    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_get_join_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
 
     uint16_t nonce;
     nvm_hal_read_join_nonce_ExpectAnyArgsAndReturn(NVM_HAL_ERR_FAIL);
@@ -205,7 +257,7 @@ void test_ulorawan_join_error_mhdr()
     session_ptr->security.type = ACTIVATION_OTAA;
 
     struct ulorawan_channel channel;
-    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_get_join_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
 
     uint16_t nonce;
     nvm_hal_read_join_nonce_ExpectAnyArgsAndReturn(NVM_HAL_ERR_NONE);
@@ -227,7 +279,7 @@ void test_ulorawan_join_error_join_req()
     session_ptr->security.type = ACTIVATION_OTAA;
 
     struct ulorawan_channel channel;
-    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_get_join_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
 
     uint16_t nonce;
     nvm_hal_read_join_nonce_ExpectAnyArgsAndReturn(NVM_HAL_ERR_NONE);
@@ -251,7 +303,7 @@ void test_ulorawan_join_cmac_error()
     session_ptr->security.type = ACTIVATION_OTAA;
 
     struct ulorawan_channel channel;
-    ulorawan_region_get_channel_IgnoreAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_get_join_channel_IgnoreAndReturn(ULORAWAN_REGION_ERR_NONE);
 
     uint16_t nonce;
     nvm_hal_read_join_nonce_ExpectAnyArgsAndReturn(NVM_HAL_ERR_NONE);
@@ -269,6 +321,465 @@ void test_ulorawan_join_cmac_error()
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_CTX, result);
 }
 
+void test_ulorawan_send_frame_error_init()
+{
+    // Arrange
+    const uint8_t payload[] = {0x01};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_INIT;
+
+    // Act
+    uint32_t result = ulorawan_send_frame(1, payload, sizeof(payload), false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_INIT, result);
+}
+
+void test_ulorawan_send_frame_error_port()
+{
+    // Arrange
+    const uint8_t payload[] = {0x01};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    // Act
+    uint32_t result_low = ulorawan_send_frame(0, payload, sizeof(payload), false);
+    uint32_t result_high = ulorawan_send_frame(224, payload, sizeof(payload), false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result_low);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result_high);
+}
+
+void test_ulorawan_send_frame_success()
+{
+    // Arrange
+    const uint8_t payload[] = {0x01, 0x02};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    timer_hal_get_time_ExpectAndReturn(500);
+    ulorawan_uplink_queue_push_ExpectAndReturn(&session_ptr->uplink_queue, NULL,
+        500, ULORAWAN_ERR_NONE);
+    ulorawan_uplink_queue_push_IgnoreArg_req();
+
+    // Act
+    uint32_t result = ulorawan_send_frame(1, payload, sizeof(payload), true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_send_frame_priority_full()
+{
+    // Arrange
+    const uint8_t payload[] = {0x01, 0x02};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    timer_hal_get_time_ExpectAndReturn(500);
+    ulorawan_uplink_queue_push_ExpectAnyArgsAndReturn(ULORAWAN_ERR_FULL);
+
+    // Act
+    uint32_t result = ulorawan_send_frame_priority(1, payload, sizeof(payload),
+        false, 10, 60000);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FULL, result);
+}
+
+void test_ulorawan_set_aggregation_error_port()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    // Act
+    uint32_t result = ulorawan_set_aggregation(224, 40, 60000);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_send_record_success()
+{
+    // Arrange
+    const uint8_t record[] = {0x01, 0x02};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    timer_hal_get_time_ExpectAndReturn(500);
+    ulorawan_aggregate_add_ExpectAndReturn(session_ptr, record, sizeof(record),
+        500, ULORAWAN_ERR_NONE);
+
+    // Act
+    uint32_t result = ulorawan_send_record(record, sizeof(record));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_start_class_b_success()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_class_c_stop_ExpectAndReturn(session_ptr, ULORAWAN_ERR_NONE);
+    ulorawan_class_b_start_ExpectAndReturn(session_ptr, 4, ULORAWAN_ERR_NONE);
+
+    // Act
+    uint32_t result = ulorawan_start_class_b(4);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_add_multicast_error_class()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.class = DEVICE_CLASS_A};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    // Act
+    uint32_t result = ulorawan_add_multicast(&group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_add_multicast_error_class_c_frequency()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.class = DEVICE_CLASS_C,
+                                             .frequency = 869100000};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_RXC;
+    session_ptr->region_params.rx2_frequency = 869525000;
+
+    // Act
+    uint32_t result = ulorawan_add_multicast(&group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_add_multicast_error_class_c_dr()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.class = DEVICE_CLASS_C,
+                                             .frequency = 869525000,
+                                             .dr = 3};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_RXC;
+    session_ptr->region_params.rx2_frequency = 869525000;
+    session_ptr->region_params.rx2_dr = 0;
+
+    // Act
+    uint32_t result = ulorawan_add_multicast(&group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_add_multicast_class_c_success()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.class = DEVICE_CLASS_C,
+                                             .frequency = 869525000};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_RXC;
+    session_ptr->region_params.rx2_frequency = 869525000;
+    session_ptr->region_params.rx2_dr = 0;
+
+    ulorawan_multicast_add_ExpectAndReturn(&session_ptr->multicast, &group,
+                                           ULORAWAN_ERR_NONE);
+
+    // Act
+    uint32_t result = ulorawan_add_multicast(&group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_add_multicast_error_class_b_dr()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.class = DEVICE_CLASS_B,
+                                             .frequency = 869100000,
+                                             .dr = 15,
+                                             .periodicity = 5};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_region_get_dr_ExpectAndReturn(&session_ptr->region_params, 15,
+                                           NULL);
+
+    // Act
+    uint32_t result = ulorawan_add_multicast(&group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_add_multicast_class_b_success()
+{
+    // Arrange
+    struct ulorawan_region_dr dr = {0};
+    struct ulorawan_multicast_group group = {.class = DEVICE_CLASS_B,
+                                             .frequency = 869100000,
+                                             .dr = 3,
+                                             .periodicity = 5};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_region_get_dr_ExpectAndReturn(&session_ptr->region_params, 3, &dr);
+    ulorawan_multicast_add_ExpectAndReturn(&session_ptr->multicast, &group,
+                                           ULORAWAN_ERR_NONE);
+
+    // Act
+    uint32_t result = ulorawan_add_multicast(&group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_remove_multicast_stops_class_c()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_RXC;
+
+    ulorawan_multicast_remove_ExpectAndReturn(&session_ptr->multicast,
+                                              0x01000010, ULORAWAN_ERR_NONE);
+    ulorawan_class_c_stop_ExpectAndReturn(session_ptr, ULORAWAN_ERR_NONE);
+
+    // Act
+    uint32_t result = ulorawan_remove_multicast(0x01000010);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_get_frag_block_incomplete()
+{
+    // Arrange
+    uint32_t size = 1;
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+    ulorawan_frag_block_size_ExpectAndReturn(&session_ptr->frag, 0);
+
+    // Act
+    int32_t result = ulorawan_get_frag_block(&size);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_STATE, result);
+    TEST_ASSERT_EQUAL_UINT32(0, size);
+}
+
+void test_ulorawan_save_snapshot_error_state()
+{
+    // Arrange
+    uint8_t buf[8];
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_TX;
+
+    // Act
+    int32_t result = ulorawan_save_snapshot(buf, sizeof(buf));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_STATE, result);
+}
+
+void test_ulorawan_restore_snapshot_success()
+{
+    // Arrange
+    const uint8_t buf[8] = {0};
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+    ulorawan_snapshot_restore_ExpectAndReturn(session_ptr, buf, sizeof(buf), ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_restore_snapshot(buf, sizeof(buf));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_set_fcnt_reserve_error_params()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    // Act
+    int32_t result = ulorawan_set_fcnt_reserve(0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_set_adr_error_init()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_INIT;
+
+    // Act
+    uint32_t result = ulorawan_set_adr(true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_INIT, result);
+}
+
+void test_ulorawan_set_adr_success()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_adr_set_enabled_Expect(session_ptr, true);
+
+    // Act
+    uint32_t result = ulorawan_set_adr(true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_get_latency_error_params()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    // Act
+    int32_t result = ulorawan_get_latency(ULORAWAN_STATE_TX, ULORAWAN_STATE_RX1, NULL);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_get_latency_success()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    struct ulorawan_latency_histogram found = {.count = 3, .total = 4500, .max = 1502};
+    struct ulorawan_latency_histogram histogram;
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_latency_find_ExpectAndReturn(&session_ptr->latency, ULORAWAN_STATE_TX,
+                                          ULORAWAN_STATE_RX1, &found);
+
+    // Act
+    int32_t result = ulorawan_get_latency(ULORAWAN_STATE_TX, ULORAWAN_STATE_RX1, &histogram);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(3, histogram.count);
+    TEST_ASSERT_EQUAL_UINT32(1502, histogram.max);
+}
+
+void test_ulorawan_get_latency_not_seen()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    struct ulorawan_latency_histogram histogram = {.count = 1, .max = 1};
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_latency_find_ExpectAndReturn(&session_ptr->latency, ULORAWAN_STATE_RX2,
+                                          ULORAWAN_STATE_IDLE, NULL);
+
+    // Act
+    int32_t result = ulorawan_get_latency(ULORAWAN_STATE_RX2, ULORAWAN_STATE_IDLE, &histogram);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.count);
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.max);
+}
+
+void test_ulorawan_dump_latency_success()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    char buf[32];
+    size_t length;
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_latency_dump_ExpectAndReturn(&session_ptr->latency, buf, sizeof(buf), 120);
+
+    // Act
+    int32_t result = ulorawan_dump_latency(buf, sizeof(buf), &length);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(120, length);
+}
+
+void test_ulorawan_set_radio_current_error_params()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    // Act
+    int32_t result = ulorawan_set_radio_current(ULORAWAN_ENERGY_MODES, 1000);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_set_radio_current_success()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    ulorawan_energy_update_Expect(&session_ptr->energy);
+
+    // Act
+    int32_t result = ulorawan_set_radio_current(MODE_TX, 40000);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(40000, session_ptr->energy.current[MODE_TX]);
+}
+
+void test_ulorawan_get_energy_error_params()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+
+    // Act
+    int32_t result = ulorawan_get_energy(NULL);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_get_energy_success()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    struct ulorawan_energy energy;
+    session_ptr->state = ULORAWAN_STATE_IDLE;
+    session_ptr->energy.charge = 4000000;
+    session_ptr->energy.uplink.count = 2;
+
+    ulorawan_energy_update_Expect(&session_ptr->energy);
+
+    // Act
+    int32_t result = ulorawan_get_energy(&energy);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT64(4000000, energy.charge);
+    TEST_ASSERT_EQUAL_UINT32(2, energy.uplink.count);
+}
+
 void test_ulorawan_radio_irq_error_init()
 {
     // Arrange
@@ -331,12 +842,59 @@ void test_ulorawan_task_error_queue()
 
 void test_ulorawan_task_timer_expire_timer0()
 {
-    ulorawan_task_timer_expire(ULORAWAN_STATE_RX1, TIMER0);
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->channel.rx1_frequency = 868100000;
+
+    ulorawan_task_timer_expire(ULORAWAN_STATE_RX1, TIMER0, 868100000);
+}
+
+void test_ulorawan_task_timer_expire_timer0_class_c()
+{
+    // Class C listens on the RX2 frequency until RX1 opens
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->class = DEVICE_CLASS_C;
+    session_ptr->channel.rx1_frequency = 923300000;
+    session_ptr->region_params.rx2_frequency = 923300000 + 600000;
+
+    ulorawan_task_timer_expire(ULORAWAN_STATE_RX1, TIMER0, 923300000);
+
+    session_ptr->class = DEVICE_CLASS_A;
 }
 
 void test_ulorawan_task_timer_expire_timer1()
 {
-    ulorawan_task_timer_expire(ULORAWAN_STATE_RX2, TIMER1);
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->region_params.rx2_frequency = 869525000;
+
+    ulorawan_task_timer_expire(ULORAWAN_STATE_RX2, TIMER1, 869525000);
+}
+
+void test_ulorawan_task_timer_expire_cad_backoff()
+{
+    // Arrange
+    struct ulorawan_session *session_ptr = ulorawan_get_session();
+    session_ptr->state = ULORAWAN_STATE_CAD;
+
+    struct ulorawan_event event;
+    event.type = EVENT_TYPE_TIMER_EXPIRE;
+    event.data.timer = TIMER0;
+
+    osal_queue_empty_IgnoreAndReturn(false);
+    osal_queue_empty_IgnoreAndReturn(true);
+
+    osal_queue_receive_ExpectAnyArgsAndReturn(OSAL_QUEUE_ERR_NONE);
+
+    osal_queue_receive_ReturnMemThruPtr_data(&event, sizeof(struct ulorawan_event ));
+
+    osal_queue_receive_IgnoreArg_queue();
+
+    ulorawan_lbt_backoff_expired_ExpectAndReturn(session_ptr, ULORAWAN_ERR_NONE);
+
+    // Act
+    uint32_t result = ulorawan_task();
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
 }
 
 void test_ulorawan_task_radio_irq()
@@ -358,6 +916,9 @@ void test_ulorawan_task_radio_irq()
     osal_queue_receive_IgnoreArg_queue();
 
     ulorawan_radio_irq_handler_ExpectAnyArgsAndReturn(ULORAWAN_ERR_NONE);
+    ulorawan_store_save_session_ExpectAndReturn(session_ptr, ULORAWAN_ERR_NONE);
+    ulorawan_uplink_dispatch_ExpectAndReturn(session_ptr, ULORAWAN_ERR_NONE);
+    ulorawan_class_c_start_ExpectAndReturn(session_ptr, ULORAWAN_ERR_NONE);
 
     // Act
     uint32_t result = ulorawan_task();
@@ -421,7 +982,8 @@ void test_ulorawan_version()
     TEST_ASSERT_EQUAL_HEX8(0, v.fields.revision);
 }
 
-void ulorawan_task_timer_expire(enum ulorawan_state state, enum timer_hal_timer timer)
+void ulorawan_task_timer_expire(enum ulorawan_state state, enum timer_hal_timer timer,
+                                uint32_t frequency)
 {
     // Arrange
     struct ulorawan_session *session_ptr = ulorawan_get_session();
@@ -440,6 +1002,7 @@ void ulorawan_task_timer_expire(enum ulorawan_state state, enum timer_hal_timer
     
     osal_queue_receive_IgnoreArg_queue();
 
+    radio_hal_set_frequency_ExpectAndReturn(frequency, RADIO_HAL_ERR_NONE);
     radio_hal_set_mode_ExpectAndReturn(MODE_RX_SINGLE, RADIO_HAL_ERR_NONE);
 
     // Act
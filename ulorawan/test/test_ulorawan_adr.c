@@ -0,0 +1,345 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_adr.h"
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_duty_cycle.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_region.h"
+#include "ulorawan_region_tables.h"
+#include "ulorawan_session.h"
+#include "ulorawan_tx.h"
+
+#include "mock_radio_hal.h"
+#include "mock_rand_hal.h"
+#include "mock_timer_hal.h"
+#include "mock_ulorawan_energy.h"
+#include "mock_ulorawan_lbt.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+static void send_uplinks(uint16_t count, union ulorawan_mac_fctrl *fctrl)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        ulorawan_adr_uplink(&session, fctrl);
+    }
+}
+
+static struct ulorawan_mac_link_adr_req link_adr_req(uint8_t dr,
+    uint8_t tx_power, uint16_t ch_mask, uint8_t cntl, uint8_t nbtrans)
+{
+    struct ulorawan_mac_link_adr_req req;
+
+    req.dr_tx_power.bits.data_rate = dr;
+    req.dr_tx_power.bits.tx_power = tx_power;
+    req.ch_mask = ch_mask;
+    req.redundancy.value = 0;
+    req.redundancy.bits.ch_mask_ctl = cntl;
+    req.redundancy.bits.nbtrans = nbtrans;
+
+    return req;
+}
+
+void setUp(void)
+{
+    timer_hal_get_time_IgnoreAndReturn(0);
+
+    memset(&session, 0, sizeof(session));
+    ulorawan_region_select(&session.region_params, REGION_EU868);
+    session.adr.nb_trans = 1;
+    ulorawan_adr_set_enabled(&session, true);
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_adr_uplink_disabled()
+{
+    // Arrange
+    union ulorawan_mac_fctrl fctrl = {0};
+
+    ulorawan_adr_set_enabled(&session, false);
+
+    // Act
+    send_uplinks(ULORAWAN_ADR_ACK_LIMIT, &fctrl);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, fctrl.bits.adr);
+    TEST_ASSERT_EQUAL_UINT8(0, fctrl.bits.adr_ack_req);
+    TEST_ASSERT_EQUAL_UINT16(0, session.adr.ack_cnt);
+}
+
+void test_ulorawan_adr_uplink_ack_req()
+{
+    // Arrange
+    union ulorawan_mac_fctrl fctrl = {0};
+
+    // Act
+    send_uplinks(ULORAWAN_ADR_ACK_LIMIT - 1, &fctrl);
+    uint8_t before = fctrl.bits.adr_ack_req;
+    send_uplinks(1, &fctrl);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, fctrl.bits.adr);
+    TEST_ASSERT_EQUAL_UINT8(0, before);
+    TEST_ASSERT_EQUAL_UINT8(1, fctrl.bits.adr_ack_req);
+}
+
+void test_ulorawan_adr_downlink_resets()
+{
+    // Arrange
+    union ulorawan_mac_fctrl fctrl = {0};
+
+    send_uplinks(ULORAWAN_ADR_ACK_LIMIT, &fctrl);
+
+    // Act
+    ulorawan_adr_downlink(&session);
+    send_uplinks(1, &fctrl);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT16(1, session.adr.ack_cnt);
+    TEST_ASSERT_EQUAL_UINT8(0, fctrl.bits.adr_ack_req);
+}
+
+void test_ulorawan_adr_uplink_backoff_power_then_dr()
+{
+    // Arrange
+    union ulorawan_mac_fctrl fctrl = {0};
+
+    session.region_params.data_rate = DR_5;
+    session.region_params.tx_power = 3;
+
+    // Act
+    send_uplinks(ULORAWAN_ADR_ACK_LIMIT + ULORAWAN_ADR_ACK_DELAY - 1, &fctrl);
+    uint8_t power_before = session.region_params.tx_power;
+    send_uplinks(1, &fctrl);
+    uint8_t power_after = session.region_params.tx_power;
+    uint8_t dr_after_power = session.region_params.data_rate;
+    send_uplinks(ULORAWAN_ADR_ACK_DELAY, &fctrl);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(3, power_before);
+    TEST_ASSERT_EQUAL_UINT8(0, power_after);
+    TEST_ASSERT_EQUAL_UINT8(DR_5, dr_after_power);
+    TEST_ASSERT_EQUAL_UINT8(DR_4, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_UINT8(1, fctrl.bits.adr_ack_req);
+}
+
+void test_ulorawan_adr_uplink_backoff_next_uplink()
+{
+    // Arrange
+    union ulorawan_mac_fctrl fctrl = {0};
+    struct radio_hal_tx_config config = {MODULATION_LORA, SPREAD_FACTOR_7,
+                                         BW_125, 16};
+
+    session.region_params.data_rate = DR_5;
+    session.region_params.tx_power = 3;
+    session.channel.frequency = 868100000;
+    send_uplinks(ULORAWAN_ADR_ACK_LIMIT + ULORAWAN_ADR_ACK_DELAY, &fctrl);
+    session.retrans.dr = session.region_params.data_rate;
+
+    radio_hal_set_frequency_ExpectAndReturn(868100000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_tx_config_ExpectAndReturn(&config, RADIO_HAL_ERR_NONE);
+    ulorawan_lbt_start_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_tx_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_adr_uplink_backoff_default_channels()
+{
+    // Arrange
+    union ulorawan_mac_fctrl fctrl = {0};
+    struct ulorawan_channel_mask mask = {{0x01}};
+
+    session.region_params.data_rate = DR_0;
+    session.adr.nb_trans = 3;
+    ulorawan_region_set_chmask(&session.region_params, &mask);
+
+    // Act
+    send_uplinks(ULORAWAN_ADR_ACK_LIMIT + ULORAWAN_ADR_ACK_DELAY, &fctrl);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX32(0x07, session.region_params.plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_UINT8(1, session.adr.nb_trans);
+    TEST_ASSERT_EQUAL_UINT16(0, session.adr.ack_cnt);
+    TEST_ASSERT_EQUAL_UINT8(0, fctrl.bits.adr_ack_req);
+}
+
+void test_ulorawan_adr_link_adr_req_success()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req req = link_adr_req(DR_5, 2, 0x0003, 0, 3);
+
+    // Act
+    union ulorawan_mac_adr_ans ans = ulorawan_adr_link_adr_req(&session, &req, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(0x07, ans.value);
+    TEST_ASSERT_EQUAL_UINT8(DR_5, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_UINT8(2, session.region_params.tx_power);
+    TEST_ASSERT_EQUAL_HEX32(0x03, session.region_params.plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, session.adr.nb_trans);
+}
+
+void test_ulorawan_adr_link_adr_req_next_uplink()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req req = link_adr_req(DR_3, 2, 0x0003, 0, 1);
+    struct radio_hal_tx_config config = {MODULATION_LORA, SPREAD_FACTOR_9,
+                                         BW_125, 12};
+
+    session.channel.frequency = 868300000;
+    ulorawan_adr_link_adr_req(&session, &req, 1);
+    session.retrans.dr = session.region_params.data_rate;
+
+    radio_hal_set_frequency_ExpectAndReturn(868300000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_tx_config_ExpectAndReturn(&config, RADIO_HAL_ERR_NONE);
+    ulorawan_lbt_start_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_tx_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_adr_link_adr_req_keep_current()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req req = link_adr_req(0x0F, 0x0F, 0x0007, 0, 0);
+
+    session.region_params.data_rate = DR_3;
+    session.region_params.tx_power = 1;
+    session.adr.nb_trans = 2;
+
+    // Act
+    union ulorawan_mac_adr_ans ans = ulorawan_adr_link_adr_req(&session, &req, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(0x07, ans.value);
+    TEST_ASSERT_EQUAL_UINT8(DR_3, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_UINT8(1, session.region_params.tx_power);
+    TEST_ASSERT_EQUAL_UINT8(2, session.adr.nb_trans);
+}
+
+void test_ulorawan_adr_link_adr_req_undefined_channel()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req req = link_adr_req(DR_5, 2, 0x0008, 0, 1);
+
+    // Act
+    union ulorawan_mac_adr_ans ans = ulorawan_adr_link_adr_req(&session, &req, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(0x04, ans.value);
+    TEST_ASSERT_EQUAL_UINT8(DR_0, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_HEX32(0x07, session.region_params.plan.enabled.words[0]);
+}
+
+void test_ulorawan_adr_link_adr_req_invalid_power()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req req = link_adr_req(DR_5, 8, 0x0001, 0, 1);
+
+    // Act
+    union ulorawan_mac_adr_ans ans = ulorawan_adr_link_adr_req(&session, &req, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(0x03, ans.value);
+    TEST_ASSERT_EQUAL_UINT8(DR_0, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_HEX32(0x07, session.region_params.plan.enabled.words[0]);
+}
+
+void test_ulorawan_adr_link_adr_req_invalid_dr()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req req = link_adr_req(DR_7, 2, 0x0007, 0, 1);
+
+    // Act
+    union ulorawan_mac_adr_ans ans = ulorawan_adr_link_adr_req(&session, &req, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(0x05, ans.value);
+    TEST_ASSERT_EQUAL_UINT8(0, session.region_params.tx_power);
+}
+
+void test_ulorawan_adr_link_adr_req_block()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req reqs[] = {
+        link_adr_req(DR_0, 0, 0x0000, 7, 1),
+        link_adr_req(DR_3, 4, 0xFF00, 0, 2)};
+
+    ulorawan_region_select(&session.region_params, REGION_US915);
+
+    // Act
+    union ulorawan_mac_adr_ans ans = ulorawan_adr_link_adr_req(&session, reqs, 2);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(0x07, ans.value);
+    TEST_ASSERT_EQUAL_HEX32(0x0000FF00, session.region_params.plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0, session.region_params.plan.enabled.words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0, session.region_params.plan.enabled.words[2]);
+    TEST_ASSERT_EQUAL_UINT8(DR_3, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_UINT8(4, session.region_params.tx_power);
+    TEST_ASSERT_EQUAL_UINT8(2, session.adr.nb_trans);
+}
+
+void test_ulorawan_adr_link_adr_req_block_rejected()
+{
+    // Arrange
+    struct ulorawan_mac_link_adr_req reqs[] = {
+        link_adr_req(DR_3, 4, 0xFF00, 0, 2),
+        link_adr_req(DR_3, 4, 0x0000, 7, 2)};
+    struct ulorawan_channel_mask enabled;
+
+    ulorawan_region_select(&session.region_params, REGION_US915);
+    enabled = session.region_params.plan.enabled;
+
+    // Act
+    union ulorawan_mac_adr_ans ans = ulorawan_adr_link_adr_req(&session, reqs, 2);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(0x04, ans.value);
+    TEST_ASSERT_EQUAL_MEMORY(&enabled, &session.region_params.plan.enabled,
+        sizeof(enabled));
+    TEST_ASSERT_EQUAL_UINT8(DR_0, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_UINT8(1, session.adr.nb_trans);
+}
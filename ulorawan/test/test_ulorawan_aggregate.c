@@ -0,0 +1,173 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_aggregate.h"
+#include "ulorawan_uplink_queue.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_ulorawan_region.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+static const uint8_t record[] = {0x01, 0x02, 0x03};
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.region_params.data_rate = 0;
+    ulorawan_region_max_payload_IgnoreAndReturn(59);
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_aggregate_add_disabled()
+{
+    // Act
+    int32_t result = ulorawan_aggregate_add(&session, record, sizeof(record), 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_STATE, result);
+}
+
+void test_ulorawan_aggregate_add_too_large()
+{
+    // Arrange
+    uint8_t large[51] = {0};
+    ulorawan_aggregate_configure(&session, 10, 200, 1000);
+
+    // Act
+    int32_t result = ulorawan_aggregate_add(&session, large, sizeof(large), 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_UINT8(0, session.aggregate.count);
+}
+
+void test_ulorawan_aggregate_add_packs_records()
+{
+    // Arrange
+    const uint8_t expected[] = {0x03, 0x01, 0x02, 0x03, 0x01, 0x01};
+    ulorawan_aggregate_configure(&session, 10, 40, 1000);
+
+    // Act
+    ulorawan_aggregate_add(&session, record, sizeof(record), 100);
+    int32_t result = ulorawan_aggregate_add(&session, record, 1, 200);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(2, session.aggregate.count);
+    TEST_ASSERT_EQUAL_UINT32(100, session.aggregate.first);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, session.aggregate.buf, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_uplink_queue_count(&session.uplink_queue));
+}
+
+void test_ulorawan_aggregate_add_threshold()
+{
+    // Arrange
+    ulorawan_aggregate_configure(&session, 10, 8, 1000);
+
+    // Act
+    ulorawan_aggregate_add(&session, record, sizeof(record), 0);
+    int32_t result = ulorawan_aggregate_add(&session, record, sizeof(record), 0);
+
+    // Assert
+    struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&session.uplink_queue);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_NOT_NULL(msg);
+    TEST_ASSERT_EQUAL_UINT8(10, msg->port);
+    TEST_ASSERT_EQUAL_UINT8(8, msg->size);
+    TEST_ASSERT_EQUAL_UINT8(0, session.aggregate.count);
+    TEST_ASSERT_EQUAL_UINT32(2, session.aggregate.records);
+    TEST_ASSERT_EQUAL_UINT32(1, session.aggregate.flushes);
+}
+
+void test_ulorawan_aggregate_add_exceeds_data_rate()
+{
+    // Arrange
+    uint8_t large[30] = {0};
+    ulorawan_aggregate_configure(&session, 10, 200, 1000);
+    ulorawan_aggregate_add(&session, large, sizeof(large), 0);
+
+    // Act
+    int32_t result = ulorawan_aggregate_add(&session, large, sizeof(large), 10);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+    TEST_ASSERT_EQUAL_UINT8(31, ulorawan_uplink_queue_peek(&session.uplink_queue)->size);
+    TEST_ASSERT_EQUAL_UINT8(1, session.aggregate.count);
+    TEST_ASSERT_EQUAL_UINT32(10, session.aggregate.first);
+}
+
+void test_ulorawan_aggregate_poll_age()
+{
+    // Arrange
+    ulorawan_aggregate_configure(&session, 10, 200, 1000);
+    ulorawan_aggregate_add(&session, record, sizeof(record), 100);
+
+    // Act
+    uint32_t wait = ulorawan_aggregate_poll(&session, 600);
+    uint32_t due = ulorawan_aggregate_poll(&session, 1100);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(500, wait);
+    TEST_ASSERT_EQUAL_UINT32(0, due);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+    TEST_ASSERT_EQUAL_UINT8(0, session.aggregate.count);
+}
+
+void test_ulorawan_aggregate_flush_full_keeps_records()
+{
+    // Arrange
+    struct ulorawan_uplink_req req = {.port = 1, .payload = record,
+        .size = sizeof(record), .priority = 255};
+    for (uint8_t i = 0; i < ULORAWAN_UPLINK_QUEUE_DEPTH; i++)
+    {
+        ulorawan_uplink_queue_push(&session.uplink_queue, &req, 0);
+    }
+    ulorawan_aggregate_configure(&session, 10, 200, 1000);
+    ulorawan_aggregate_add(&session, record, sizeof(record), 0);
+
+    // Act
+    int32_t result = ulorawan_aggregate_flush(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FULL, result);
+    TEST_ASSERT_EQUAL_UINT8(1, session.aggregate.count);
+    TEST_ASSERT_EQUAL_UINT32(0, session.aggregate.flushes);
+}
@@ -0,0 +1,491 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "mock_rand_hal.h"
+#include "mock_timer_hal.h"
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_duty_cycle.h"
+#include "ulorawan_region.h"
+#include "ulorawan_region_tables.h"
+
+static struct ulorawan_channel_plan plan;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_ulorawan_channel_plan_init_dynamic()
+{
+    // Arrange
+
+    // Act
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX32(0x00000007, plan.defined.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0x00000007, plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, ulorawan_channel_plan_count(&plan, DR_0));
+    TEST_ASSERT_EQUAL_UINT8(3, ulorawan_channel_plan_count(&plan, DR_5));
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_channel_plan_count(&plan, DR_6));
+}
+
+void test_ulorawan_channel_plan_init_fixed()
+{
+    // Arrange
+
+    // Act
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, plan.enabled.words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0x000000FF, plan.enabled.words[2]);
+    TEST_ASSERT_EQUAL_UINT8(64, ulorawan_channel_plan_count(&plan, DR_0));
+    TEST_ASSERT_EQUAL_UINT8(8, ulorawan_channel_plan_count(&plan, DR_4));
+}
+
+void test_ulorawan_channel_plan_get_fixed()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_get(&plan, 65, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(904600000, channel.frequency);
+    TEST_ASSERT_EQUAL_UINT32(923900000, channel.rx1_frequency);
+    TEST_ASSERT_EQUAL_UINT8(DR_4, channel.min_dr);
+    TEST_ASSERT_EQUAL_UINT8(DR_4, channel.max_dr);
+}
+
+void test_ulorawan_channel_plan_get_undefined()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_get(&plan, 3, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_PARAM, result);
+}
+
+void test_ulorawan_channel_plan_set_channel()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result =
+        ulorawan_channel_plan_set(&plan, 5, 867100000, DR_0, DR_5);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000027, plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_UINT8(4, ulorawan_channel_plan_count(&plan, DR_0));
+    ulorawan_channel_plan_get(&plan, 5, &channel);
+    TEST_ASSERT_EQUAL_UINT32(867100000, channel.frequency);
+    TEST_ASSERT_EQUAL_UINT8(1, channel.band);
+}
+
+void test_ulorawan_channel_plan_remove_channel()
+{
+    // Arrange
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_set(&plan, 1, 0, 0, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000005, plan.defined.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0x00000005, plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, ulorawan_channel_plan_count(&plan, DR_0));
+}
+
+void test_ulorawan_channel_plan_set_channel_fixed()
+{
+    // Arrange
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Act
+    int32_t result =
+        ulorawan_channel_plan_set(&plan, 1, 903000000, DR_0, DR_3);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_PARAM, result);
+}
+
+void test_ulorawan_channel_plan_set_channel_out_of_band()
+{
+    // Arrange
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result =
+        ulorawan_channel_plan_set(&plan, 3, 915000000, DR_0, DR_5);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_PARAM, result);
+}
+
+void test_ulorawan_channel_plan_select_covers_all_channels()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+    uint8_t seen[ULORAWAN_CHANNEL_PLAN_MAX_CHANNELS];
+
+    memset(seen, 0, sizeof(seen));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Act
+    for (uint32_t random = 0; random < 64; random++) {
+        TEST_ASSERT_EQUAL_HEX8(
+            ULORAWAN_CHANNEL_PLAN_ERR_NONE,
+            ulorawan_channel_plan_select(&plan, DR_0, random, &channel));
+        seen[channel.index]++;
+    }
+
+    // Assert
+    for (uint8_t i = 0; i < 64; i++) {
+        TEST_ASSERT_EQUAL_UINT8(1, seen[i]);
+    }
+}
+
+void test_ulorawan_channel_plan_select_sparse_mask()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+    struct ulorawan_channel_mask mask;
+
+    memset(&mask, 0, sizeof(mask));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+    ulorawan_channel_plan_apply_chmask(&plan, &mask, 3, 0x8001);
+    ulorawan_channel_plan_set_enabled(&plan, &mask);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_select(&plan, DR_0, 3, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(63, channel.index);
+    TEST_ASSERT_EQUAL_UINT32(914900000, channel.frequency);
+}
+
+void test_ulorawan_channel_plan_select_data_rate_unsupported()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_select(&plan, DR_7, 0, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NO_CHANNEL, result);
+}
+
+void test_ulorawan_channel_plan_band_unavailable()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+    ulorawan_channel_plan_set(&plan, 3, 867100000, DR_0, DR_5);
+
+    // Act
+    ulorawan_channel_plan_set_band_available(&plan, 2, false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_channel_plan_count(&plan, DR_0));
+    TEST_ASSERT_EQUAL_HEX8(
+        ULORAWAN_CHANNEL_PLAN_ERR_NONE,
+        ulorawan_channel_plan_select(&plan, DR_0, 7, &channel));
+    TEST_ASSERT_EQUAL_UINT8(3, channel.index);
+
+    ulorawan_channel_plan_set_band_available(&plan, 2, true);
+    TEST_ASSERT_EQUAL_UINT8(4, ulorawan_channel_plan_count(&plan, DR_0));
+}
+
+void test_ulorawan_channel_plan_apply_chmask_all_on()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask;
+
+    memset(&mask, 0, sizeof(mask));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_apply_chmask(&plan, &mask, 6, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000007, mask.words[0]);
+}
+
+void test_ulorawan_channel_plan_apply_chmask_invalid_cntl()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_apply_chmask(&plan, &mask, 1, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_PARAM, result);
+}
+
+void test_ulorawan_channel_plan_set_enabled_empty()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask;
+
+    memset(&mask, 0, sizeof(mask));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_set_enabled(&plan, &mask);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_PARAM, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000007, plan.enabled.words[0]);
+}
+
+void test_ulorawan_channel_plan_validate_undefined()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask = {{0x00000009}};
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_validate(&plan, &mask);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_PARAM, result);
+}
+
+void test_ulorawan_channel_plan_supports_dr()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask_125k = {{0xFFFFFFFF, 0xFFFFFFFF, 0}};
+    struct ulorawan_channel_mask mask_500k = {{0, 0, 0x00000001}};
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Act & Assert
+    TEST_ASSERT_TRUE(ulorawan_channel_plan_supports_dr(&plan, &mask_125k, DR_3));
+    TEST_ASSERT_FALSE(ulorawan_channel_plan_supports_dr(&plan, &mask_125k, DR_4));
+    TEST_ASSERT_TRUE(ulorawan_channel_plan_supports_dr(&plan, &mask_500k, DR_4));
+    TEST_ASSERT_FALSE(ulorawan_channel_plan_supports_dr(&plan, &mask_500k,
+        ULORAWAN_CHANNEL_PLAN_MAX_DR));
+}
+
+void test_ulorawan_channel_plan_enable_defaults_dynamic()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask = {{0x00000008}};
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+    ulorawan_channel_plan_set(&plan, 3, 867100000, DR_0, DR_5);
+    ulorawan_channel_plan_set_enabled(&plan, &mask);
+
+    // Act
+    ulorawan_channel_plan_enable_defaults(&plan);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX32(0x0000000F, plan.enabled.words[0]);
+}
+
+void test_ulorawan_channel_plan_apply_chmask_sub_bands()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask;
+
+    memset(&mask, 0, sizeof(mask));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_apply_chmask(&plan, &mask, 5, 0x0082);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x0000FF00, mask.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0xFF000000, mask.words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0x00000082, mask.words[2]);
+}
+
+void test_ulorawan_channel_plan_apply_chmask_all_125khz_on()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask;
+
+    memset(&mask, 0, sizeof(mask));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_au915);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_apply_chmask(&plan, &mask, 6, 0x0001);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, mask.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, mask.words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0x00000001, mask.words[2]);
+}
+
+void test_ulorawan_channel_plan_apply_chmask_all_125khz_off()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+    mask = plan.enabled;
+
+    // Act
+    int32_t result = ulorawan_channel_plan_apply_chmask(&plan, &mask, 7, 0x00F0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, mask.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, mask.words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0x000000F0, mask.words[2]);
+}
+
+void test_ulorawan_channel_plan_apply_chmask_cn470_all_on()
+{
+    // Arrange
+    struct ulorawan_channel_mask mask;
+
+    memset(&mask, 0, sizeof(mask));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_cn470);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_apply_chmask(&plan, &mask, 6, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, mask.words[2]);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_PARAM,
+        ulorawan_channel_plan_apply_chmask(&plan, &mask, 7, 0));
+}
+
+void test_ulorawan_channel_plan_select_join_covers_sub_bands()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+    uint8_t narrow[ULORAWAN_CHANNEL_PLAN_MAX_SUB_BANDS];
+    uint8_t wide[ULORAWAN_CHANNEL_PLAN_MAX_SUB_BANDS];
+
+    memset(narrow, 0, sizeof(narrow));
+    memset(wide, 0, sizeof(wide));
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Act
+    for (uint8_t i = 0; i < 16; i++) {
+        TEST_ASSERT_EQUAL_HEX8(
+            ULORAWAN_CHANNEL_PLAN_ERR_NONE,
+            ulorawan_channel_plan_select_join(&plan, DR_0, 0x9E3779B9 * (i + 1),
+                                              &channel));
+
+        if (i % 2 == 0) {
+            TEST_ASSERT_TRUE(channel.index < 64);
+            narrow[channel.index / 8]++;
+        } else {
+            TEST_ASSERT_TRUE(channel.index >= 64);
+            wide[channel.index - 64]++;
+        }
+    }
+
+    // Assert
+    for (uint8_t i = 0; i < ULORAWAN_CHANNEL_PLAN_MAX_SUB_BANDS; i++) {
+        TEST_ASSERT_EQUAL_UINT8(1, narrow[i]);
+        TEST_ASSERT_EQUAL_UINT8(1, wide[i]);
+    }
+}
+
+void test_ulorawan_channel_plan_select_join_remembers_sub_band()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+    ulorawan_channel_plan_get(&plan, 69, &channel);
+    ulorawan_channel_plan_join_accepted(&plan, &channel);
+
+    // Act
+    ulorawan_channel_plan_select_join(&plan, DR_0, 12345, &channel);
+    uint8_t first = channel.index;
+    ulorawan_channel_plan_select_join(&plan, DR_0, 12345, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(5, first / 8);
+    TEST_ASSERT_EQUAL_UINT8(69, channel.index);
+    TEST_ASSERT_EQUAL_UINT8(2, plan.join_attempts);
+}
+
+void test_ulorawan_channel_plan_select_join_dynamic()
+{
+    // Arrange
+    struct ulorawan_channel channel;
+
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+
+    // Act
+    int32_t result = ulorawan_channel_plan_select_join(&plan, DR_0, 2, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_CHANNEL_PLAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(868500000, channel.frequency);
+}
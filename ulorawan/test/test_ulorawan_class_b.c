@@ -0,0 +1,499 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_class_b.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_region_tables.h"
+
+#include "mock_crypto_hal.h"
+#include "mock_radio_hal.h"
+#include "mock_timer_hal.h"
+#include "mock_ulorawan_cmds.h"
+#include "mock_ulorawan_downlink.h"
+#include "mock_ulorawan_energy.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+static const uint8_t beacon[] = {0x00, 0x00, 0x40, 0x42, 0x0F, 0x00, 0x6F, 0x0D,
+                                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                 0x00, 0x00};
+
+static const uint8_t rand_block[16] = {0x34, 0x12};
+
+static const uint8_t group_rand_block[16] = {0x10, 0x00};
+
+static size_t beacon_size;
+
+static void expect_beacon(const uint8_t *const buf, size_t size)
+{
+    beacon_size = size;
+
+    radio_hal_fifo_read_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_NONE);
+    radio_hal_fifo_read_ReturnMemThruPtr_buf(buf, size);
+    radio_hal_fifo_read_ReturnThruPtr_len(&beacon_size);
+}
+
+static void expect_ping_offset(const uint8_t *const block)
+{
+    crypto_hal_aes_encrypt_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_encrypt_ReturnMemThruPtr_out(block, 16);
+}
+
+static void tracking(uint8_t periodicity)
+{
+    session.class_b.status = CLASS_B_TRACKING;
+    session.class_b.periodicity = periodicity;
+    session.class_b.period = ULORAWAN_CLASS_B_BEACON_PERIOD;
+    session.class_b.last_beacon = 10000;
+    session.class_b.beacon_time = 1000000;
+}
+
+// A class B group with a ping slot every 32 seconds
+static void add_group(uint16_t ping_offset)
+{
+    struct ulorawan_multicast_group *group =
+        &session.multicast.groups[session.multicast.count++];
+
+    group->keys.dev_addr = 0x26011BDB;
+    group->class = DEVICE_CLASS_B;
+    group->frequency = 869100000;
+    group->dr = DR_3;
+    group->periodicity = 5;
+    group->ping_offset = ping_offset;
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.state = ULORAWAN_STATE_IDLE;
+    session.keys.dev_addr = 0x26011BDA;
+    session.region_params.desc = &ulorawan_region_eu868;
+    session.region_params.rx2_frequency = 869525000;
+    session.region_params.rx2_dr = DR_0;
+    ulorawan_energy_mode_Ignore();
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_class_b_ping_offset()
+{
+    // Arrange
+    uint16_t offset;
+
+    expect_ping_offset(rand_block);
+
+    // Act
+    int32_t result = ulorawan_class_b_ping_offset(0x26011BDA, 1000000, 128,
+        &offset);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT16(0x34, offset);
+}
+
+void test_ulorawan_class_b_start_invalid_periodicity()
+{
+    // Act
+    int32_t result = ulorawan_class_b_start(&session, 8);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL(CLASS_B_OFF, session.class_b.status);
+}
+
+void test_ulorawan_class_b_start_success()
+{
+    // Arrange
+    ulorawan_cmds_ping_slot_info_req_Expect(&session, 7);
+    radio_hal_set_frequency_ExpectAndReturn(869525000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CONT, RADIO_HAL_ERR_NONE);
+    timer_hal_start_ExpectAndReturn(TIMER2,
+        ULORAWAN_CLASS_B_BEACON_PERIOD + ULORAWAN_CLASS_B_GUARD,
+        TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_start(&session, 7);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(CLASS_B_ACQUIRING, session.class_b.status);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_BEACON, session.state);
+    TEST_ASSERT_EQUAL(DEVICE_CLASS_B, session.class);
+}
+
+void test_ulorawan_class_b_acquire_beacon()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_BEACON;
+    session.class_b.status = CLASS_B_ACQUIRING;
+    session.class_b.periodicity = 7;
+    session.class_b.period = ULORAWAN_CLASS_B_BEACON_PERIOD;
+
+    expect_beacon(beacon, sizeof(beacon));
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_NONE);
+    timer_hal_get_time_ExpectAndReturn(10000 + ULORAWAN_CLASS_B_BEACON_AIRTIME);
+    expect_ping_offset(rand_block);
+    timer_hal_get_time_ExpectAndReturn(10000 + ULORAWAN_CLASS_B_BEACON_AIRTIME);
+    // The only ping slot of the period opens 0x1234 % 4096 slots in
+    timer_hal_start_ExpectAndReturn(TIMER2,
+        ULORAWAN_CLASS_B_BEACON_RESERVED + 0x234 * 30 - ULORAWAN_CLASS_B_GUARD
+            - ULORAWAN_CLASS_B_BEACON_AIRTIME,
+        TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(CLASS_B_TRACKING, session.class_b.status);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+    TEST_ASSERT_EQUAL_UINT32(10000, session.class_b.last_beacon);
+    TEST_ASSERT_EQUAL_UINT32(1000000, session.class_b.beacon_time);
+    TEST_ASSERT_EQUAL_UINT16(0x234, session.class_b.ping_offset);
+    TEST_ASSERT_EQUAL_UINT8(0, session.class_b.beacon_next);
+}
+
+void test_ulorawan_class_b_acquire_beacon_group()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_BEACON;
+    session.class_b.status = CLASS_B_ACQUIRING;
+    session.class_b.periodicity = 7;
+    session.class_b.period = ULORAWAN_CLASS_B_BEACON_PERIOD;
+    add_group(UINT16_MAX);
+
+    expect_beacon(beacon, sizeof(beacon));
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_NONE);
+    timer_hal_get_time_ExpectAndReturn(10000 + ULORAWAN_CLASS_B_BEACON_AIRTIME);
+    expect_ping_offset(rand_block);
+    expect_ping_offset(group_rand_block);
+    timer_hal_get_time_ExpectAndReturn(10000 + ULORAWAN_CLASS_B_BEACON_AIRTIME);
+    // The first slot of the group comes before the slot of the device
+    timer_hal_start_ExpectAndReturn(TIMER2,
+        ULORAWAN_CLASS_B_BEACON_RESERVED + 0x10 * 30 - ULORAWAN_CLASS_B_GUARD
+            - ULORAWAN_CLASS_B_BEACON_AIRTIME,
+        TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT16(0x234, session.class_b.ping_offset);
+    TEST_ASSERT_EQUAL_UINT16(0x10, session.multicast.groups[0].ping_offset);
+    TEST_ASSERT_EQUAL_UINT16(0x10, session.class_b.next_slot);
+}
+
+void test_ulorawan_class_b_acquire_invalid_beacon()
+{
+    // Arrange
+    uint8_t corrupt[sizeof(beacon)];
+
+    memcpy(corrupt, beacon, sizeof(beacon));
+    corrupt[2] ^= 0x01;
+    session.state = ULORAWAN_STATE_BEACON;
+    session.class_b.status = CLASS_B_ACQUIRING;
+
+    expect_beacon(corrupt, sizeof(corrupt));
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(CLASS_B_ACQUIRING, session.class_b.status);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_BEACON, session.state);
+}
+
+void test_ulorawan_class_b_acquire_timeout()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_BEACON;
+    session.class = DEVICE_CLASS_B;
+    session.class_b.status = CLASS_B_ACQUIRING;
+
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_timer(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(CLASS_B_OFF, session.class_b.status);
+    TEST_ASSERT_EQUAL(DEVICE_CLASS_A, session.class);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+    TEST_ASSERT_EQUAL_UINT32(1, session.class_b.stats.acquisitions_failed);
+}
+
+void test_ulorawan_class_b_timer_opens_ping_slot()
+{
+    // Arrange
+    struct radio_hal_rx_config sf12_config = {MODULATION_LORA,
+                                              SPREAD_FACTOR_12, BW_125};
+
+    tracking(7);
+    session.class_b.ping_frequency = 869525000;
+    session.class_b.ping_dr = DR_0;
+    session.class_b.missed = 2;
+
+    radio_hal_set_rx_config_ExpectAndReturn(&sf12_config, RADIO_HAL_ERR_NONE);
+    radio_hal_set_frequency_ExpectAndReturn(869525000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_symbol_timeout_ExpectAndReturn(
+        ULORAWAN_CLASS_B_PING_SYMBOLS + 2 * ULORAWAN_CLASS_B_SYMBOL_WIDENING,
+        RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_SINGLE, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_timer(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_PING, session.state);
+    TEST_ASSERT_EQUAL_UINT32(1, session.class_b.stats.ping_slots);
+}
+
+void test_ulorawan_class_b_timer_opens_group_ping_slot()
+{
+    // Arrange
+    struct radio_hal_rx_config sf9_config = {MODULATION_LORA,
+                                             SPREAD_FACTOR_9, BW_125};
+
+    tracking(7);
+    session.class_b.ping_frequency = 869525000;
+    session.class_b.ping_offset = 0x234;
+    session.class_b.next_slot = 0x410;
+    add_group(0x10);
+
+    radio_hal_set_rx_config_ExpectAndReturn(&sf9_config, RADIO_HAL_ERR_NONE);
+    radio_hal_set_frequency_ExpectAndReturn(869100000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_symbol_timeout_ExpectAndReturn(ULORAWAN_CLASS_B_PING_SYMBOLS,
+        RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_SINGLE, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_timer(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_PING, session.state);
+}
+
+void test_ulorawan_class_b_timer_busy_skips_ping_slot()
+{
+    // Arrange
+    tracking(7);
+    session.state = ULORAWAN_STATE_RX1;
+
+    timer_hal_get_time_ExpectAndReturn(20000);
+    timer_hal_start_ExpectAndReturn(TIMER2,
+        10000 + ULORAWAN_CLASS_B_BEACON_PERIOD - ULORAWAN_CLASS_B_GUARD - 20000,
+        TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_timer(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RX1, session.state);
+    TEST_ASSERT_EQUAL_UINT8(1, session.class_b.beacon_next);
+    TEST_ASSERT_EQUAL_UINT32(1, session.class_b.stats.ping_slots_skipped);
+}
+
+void test_ulorawan_class_b_ping_slot_downlink()
+{
+    // Arrange
+    tracking(7);
+    session.state = ULORAWAN_STATE_PING;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    timer_hal_get_time_ExpectAndReturn(20000);
+    timer_hal_start_ExpectAnyArgsAndReturn(TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+    TEST_ASSERT_EQUAL_UINT32(1, session.class_b.stats.ping_downlinks);
+    TEST_ASSERT_EQUAL_UINT8(1, session.class_b.beacon_next);
+}
+
+void test_ulorawan_class_b_ping_slot_next_group_slot()
+{
+    // Arrange
+    tracking(7);
+    session.state = ULORAWAN_STATE_PING;
+    session.class_b.ping_offset = 0x234;
+    session.class_b.next_slot = 0x10;
+    add_group(0x10);
+
+    // The device slot comes before the next slot of the group at 0x410
+    timer_hal_get_time_ExpectAndReturn(20000);
+    timer_hal_start_ExpectAndReturn(TIMER2,
+        10000 + ULORAWAN_CLASS_B_BEACON_RESERVED + 0x234 * 30
+            - ULORAWAN_CLASS_B_GUARD - 20000,
+        TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT16(0x234, session.class_b.next_slot);
+    TEST_ASSERT_EQUAL_UINT8(0, session.class_b.beacon_next);
+}
+
+void test_ulorawan_class_b_beacon_drift()
+{
+    // Arrange
+    tracking(7);
+    session.state = ULORAWAN_STATE_BEACON;
+
+    // The beacon arrives 40 ms later than the local clock expects
+    expect_beacon(beacon, sizeof(beacon));
+    timer_hal_get_time_ExpectAndReturn(10000 + ULORAWAN_CLASS_B_BEACON_PERIOD +
+        40 + ULORAWAN_CLASS_B_BEACON_AIRTIME);
+    expect_ping_offset(rand_block);
+    timer_hal_get_time_ExpectAndReturn(10000 + ULORAWAN_CLASS_B_BEACON_PERIOD +
+        40 + ULORAWAN_CLASS_B_BEACON_AIRTIME);
+    timer_hal_start_ExpectAnyArgsAndReturn(TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(ULORAWAN_CLASS_B_BEACON_PERIOD +
+        40 / ULORAWAN_CLASS_B_DRIFT_GAIN, session.class_b.period);
+    TEST_ASSERT_EQUAL_UINT32(10000 + ULORAWAN_CLASS_B_BEACON_PERIOD + 40,
+        session.class_b.last_beacon);
+    TEST_ASSERT_EQUAL_UINT32(1, session.class_b.stats.beacons);
+}
+
+void test_ulorawan_class_b_beacon_missed()
+{
+    // Arrange
+    tracking(7);
+    session.state = ULORAWAN_STATE_BEACON;
+
+    expect_ping_offset(rand_block);
+    timer_hal_get_time_ExpectAndReturn(10000 + ULORAWAN_CLASS_B_BEACON_PERIOD + 50);
+    timer_hal_start_ExpectAnyArgsAndReturn(TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+    TEST_ASSERT_EQUAL_UINT8(1, session.class_b.missed);
+    TEST_ASSERT_EQUAL_UINT32(1000128, session.class_b.beacon_time);
+    TEST_ASSERT_EQUAL_UINT32(1, session.class_b.stats.beacons_missed);
+}
+
+void test_ulorawan_class_b_beacon_lost()
+{
+    // Arrange
+    tracking(7);
+    session.class = DEVICE_CLASS_B;
+    session.state = ULORAWAN_STATE_BEACON;
+    session.class_b.missed = ULORAWAN_CLASS_B_MAX_MISSED;
+
+    // Act
+    int32_t result = ulorawan_class_b_irq(&session, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(CLASS_B_OFF, session.class_b.status);
+    TEST_ASSERT_EQUAL(DEVICE_CLASS_A, session.class);
+}
+
+void test_ulorawan_class_b_stop_beacon()
+{
+    // Arrange
+    tracking(7);
+    session.class = DEVICE_CLASS_B;
+    session.state = ULORAWAN_STATE_BEACON;
+
+    timer_hal_stop_ExpectAndReturn(TIMER2, TIMER_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_stop(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+    TEST_ASSERT_EQUAL(CLASS_B_OFF, session.class_b.status);
+    TEST_ASSERT_EQUAL(DEVICE_CLASS_A, session.class);
+}
+
+void test_ulorawan_class_b_stop_ping_radio_error()
+{
+    // Arrange
+    tracking(7);
+    session.class = DEVICE_CLASS_B;
+    session.state = ULORAWAN_STATE_PING;
+
+    timer_hal_stop_ExpectAndReturn(TIMER2, TIMER_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_PARAM);
+
+    // Act
+    int32_t result = ulorawan_class_b_stop(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_RADIO, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
+}
+
+void test_ulorawan_class_b_stop_idle()
+{
+    // Arrange
+    tracking(7);
+    session.class = DEVICE_CLASS_B;
+
+    timer_hal_stop_ExpectAndReturn(TIMER2, TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_b_stop(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+}
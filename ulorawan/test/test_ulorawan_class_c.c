@@ -0,0 +1,227 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_class_c.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_region_tables.h"
+
+#include "mock_radio_hal.h"
+#include "mock_ulorawan_downlink.h"
+#include "mock_ulorawan_energy.h"
+#include "mock_ulorawan_retrans.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+static const struct radio_hal_rx_config rx2_config = {MODULATION_LORA,
+                                                      SPREAD_FACTOR_12, BW_125};
+
+static void add_group(enum ulorawan_device_class class)
+{
+    session.multicast.groups[session.multicast.count].class = class;
+    session.multicast.count++;
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.state = ULORAWAN_STATE_IDLE;
+    session.class = DEVICE_CLASS_C;
+    session.region_params.desc = &ulorawan_region_eu868;
+    session.region_params.rx2_frequency = 869525000;
+    session.region_params.rx2_dr = DR_0;
+    ulorawan_energy_mode_Ignore();
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_class_c_listen_radio_error()
+{
+    // Arrange
+    radio_hal_set_frequency_ExpectAndReturn(869525000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_rx_config_ExpectAndReturn(&rx2_config, RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CONT, RADIO_HAL_ERR_PARAM);
+
+    // Act
+    int32_t result = ulorawan_class_c_listen(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_RADIO, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
+}
+
+void test_ulorawan_class_c_start_class_a()
+{
+    // Arrange
+    session.class = DEVICE_CLASS_A;
+
+    // Act
+    int32_t result = ulorawan_class_c_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+}
+
+void test_ulorawan_class_c_start_success()
+{
+    // Arrange
+    radio_hal_set_frequency_ExpectAndReturn(869525000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_rx_config_ExpectAndReturn(&rx2_config, RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CONT, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_c_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
+
+void test_ulorawan_class_c_start_class_a_multicast()
+{
+    // Arrange
+    session.class = DEVICE_CLASS_A;
+    add_group(DEVICE_CLASS_B);
+    add_group(DEVICE_CLASS_C);
+
+    radio_hal_set_frequency_ExpectAndReturn(869525000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_rx_config_ExpectAndReturn(&rx2_config, RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CONT, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_c_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
+
+void test_ulorawan_class_c_start_class_b_multicast()
+{
+    // Arrange
+    session.class = DEVICE_CLASS_B;
+    add_group(DEVICE_CLASS_C);
+
+    // Act
+    int32_t result = ulorawan_class_c_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+}
+
+void test_ulorawan_class_c_stop_class_a()
+{
+    // Arrange
+    session.class = DEVICE_CLASS_A;
+    session.state = ULORAWAN_STATE_RXC;
+    add_group(DEVICE_CLASS_C);
+
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_c_stop(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+}
+
+void test_ulorawan_class_c_stop_class_c()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_RXC;
+
+    // Act
+    int32_t result = ulorawan_class_c_stop(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
+
+void test_ulorawan_class_c_irq_downlink()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_RXC;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    ulorawan_retrans_rx_done_Expect(&session, true);
+
+    // Act
+    int32_t result = ulorawan_class_c_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
+
+void test_ulorawan_class_c_irq_multicast_downlink()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_RXC;
+    session.retrans.active = 1;
+    session.retrans.attempts = 1;
+    session.retrans.max_attempts = 3;
+    session.rx.multicast = 1;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_class_c_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+    TEST_ASSERT_EQUAL_UINT8(1, session.retrans.active);
+}
+
+void test_ulorawan_class_c_irq_downlink_error()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_RXC;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_MIC);
+
+    // Act
+    int32_t result = ulorawan_class_c_irq(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_MIC, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
@@ -0,0 +1,382 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_cmds.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_mac_cmds.h"
+
+#include "mock_ulorawan_adr.h"
+#include "mock_ulorawan_link_stats.h"
+#include "mock_ulorawan_region.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_cmds_process_empty()
+{
+    // Arrange
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, NULL, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(0, session.cmds.answers_size);
+}
+
+void test_ulorawan_cmds_process_link_adr_req()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_LINK_ADR_REQ, 0x52, 0x07, 0x01, 0x03};
+    struct ulorawan_mac_link_adr_req req;
+    union ulorawan_mac_adr_ans ans;
+
+    req.dr_tx_power.value = 0x52;
+    req.ch_mask = 0x0107;
+    req.redundancy.value = 0x03;
+    ans.value = 0x07;
+
+    ulorawan_adr_link_adr_req_ExpectAndReturn(&session, &req, 1, ans);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(2, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_LINK_ADR_ANS, session.cmds.answers[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x07, session.cmds.answers[1]);
+}
+
+void test_ulorawan_cmds_process_link_adr_req_block()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_LINK_ADR_REQ, 0x00, 0x00, 0x00, 0x70,
+                            SRV_MAC_LINK_ADR_REQ, 0x34, 0xFF, 0x00, 0x02,
+                            SRV_MAC_DUTY_CYCLE_REQ, 0x01};
+    struct ulorawan_mac_link_adr_req req;
+    union ulorawan_mac_adr_ans ans;
+
+    req.dr_tx_power.value = 0x00;
+    req.ch_mask = 0x0000;
+    req.redundancy.value = 0x70;
+    ans.value = 0x07;
+
+    ulorawan_adr_link_adr_req_ExpectAndReturn(&session, &req, 2, ans);
+    ulorawan_region_set_max_duty_cycle_ExpectAndReturn(&session.region_params, 1,
+        ULORAWAN_REGION_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(5, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_LINK_ADR_ANS, session.cmds.answers[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x07, session.cmds.answers[1]);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_LINK_ADR_ANS, session.cmds.answers[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x07, session.cmds.answers[3]);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_DUTY_CYCLE_ANS, session.cmds.answers[4]);
+}
+
+void test_ulorawan_cmds_process_link_adr_req_block_max()
+{
+    // Arrange
+    uint8_t cmds[5 * ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK + 2];
+    struct ulorawan_mac_link_adr_req req;
+    union ulorawan_mac_adr_ans ans;
+
+    for (uint8_t i = 0; i < ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK; i++)
+    {
+        cmds[i * 5] = SRV_MAC_LINK_ADR_REQ;
+        cmds[i * 5 + 1] = 0x34;
+        cmds[i * 5 + 2] = 0xFF;
+        cmds[i * 5 + 3] = 0x00;
+        cmds[i * 5 + 4] = (uint8_t)(i << 4);
+    }
+    cmds[5 * ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK] = SRV_MAC_DUTY_CYCLE_REQ;
+    cmds[5 * ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK + 1] = 0x01;
+
+    req.dr_tx_power.value = 0x34;
+    req.ch_mask = 0x00FF;
+    req.redundancy.value = 0x00;
+    ans.value = 0x07;
+
+    ulorawan_adr_link_adr_req_ExpectAndReturn(&session, &req,
+        ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK, ans);
+    ulorawan_region_set_max_duty_cycle_ExpectAndReturn(&session.region_params, 1,
+        ULORAWAN_REGION_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(2 * ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK + 1,
+        session.cmds.answers_size);
+    for (uint8_t i = 0; i < ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(DEV_MAC_LINK_ADR_ANS, session.cmds.answers[i * 2]);
+        TEST_ASSERT_EQUAL_HEX8(0x07, session.cmds.answers[i * 2 + 1]);
+    }
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_DUTY_CYCLE_ANS,
+        session.cmds.answers[2 * ULORAWAN_CMDS_MAX_LINK_ADR_BLOCK]);
+}
+
+void test_ulorawan_cmds_process_link_check_ans()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_LINK_CHECK_ANS, 0x14, 0x03};
+
+    ulorawan_link_stats_link_check_Expect(&session.link_stats, 0x14, 0x03);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(0, session.cmds.answers_size);
+}
+
+void test_ulorawan_cmds_process_dev_status_req()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_DEV_STATUS_REQ};
+
+    ulorawan_link_stats_margin_ExpectAndReturn(&session.link_stats, -5);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(3, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_DEV_STATUS_ANS, session.cmds.answers[0]);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_MAC_BATTERY_UNABLE_TO_MEASURE,
+        session.cmds.answers[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x3B, session.cmds.answers[2]);
+}
+
+void test_ulorawan_cmds_process_tx_param_setup_req()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_TX_PARAM_SETUP_REQ, 0x1D};
+
+    ulorawan_region_set_tx_params_ExpectAndReturn(&session.region_params, 1, 0,
+        0x0D, ULORAWAN_REGION_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(1, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_TX_PARAM_SETUP_ANS, session.cmds.answers[0]);
+}
+
+void test_ulorawan_cmds_process_tx_param_setup_req_unsupported()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_TX_PARAM_SETUP_REQ, 0x25};
+
+    ulorawan_region_set_tx_params_ExpectAndReturn(&session.region_params, 0, 1,
+        0x05, ULORAWAN_REGION_ERR_FAIL);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(0, session.cmds.answers_size);
+}
+
+void test_ulorawan_cmds_process_ping_slot_ch_req()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_PING_SLOT_CH_REQ, 0xD2, 0xAD, 0x84, 0x03};
+
+    ulorawan_region_frequency_valid_ExpectAndReturn(&session.region_params,
+                                                    869525000, true);
+    ulorawan_region_max_payload_ExpectAndReturn(&session.region_params, 3, 115);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(869525000, session.class_b.ping_frequency);
+    TEST_ASSERT_EQUAL_UINT8(3, session.class_b.ping_dr);
+    TEST_ASSERT_EQUAL_UINT8(2, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_PING_SLOT_CH_ANS, session.cmds.answers[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, session.cmds.answers[1]);
+}
+
+void test_ulorawan_cmds_process_beacon_freq_req()
+{
+    // Arrange
+    const uint8_t cmds[] = {SVR_MAC_BEACON_FREQ_REQ, 0xD2, 0xAD, 0x84};
+
+    ulorawan_region_frequency_valid_ExpectAndReturn(&session.region_params,
+                                                    869525000, true);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(869525000, session.class_b.beacon_frequency);
+    TEST_ASSERT_EQUAL_UINT8(2, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(SVR_MAC_BEACON_FREQ_ANS, session.cmds.answers[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, session.cmds.answers[1]);
+}
+
+void test_ulorawan_cmds_process_ping_slot_ch_req_frequency()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_PING_SLOT_CH_REQ, 0x40, 0x42, 0x0F, 0x03};
+    session.class_b.ping_frequency = 869525000;
+
+    ulorawan_region_frequency_valid_ExpectAndReturn(&session.region_params,
+                                                    100000000, false);
+    ulorawan_region_max_payload_ExpectAndReturn(&session.region_params, 3, 115);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(869525000, session.class_b.ping_frequency);
+    TEST_ASSERT_EQUAL_HEX8(0x02, session.cmds.answers[1]);
+}
+
+void test_ulorawan_cmds_process_beacon_freq_req_frequency()
+{
+    // Arrange
+    const uint8_t cmds[] = {SVR_MAC_BEACON_FREQ_REQ, 0x40, 0x42, 0x0F};
+    session.class_b.beacon_frequency = 869525000;
+
+    ulorawan_region_frequency_valid_ExpectAndReturn(&session.region_params,
+                                                    100000000, false);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(869525000, session.class_b.beacon_frequency);
+    TEST_ASSERT_EQUAL_UINT8(2, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(0x00, session.cmds.answers[1]);
+}
+
+void test_ulorawan_cmds_ping_slot_info_req()
+{
+    // Act
+    ulorawan_cmds_ping_slot_info_req(&session, 5);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(2, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_PING_SLOT_INFO_REQ, session.cmds.answers[0]);
+    TEST_ASSERT_EQUAL_HEX8(5, session.cmds.answers[1]);
+}
+
+void test_ulorawan_cmds_process_sequence()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_DEV_STATUS_REQ, SRV_MAC_DUTY_CYCLE_REQ, 0x07,
+        SRV_MAC_TX_PARAM_SETUP_REQ, 0x10};
+
+    ulorawan_link_stats_margin_ExpectAndReturn(&session.link_stats, 10);
+    ulorawan_region_set_max_duty_cycle_ExpectAndReturn(&session.region_params,
+        7, ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_set_tx_params_ExpectAndReturn(&session.region_params, 1, 0,
+        0x00, ULORAWAN_REGION_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(5, session.cmds.answers_size);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_DEV_STATUS_ANS, session.cmds.answers[0]);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_DUTY_CYCLE_ANS, session.cmds.answers[3]);
+    TEST_ASSERT_EQUAL_HEX8(DEV_MAC_TX_PARAM_SETUP_ANS, session.cmds.answers[4]);
+}
+
+void test_ulorawan_cmds_process_unknown_command()
+{
+    // Arrange
+    const uint8_t cmds[] = {0x7F, SRV_MAC_DUTY_CYCLE_REQ, 0x07};
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_UINT8(0, session.cmds.answers_size);
+}
+
+void test_ulorawan_cmds_process_truncated_command()
+{
+    // Arrange
+    const uint8_t cmds[] = {SRV_MAC_TX_PARAM_SETUP_REQ};
+
+    // Act
+    int32_t result = ulorawan_cmds_process(&session, cmds, sizeof(cmds));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_cmds_clear_answers()
+{
+    // Arrange
+    session.cmds.answers_size = 3;
+
+    // Act
+    ulorawan_cmds_clear_answers(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, session.cmds.answers_size);
+}
@@ -0,0 +1,150 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_crypto.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_crypto_hal.h"
+
+static const uint8_t key[16] = {0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                                0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+
+static uint8_t cmac_block[64];
+static size_t cmac_size;
+
+// Echo the block so the key stream is the A block itself
+static int32_t aes_encrypt_echo(const uint8_t *const k, const uint8_t *const in,
+                                uint8_t *const out, int cmock_num_calls)
+{
+    (void)k;
+    (void)cmock_num_calls;
+    memcpy(out, in, 16);
+    return CRYPTO_HAL_ERR_NONE;
+}
+
+static int32_t aes_cmac_capture(const uint8_t *const k,
+                                const uint8_t *const payload, size_t size,
+                                uint32_t *const cmac, int cmock_num_calls)
+{
+    (void)k;
+    (void)cmock_num_calls;
+    memcpy(cmac_block, payload, size);
+    cmac_size = size;
+    *cmac = 0xA1B2C3D4;
+    return CRYPTO_HAL_ERR_NONE;
+}
+
+void setUp(void)
+{
+    memset(cmac_block, 0, sizeof(cmac_block));
+    cmac_size = 0;
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_crypto_payload_key_stream()
+{
+    // Arrange
+    uint8_t buf[20];
+    const uint8_t a1[16] = {0x01, 0, 0, 0, 0, ULORAWAN_CRYPTO_DIR_UP,
+                            0xDA, 0x1B, 0x01, 0x26, 0x05, 0x01, 0, 0, 0, 0x01};
+    const uint8_t a2[4] = {0x01, 0, 0, 0};
+
+    memset(buf, 0, sizeof(buf));
+    crypto_hal_aes_encrypt_StubWithCallback(aes_encrypt_echo);
+
+    // Act
+    int32_t result = ulorawan_crypto_payload(key, ULORAWAN_CRYPTO_DIR_UP,
+        0x26011BDA, 0x0105, buf, sizeof(buf));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(a1, buf, sizeof(a1));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(a2, &buf[16], sizeof(a2));
+}
+
+void test_ulorawan_crypto_payload_error()
+{
+    // Arrange
+    uint8_t buf[4] = {0};
+
+    crypto_hal_aes_encrypt_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_FAIL);
+
+    // Act
+    int32_t result = ulorawan_crypto_payload(key, ULORAWAN_CRYPTO_DIR_UP,
+        0x26011BDA, 1, buf, sizeof(buf));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_CMAC, result);
+}
+
+void test_ulorawan_crypto_mic_b0_block()
+{
+    // Arrange
+    const uint8_t msg[] = {0x40, 0xDA, 0x1B, 0x01, 0x26, 0x00, 0x05, 0x00};
+    const uint8_t b0[16] = {0x49, 0, 0, 0, 0, ULORAWAN_CRYPTO_DIR_DOWN,
+                            0xDA, 0x1B, 0x01, 0x26, 0x05, 0x00, 0x01, 0, 0,
+                            sizeof(msg)};
+    uint32_t mic;
+
+    crypto_hal_aes_cmac_StubWithCallback(aes_cmac_capture);
+
+    // Act
+    int32_t result = ulorawan_crypto_mic(key, ULORAWAN_CRYPTO_DIR_DOWN,
+        0x26011BDA, 0x00010005, msg, sizeof(msg), &mic);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0xA1B2C3D4, mic);
+    TEST_ASSERT_EQUAL(16 + sizeof(msg), cmac_size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(b0, cmac_block, sizeof(b0));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(msg, &cmac_block[16], sizeof(msg));
+}
+
+void test_ulorawan_crypto_mic_error()
+{
+    // Arrange
+    const uint8_t msg[] = {0x40};
+    uint32_t mic;
+
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_FAIL);
+
+    // Act
+    int32_t result = ulorawan_crypto_mic(key, ULORAWAN_CRYPTO_DIR_UP,
+        0x26011BDA, 1, msg, sizeof(msg), &mic);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_CMAC, result);
+}
@@ -0,0 +1,330 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_crypto.h"
+#include "ulorawan_downlink.h"
+#include "ulorawan_multicast.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_crypto_hal.h"
+#include "mock_radio_hal.h"
+#include "mock_ulorawan_adr.h"
+#include "mock_ulorawan_cmds.h"
+#include "mock_ulorawan_frag.h"
+#include "mock_ulorawan_link_stats.h"
+#include "mock_ulorawan_retrans.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+static const uint8_t frame[] = {0x60, 0xDA, 0x1B, 0x01, 0x26, 0x02, 0x05, 0x00,
+                                0x09, 0x1D, 0x78, 0x56, 0x34, 0x12};
+
+static size_t frame_size;
+
+static struct radio_hal_rx_status rx_status = {-97, 7};
+
+static void expect_read(const uint8_t *const buf, size_t size)
+{
+    frame_size = size;
+
+    radio_hal_fifo_read_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_NONE);
+    radio_hal_fifo_read_ReturnMemThruPtr_buf(buf, size);
+    radio_hal_fifo_read_ReturnThruPtr_len(&frame_size);
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.keys.dev_addr = 0x26011BDA;
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_downlink_handler_read_error()
+{
+    // Arrange
+    radio_hal_fifo_read_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_PARAM);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_RADIO, result);
+}
+
+void test_ulorawan_downlink_handler_too_short()
+{
+    // Arrange
+    expect_read(frame, 11);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FRAME, result);
+}
+
+void test_ulorawan_downlink_handler_other_device()
+{
+    // Arrange
+    session.keys.dev_addr = 0x26011BDB;
+
+    expect_read(frame, sizeof(frame));
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FRAME, result);
+}
+
+void test_ulorawan_downlink_handler_uplink_frame()
+{
+    // Arrange
+    uint8_t uplink[sizeof(frame)];
+
+    memcpy(uplink, frame, sizeof(frame));
+    uplink[0] = 0x40;
+
+    expect_read(uplink, sizeof(uplink));
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FRAME, result);
+}
+
+void test_ulorawan_downlink_handler_mic_error()
+{
+    // Arrange
+    uint32_t cmac = 0x12345679;
+
+    expect_read(frame, sizeof(frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_cmac_ReturnThruPtr_cmac(&cmac);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_MIC, result);
+    TEST_ASSERT_EQUAL_UINT32(0, session.keys.fcnt_down);
+}
+
+void test_ulorawan_downlink_handler_cmac_error()
+{
+    // Arrange
+    expect_read(frame, sizeof(frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_FAIL);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_CMAC, result);
+}
+
+void test_ulorawan_downlink_handler_success()
+{
+    // Arrange
+    uint32_t cmac = 0x12345678;
+
+    expect_read(frame, sizeof(frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_cmac_ReturnThruPtr_cmac(&cmac);
+    ulorawan_adr_downlink_Expect(&session);
+    radio_hal_get_rx_status_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_NONE);
+    radio_hal_get_rx_status_ReturnThruPtr_status(&rx_status);
+    ulorawan_link_stats_add_Expect(&session.link_stats, -97, 7);
+    ulorawan_cmds_process_ExpectAndReturn(&session, &session.frame[8], 2,
+                                          ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(6, session.keys.fcnt_down);
+}
+
+void test_ulorawan_downlink_handler_fcnt_rollover()
+{
+    // Arrange
+    uint32_t cmac = 0x12345678;
+
+    session.keys.fcnt_down = 0x0000FFF0;
+
+    expect_read(frame, sizeof(frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_cmac_ReturnThruPtr_cmac(&cmac);
+    ulorawan_adr_downlink_Expect(&session);
+    radio_hal_get_rx_status_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_NONE);
+    radio_hal_get_rx_status_ReturnThruPtr_status(&rx_status);
+    ulorawan_link_stats_add_Expect(&session.link_stats, -97, 7);
+    ulorawan_cmds_process_ExpectAnyArgsAndReturn(ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(0x00010006, session.keys.fcnt_down);
+}
+
+void test_ulorawan_downlink_handler_ack()
+{
+    // Arrange
+    uint32_t cmac = 0x12345678;
+    uint8_t ack_frame[sizeof(frame)];
+
+    memcpy(ack_frame, frame, sizeof(frame));
+    ack_frame[5] |= 0x20;
+
+    expect_read(ack_frame, sizeof(ack_frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_cmac_ReturnThruPtr_cmac(&cmac);
+    ulorawan_adr_downlink_Expect(&session);
+    ulorawan_retrans_ack_Expect(&session);
+    radio_hal_get_rx_status_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_NONE);
+    radio_hal_get_rx_status_ReturnThruPtr_status(&rx_status);
+    ulorawan_link_stats_add_Expect(&session.link_stats, -97, 7);
+    ulorawan_cmds_process_ExpectAnyArgsAndReturn(ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_downlink_handler_rx_status_error()
+{
+    // Arrange
+    uint32_t cmac = 0x12345678;
+
+    expect_read(frame, sizeof(frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_cmac_ReturnThruPtr_cmac(&cmac);
+    ulorawan_adr_downlink_Expect(&session);
+    radio_hal_get_rx_status_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_PARAM);
+    ulorawan_cmds_process_ExpectAnyArgsAndReturn(ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_downlink_handler_multicast()
+{
+    // Arrange
+    const uint8_t mc_frame[] = {0x60, 0x01, 0x00, 0x00, 0xFC, 0x00, 0x05, 0x00,
+                                0x0A, 0xAB, 0x78, 0x56, 0x34, 0x12};
+    struct ulorawan_multicast_group group = {.keys.dev_addr = 0xFC000001,
+                                             .class = DEVICE_CLASS_C};
+    uint32_t cmac = 0x12345678;
+
+    ulorawan_multicast_add(&session.multicast, &group);
+
+    expect_read(mc_frame, sizeof(mc_frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_cmac_ReturnThruPtr_cmac(&cmac);
+    crypto_hal_aes_encrypt_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(6, session.multicast.groups[0].keys.fcnt_down);
+    TEST_ASSERT_EQUAL_UINT32(0, session.keys.fcnt_down);
+    TEST_ASSERT_EQUAL_UINT8(1, session.rx.multicast);
+    TEST_ASSERT_EQUAL_UINT8(10, session.rx.port);
+    TEST_ASSERT_EQUAL_UINT8(9, session.rx.offset);
+    TEST_ASSERT_EQUAL_UINT8(1, session.rx.size);
+}
+
+void test_ulorawan_downlink_handler_multicast_fopts()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.keys.dev_addr = 0x26011BDB,
+                                             .class = DEVICE_CLASS_C};
+    uint8_t mc_frame[sizeof(frame)];
+
+    memcpy(mc_frame, frame, sizeof(frame));
+    mc_frame[1] = 0xDB;
+    ulorawan_multicast_add(&session.multicast, &group);
+
+    expect_read(mc_frame, sizeof(mc_frame));
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FRAME, result);
+    TEST_ASSERT_EQUAL_UINT32(0, session.multicast.groups[0].keys.fcnt_down);
+}
+
+void test_ulorawan_downlink_handler_multicast_fragment()
+{
+    // Arrange
+    const uint8_t mc_frame[] = {0x60, 0x01, 0x00, 0x00, 0xFC, 0x00, 0x05, 0x00,
+                                0xC9, 0x08, 0x78, 0x56, 0x34, 0x12};
+    struct ulorawan_multicast_group group = {.keys.dev_addr = 0xFC000001,
+                                             .class = DEVICE_CLASS_C};
+    uint32_t cmac = 0x12345678;
+
+    ulorawan_multicast_add(&session.multicast, &group);
+
+    expect_read(mc_frame, sizeof(mc_frame));
+    crypto_hal_aes_cmac_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    crypto_hal_aes_cmac_ReturnThruPtr_cmac(&cmac);
+    crypto_hal_aes_encrypt_ExpectAnyArgsAndReturn(CRYPTO_HAL_ERR_NONE);
+    ulorawan_frag_process_ExpectAndReturn(&session, &session.frame[9], 1,
+                                          ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_downlink_handler(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(ULORAWAN_FRAG_PORT, session.rx.port);
+}
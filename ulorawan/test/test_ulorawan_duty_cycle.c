@@ -0,0 +1,166 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "unity.h"
+#include "mock_rand_hal.h"
+#include "mock_timer_hal.h"
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_duty_cycle.h"
+#include "ulorawan_region.h"
+#include "ulorawan_region_tables.h"
+
+static struct ulorawan_channel_plan plan;
+static struct ulorawan_duty_cycle duty_cycle;
+
+void setUp(void)
+{
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_eu868);
+    ulorawan_channel_plan_set(&plan, 3, 867100000, DR_0, DR_5);
+    ulorawan_duty_cycle_init(&duty_cycle, &ulorawan_region_eu868, 0);
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_duty_cycle_init()
+{
+    // Arrange
+
+    // Act
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(6, duty_cycle.band_count);
+    TEST_ASSERT_EQUAL_UINT16(1, duty_cycle.aggregated);
+    TEST_ASSERT_EQUAL_UINT16(100, duty_cycle.limit[2]);
+    TEST_ASSERT_EQUAL_UINT32(0, ulorawan_duty_cycle_next(&duty_cycle, &plan));
+}
+
+void test_ulorawan_duty_cycle_record_blocks_band()
+{
+    // Arrange
+
+    // Act
+    ulorawan_duty_cycle_record(&duty_cycle, &plan, 2, 1000, 1100);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(11000, duty_cycle.release[2]);
+    TEST_ASSERT_EQUAL_UINT8(2, duty_cycle.order[5]);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_channel_plan_count(&plan, DR_0));
+    TEST_ASSERT_EQUAL_UINT32(0, ulorawan_duty_cycle_next(&duty_cycle, &plan));
+}
+
+void test_ulorawan_duty_cycle_update_releases_band()
+{
+    // Arrange
+    ulorawan_duty_cycle_record(&duty_cycle, &plan, 2, 1000, 1100);
+
+    // Act
+    ulorawan_duty_cycle_update(&duty_cycle, &plan, 10999);
+    uint8_t blocked = ulorawan_channel_plan_count(&plan, DR_0);
+    ulorawan_duty_cycle_update(&duty_cycle, &plan, 11000);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, blocked);
+    TEST_ASSERT_EQUAL_UINT8(4, ulorawan_channel_plan_count(&plan, DR_0));
+    TEST_ASSERT_EQUAL_HEX8(0, duty_cycle.blocked);
+}
+
+void test_ulorawan_duty_cycle_next_all_bands_blocked()
+{
+    // Arrange
+    ulorawan_duty_cycle_init(&duty_cycle, &ulorawan_region_eu868, 0);
+
+    // Act
+    for (uint8_t band = 0; band < duty_cycle.band_count; band++) {
+        ulorawan_duty_cycle_record(&duty_cycle, &plan, band, 0, 10);
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(1000, ulorawan_duty_cycle_next(&duty_cycle, &plan));
+    TEST_ASSERT_EQUAL_UINT8(4, duty_cycle.order[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_channel_plan_count(&plan, DR_0));
+}
+
+void test_ulorawan_duty_cycle_record_no_limit()
+{
+    // Arrange
+    ulorawan_duty_cycle_init(&duty_cycle, &ulorawan_region_us915, 0);
+    ulorawan_channel_plan_init(&plan, &ulorawan_region_us915);
+
+    // Act
+    ulorawan_duty_cycle_record(&duty_cycle, &plan, 0, 0, 400);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(0, ulorawan_duty_cycle_next(&duty_cycle, &plan));
+    TEST_ASSERT_EQUAL_UINT8(64, ulorawan_channel_plan_count(&plan, DR_0));
+}
+
+void test_ulorawan_duty_cycle_aggregated()
+{
+    // Arrange
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_DUTY_CYCLE_ERR_NONE,
+        ulorawan_duty_cycle_set_max(&duty_cycle, 10));
+
+    // Act
+    ulorawan_duty_cycle_record(&duty_cycle, &plan, 2, 0, 100);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(102400, ulorawan_duty_cycle_next(&duty_cycle, &plan));
+}
+
+void test_ulorawan_duty_cycle_set_max_invalid()
+{
+    // Arrange
+
+    // Act
+    int32_t result = ulorawan_duty_cycle_set_max(&duty_cycle, 16);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_DUTY_CYCLE_ERR_PARAM, result);
+    TEST_ASSERT_EQUAL_UINT16(1, duty_cycle.aggregated);
+}
+
+void test_ulorawan_duty_cycle_clock_wrap()
+{
+    // Arrange
+    ulorawan_duty_cycle_init(&duty_cycle, &ulorawan_region_eu868, 0xFFFFFF00);
+
+    // Act
+    ulorawan_duty_cycle_record(&duty_cycle, &plan, 2, 0xFFFFFF00, 0xFFFFFFF0);
+    ulorawan_duty_cycle_update(&duty_cycle, &plan, 0x00001000);
+    uint8_t blocked = ulorawan_channel_plan_count(&plan, DR_0);
+    ulorawan_duty_cycle_update(&duty_cycle, &plan, 0x00005E00);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, blocked);
+    TEST_ASSERT_EQUAL_UINT8(4, ulorawan_channel_plan_count(&plan, DR_0));
+}
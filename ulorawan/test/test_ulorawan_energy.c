@@ -0,0 +1,285 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_energy.h"
+#include "ulorawan_session.h"
+
+#include "mock_timer_hal.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_energy energy;
+
+void setUp(void)
+{
+    memset(&energy, 0, sizeof(energy));
+    energy.current[MODE_SLEEP] = 1;
+    energy.current[MODE_STDBY] = 1500;
+    energy.current[MODE_TX] = 40000;
+    energy.current[MODE_RX_SINGLE] = 10000;
+    energy.current[MODE_RX_CONT] = 10000;
+    energy.current[MODE_RX_CAD] = 8000;
+
+    timer_hal_get_time_ExpectAndReturn(1000);
+    ulorawan_energy_reset(&energy);
+}
+
+void tearDown(void) {}
+
+static void mode_at(uint32_t now, enum RADIO_HAL_MODE mode)
+{
+    timer_hal_get_time_ExpectAndReturn(now);
+    ulorawan_energy_mode(&energy, mode);
+}
+
+static void step_at(uint32_t now, enum ulorawan_state from,
+                    enum ulorawan_state to, bool downlink)
+{
+    timer_hal_get_time_ExpectAndReturn(now);
+    ulorawan_energy_step(&energy, from, to, downlink);
+}
+
+void test_ulorawan_energy_reset()
+{
+    // Arrange
+    energy.charge = 100;
+    energy.time[MODE_TX] = 50;
+    energy.uplink.count = 2;
+    energy.mode = MODE_TX;
+    timer_hal_get_time_ExpectAndReturn(5000);
+
+    // Act
+    ulorawan_energy_reset(&energy);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT64(0, energy.charge);
+    TEST_ASSERT_EQUAL_UINT64(0, energy.time[MODE_TX]);
+    TEST_ASSERT_EQUAL_UINT32(0, energy.uplink.count);
+    TEST_ASSERT_EQUAL_UINT8(MODE_SLEEP, energy.mode);
+    TEST_ASSERT_EQUAL_UINT32(5000, energy.since);
+    TEST_ASSERT_EQUAL_UINT32(40000, energy.current[MODE_TX]);
+}
+
+void test_ulorawan_energy_mode()
+{
+    // Arrange
+
+    // Act
+    mode_at(3000, MODE_TX);
+    mode_at(3100, MODE_STDBY);
+    mode_at(3110, MODE_SLEEP);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT64(2000, energy.time[MODE_SLEEP]);
+    TEST_ASSERT_EQUAL_UINT64(100, energy.time[MODE_TX]);
+    TEST_ASSERT_EQUAL_UINT64(10, energy.time[MODE_STDBY]);
+    TEST_ASSERT_EQUAL_UINT64(2000 + 4000000 + 15000, energy.charge);
+    TEST_ASSERT_EQUAL_UINT8(MODE_SLEEP, energy.mode);
+    TEST_ASSERT_EQUAL_UINT32(3110, energy.since);
+}
+
+void test_ulorawan_energy_mode_invalid()
+{
+    // Arrange
+
+    // Act
+    ulorawan_energy_mode(&energy, ULORAWAN_ENERGY_MODES);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(MODE_SLEEP, energy.mode);
+    TEST_ASSERT_EQUAL_UINT32(1000, energy.since);
+}
+
+void test_ulorawan_energy_update_wrap()
+{
+    // Arrange
+    timer_hal_get_time_ExpectAndReturn(0xFFFFFF00);
+    ulorawan_energy_reset(&energy);
+    timer_hal_get_time_ExpectAndReturn(0x100);
+
+    // Act
+    ulorawan_energy_update(&energy);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT64(0x200, energy.time[MODE_SLEEP]);
+    TEST_ASSERT_EQUAL_UINT64(0x200, energy.charge);
+}
+
+void test_ulorawan_energy_irq()
+{
+    // Arrange
+    mode_at(1000, MODE_TX);
+    timer_hal_get_time_ExpectAndReturn(1050);
+
+    // Act
+    ulorawan_energy_irq(&energy, RADIO_HAL_IRQ_TX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(MODE_STDBY, energy.mode);
+    TEST_ASSERT_EQUAL_UINT64(50, energy.time[MODE_TX]);
+    TEST_ASSERT_EQUAL_UINT64(energy.charge, energy.exchange_rx);
+}
+
+void test_ulorawan_energy_irq_rx_single()
+{
+    // Arrange
+    mode_at(1000, MODE_RX_SINGLE);
+    timer_hal_get_time_ExpectAndReturn(1020);
+
+    // Act
+    ulorawan_energy_irq(&energy, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(MODE_STDBY, energy.mode);
+    TEST_ASSERT_EQUAL_UINT64(20, energy.time[MODE_RX_SINGLE]);
+}
+
+void test_ulorawan_energy_irq_rx_cont()
+{
+    // Arrange
+    mode_at(1000, MODE_RX_CONT);
+
+    // Act
+    ulorawan_energy_irq(&energy, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(MODE_RX_CONT, energy.mode);
+    TEST_ASSERT_EQUAL_UINT32(1000, energy.since);
+}
+
+void test_ulorawan_energy_uplink()
+{
+    // Arrange
+    step_at(1000, ULORAWAN_STATE_IDLE, ULORAWAN_STATE_TX, false);
+    mode_at(1000, MODE_TX);
+    timer_hal_get_time_ExpectAndReturn(1100);
+    ulorawan_energy_irq(&energy, RADIO_HAL_IRQ_TX_DONE);
+    mode_at(2100, MODE_RX_SINGLE);
+    timer_hal_get_time_ExpectAndReturn(2110);
+    ulorawan_energy_irq(&energy, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Act
+    step_at(2110, ULORAWAN_STATE_RX2, ULORAWAN_STATE_IDLE, false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(ENERGY_EXCHANGE_NONE, energy.exchange);
+    TEST_ASSERT_EQUAL_UINT32(1, energy.uplink.count);
+    TEST_ASSERT_EQUAL_UINT64(4000000 + 1500000 + 100000,
+                             energy.uplink.charge);
+    TEST_ASSERT_EQUAL_UINT64(energy.uplink.charge, energy.uplink.last);
+    TEST_ASSERT_EQUAL_UINT32(0, energy.downlink.count);
+}
+
+void test_ulorawan_energy_uplink_downlink()
+{
+    // Arrange
+    step_at(1000, ULORAWAN_STATE_IDLE, ULORAWAN_STATE_TX, false);
+    mode_at(1000, MODE_TX);
+    timer_hal_get_time_ExpectAndReturn(1100);
+    ulorawan_energy_irq(&energy, RADIO_HAL_IRQ_TX_DONE);
+    mode_at(2100, MODE_RX_SINGLE);
+    timer_hal_get_time_ExpectAndReturn(2150);
+    ulorawan_energy_irq(&energy, RADIO_HAL_IRQ_RX_DONE);
+
+    // Act
+    step_at(2150, ULORAWAN_STATE_RX1, ULORAWAN_STATE_IDLE, true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(1, energy.uplink.count);
+    TEST_ASSERT_EQUAL_UINT64(4000000, energy.uplink.charge);
+    TEST_ASSERT_EQUAL_UINT32(1, energy.downlink.count);
+    TEST_ASSERT_EQUAL_UINT64(1500000 + 500000, energy.downlink.charge);
+}
+
+void test_ulorawan_energy_step_class_c()
+{
+    // Arrange
+    step_at(1000, ULORAWAN_STATE_RXC, ULORAWAN_STATE_CAD, false);
+    mode_at(1000, MODE_RX_CAD);
+
+    // Act
+    ulorawan_energy_step(&energy, ULORAWAN_STATE_CAD, ULORAWAN_STATE_TX,
+                         false);
+    step_at(1010, ULORAWAN_STATE_RX2, ULORAWAN_STATE_RXC, false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(1, energy.uplink.count);
+    TEST_ASSERT_EQUAL_UINT64(80000, energy.uplink.charge);
+}
+
+void test_ulorawan_energy_step_idle()
+{
+    // Arrange
+
+    // Act
+    ulorawan_energy_step(&energy, ULORAWAN_STATE_IDLE, ULORAWAN_STATE_RXC,
+                         false);
+    ulorawan_energy_step(&energy, ULORAWAN_STATE_RX1, ULORAWAN_STATE_IDLE,
+                         false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(ENERGY_EXCHANGE_NONE, energy.exchange);
+    TEST_ASSERT_EQUAL_UINT32(0, energy.uplink.count);
+}
+
+void test_ulorawan_energy_join()
+{
+    // Arrange
+    timer_hal_get_time_ExpectAndReturn(1000);
+    ulorawan_energy_begin(&energy, ENERGY_EXCHANGE_JOIN);
+    mode_at(1000, MODE_TX);
+    timer_hal_get_time_ExpectAndReturn(1200);
+
+    // Act
+    ulorawan_energy_end(&energy, true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(1, energy.join.count);
+    TEST_ASSERT_EQUAL_UINT64(8000000, energy.join.charge);
+    TEST_ASSERT_EQUAL_UINT32(0, energy.uplink.count);
+    TEST_ASSERT_EQUAL_UINT32(0, energy.downlink.count);
+}
+
+void test_ulorawan_energy_nah()
+{
+    // Arrange
+
+    // Act
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT64(0, ulorawan_energy_nah(1799));
+    TEST_ASSERT_EQUAL_UINT64(1, ulorawan_energy_nah(1800));
+    TEST_ASSERT_EQUAL_UINT64(1111, ulorawan_energy_nah(4000000));
+}
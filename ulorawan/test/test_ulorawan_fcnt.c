@@ -0,0 +1,149 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_fcnt.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_ulorawan_store.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+static uint8_t put_key;
+static uint8_t put_value[4];
+
+static int32_t store_put(struct ulorawan_store *const store, uint8_t key,
+                         const uint8_t *const value, uint8_t size,
+                         int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    TEST_ASSERT_EQUAL_PTR(&session.store, store);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(put_value), size);
+    put_key = key;
+    memcpy(put_value, value, size);
+    return ULORAWAN_ERR_NONE;
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.fcnt.block = 100;
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_fcnt_restore()
+{
+    // Arrange
+    const uint8_t record[] = {0x2C, 0x01, 0x00, 0x00};
+    ulorawan_store_get_ExpectAndReturn(&session.store, ULORAWAN_STORE_KEY_FCNT_UP,
+        NULL, 4, ULORAWAN_ERR_NONE);
+    ulorawan_store_get_IgnoreArg_value();
+    ulorawan_store_get_ReturnMemThruPtr_value(record, sizeof(record));
+
+    // Act
+    int32_t result = ulorawan_fcnt_restore(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(300, session.keys.fcnt_up);
+    TEST_ASSERT_EQUAL_UINT32(300, session.fcnt.reserved);
+}
+
+void test_ulorawan_fcnt_restore_none()
+{
+    // Arrange
+    ulorawan_store_get_ExpectAnyArgsAndReturn(ULORAWAN_ERR_PARAMS);
+
+    // Act
+    int32_t result = ulorawan_fcnt_restore(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(0, session.keys.fcnt_up);
+}
+
+void test_ulorawan_fcnt_reserve_block()
+{
+    // Arrange
+    const uint8_t record[] = {0x2C, 0x01, 0x00, 0x00};
+    session.keys.fcnt_up = 200;
+    session.fcnt.reserved = 200;
+    ulorawan_store_put_StubWithCallback(store_put);
+    ulorawan_store_flush_ExpectAndReturn(&session.store, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_fcnt_reserve(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(ULORAWAN_STORE_KEY_FCNT_UP, put_key);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(record, put_value, sizeof(record));
+    TEST_ASSERT_EQUAL_UINT32(300, session.fcnt.reserved);
+    TEST_ASSERT_EQUAL_UINT32(1, session.fcnt.stats.reservations);
+}
+
+void test_ulorawan_fcnt_reserve_saved()
+{
+    // Arrange
+    session.keys.fcnt_up = 250;
+    session.fcnt.reserved = 300;
+
+    // Act
+    int32_t result = ulorawan_fcnt_reserve(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(300, session.fcnt.reserved);
+    TEST_ASSERT_EQUAL_UINT32(1, session.fcnt.stats.saved);
+}
+
+void test_ulorawan_fcnt_reserve_error()
+{
+    // Arrange
+    session.keys.fcnt_up = 300;
+    session.fcnt.reserved = 300;
+    ulorawan_store_put_ExpectAnyArgsAndReturn(ULORAWAN_ERR_NONE);
+    ulorawan_store_flush_ExpectAndReturn(&session.store, ULORAWAN_ERR_NVM);
+
+    // Act
+    int32_t result = ulorawan_fcnt_reserve(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NVM, result);
+    TEST_ASSERT_EQUAL_UINT32(300, session.fcnt.reserved);
+    TEST_ASSERT_EQUAL_UINT32(0, session.fcnt.stats.reservations);
+}
@@ -0,0 +1,375 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_frag.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_uplink_queue.h"
+
+#include "mock_nvm_hal.h"
+
+TEST_FILE("log_console.c")
+
+#define NB_FRAG 8
+#define FRAG_SIZE 8
+#define PADDING 3
+
+static struct ulorawan_session session;
+static uint8_t nvm[NVM_HAL_SECTOR_SIZE];
+static uint8_t block[NB_FRAG][FRAG_SIZE];
+
+static int32_t nvm_read(uint32_t address, uint8_t *const buf, size_t size,
+                        int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    TEST_ASSERT_TRUE(address + size <= sizeof(nvm));
+    memcpy(buf, &nvm[address], size);
+    return NVM_HAL_ERR_NONE;
+}
+
+// Flash is programmed once after an erase
+static int32_t nvm_write(uint32_t address, const uint8_t *const buf,
+                         size_t size, int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    TEST_ASSERT_TRUE(address + size <= sizeof(nvm));
+    for (size_t i = 0; i < size; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(0xFF, nvm[address + i]);
+    }
+    memcpy(&nvm[address], buf, size);
+    return NVM_HAL_ERR_NONE;
+}
+
+static int32_t nvm_erase(uint32_t address, int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    TEST_ASSERT_EQUAL_UINT32(0, address % NVM_HAL_SECTOR_SIZE);
+    TEST_ASSERT_TRUE(address < sizeof(nvm));
+    memset(&nvm[address], 0xFF, NVM_HAL_SECTOR_SIZE);
+    return NVM_HAL_ERR_NONE;
+}
+
+// The coded fragment n, built as the fragmentation specification describes
+static void encode(uint16_t n, uint8_t *const coded)
+{
+    uint8_t line[NB_FRAG] = {0};
+    uint32_t x = 1 + 1001 * n;
+    uint32_t modulus = (NB_FRAG & (NB_FRAG - 1)) == 0 ? NB_FRAG + 1 : NB_FRAG;
+
+    for (int i = 0; i < NB_FRAG / 2; i++)
+    {
+        uint32_t r = 1 << 16;
+        while (r >= NB_FRAG)
+        {
+            x = (x >> 1) + (((x & 1) ^ ((x & 0x20) >> 5)) << 22);
+            r = x % modulus;
+        }
+        line[r] = 1;
+    }
+
+    memset(coded, 0, FRAG_SIZE);
+    for (int i = 0; i < NB_FRAG; i++)
+    {
+        for (int b = 0; line[i] && b < FRAG_SIZE; b++)
+        {
+            coded[b] ^= block[i][b];
+        }
+    }
+}
+
+static int32_t send_fragment(uint16_t n, const uint8_t *const data)
+{
+    uint8_t msg[3 + FRAG_SIZE] = {0x08, (uint8_t)n, (uint8_t)(n >> 8)};
+
+    memcpy(&msg[3], data, FRAG_SIZE);
+
+    return ulorawan_frag_process(&session, msg, sizeof(msg));
+}
+
+static void setup_session(void)
+{
+    const uint8_t setup[] = {0x02, 0x01, NB_FRAG, 0x00, FRAG_SIZE, 0x00,
+                             PADDING, 0x44, 0x33, 0x22, 0x11};
+
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE,
+        ulorawan_frag_process(&session, setup, sizeof(setup)));
+    ulorawan_uplink_queue_pop(&session.uplink_queue);
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    memset(nvm, 0xFF, sizeof(nvm));
+    for (int i = 0; i < NB_FRAG; i++)
+    {
+        for (int b = 0; b < FRAG_SIZE; b++)
+        {
+            block[i][b] = (uint8_t)(i * 31 + b * 7 + 1);
+        }
+    }
+    nvm_hal_read_StubWithCallback(nvm_read);
+    nvm_hal_write_StubWithCallback(nvm_write);
+    nvm_hal_erase_StubWithCallback(nvm_erase);
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_frag_package_version()
+{
+    // Arrange
+    const uint8_t req[] = {0x00};
+
+    // Act
+    int32_t result = ulorawan_frag_process(&session, req, sizeof(req));
+
+    // Assert
+    struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&session.uplink_queue);
+    const uint8_t expected[] = {0x00, 3, 1};
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_NOT_NULL(msg);
+    TEST_ASSERT_EQUAL_UINT8(ULORAWAN_FRAG_PORT, msg->port);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), msg->size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, msg->payload, sizeof(expected));
+}
+
+void test_ulorawan_frag_setup()
+{
+    // Arrange
+    const uint8_t req[] = {0x02, 0x01, NB_FRAG, 0x00, FRAG_SIZE, 0x00,
+                           PADDING, 0x44, 0x33, 0x22, 0x11};
+
+    // Act
+    int32_t result = ulorawan_frag_process(&session, req, sizeof(req));
+
+    // Assert
+    struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&session.uplink_queue);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(2, msg->size);
+    TEST_ASSERT_EQUAL_HEX8(0x00, msg->payload[1]);
+    TEST_ASSERT_EQUAL_UINT8(1, session.frag.active);
+    TEST_ASSERT_EQUAL_UINT8(0x01, session.frag.mc_group_mask);
+    TEST_ASSERT_EQUAL_UINT16(NB_FRAG, session.frag.nb_frag);
+    TEST_ASSERT_EQUAL_UINT8(FRAG_SIZE, session.frag.frag_size);
+    TEST_ASSERT_EQUAL_HEX32(0x11223344, session.frag.descriptor);
+}
+
+void test_ulorawan_frag_setup_erase_error()
+{
+    // Arrange
+    const uint8_t req[] = {0x02, 0x01, NB_FRAG, 0x00, FRAG_SIZE, 0x00,
+                           PADDING, 0x44, 0x33, 0x22, 0x11};
+    nvm_hal_erase_StubWithCallback(NULL);
+    nvm_hal_erase_ExpectAndReturn(ULORAWAN_FRAG_NVM_ADDRESS, NVM_HAL_ERR_FAIL);
+
+    // Act
+    int32_t result = ulorawan_frag_process(&session, req, sizeof(req));
+
+    // Assert
+    struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&session.uplink_queue);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(0x02, msg->payload[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, session.frag.active);
+}
+
+void test_ulorawan_frag_setup_unsupported()
+{
+    // Arrange
+    const uint8_t req[] = {0x02, 0x10, 0x00, 0x04, FRAG_SIZE, 0x08,
+                           0x00, 0x00, 0x00, 0x00, 0x00};
+
+    // Act
+    int32_t result = ulorawan_frag_process(&session, req, sizeof(req));
+
+    // Assert
+    struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&session.uplink_queue);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(0x47, msg->payload[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, session.frag.active);
+}
+
+void test_ulorawan_frag_uncoded()
+{
+    // Arrange
+    setup_session();
+
+    // Act
+    for (uint16_t n = 1; n <= NB_FRAG; n++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, send_fragment(n, block[n - 1]));
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, session.frag.complete);
+    TEST_ASSERT_EQUAL_UINT32(NB_FRAG * FRAG_SIZE - PADDING,
+                             ulorawan_frag_block_size(&session.frag));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(block, nvm, sizeof(block));
+}
+
+void test_ulorawan_frag_second_session()
+{
+    // Arrange
+    setup_session();
+    for (uint16_t n = 1; n <= NB_FRAG; n++)
+    {
+        send_fragment(n, block[n - 1]);
+    }
+    for (int i = 0; i < NB_FRAG; i++)
+    {
+        for (int b = 0; b < FRAG_SIZE; b++)
+        {
+            block[i][b] = (uint8_t)~block[i][b];
+        }
+    }
+    setup_session();
+
+    // Act
+    for (uint16_t n = 1; n <= NB_FRAG; n++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, send_fragment(n, block[n - 1]));
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, session.frag.complete);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(block, nvm, sizeof(block));
+}
+
+void test_ulorawan_frag_recover_lost()
+{
+    // Arrange
+    uint8_t coded[FRAG_SIZE];
+    uint16_t n;
+    setup_session();
+
+    for (n = 1; n <= NB_FRAG; n++)
+    {
+        if (n != 2 && n != 5 && n != 6)
+        {
+            send_fragment(n, block[n - 1]);
+        }
+    }
+
+    // Act
+    for (n = 1; n <= 16 && !session.frag.complete; n++)
+    {
+        encode(n, coded);
+        TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, send_fragment(NB_FRAG + n, coded));
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, session.frag.complete);
+    TEST_ASSERT_EQUAL_UINT16(3, session.frag.lost);
+    TEST_ASSERT_EQUAL_UINT32(3, session.frag.stats.recovered);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(block, nvm, sizeof(block));
+}
+
+void test_ulorawan_frag_late_uncoded()
+{
+    // Arrange
+    uint8_t coded[FRAG_SIZE];
+    setup_session();
+
+    for (uint16_t n = 1; n <= NB_FRAG; n++)
+    {
+        if (n != 3 && n != 7)
+        {
+            send_fragment(n, block[n - 1]);
+        }
+    }
+
+    // Act
+    for (uint16_t n = 1; n <= 16 && session.frag.rows == 0; n++)
+    {
+        encode(n, coded);
+        send_fragment(NB_FRAG + n, coded);
+    }
+    send_fragment(3, block[2]);
+    send_fragment(7, block[6]);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, session.frag.complete);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(block, nvm, sizeof(block));
+}
+
+void test_ulorawan_frag_status()
+{
+    // Arrange
+    const uint8_t req[] = {0x01, 0x00};
+    setup_session();
+    send_fragment(1, block[0]);
+    send_fragment(1, block[0]);
+
+    // Act
+    int32_t result = ulorawan_frag_process(&session, req, sizeof(req));
+
+    // Assert
+    struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&session.uplink_queue);
+    const uint8_t expected[] = {0x01, 0x02, 0x00, NB_FRAG - 1, 0x00};
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), msg->size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, msg->payload, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT32(1, session.frag.stats.redundant);
+}
+
+void test_ulorawan_frag_delete()
+{
+    // Arrange
+    const uint8_t req[] = {0x03, 0x00, 0x03, 0x00};
+    setup_session();
+
+    // Act
+    int32_t result = ulorawan_frag_process(&session, req, sizeof(req));
+
+    // Assert
+    struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&session.uplink_queue);
+    const uint8_t expected[] = {0x03, 0x00, 0x03, 0x04};
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, msg->payload, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT8(0, session.frag.active);
+}
+
+void test_ulorawan_frag_fragment_size()
+{
+    // Arrange
+    const uint8_t req[] = {0x08, 0x01, 0x00, 0xAA};
+    setup_session();
+
+    // Act
+    int32_t result = ulorawan_frag_process(&session, req, sizeof(req));
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FRAME, result);
+    TEST_ASSERT_EQUAL_UINT16(0, session.frag.received);
+}
@@ -37,7 +37,12 @@
 #include "ulorawan_error_codes.h"
 
 #include "mock_timer_hal.h"
+#include "mock_ulorawan_class_b.h"
+#include "mock_ulorawan_class_c.h"
+#include "mock_ulorawan_lbt.h"
 #include "mock_ulorawan_downlink.h"
+#include "mock_ulorawan_region.h"
+#include "mock_ulorawan_retrans.h"
 
 TEST_FILE("log_console.c")
 
@@ -79,9 +84,14 @@ void test_ulorawan_radio_irq_handler_state_tx_success()
     // Arrange
     struct ulorawan_session session;
     session.state = ULORAWAN_STATE_TX;
+    session.class = DEVICE_CLASS_A;
     session.region_params.rx_delay_1 = 100;
     session.region_params.rx_delay_2 = 200;
+    session.channel.band = 2;
+    session.tx_start = 1000;
 
+    timer_hal_get_time_ExpectAndReturn(1050);
+    ulorawan_region_record_tx_Expect(&session.region_params, 2, 1000, 1050);
     timer_hal_start_ExpectAndReturn(TIMER0, 100, TIMER_HAL_ERR_NONE);
     timer_hal_start_ExpectAndReturn(TIMER1, 200, TIMER_HAL_ERR_NONE);
 
@@ -93,12 +103,70 @@ void test_ulorawan_radio_irq_handler_state_tx_success()
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RX1, session.state);
 }
 
+void test_ulorawan_radio_irq_handler_state_tx_class_c()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_TX;
+    session.class = DEVICE_CLASS_C;
+    session.region_params.rx_delay_1 = 100;
+    session.region_params.rx_delay_2 = 200;
+
+    timer_hal_get_time_IgnoreAndReturn(0);
+    ulorawan_region_record_tx_Ignore();
+    timer_hal_start_ExpectAndReturn(TIMER0, 100, TIMER_HAL_ERR_NONE);
+    timer_hal_start_ExpectAndReturn(TIMER1, 200, TIMER_HAL_ERR_NONE);
+    ulorawan_class_c_listen_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_TX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RX1, session.state);
+}
+
+void test_ulorawan_radio_irq_handler_state_rx1_timeout()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RX1;
+    session.class = DEVICE_CLASS_A;
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RX2, session.state);
+}
+
+void test_ulorawan_radio_irq_handler_state_rx1_timeout_class_c()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RX1;
+    session.class = DEVICE_CLASS_C;
+
+    ulorawan_class_c_listen_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    ulorawan_retrans_rx_done_Expect(&session, false);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
+
 void test_ulorawan_radio_irq_handler_state_rx1_timer_error()
 {
     // Arrange
     struct ulorawan_session session;
     session.state = ULORAWAN_STATE_RX1;
-    
+    session.rx.multicast = 0;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
     timer_hal_stop_ExpectAndReturn(TIMER1, TIMER_HAL_ERR_FAIL);
 
     // Act
@@ -106,6 +174,7 @@ void test_ulorawan_radio_irq_handler_state_rx1_timer_error()
 
     // Assert
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_TIMER, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
 }
 
 void test_ulorawan_radio_irq_handler_state_rx1_downlink_error()
@@ -113,8 +182,7 @@ void test_ulorawan_radio_irq_handler_state_rx1_downlink_error()
     // Arrange
     struct ulorawan_session session;
     session.state = ULORAWAN_STATE_RX1;
-
-    timer_hal_stop_ExpectAnyArgsAndReturn(TIMER_HAL_ERR_NONE);
+    session.class = DEVICE_CLASS_A;
 
     ulorawan_downlink_handler_ExpectAndReturn(NULL, ULORAWAN_ERR_PARAMS);
     ulorawan_downlink_handler_IgnoreArg_session();
@@ -124,18 +192,57 @@ void test_ulorawan_radio_irq_handler_state_rx1_downlink_error()
 
     // Assert
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RX2, session.state);
 }
 
-void test_ulorawan_radio_irq_handler_state_rx1_success()
+void test_ulorawan_radio_irq_handler_state_rx1_downlink_mic()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RX1;
+    session.class = DEVICE_CLASS_A;
+
+    // TIMER1 keeps running to open RX2
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_MIC);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RX2, session.state);
+}
+
+void test_ulorawan_radio_irq_handler_state_rx1_downlink_mic_class_c()
 {
     // Arrange
     struct ulorawan_session session;
     session.state = ULORAWAN_STATE_RX1;
+    session.class = DEVICE_CLASS_C;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_MIC);
+    ulorawan_class_c_listen_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    ulorawan_retrans_rx_done_Expect(&session, false);
 
-    timer_hal_stop_ExpectAnyArgsAndReturn(TIMER_HAL_ERR_NONE);
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
+
+void test_ulorawan_radio_irq_handler_state_rx1_success()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RX1;
+    session.rx.multicast = 0;
 
     ulorawan_downlink_handler_ExpectAndReturn(NULL, ULORAWAN_ERR_NONE);
     ulorawan_downlink_handler_IgnoreArg_session();
+    timer_hal_stop_ExpectAndReturn(TIMER1, TIMER_HAL_ERR_NONE);
+    ulorawan_retrans_rx_done_Expect(&session, true);
 
     // Act
     int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
@@ -145,12 +252,32 @@ void test_ulorawan_radio_irq_handler_state_rx1_success()
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
 }
 
+void test_ulorawan_radio_irq_handler_state_rx1_multicast()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RX1;
+    session.class = DEVICE_CLASS_A;
+    session.rx.multicast = 1;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RX2, session.state);
+}
+
 void test_ulorawan_radio_irq_handler_state_rx2_timeout()
 {
     // Arrange
     struct ulorawan_session session;
     session.state = ULORAWAN_STATE_RX2;
 
+    ulorawan_retrans_rx_done_Expect(&session, false);
+
     // Act
     int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_TIMEOUT);
 
@@ -167,12 +294,31 @@ void test_ulorawan_radio_irq_handler_state_rx2_downlink_error()
 
     ulorawan_downlink_handler_ExpectAndReturn(NULL, ULORAWAN_ERR_PARAMS);
     ulorawan_downlink_handler_IgnoreArg_session();
+    ulorawan_retrans_rx_done_Expect(&session, false);
 
     // Act
     int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
 
     // Assert
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+}
+
+void test_ulorawan_radio_irq_handler_state_rx2_downlink_mic()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RX2;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_MIC);
+    ulorawan_retrans_rx_done_Expect(&session, false);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
 }
 
 void test_ulorawan_radio_irq_handler_state_rx2_success()
@@ -180,9 +326,11 @@ void test_ulorawan_radio_irq_handler_state_rx2_success()
     // Arrange
     struct ulorawan_session session;
     session.state = ULORAWAN_STATE_RX2;
+    session.rx.multicast = 0;
 
     ulorawan_downlink_handler_ExpectAndReturn(NULL, ULORAWAN_ERR_NONE);
     ulorawan_downlink_handler_IgnoreArg_session();
+    ulorawan_retrans_rx_done_Expect(&session, true);
 
     // Act
     int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
@@ -192,6 +340,88 @@ void test_ulorawan_radio_irq_handler_state_rx2_success()
     TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
 }
 
+void test_ulorawan_radio_irq_handler_state_rx2_multicast()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RX2;
+    session.rx.multicast = 1;
+
+    ulorawan_downlink_handler_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    ulorawan_retrans_rx_done_Expect(&session, false);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+}
+
+void test_ulorawan_radio_irq_handler_state_rxc()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_RXC;
+
+    ulorawan_class_c_irq_ExpectAndReturn(&session, RADIO_HAL_IRQ_RX_DONE,
+        ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_RXC, session.state);
+}
+
+void test_ulorawan_radio_irq_handler_state_ping()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_PING;
+
+    ulorawan_class_b_irq_ExpectAndReturn(&session, RADIO_HAL_IRQ_RX_TIMEOUT,
+        ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_TIMEOUT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_radio_irq_handler_state_cad_done()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_CAD;
+
+    ulorawan_lbt_cad_done_ExpectAndReturn(&session,
+        RADIO_HAL_IRQ_CAD_DONE | RADIO_HAL_IRQ_CAD_DETECTED, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session,
+        RADIO_HAL_IRQ_CAD_DONE | RADIO_HAL_IRQ_CAD_DETECTED);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_radio_irq_handler_state_cad_ignore()
+{
+    // Arrange
+    struct ulorawan_session session;
+    session.state = ULORAWAN_STATE_CAD;
+
+    // Act
+    int32_t result = ulorawan_radio_irq_handler(&session, RADIO_HAL_IRQ_RX_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_CAD, session.state);
+}
+
 void ulorawan_radio_irq_handler_tx_state_timer_test(
     enum timer_hal_timer timer,
     uint32_t interval,
@@ -204,6 +434,8 @@ void ulorawan_radio_irq_handler_tx_state_timer_test(
     session.region_params.rx_delay_1 = interval;
     session.region_params.rx_delay_2 = interval;
 
+    timer_hal_get_time_IgnoreAndReturn(0);
+    ulorawan_region_record_tx_Ignore();
     timer_hal_start_ExpectAndReturn(timer, interval, timer_result);
 
     // Act
@@ -0,0 +1,242 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_latency.h"
+#include "ulorawan_session.h"
+
+#include "mock_timer_hal.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_latency latency;
+
+void setUp(void)
+{
+    timer_hal_get_time_ExpectAndReturn(1000);
+    ulorawan_latency_reset(&latency);
+}
+
+void tearDown(void) {}
+
+static void step_at(uint32_t now, enum ulorawan_state from, enum ulorawan_state to)
+{
+    timer_hal_get_time_ExpectAndReturn(now);
+    ulorawan_latency_step(&latency, from, to);
+}
+
+void test_ulorawan_latency_reset()
+{
+    // Arrange
+    latency.count = 3;
+    latency.overflow = 2;
+    latency.radio_queue.count = 5;
+    timer_hal_get_time_ExpectAndReturn(5000);
+
+    // Act
+    ulorawan_latency_reset(&latency);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(5000, latency.last);
+    TEST_ASSERT_EQUAL_UINT8(0, latency.count);
+    TEST_ASSERT_EQUAL_UINT32(0, latency.overflow);
+    TEST_ASSERT_EQUAL_UINT32(0, latency.radio_queue.count);
+}
+
+void test_ulorawan_latency_step()
+{
+    // Arrange
+    step_at(1010, ULORAWAN_STATE_IDLE, ULORAWAN_STATE_TX);
+
+    // Act
+    step_at(2510, ULORAWAN_STATE_TX, ULORAWAN_STATE_RX1);
+    step_at(2520, ULORAWAN_STATE_IDLE, ULORAWAN_STATE_TX);
+    step_at(4022, ULORAWAN_STATE_TX, ULORAWAN_STATE_RX1);
+
+    // Assert
+    const struct ulorawan_latency_histogram *histogram =
+        ulorawan_latency_find(&latency, ULORAWAN_STATE_TX, ULORAWAN_STATE_RX1);
+
+    TEST_ASSERT_EQUAL_UINT8(2, latency.count);
+    TEST_ASSERT_EQUAL_UINT32(4022, latency.last);
+    TEST_ASSERT_NOT_NULL(histogram);
+    TEST_ASSERT_EQUAL_UINT32(2, histogram->count);
+    TEST_ASSERT_EQUAL_UINT32(3002, histogram->total);
+    TEST_ASSERT_EQUAL_UINT32(1502, histogram->max);
+    TEST_ASSERT_EQUAL_UINT16(2, histogram->buckets[11]);
+    TEST_ASSERT_NULL(ulorawan_latency_find(&latency, ULORAWAN_STATE_RX1,
+                                           ULORAWAN_STATE_RX2));
+}
+
+void test_ulorawan_latency_step_buckets()
+{
+    // Arrange
+    uint16_t expected[ULORAWAN_LATENCY_BUCKETS] = {0};
+    const uint32_t samples[] = {0, 1, 3, 4, 1500, 100000};
+    uint32_t now = 1000;
+
+    expected[0] = 1;
+    expected[1] = 1;
+    expected[2] = 1;
+    expected[3] = 1;
+    expected[11] = 1;
+    expected[ULORAWAN_LATENCY_BUCKETS - 1] = 1;
+
+    // Act
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        now += samples[i];
+        step_at(now, ULORAWAN_STATE_RX1, ULORAWAN_STATE_RX1);
+    }
+
+    // Assert
+    const struct ulorawan_latency_histogram *histogram =
+        ulorawan_latency_find(&latency, ULORAWAN_STATE_RX1, ULORAWAN_STATE_RX1);
+
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected, histogram->buckets, ULORAWAN_LATENCY_BUCKETS);
+    TEST_ASSERT_EQUAL_UINT32(100000, histogram->max);
+}
+
+void test_ulorawan_latency_step_overflow()
+{
+    // Arrange
+    for (uint8_t i = 0; i < ULORAWAN_LATENCY_MAX_STEPS; i++) {
+        step_at(1000, (enum ulorawan_state)(i % 10), (enum ulorawan_state)(i / 10));
+    }
+
+    // Act
+    step_at(1000, ULORAWAN_STATE_FAULT, ULORAWAN_STATE_FAULT);
+    step_at(1000, ULORAWAN_STATE_INIT, ULORAWAN_STATE_INIT);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(ULORAWAN_LATENCY_MAX_STEPS, latency.count);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.overflow);
+    TEST_ASSERT_EQUAL_UINT32(2, ulorawan_latency_find(&latency, ULORAWAN_STATE_INIT,
+                                                      ULORAWAN_STATE_INIT)->count);
+}
+
+void test_ulorawan_latency_queue()
+{
+    // Arrange
+    struct ulorawan_event radio = {.type = EVENT_TYPE_RADIO_IRQ};
+    struct ulorawan_event timer = {.type = EVENT_TYPE_TIMER_EXPIRE};
+
+    timer_hal_get_time_ExpectAndReturn(2000);
+    ulorawan_latency_enqueue(&radio);
+    timer_hal_get_time_ExpectAndReturn(2001);
+    ulorawan_latency_enqueue(&timer);
+
+    // Act
+    timer_hal_get_time_ExpectAndReturn(2003);
+    ulorawan_latency_dequeue(&latency, &radio);
+    timer_hal_get_time_ExpectAndReturn(2009);
+    ulorawan_latency_dequeue(&latency, &timer);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(2000, radio.time);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.radio_queue.count);
+    TEST_ASSERT_EQUAL_UINT32(3, latency.radio_queue.max);
+    TEST_ASSERT_EQUAL_UINT16(1, latency.radio_queue.buckets[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.timer_queue.count);
+    TEST_ASSERT_EQUAL_UINT32(8, latency.timer_queue.max);
+    TEST_ASSERT_EQUAL_UINT16(1, latency.timer_queue.buckets[4]);
+}
+
+void test_ulorawan_latency_percentile()
+{
+    // Arrange
+    struct ulorawan_latency_histogram histogram = {0};
+
+    histogram.count = 10;
+    histogram.max = 1900;
+    histogram.buckets[0] = 5;
+    histogram.buckets[3] = 4;
+    histogram.buckets[11] = 1;
+
+    // Act
+    uint32_t p50 = ulorawan_latency_percentile(&histogram, 50);
+    uint32_t p90 = ulorawan_latency_percentile(&histogram, 90);
+    uint32_t p99 = ulorawan_latency_percentile(&histogram, 99);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(0, p50);
+    TEST_ASSERT_EQUAL_UINT32(7, p90);
+    TEST_ASSERT_EQUAL_UINT32(1900, p99);
+}
+
+void test_ulorawan_latency_percentile_empty()
+{
+    // Arrange
+    struct ulorawan_latency_histogram histogram = {0};
+
+    // Act
+    uint32_t result = ulorawan_latency_percentile(&histogram, 50);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(0, result);
+}
+
+void test_ulorawan_latency_dump()
+{
+    // Arrange
+    char buf[256];
+
+    step_at(2500, ULORAWAN_STATE_TX, ULORAWAN_STATE_RX1);
+
+    // Act
+    size_t length = ulorawan_latency_dump(&latency, buf, sizeof(buf));
+
+    // Assert
+    const char *expected =
+        "TX>RX1 n=1 mean=1500 max=1500 0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0\n"
+        "QUEUE>RADIO n=0 mean=0 max=0 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\n"
+        "QUEUE>TIMER n=0 mean=0 max=0 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\n";
+
+    TEST_ASSERT_EQUAL_STRING(expected, buf);
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+}
+
+void test_ulorawan_latency_dump_truncated()
+{
+    // Arrange
+    char buf[8];
+
+    step_at(2500, ULORAWAN_STATE_TX, ULORAWAN_STATE_RX1);
+
+    // Act
+    size_t length = ulorawan_latency_dump(&latency, buf, sizeof(buf));
+
+    // Assert
+    TEST_ASSERT_EQUAL_STRING("TX>RX1 ", buf);
+    TEST_ASSERT_TRUE(length > sizeof(buf));
+}
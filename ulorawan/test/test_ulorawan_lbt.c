@@ -0,0 +1,212 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_lbt.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_rand_hal.h"
+#include "mock_radio_hal.h"
+#include "mock_timer_hal.h"
+#include "mock_ulorawan_energy.h"
+#include "mock_ulorawan_tx.h"
+#include "mock_ulorawan_region.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.channel.frequency = 868100000;
+    ulorawan_energy_mode_Ignore();
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_lbt_start_radio_error()
+{
+    // Arrange
+    timer_hal_get_time_ExpectAndReturn(1000);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CAD, RADIO_HAL_ERR_PARAM);
+
+    // Act
+    int32_t result = ulorawan_lbt_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_RADIO, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
+}
+
+void test_ulorawan_lbt_start_success()
+{
+    // Arrange
+    timer_hal_get_time_ExpectAndReturn(1000);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CAD, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_lbt_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_CAD, session.state);
+    TEST_ASSERT_EQUAL_UINT32(1, session.lbt.stats.cad_count);
+}
+
+void test_ulorawan_lbt_cad_done_clear()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_CAD;
+    session.lbt.start = 1000;
+
+    timer_hal_get_time_ExpectAndReturn(1007);
+    ulorawan_tx_transmit_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_lbt_cad_done(&session, RADIO_HAL_IRQ_CAD_DONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(0, session.lbt.stats.cad_hits);
+    TEST_ASSERT_EQUAL_UINT32(7, session.lbt.stats.time_spent);
+}
+
+void test_ulorawan_lbt_cad_done_busy_channel_change()
+{
+    // Arrange
+    struct ulorawan_channel channel = {868300000};
+    session.state = ULORAWAN_STATE_CAD;
+
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_get_channel_ReturnThruPtr_channel(&channel);
+    radio_hal_set_frequency_ExpectAndReturn(868300000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CAD, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_lbt_cad_done(&session,
+        RADIO_HAL_IRQ_CAD_DONE | RADIO_HAL_IRQ_CAD_DETECTED);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_CAD, session.state);
+    TEST_ASSERT_EQUAL_UINT32(868300000, session.channel.frequency);
+    TEST_ASSERT_EQUAL_UINT32(1, session.lbt.stats.cad_hits);
+    TEST_ASSERT_EQUAL_UINT32(1, session.lbt.stats.channel_changes);
+    TEST_ASSERT_EQUAL_UINT32(0, session.lbt.stats.backoffs);
+}
+
+void test_ulorawan_lbt_cad_done_busy_backoff()
+{
+    // Arrange
+    struct ulorawan_channel channel = {868100000};
+    uint32_t value = 5;
+    session.state = ULORAWAN_STATE_CAD;
+
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_get_channel_ReturnThruPtr_channel(&channel);
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+    rand_hal_get_random_ReturnThruPtr_value(&value);
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_NONE);
+    timer_hal_start_ExpectAndReturn(TIMER0, ULORAWAN_LBT_BACKOFF_MIN + 5,
+                                    TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_lbt_cad_done(&session,
+        RADIO_HAL_IRQ_CAD_DONE | RADIO_HAL_IRQ_CAD_DETECTED);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_CAD, session.state);
+    TEST_ASSERT_EQUAL_UINT32(1, session.lbt.stats.backoffs);
+}
+
+void test_ulorawan_lbt_cad_done_busy_timer_error()
+{
+    // Arrange
+    uint32_t value = 0;
+    session.state = ULORAWAN_STATE_CAD;
+
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_FAIL);
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+    rand_hal_get_random_ReturnThruPtr_value(&value);
+    radio_hal_set_mode_ExpectAndReturn(MODE_STDBY, RADIO_HAL_ERR_NONE);
+    timer_hal_start_ExpectAndReturn(TIMER0, ULORAWAN_LBT_BACKOFF_MIN,
+                                    TIMER_HAL_ERR_FAIL);
+
+    // Act
+    int32_t result = ulorawan_lbt_cad_done(&session,
+        RADIO_HAL_IRQ_CAD_DONE | RADIO_HAL_IRQ_CAD_DETECTED);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_TIMER, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
+}
+
+void test_ulorawan_lbt_cad_done_busy_max_attempts()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_CAD;
+    session.lbt.attempts = ULORAWAN_LBT_MAX_ATTEMPTS - 1;
+    session.lbt.start = 1000;
+
+    timer_hal_get_time_ExpectAndReturn(1500);
+
+    // Act
+    int32_t result = ulorawan_lbt_cad_done(&session,
+        RADIO_HAL_IRQ_CAD_DONE | RADIO_HAL_IRQ_CAD_DETECTED);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NO_CHANNEL, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_IDLE, session.state);
+    TEST_ASSERT_EQUAL_UINT32(1, session.lbt.stats.failures);
+    TEST_ASSERT_EQUAL_UINT32(500, session.lbt.stats.time_spent);
+}
+
+void test_ulorawan_lbt_backoff_expired()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_CAD;
+
+    radio_hal_set_mode_ExpectAndReturn(MODE_RX_CAD, RADIO_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_lbt_backoff_expired(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(1, session.lbt.stats.cad_count);
+}
@@ -0,0 +1,142 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_link_stats.h"
+
+static struct ulorawan_link_stats stats;
+
+void setUp(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_link_stats_empty()
+{
+    // Act & Assert
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_link_stats_count(&stats));
+    TEST_ASSERT_EQUAL_INT16(0, ulorawan_link_stats_mean(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_INT16(0, ulorawan_link_stats_min(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_UINT32(0, ulorawan_link_stats_variance(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_INT8(0, ulorawan_link_stats_margin(&stats));
+}
+
+void test_ulorawan_link_stats_add()
+{
+    // Act
+    ulorawan_link_stats_add(&stats, -100, 4);
+    ulorawan_link_stats_add(&stats, -90, 8);
+    ulorawan_link_stats_add(&stats, -110, -6);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(3, ulorawan_link_stats_count(&stats));
+    TEST_ASSERT_EQUAL_INT16(-100, ulorawan_link_stats_mean(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_INT16(-110, ulorawan_link_stats_min(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_UINT32(66, ulorawan_link_stats_variance(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_INT16(2, ulorawan_link_stats_mean(&stats, &stats.snr));
+    TEST_ASSERT_EQUAL_INT16(-6, ulorawan_link_stats_min(&stats, &stats.snr));
+    TEST_ASSERT_EQUAL_INT8(-6, ulorawan_link_stats_margin(&stats));
+}
+
+void test_ulorawan_link_stats_window_rolls()
+{
+    // Arrange
+    ulorawan_link_stats_add(&stats, -120, 0);
+
+    // Act
+    for (uint8_t i = 0; i < ULORAWAN_LINK_STATS_DEPTH; i++) {
+        ulorawan_link_stats_add(&stats, -80, 5);
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(ULORAWAN_LINK_STATS_DEPTH,
+        ulorawan_link_stats_count(&stats));
+    TEST_ASSERT_EQUAL_INT16(-80, ulorawan_link_stats_mean(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_INT16(-80, ulorawan_link_stats_min(&stats, &stats.rssi));
+    TEST_ASSERT_EQUAL_UINT32(0, ulorawan_link_stats_variance(&stats, &stats.rssi));
+}
+
+void test_ulorawan_link_stats_min_matches_window()
+{
+    // Arrange
+    int16_t samples[3 * ULORAWAN_LINK_STATS_DEPTH];
+
+    for (uint8_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        samples[i] = (int16_t)(-60 - ((i * 37) % 53));
+    }
+
+    for (uint8_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        // Act
+        ulorawan_link_stats_add(&stats, samples[i], 0);
+
+        // Assert
+        int16_t expected = samples[i];
+        uint8_t first = i + 1 > ULORAWAN_LINK_STATS_DEPTH ?
+            i + 1 - ULORAWAN_LINK_STATS_DEPTH : 0;
+
+        for (uint8_t j = first; j <= i; j++) {
+            if (samples[j] < expected) {
+                expected = samples[j];
+            }
+        }
+
+        TEST_ASSERT_EQUAL_INT16(expected,
+            ulorawan_link_stats_min(&stats, &stats.rssi));
+    }
+}
+
+void test_ulorawan_link_stats_margin_clamped()
+{
+    // Act
+    ulorawan_link_stats_add(&stats, -130, -40);
+    int8_t low = ulorawan_link_stats_margin(&stats);
+    ulorawan_link_stats_add(&stats, -30, 40);
+    int8_t high = ulorawan_link_stats_margin(&stats);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT8(-32, low);
+    TEST_ASSERT_EQUAL_INT8(31, high);
+}
+
+void test_ulorawan_link_stats_link_check()
+{
+    // Act
+    ulorawan_link_stats_link_check(&stats, 20, 3);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(20, stats.link_margin);
+    TEST_ASSERT_EQUAL_UINT8(3, stats.link_gw_cnt);
+}
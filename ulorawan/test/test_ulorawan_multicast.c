@@ -0,0 +1,154 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_multicast.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+static struct ulorawan_session session;
+
+static void add_group(uint32_t dev_addr, enum ulorawan_device_class class,
+                      uint32_t frequency)
+{
+    struct ulorawan_multicast_group group = {.keys.dev_addr = dev_addr,
+                                             .class = class,
+                                             .frequency = frequency};
+
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE,
+        ulorawan_multicast_add(&session.multicast, &group));
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.region_params.rx2_frequency = 869525000;
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_multicast_add_ordered()
+{
+    // Act
+    add_group(0x30, DEVICE_CLASS_C, 0);
+    add_group(0x10, DEVICE_CLASS_C, 0);
+    add_group(0x20, DEVICE_CLASS_B, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(3, session.multicast.count);
+    TEST_ASSERT_EQUAL_HEX32(0x10, session.multicast.groups[0].keys.dev_addr);
+    TEST_ASSERT_EQUAL_HEX32(0x20, session.multicast.groups[1].keys.dev_addr);
+    TEST_ASSERT_EQUAL_HEX32(0x30, session.multicast.groups[2].keys.dev_addr);
+}
+
+void test_ulorawan_multicast_add_no_ping_slot()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.keys.dev_addr = 0x10,
+                                             .class = DEVICE_CLASS_B,
+                                             .ping_offset = 0x20};
+
+    // Act
+    int32_t result = ulorawan_multicast_add(&session.multicast, &group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT16(UINT16_MAX,
+        session.multicast.groups[0].ping_offset);
+}
+
+void test_ulorawan_multicast_add_duplicate()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.keys.dev_addr = 0x10};
+    add_group(0x10, DEVICE_CLASS_C, 0);
+
+    // Act
+    int32_t result = ulorawan_multicast_add(&session.multicast, &group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_UINT8(1, session.multicast.count);
+}
+
+void test_ulorawan_multicast_add_full()
+{
+    // Arrange
+    struct ulorawan_multicast_group group = {.keys.dev_addr = 0xFF};
+    for (uint8_t i = 0; i < ULORAWAN_MULTICAST_MAX_GROUPS; i++)
+    {
+        add_group(i, DEVICE_CLASS_C, 0);
+    }
+
+    // Act
+    int32_t result = ulorawan_multicast_add(&session.multicast, &group);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FULL, result);
+}
+
+void test_ulorawan_multicast_find()
+{
+    // Arrange
+    add_group(0x30, DEVICE_CLASS_C, 0);
+    add_group(0x10, DEVICE_CLASS_C, 0);
+
+    // Act
+    struct ulorawan_multicast_group *found =
+        ulorawan_multicast_find(&session.multicast, 0x30);
+    struct ulorawan_multicast_group *missing =
+        ulorawan_multicast_find(&session.multicast, 0x20);
+
+    // Assert
+    TEST_ASSERT_EQUAL_PTR(&session.multicast.groups[1], found);
+    TEST_ASSERT_NULL(missing);
+}
+
+void test_ulorawan_multicast_remove()
+{
+    // Arrange
+    add_group(0x10, DEVICE_CLASS_C, 0);
+    add_group(0x20, DEVICE_CLASS_C, 0);
+    add_group(0x30, DEVICE_CLASS_C, 0);
+
+    // Act
+    int32_t result = ulorawan_multicast_remove(&session.multicast, 0x20);
+    int32_t missing = ulorawan_multicast_remove(&session.multicast, 0x20);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, missing);
+    TEST_ASSERT_EQUAL_UINT8(2, session.multicast.count);
+    TEST_ASSERT_EQUAL_HEX32(0x30, session.multicast.groups[1].keys.dev_addr);
+}
@@ -32,9 +32,17 @@
  */
 
 #include "unity.h"
+#include "mock_rand_hal.h"
+#include "mock_timer_hal.h"
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_duty_cycle.h"
 #include "ulorawan_region.h"
+#include "ulorawan_region_tables.h"
 
-void setUp(void) {}
+void setUp(void)
+{
+    timer_hal_get_time_IgnoreAndReturn(0);
+}
 
 void tearDown(void) {}
 
@@ -51,6 +59,509 @@ void test_ulorawan_ulorawan_region_init_params_success()
     TEST_ASSERT_EQUAL_INT32(ACTIVE_REGION, params.region );
     TEST_ASSERT_EQUAL_INT32(ULORAWAN_REGION_RECEIVE_DELAY1, params.rx_delay_1);
     TEST_ASSERT_EQUAL_INT32(ULORAWAN_REGION_RECEIVE_DELAY2, params.rx_delay_2);
+    TEST_ASSERT_EQUAL_PTR(&ulorawan_region_eu868, params.desc);
+    TEST_ASSERT_EQUAL_UINT32(869525000, params.rx2_frequency);
+    TEST_ASSERT_EQUAL_HEX8(DR_0, params.rx2_dr);
+}
+
+void test_ulorawan_region_select_unsupported()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    // Act
+    int32_t result = ulorawan_region_select(&params, REGION_NONE);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+}
+
+void test_ulorawan_region_select_us915()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    // Act
+    int32_t result = ulorawan_region_select(&params, REGION_US915);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_INT32(REGION_US915, params.region);
+    TEST_ASSERT_EQUAL_INT32(CFLIST_TYPE_FIXED, params.desc->plan);
+    TEST_ASSERT_EQUAL_UINT8(72, params.desc->max_channels);
+    TEST_ASSERT_EQUAL_UINT32(923300000, params.rx2_frequency);
+    TEST_ASSERT_EQUAL_HEX8(DR_8, params.rx2_dr);
+}
+
+void test_ulorawan_region_get_desc_all_regions()
+{
+    for (enum ulorawan_region region = REGION_EU868; region <= REGION_AS923_4; region++) {
+        const struct ulorawan_region_desc *desc = ulorawan_region_get_desc(region);
+
+        TEST_ASSERT_NOT_NULL(desc);
+        TEST_ASSERT_EQUAL_INT32(region, desc->region);
+        TEST_ASSERT_TRUE(desc->rx2_frequency >= desc->min_frequency);
+        TEST_ASSERT_TRUE(desc->rx2_frequency <= desc->max_frequency);
+        TEST_ASSERT_TRUE(desc->tx_power_count <= ULORAWAN_REGION_MAX_TX_POWER);
+        TEST_ASSERT_TRUE(desc->data_rates[DR_0].max_payload > 0);
+    }
+}
+
+void test_ulorawan_region_get_desc_invalid()
+{
+    TEST_ASSERT_NULL(ulorawan_region_get_desc(REGION_NONE));
+    TEST_ASSERT_NULL(ulorawan_region_get_desc((enum ulorawan_region)0xFF));
+}
+
+void test_ulorawan_region_get_dr()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    const struct ulorawan_region_dr *dr = ulorawan_region_get_dr(&params, DR_5);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(dr);
+    TEST_ASSERT_EQUAL_HEX8(MODULATION_LORA, dr->modulation);
+    TEST_ASSERT_EQUAL_HEX8(SPREAD_FACTOR_7, dr->sf);
+    TEST_ASSERT_EQUAL_HEX8(BW_125, dr->bw);
+    TEST_ASSERT_EQUAL_UINT8(230, dr->max_payload);
+}
+
+void test_ulorawan_region_get_dr_rfu()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    ulorawan_region_select(&params, REGION_US915);
+
+    // Act & Assert
+    TEST_ASSERT_NULL(ulorawan_region_get_dr(&params, DR_7));
+    TEST_ASSERT_NULL(ulorawan_region_get_dr(&params, DR_15));
+    TEST_ASSERT_NULL(ulorawan_region_get_dr(&params, ULORAWAN_REGION_MAX_DR));
+    TEST_ASSERT_EQUAL_HEX8(BW_500, ulorawan_region_get_dr(&params, DR_4)->bw);
+}
+
+void test_ulorawan_region_get_channel_success()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+    uint32_t random = 4;
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+    rand_hal_get_random_ReturnThruPtr_value(&random);
+
+    // Act
+    int32_t result = ulorawan_region_get_channel(&params, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(868300000, channel.frequency);
+    TEST_ASSERT_EQUAL_UINT8(1, channel.index);
+}
+
+void test_ulorawan_region_get_channel_rand_fail()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_INIT);
+
+    // Act
+    int32_t result = ulorawan_region_get_channel(&params, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+}
+
+void test_ulorawan_region_get_channel_duty_cycle_blocked()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+
+    ulorawan_region_select(&params, REGION_EU868);
+    ulorawan_region_record_tx(&params, 2, 0, 100);
+
+    // Act
+    int32_t result = ulorawan_region_get_channel(&params, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+    TEST_ASSERT_EQUAL_UINT32(10000, ulorawan_region_next_tx_time(&params));
+}
+
+void test_ulorawan_region_set_max_duty_cycle_invalid()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    int32_t result = ulorawan_region_set_max_duty_cycle(&params, 16);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+}
+
+void test_ulorawan_region_get_join_channel_wide()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+
+    ulorawan_region_select(&params, REGION_US915);
+    params.plan.join_attempts = 1;
+    params.plan.join_order[0] = 3;
+
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_region_get_join_channel(&params, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(67, channel.index);
+    TEST_ASSERT_EQUAL_UINT32(907800000, channel.frequency);
+    TEST_ASSERT_EQUAL_HEX8(DR_4, params.data_rate);
+}
+
+void test_ulorawan_region_get_join_channel_au915_narrow()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+    uint32_t random = 0;
+
+    ulorawan_region_select(&params, REGION_AU915);
+    params.plan.join_attempts = 2;
+    params.plan.join_order[1] = 0;
+
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+    rand_hal_get_random_ReturnThruPtr_value(&random);
+
+    // Act
+    int32_t result = ulorawan_region_get_join_channel(&params, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(0, channel.index);
+    TEST_ASSERT_EQUAL_UINT32(915200000, channel.frequency);
+    TEST_ASSERT_EQUAL_HEX8(DR_2, params.data_rate);
+}
+
+void test_ulorawan_region_get_join_channel_au915_wide()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+
+    ulorawan_region_select(&params, REGION_AU915);
+    params.plan.join_attempts = 1;
+    params.plan.join_order[0] = 3;
+
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_region_get_join_channel(&params, &channel);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(67, channel.index);
+    TEST_ASSERT_EQUAL_UINT32(920700000, channel.frequency);
+    TEST_ASSERT_EQUAL_HEX8(DR_6, params.data_rate);
+}
+
+void test_ulorawan_region_apply_chmask_success()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    int32_t result = ulorawan_region_apply_chmask(&params, 0, 0x0004);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000004, params.plan.enabled.words[0]);
+}
+
+void test_ulorawan_region_apply_chmask_undefined_channel()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    int32_t result = ulorawan_region_apply_chmask(&params, 0, 0x0008);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000007, params.plan.enabled.words[0]);
+}
+
+void test_ulorawan_region_update_channels_eu868()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+    const uint8_t cflist[ULORAWAN_REGION_CFLIST_SIZE] = {
+        0x18, 0x4F, 0x84, 0xE8, 0x56, 0x84, 0xB8, 0x5E, 0x84,
+        0x88, 0x66, 0x84, 0x58, 0x6E, 0x84, 0x00};
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    int32_t result = ulorawan_region_update_channels(&params, cflist);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x000000FF, params.plan.enabled.words[0]);
+    ulorawan_channel_plan_get(&params.plan, 3, &channel);
+    TEST_ASSERT_EQUAL_UINT32(867100000, channel.frequency);
+    TEST_ASSERT_EQUAL_UINT8(DR_5, channel.max_dr);
+    ulorawan_channel_plan_get(&params.plan, 7, &channel);
+    TEST_ASSERT_EQUAL_UINT32(867900000, channel.frequency);
+}
+
+void test_ulorawan_region_update_channels_as923()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    struct ulorawan_channel channel;
+    const uint8_t cflist[ULORAWAN_REGION_CFLIST_SIZE] = {
+        0x70, 0xB7, 0x8C, 0x40, 0xBF, 0x8C, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+    ulorawan_region_select(&params, REGION_AS923);
+
+    // Act
+    int32_t result = ulorawan_region_update_channels(&params, cflist);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x0000000F, params.plan.enabled.words[0]);
+    ulorawan_channel_plan_get(&params.plan, 2, &channel);
+    TEST_ASSERT_EQUAL_UINT32(922200000, channel.frequency);
+    ulorawan_channel_plan_get(&params.plan, 3, &channel);
+    TEST_ASSERT_EQUAL_UINT32(922400000, channel.frequency);
+}
+
+void test_ulorawan_region_update_channels_invalid_frequency()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    const uint8_t cflist[ULORAWAN_REGION_CFLIST_SIZE] = {
+        0x18, 0x4F, 0x84, 0x60, 0x9F, 0x8B, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    int32_t result = ulorawan_region_update_channels(&params, cflist);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000007, params.plan.defined.words[0]);
+}
+
+void test_ulorawan_region_update_channels_type_mismatch()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    uint8_t cflist[ULORAWAN_REGION_CFLIST_SIZE] = {0};
+
+    cflist[ULORAWAN_REGION_CFLIST_SIZE - 1] = CFLIST_TYPE_FIXED;
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    int32_t result = ulorawan_region_update_channels(&params, cflist);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+}
+
+void test_ulorawan_region_update_channels_us915()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    const uint8_t cflist[ULORAWAN_REGION_CFLIST_SIZE] = {
+        0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xFF,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+    ulorawan_region_select(&params, REGION_US915);
+
+    // Act
+    int32_t result = ulorawan_region_update_channels(&params, cflist);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x0000FF00, params.plan.enabled.words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, params.plan.enabled.words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0x00000002, params.plan.enabled.words[2]);
+}
+
+void test_ulorawan_region_update_channels_cn470()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    const uint8_t cflist[ULORAWAN_REGION_CFLIST_SIZE] = {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x0F, 0x80, 0x00, 0x00, 0x00, 0x01};
+
+    ulorawan_region_select(&params, REGION_CN470);
+
+    // Act
+    int32_t result = ulorawan_region_update_channels(&params, cflist);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, params.plan.enabled.words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0x800F0000, params.plan.enabled.words[2]);
+}
+
+void test_ulorawan_region_update_channels_fixed_empty()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    uint8_t cflist[ULORAWAN_REGION_CFLIST_SIZE] = {0};
+
+    cflist[ULORAWAN_REGION_CFLIST_SIZE - 1] = CFLIST_TYPE_FIXED;
+
+    ulorawan_region_select(&params, REGION_AU915);
+
+    // Act
+    int32_t result = ulorawan_region_update_channels(&params, cflist);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, params.plan.enabled.words[0]);
+}
+
+void test_ulorawan_region_max_payload_dwell_time()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    // Act
+    ulorawan_region_select(&params, REGION_AS923);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_region_max_payload(&params, DR_0));
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_region_max_payload(&params, DR_1));
+    TEST_ASSERT_EQUAL_UINT8(19, ulorawan_region_max_payload(&params, DR_2));
+    TEST_ASSERT_EQUAL_UINT8(61, ulorawan_region_max_payload(&params, DR_3));
+    TEST_ASSERT_EQUAL_UINT8(133, ulorawan_region_max_payload(&params, DR_4));
+    TEST_ASSERT_EQUAL_UINT8(250, ulorawan_region_max_payload(&params, DR_5));
+    TEST_ASSERT_EQUAL_UINT8(250, ulorawan_region_max_payload(&params, DR_7));
+}
+
+void test_ulorawan_region_set_tx_params_no_dwell_time()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    ulorawan_region_select(&params, REGION_AS923);
+
+    // Act
+    int32_t result = ulorawan_region_set_tx_params(&params, 0, 0, 5);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(59, ulorawan_region_max_payload(&params, DR_0));
+    TEST_ASSERT_EQUAL_UINT8(123, ulorawan_region_max_payload(&params, DR_2));
+    TEST_ASSERT_EQUAL_INT8(16, params.max_eirp);
+}
+
+void test_ulorawan_region_set_tx_params_unsupported()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    ulorawan_region_select(&params, REGION_EU868);
+
+    // Act
+    int32_t result = ulorawan_region_set_tx_params(&params, 1, 1, 5);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+    TEST_ASSERT_EQUAL_UINT8(59, ulorawan_region_max_payload(&params, DR_0));
+}
+
+void test_ulorawan_region_fit_payload_reroute()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    uint8_t dr = DR_15;
+
+    ulorawan_region_select(&params, REGION_AS923);
+    params.data_rate = DR_2;
+
+    // Act
+    int32_t result = ulorawan_region_fit_payload(&params, 40, &dr);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(DR_3, dr);
+}
+
+void test_ulorawan_region_fit_payload_current()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    uint8_t dr = DR_15;
+
+    ulorawan_region_select(&params, REGION_AS923);
+    params.data_rate = DR_2;
+
+    // Act
+    int32_t result = ulorawan_region_fit_payload(&params, 19, &dr);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(DR_2, dr);
+}
+
+void test_ulorawan_region_fit_payload_too_large()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    uint8_t dr;
+
+    ulorawan_region_select(&params, REGION_US915);
+
+    // Act
+    int32_t result = ulorawan_region_fit_payload(&params, 251, &dr);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_REGION_ERR_FAIL, result);
+}
+
+void test_ulorawan_region_get_eirp()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+
+    ulorawan_region_select(&params, REGION_AS923);
+    ulorawan_region_set_tx_params(&params, 1, 0, 2);
+
+    // Act
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT8(12, ulorawan_region_get_eirp(&params, 0));
+    TEST_ASSERT_EQUAL_INT8(8, ulorawan_region_get_eirp(&params, 2));
+    TEST_ASSERT_EQUAL_INT8(-2, ulorawan_region_get_eirp(&params, 15));
 }
 
 void test_ulorawan_region_version()
@@ -61,4 +572,20 @@ void test_ulorawan_region_version()
     TEST_ASSERT_EQUAL_HEX8(1, v.fields.minor);
     TEST_ASSERT_EQUAL_HEX8(0, v.fields.patch);
     TEST_ASSERT_EQUAL_HEX8(4, v.fields.revision);
-}
\ No newline at end of file
+}
+
+void test_ulorawan_region_frequency_valid()
+{
+    // Arrange
+    struct ulorawan_region_params params;
+    ulorawan_region_init_params(&params);
+
+    // Act
+
+    // Assert
+    TEST_ASSERT_TRUE(ulorawan_region_frequency_valid(&params, 863000000));
+    TEST_ASSERT_TRUE(ulorawan_region_frequency_valid(&params, 869525000));
+    TEST_ASSERT_TRUE(ulorawan_region_frequency_valid(&params, 870000000));
+    TEST_ASSERT_FALSE(ulorawan_region_frequency_valid(&params, 862999900));
+    TEST_ASSERT_FALSE(ulorawan_region_frequency_valid(&params, 870000100));
+}
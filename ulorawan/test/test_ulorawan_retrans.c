@@ -0,0 +1,174 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_retrans.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_rand_hal.h"
+#include "mock_timer_hal.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+static uint32_t random_value;
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.adr.nb_trans = 1;
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_retrans_start_confirmed()
+{
+    // Act
+    ulorawan_retrans_start(&session, true, 3, 100);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, session.retrans.active);
+    TEST_ASSERT_EQUAL_UINT8(1, session.retrans.attempts);
+    TEST_ASSERT_EQUAL_UINT8(ULORAWAN_RETRANS_CONFIRMED_NB_TRANS,
+        session.retrans.max_attempts);
+    TEST_ASSERT_EQUAL_UINT8(3, session.retrans.dr);
+}
+
+void test_ulorawan_retrans_unconfirmed_single()
+{
+    // Arrange
+    ulorawan_retrans_start(&session, false, 3, 100);
+
+    timer_hal_get_time_ExpectAndReturn(2100);
+
+    // Act
+    ulorawan_retrans_rx_done(&session, false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, session.retrans.active);
+    TEST_ASSERT_EQUAL_UINT32(1, session.retrans.stats.unconfirmed);
+    TEST_ASSERT_EQUAL_UINT8(1, session.retrans.stats.last_attempts);
+}
+
+void test_ulorawan_retrans_unconfirmed_nb_trans()
+{
+    // Arrange
+    session.adr.nb_trans = 2;
+    random_value = 1500;
+    ulorawan_retrans_start(&session, false, 3, 100);
+
+    timer_hal_get_time_ExpectAndReturn(2100);
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+    rand_hal_get_random_ReturnThruPtr_value(&random_value);
+
+    // Act
+    ulorawan_retrans_rx_done(&session, false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, session.retrans.active);
+    TEST_ASSERT_EQUAL_UINT32(2100 + 1000 + 1500, session.retrans.next);
+}
+
+void test_ulorawan_retrans_unconfirmed_downlink_stops()
+{
+    // Arrange
+    session.adr.nb_trans = 3;
+    ulorawan_retrans_start(&session, false, 3, 100);
+
+    timer_hal_get_time_ExpectAndReturn(1100);
+
+    // Act
+    ulorawan_retrans_rx_done(&session, true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, session.retrans.active);
+}
+
+void test_ulorawan_retrans_confirmed_no_ack()
+{
+    // Arrange
+    random_value = 0;
+    ulorawan_retrans_start(&session, true, 3, 100);
+
+    timer_hal_get_time_ExpectAndReturn(1100);
+    rand_hal_get_random_ExpectAnyArgsAndReturn(RAND_HAL_ERR_NONE);
+    rand_hal_get_random_ReturnThruPtr_value(&random_value);
+
+    // Act
+    ulorawan_retrans_rx_done(&session, true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(1, session.retrans.active);
+    TEST_ASSERT_EQUAL_UINT32(1100 + 1000, session.retrans.next);
+}
+
+void test_ulorawan_retrans_confirmed_acked()
+{
+    // Arrange
+    ulorawan_retrans_start(&session, true, 3, 100);
+    ulorawan_retrans_attempt(&session);
+
+    timer_hal_get_time_ExpectAndReturn(4100);
+
+    // Act
+    ulorawan_retrans_ack(&session);
+    ulorawan_retrans_rx_done(&session, true);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, session.retrans.active);
+    TEST_ASSERT_EQUAL_UINT32(1, session.retrans.stats.acked);
+    TEST_ASSERT_EQUAL_UINT32(1, session.retrans.stats.retransmissions);
+    TEST_ASSERT_EQUAL_UINT8(2, session.retrans.stats.last_attempts);
+    TEST_ASSERT_EQUAL_UINT32(4000, session.retrans.stats.last_latency);
+    TEST_ASSERT_EQUAL_UINT32(4000, session.retrans.stats.max_latency);
+}
+
+void test_ulorawan_retrans_confirmed_given_up()
+{
+    // Arrange
+    ulorawan_retrans_start(&session, true, 3, 100);
+    session.retrans.attempts = ULORAWAN_RETRANS_CONFIRMED_NB_TRANS;
+
+    timer_hal_get_time_ExpectAndReturn(30000);
+
+    // Act
+    ulorawan_retrans_rx_done(&session, false);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, session.retrans.active);
+    TEST_ASSERT_EQUAL_UINT32(1, session.retrans.stats.unacked);
+    TEST_ASSERT_EQUAL_UINT32(0, session.retrans.stats.acked);
+}
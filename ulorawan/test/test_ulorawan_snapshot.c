@@ -0,0 +1,232 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_snapshot.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+TEST_FILE("log_console.c")
+
+static const struct ulorawan_region_desc *const desc =
+    (const struct ulorawan_region_desc *)0x1000;
+
+static struct ulorawan_session session;
+static struct ulorawan_session restored;
+static uint8_t buf[sizeof(struct ulorawan_session)];
+
+static void fill_session(void)
+{
+    session.class = DEVICE_CLASS_C;
+    session.keys.dev_addr = 0x26011BDA;
+    memset(session.keys.nwk_s_key, 0xA5, sizeof(session.keys.nwk_s_key));
+    memset(session.keys.app_s_key, 0x5A, sizeof(session.keys.app_s_key));
+    session.keys.fcnt_up = 150;
+    session.keys.fcnt_down = 12;
+    session.fcnt.reserved = 200;
+    session.fcnt.block = 100;
+    session.multicast.count = 1;
+    session.multicast.groups[0].keys.dev_addr = 0xFC000001;
+    session.cmds.answers[0] = 0x03;
+    session.cmds.answers_size = 1;
+    session.adr.nb_trans = 2;
+    session.region_params.desc = desc;
+    session.region_params.data_rate = 3;
+    session.region_params.rx2_frequency = 869525000;
+    session.frame[0] = 0xEE;
+    session.frame_size = 1;
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    memset(&restored, 0, sizeof(restored));
+    memset(buf, 0, sizeof(buf));
+    restored.region_params.desc = desc;
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_snapshot_size()
+{
+    // Act
+    size_t size = ulorawan_snapshot_size();
+
+    // Assert
+    TEST_ASSERT_TRUE(size < sizeof(struct ulorawan_session) / 4);
+    TEST_ASSERT_TRUE(size > sizeof(struct ulorawan_session_keys));
+}
+
+void test_ulorawan_snapshot_round_trip()
+{
+    // Arrange
+    fill_session();
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE,
+        ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size()));
+
+    // Act
+    int32_t result = ulorawan_snapshot_restore(&restored, buf, ulorawan_snapshot_size());
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_MEMORY(&session.keys, &restored.keys, sizeof(session.keys));
+    TEST_ASSERT_EQUAL_MEMORY(&session.multicast, &restored.multicast, sizeof(session.multicast));
+    TEST_ASSERT_EQUAL_MEMORY(&session.cmds, &restored.cmds, sizeof(session.cmds));
+    TEST_ASSERT_EQUAL_MEMORY(&session.region_params, &restored.region_params,
+                             sizeof(session.region_params));
+    TEST_ASSERT_EQUAL_MEMORY(&session.fcnt, &restored.fcnt, sizeof(session.fcnt));
+    TEST_ASSERT_EQUAL_HEX8(DEVICE_CLASS_C, restored.class);
+    TEST_ASSERT_EQUAL_UINT8(2, restored.adr.nb_trans);
+    TEST_ASSERT_EQUAL_HEX8(0x00, restored.frame[0]);
+    TEST_ASSERT_EQUAL(0, restored.frame_size);
+}
+
+void test_ulorawan_snapshot_stale()
+{
+    // Arrange
+    fill_session();
+    ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size());
+    restored.keys.fcnt_up = 300;
+    restored.keys.fcnt_down = 20;
+    restored.fcnt.reserved = 300;
+
+    // Act
+    int32_t result = ulorawan_snapshot_restore(&restored, buf, ulorawan_snapshot_size());
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(300, restored.keys.fcnt_up);
+    TEST_ASSERT_EQUAL_UINT32(300, restored.fcnt.reserved);
+    TEST_ASSERT_EQUAL_UINT32(20, restored.keys.fcnt_down);
+}
+
+void test_ulorawan_snapshot_same_reservation()
+{
+    // Arrange
+    fill_session();
+    session.keys.fcnt_up = 110;
+    ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size());
+    restored.keys.fcnt_up = 200;
+    restored.fcnt.reserved = 200;
+
+    // Act
+    int32_t result = ulorawan_snapshot_restore(&restored, buf, ulorawan_snapshot_size());
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(200, restored.keys.fcnt_up);
+    TEST_ASSERT_EQUAL_UINT32(200, restored.fcnt.reserved);
+}
+
+void test_ulorawan_snapshot_newer_reservation()
+{
+    // Arrange
+    fill_session();
+    ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size());
+    restored.keys.fcnt_up = 100;
+    restored.fcnt.reserved = 100;
+
+    // Act
+    int32_t result = ulorawan_snapshot_restore(&restored, buf, ulorawan_snapshot_size());
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(150, restored.keys.fcnt_up);
+    TEST_ASSERT_EQUAL_UINT32(200, restored.fcnt.reserved);
+}
+
+void test_ulorawan_snapshot_duty_cycle()
+{
+    // Arrange
+    fill_session();
+    session.region_params.duty_cycle.release[0] = 3600000;
+    session.region_params.duty_cycle.aggregated_release = 3600000;
+    session.region_params.duty_cycle.blocked = 0x01;
+    session.region_params.duty_cycle.aggregated = 16;
+    ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size());
+    restored.region_params.duty_cycle.release[0] = 50;
+    restored.region_params.duty_cycle.band_count = 1;
+    restored.region_params.duty_cycle.limit[0] = 100;
+
+    // Act
+    int32_t result = ulorawan_snapshot_restore(&restored, buf, ulorawan_snapshot_size());
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT32(50, restored.region_params.duty_cycle.release[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, restored.region_params.duty_cycle.aggregated_release);
+    TEST_ASSERT_EQUAL_HEX8(0x00, restored.region_params.duty_cycle.blocked);
+    TEST_ASSERT_EQUAL_UINT8(1, restored.region_params.duty_cycle.band_count);
+    TEST_ASSERT_EQUAL_UINT16(100, restored.region_params.duty_cycle.limit[0]);
+    TEST_ASSERT_EQUAL_UINT16(16, restored.region_params.duty_cycle.aggregated);
+    TEST_ASSERT_EQUAL_UINT32(869525000, restored.region_params.rx2_frequency);
+}
+
+void test_ulorawan_snapshot_save_too_small()
+{
+    // Act
+    int32_t result = ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size() - 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_snapshot_corrupted()
+{
+    // Arrange
+    fill_session();
+    ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size());
+    buf[10] ^= 0x01;
+
+    // Act
+    int32_t result = ulorawan_snapshot_restore(&restored, buf, ulorawan_snapshot_size());
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_UINT32(0, restored.keys.dev_addr);
+}
+
+void test_ulorawan_snapshot_version()
+{
+    // Arrange
+    fill_session();
+    ulorawan_snapshot_save(&session, buf, ulorawan_snapshot_size());
+    buf[2]++;
+
+    // Act
+    int32_t result = ulorawan_snapshot_restore(&restored, buf, ulorawan_snapshot_size());
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
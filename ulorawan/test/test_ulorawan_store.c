@@ -0,0 +1,289 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_store.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_nvm_hal.h"
+
+TEST_FILE("log_console.c")
+
+#define FLASH_SIZE (ULORAWAN_STORE_SECTORS * NVM_HAL_SECTOR_SIZE)
+
+static struct ulorawan_session session;
+static uint8_t flash[FLASH_SIZE];
+static uint32_t writes;
+
+static int32_t flash_read(uint32_t address, uint8_t *const buf, size_t size,
+                          int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    address -= ULORAWAN_STORE_NVM_ADDRESS;
+    TEST_ASSERT_TRUE(address + size <= FLASH_SIZE);
+    memcpy(buf, &flash[address], size);
+    return NVM_HAL_ERR_NONE;
+}
+
+// Programming only clears bits
+static int32_t flash_write(uint32_t address, const uint8_t *const buf,
+                           size_t size, int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    address -= ULORAWAN_STORE_NVM_ADDRESS;
+    TEST_ASSERT_TRUE(address + size <= FLASH_SIZE);
+    for (size_t i = 0; i < size; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(0xFF, flash[address + i]);
+        flash[address + i] = buf[i];
+    }
+    writes++;
+    return NVM_HAL_ERR_NONE;
+}
+
+static int32_t flash_erase(uint32_t address, int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    address -= ULORAWAN_STORE_NVM_ADDRESS;
+    TEST_ASSERT_EQUAL_UINT32(0, address % NVM_HAL_SECTOR_SIZE);
+    TEST_ASSERT_TRUE(address < FLASH_SIZE);
+    memset(&flash[address], 0xFF, NVM_HAL_SECTOR_SIZE);
+    return NVM_HAL_ERR_NONE;
+}
+
+static void put_u32(uint8_t key, uint32_t value)
+{
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE,
+        ulorawan_store_put(&session.store, key, (const uint8_t *)&value, sizeof(value)));
+}
+
+static uint32_t get_u32(uint8_t key)
+{
+    uint32_t value = 0;
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE,
+        ulorawan_store_get(&session.store, key, (uint8_t *)&value, sizeof(value)));
+    return value;
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    memset(flash, 0xFF, sizeof(flash));
+    writes = 0;
+    nvm_hal_read_StubWithCallback(flash_read);
+    nvm_hal_write_StubWithCallback(flash_write);
+    nvm_hal_erase_StubWithCallback(flash_erase);
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_store_init_format()
+{
+    // Act
+    int32_t result = ulorawan_store_init(&session.store);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(1, session.store.mounted);
+    TEST_ASSERT_EQUAL_UINT32(1, session.store.sequence);
+    TEST_ASSERT_EQUAL_UINT32(1, session.store.stats.erases);
+    TEST_ASSERT_EQUAL_HEX8(0x54, flash[0]);
+}
+
+void test_ulorawan_store_put_not_mounted()
+{
+    // Arrange
+    uint8_t value = 1;
+
+    // Act
+    int32_t result = ulorawan_store_put(&session.store, 0, &value, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_STATE, result);
+}
+
+void test_ulorawan_store_put_invalid_key()
+{
+    // Arrange
+    uint8_t value = 1;
+    ulorawan_store_init(&session.store);
+
+    // Act
+    int32_t result = ulorawan_store_put(&session.store, ULORAWAN_STORE_MAX_KEYS, &value, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+}
+
+void test_ulorawan_store_remount()
+{
+    // Arrange
+    ulorawan_store_init(&session.store);
+    put_u32(1, 0x11111111);
+    put_u32(2, 0x22222222);
+    ulorawan_store_flush(&session.store);
+    put_u32(1, 0x33333333);
+    ulorawan_store_flush(&session.store);
+
+    // Act
+    int32_t result = ulorawan_store_init(&session.store);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x33333333, get_u32(1));
+    TEST_ASSERT_EQUAL_HEX32(0x22222222, get_u32(2));
+    TEST_ASSERT_EQUAL_UINT16(8 + 3 * 8, session.store.offset);
+}
+
+void test_ulorawan_store_coalesce()
+{
+    // Arrange
+    ulorawan_store_init(&session.store);
+    writes = 0;
+
+    // Act
+    for (uint32_t fcnt = 0; fcnt < 10; fcnt++)
+    {
+        put_u32(1, fcnt);
+        put_u32(2, fcnt);
+    }
+    ulorawan_store_flush(&session.store);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(1, writes);
+    TEST_ASSERT_EQUAL_UINT32(2, session.store.stats.records);
+    TEST_ASSERT_EQUAL_UINT32(18, session.store.stats.coalesced);
+    TEST_ASSERT_EQUAL_UINT32(9, get_u32(1));
+}
+
+void test_ulorawan_store_unchanged()
+{
+    // Arrange
+    ulorawan_store_init(&session.store);
+    put_u32(1, 7);
+    ulorawan_store_flush(&session.store);
+    writes = 0;
+
+    // Act
+    put_u32(1, 7);
+    ulorawan_store_flush(&session.store);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(0, writes);
+    TEST_ASSERT_EQUAL_UINT32(1, session.store.stats.unchanged);
+}
+
+void test_ulorawan_store_compaction_rotates()
+{
+    // Arrange
+    ulorawan_store_init(&session.store);
+    put_u32(0, 0xCAFE);
+    ulorawan_store_flush(&session.store);
+
+    // Act
+    for (uint32_t fcnt = 1; fcnt <= 4 * NVM_HAL_SECTOR_SIZE / 8; fcnt++)
+    {
+        put_u32(1, fcnt);
+        ulorawan_store_flush(&session.store);
+    }
+    ulorawan_store_init(&session.store);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(0, session.store.sector);
+    TEST_ASSERT_EQUAL_UINT32(5, session.store.sequence);
+    TEST_ASSERT_EQUAL_HEX32(0xCAFE, get_u32(0));
+    TEST_ASSERT_EQUAL_UINT32(4 * NVM_HAL_SECTOR_SIZE / 8, get_u32(1));
+}
+
+void test_ulorawan_store_torn_record()
+{
+    // Arrange
+    ulorawan_store_init(&session.store);
+    put_u32(1, 1);
+    ulorawan_store_flush(&session.store);
+    put_u32(1, 2);
+    ulorawan_store_flush(&session.store);
+    flash[8 + 8 + 3] ^= 0x01;
+
+    // Act
+    ulorawan_store_init(&session.store);
+    put_u32(1, 3);
+    ulorawan_store_flush(&session.store);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(1, session.store.sector);
+    TEST_ASSERT_EQUAL_UINT32(1, session.store.stats.compactions);
+    TEST_ASSERT_EQUAL_UINT32(3, get_u32(1));
+}
+
+void test_ulorawan_store_uncommitted_sector()
+{
+    // Arrange
+    ulorawan_store_init(&session.store);
+    put_u32(1, 1);
+    ulorawan_store_flush(&session.store);
+    memset(&flash[NVM_HAL_SECTOR_SIZE + 8], 0x00, 8);
+
+    // Act
+    ulorawan_store_init(&session.store);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(0, session.store.sector);
+    TEST_ASSERT_EQUAL_UINT32(1, get_u32(1));
+}
+
+void test_ulorawan_store_session_round_trip()
+{
+    // Arrange
+    session.security.type = ACTIVATION_OTAA;
+    session.keys.dev_addr = 0x26011BDA;
+    memset(session.keys.nwk_s_key, 0xA5, sizeof(session.keys.nwk_s_key));
+    memset(session.keys.app_s_key, 0x5A, sizeof(session.keys.app_s_key));
+    session.keys.fcnt_down = 42;
+    ulorawan_store_init(&session.store);
+    ulorawan_store_save_session(&session);
+    memset(&session.keys, 0, sizeof(session.keys));
+
+    // Act
+    ulorawan_store_init(&session.store);
+    int32_t result = ulorawan_store_load_session(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX32(0x26011BDA, session.keys.dev_addr);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, session.keys.nwk_s_key[15]);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, session.keys.app_s_key[0]);
+    TEST_ASSERT_EQUAL_UINT32(42, session.keys.fcnt_down);
+}
@@ -0,0 +1,162 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_tx.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+#include "ulorawan_channel_plan.h"
+#include "ulorawan_duty_cycle.h"
+#include "ulorawan_region.h"
+#include "ulorawan_region_tables.h"
+
+#include "mock_radio_hal.h"
+#include "mock_rand_hal.h"
+#include "mock_ulorawan_energy.h"
+#include "mock_ulorawan_lbt.h"
+#include "mock_timer_hal.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.channel.frequency = 868100000;
+    session.region_params.desc = &ulorawan_region_eu868;
+    session.region_params.max_eirp = 16;
+    session.uplink.eof = 12;
+    ulorawan_energy_mode_Ignore();
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_tx_start_frequency_error()
+{
+    // Arrange
+    radio_hal_set_frequency_ExpectAndReturn(868100000, RADIO_HAL_ERR_PARAM);
+
+    // Act
+    int32_t result = ulorawan_tx_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_RADIO, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
+}
+
+void test_ulorawan_tx_start_config_error()
+{
+    // Arrange
+    radio_hal_set_frequency_ExpectAndReturn(868100000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_tx_config_ExpectAnyArgsAndReturn(RADIO_HAL_ERR_PARAM);
+
+    // Act
+    int32_t result = ulorawan_tx_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_RADIO, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
+}
+
+void test_ulorawan_tx_start_lbt()
+{
+    // Arrange
+    struct radio_hal_tx_config config = {MODULATION_LORA, SPREAD_FACTOR_12,
+                                         BW_125, 16};
+
+    radio_hal_set_frequency_ExpectAndReturn(868100000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_tx_config_ExpectAndReturn(&config, RADIO_HAL_ERR_NONE);
+    ulorawan_lbt_start_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_tx_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_tx_start_max_eirp()
+{
+    // Arrange
+    struct radio_hal_tx_config config = {MODULATION_LORA, SPREAD_FACTOR_7,
+                                         BW_125, 10};
+
+    session.region_params.desc = &ulorawan_region_as923;
+    session.region_params.data_rate = DR_2;
+    session.region_params.tx_power = 1;
+    ulorawan_region_set_tx_params(&session.region_params, 1, 0, 2);
+    // Sent faster than the uplink data rate to fit the dwell time
+    session.retrans.dr = DR_5;
+
+    radio_hal_set_frequency_ExpectAndReturn(868100000, RADIO_HAL_ERR_NONE);
+    radio_hal_set_tx_config_ExpectAndReturn(&config, RADIO_HAL_ERR_NONE);
+    ulorawan_lbt_start_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_tx_start(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_tx_transmit_fifo_error()
+{
+    // Arrange
+    radio_hal_fifo_write_ExpectAndReturn(session.uplink.buf, 12, RADIO_HAL_ERR_PARAM);
+
+    // Act
+    int32_t result = ulorawan_tx_transmit(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_RADIO, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_FAULT, session.state);
+}
+
+void test_ulorawan_tx_transmit_success()
+{
+    // Arrange
+    radio_hal_fifo_write_ExpectAndReturn(session.uplink.buf, 12, RADIO_HAL_ERR_NONE);
+    radio_hal_set_mode_ExpectAndReturn(MODE_TX, RADIO_HAL_ERR_NONE);
+    timer_hal_get_time_ExpectAndReturn(1000);
+
+    // Act
+    int32_t result = ulorawan_tx_transmit(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_STATE_TX, session.state);
+    TEST_ASSERT_EQUAL_UINT32(1000, session.tx_start);
+}
@@ -0,0 +1,364 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_mac.h"
+#include "ulorawan_uplink.h"
+#include "ulorawan_uplink_queue.h"
+#include "ulorawan_session.h"
+#include "ulorawan_error_codes.h"
+
+#include "mock_timer_hal.h"
+#include "mock_ulorawan_adr.h"
+#include "mock_ulorawan_aggregate.h"
+#include "mock_ulorawan_cmds.h"
+#include "mock_ulorawan_crypto.h"
+#include "mock_ulorawan_fcnt.h"
+#include "mock_ulorawan_region.h"
+#include "mock_ulorawan_retrans.h"
+#include "mock_ulorawan_tx.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_session session;
+
+static const uint8_t payload[] = {0x01, 0x02, 0x03};
+
+static uint8_t fit_dr;
+static uint32_t mic = 0x44332211;
+
+static void queue_msg(bool confirm)
+{
+    struct ulorawan_uplink_req req = {.port = 10,
+                                      .payload = payload,
+                                      .size = sizeof(payload),
+                                      .confirm = confirm,
+                                      .priority = 1};
+
+    ulorawan_uplink_queue_push(&session.uplink_queue, &req, 0);
+}
+
+void setUp(void)
+{
+    memset(&session, 0, sizeof(session));
+    session.state = ULORAWAN_STATE_IDLE;
+    session.keys.dev_addr = 0x26011BDA;
+    session.keys.fcnt_up = 0x00010002;
+    session.region_params.data_rate = 5;
+    fit_dr = 5;
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_uplink_dispatch_not_idle()
+{
+    // Arrange
+    session.state = ULORAWAN_STATE_RX1;
+    queue_msg(false);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+}
+
+void test_ulorawan_uplink_dispatch_empty()
+{
+    // Arrange
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_uplink_dispatch_records_pending()
+{
+    // Arrange
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 400);
+    timer_hal_start_ExpectAndReturn(TIMER0, 400, TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+}
+
+void test_ulorawan_uplink_dispatch_too_large()
+{
+    // Arrange
+    queue_msg(false);
+
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+    ulorawan_region_fit_payload_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_FAIL);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_uplink_queue_count(&session.uplink_queue));
+    TEST_ASSERT_EQUAL_UINT32(1, session.uplink_queue.stats.dropped_size);
+}
+
+void test_ulorawan_uplink_dispatch_duty_cycle_deferred()
+{
+    // Arrange
+    queue_msg(false);
+
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+    ulorawan_region_fit_payload_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_fit_payload_ReturnThruPtr_dr(&fit_dr);
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_FAIL);
+    ulorawan_region_next_tx_time_ExpectAndReturn(&session.region_params, 1100);
+    timer_hal_start_ExpectAndReturn(TIMER0, 1000, TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+}
+
+void test_ulorawan_uplink_dispatch_no_channel()
+{
+    // Arrange
+    queue_msg(false);
+
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+    ulorawan_region_fit_payload_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_fit_payload_ReturnThruPtr_dr(&fit_dr);
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_FAIL);
+    ulorawan_region_next_tx_time_ExpectAndReturn(&session.region_params, 100);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NO_CHANNEL, result);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+}
+
+void test_ulorawan_uplink_dispatch_fcnt_error()
+{
+    // Arrange
+    queue_msg(false);
+
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+    ulorawan_region_fit_payload_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_fit_payload_ReturnThruPtr_dr(&fit_dr);
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_fcnt_reserve_ExpectAndReturn(&session, ULORAWAN_ERR_NVM);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NVM, result);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+    TEST_ASSERT_EQUAL_UINT32(0x00010002, session.keys.fcnt_up);
+}
+
+void test_ulorawan_uplink_dispatch_crypto_error()
+{
+    // Arrange
+    queue_msg(false);
+
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+    ulorawan_region_fit_payload_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_fit_payload_ReturnThruPtr_dr(&fit_dr);
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_fcnt_reserve_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    ulorawan_adr_uplink_ExpectAnyArgs();
+    ulorawan_crypto_payload_ExpectAnyArgsAndReturn(ULORAWAN_ERR_CMAC);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_CMAC, result);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+    TEST_ASSERT_EQUAL_UINT32(0x00010002, session.keys.fcnt_up);
+}
+
+void test_ulorawan_uplink_dispatch_success()
+{
+    // Arrange
+    const uint8_t frame[] = {0x80, 0xDA, 0x1B, 0x01, 0x26, 0x02, 0x02, 0x00,
+                             0x06, 0x3B, 0x0A, 0x01, 0x02, 0x03,
+                             0x11, 0x22, 0x33, 0x44};
+
+    session.cmds.answers[0] = 0x06;
+    session.cmds.answers[1] = 0x3B;
+    session.cmds.answers_size = 2;
+    queue_msg(true);
+
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+    ulorawan_region_fit_payload_ExpectAndReturn(&session.region_params,
+        7 + 2 + 1 + sizeof(payload), NULL, ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_fit_payload_IgnoreArg_dr();
+    ulorawan_region_fit_payload_ReturnThruPtr_dr(&fit_dr);
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_fcnt_reserve_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    ulorawan_adr_uplink_ExpectAnyArgs();
+    ulorawan_crypto_payload_ExpectAndReturn(session.keys.app_s_key,
+        ULORAWAN_CRYPTO_DIR_UP, 0x26011BDA, 0x00010002, &session.uplink.buf[11],
+        sizeof(payload), ULORAWAN_ERR_NONE);
+    ulorawan_crypto_mic_ExpectAndReturn(session.keys.nwk_s_key,
+        ULORAWAN_CRYPTO_DIR_UP, 0x26011BDA, 0x00010002, session.uplink.buf, 14,
+        NULL, ULORAWAN_ERR_NONE);
+    ulorawan_crypto_mic_IgnoreArg_msg();
+    ulorawan_crypto_mic_IgnoreArg_mic();
+    ulorawan_crypto_mic_ReturnThruPtr_mic(&mic);
+    ulorawan_retrans_start_Expect(&session, true, 5, 100);
+    ulorawan_cmds_clear_answers_Expect(&session);
+    ulorawan_tx_start_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(sizeof(frame), session.uplink.eof);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(frame, session.uplink.buf, sizeof(frame));
+    TEST_ASSERT_EQUAL_UINT32(0x00010003, session.keys.fcnt_up);
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_uplink_queue_count(&session.uplink_queue));
+    TEST_ASSERT_EQUAL_UINT32(1, session.uplink_queue.stats.sent);
+}
+
+void test_ulorawan_uplink_dispatch_mac_answers()
+{
+    // Arrange
+    const uint8_t header[] = {0x40, 0xDA, 0x1B, 0x01, 0x26, 0x00, 0x02, 0x00,
+                              0x00};
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        session.cmds.answers[i * 2] = 0x03;
+        session.cmds.answers[i * 2 + 1] = 0x07;
+    }
+    session.cmds.answers[16] = 0x04;
+    session.cmds.answers_size = 17;
+    queue_msg(false);
+
+    timer_hal_get_time_ExpectAndReturn(100);
+    ulorawan_aggregate_poll_ExpectAndReturn(&session, 100, 0);
+    ulorawan_region_fit_payload_ExpectAndReturn(&session.region_params,
+        7 + 1 + 17, NULL, ULORAWAN_REGION_ERR_NONE);
+    ulorawan_region_fit_payload_IgnoreArg_dr();
+    ulorawan_region_fit_payload_ReturnThruPtr_dr(&fit_dr);
+    ulorawan_region_get_channel_ExpectAnyArgsAndReturn(ULORAWAN_REGION_ERR_NONE);
+    ulorawan_fcnt_reserve_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+    ulorawan_adr_uplink_ExpectAnyArgs();
+    ulorawan_crypto_payload_ExpectAndReturn(session.keys.nwk_s_key,
+        ULORAWAN_CRYPTO_DIR_UP, 0x26011BDA, 0x00010002, &session.uplink.buf[9],
+        17, ULORAWAN_ERR_NONE);
+    ulorawan_crypto_mic_ExpectAndReturn(session.keys.nwk_s_key,
+        ULORAWAN_CRYPTO_DIR_UP, 0x26011BDA, 0x00010002, session.uplink.buf, 26,
+        NULL, ULORAWAN_ERR_NONE);
+    ulorawan_crypto_mic_IgnoreArg_msg();
+    ulorawan_crypto_mic_IgnoreArg_mic();
+    ulorawan_crypto_mic_ReturnThruPtr_mic(&mic);
+    ulorawan_retrans_start_Expect(&session, false, 5, 100);
+    ulorawan_cmds_clear_answers_Expect(&session);
+    ulorawan_tx_start_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL(sizeof(header) + 17 + 4, session.uplink.eof);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(header, session.uplink.buf, sizeof(header));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(session.cmds.answers,
+        &session.uplink.buf[sizeof(header)], 17);
+    TEST_ASSERT_EQUAL_UINT32(0x00010003, session.keys.fcnt_up);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+}
+
+void test_ulorawan_uplink_dispatch_retransmit_backoff()
+{
+    // Arrange
+    queue_msg(false);
+    session.retrans.active = 1;
+    session.retrans.next = 2500;
+
+    timer_hal_get_time_ExpectAndReturn(1000);
+    timer_hal_start_ExpectAndReturn(TIMER0, 1500, TIMER_HAL_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+}
+
+void test_ulorawan_uplink_dispatch_retransmit()
+{
+    // Arrange
+    queue_msg(false);
+    session.retrans.active = 1;
+    session.retrans.dr = 3;
+    session.retrans.next = 2500;
+
+    timer_hal_get_time_ExpectAndReturn(2600);
+    ulorawan_region_get_channel_ExpectAndReturn(&session.region_params,
+        &session.channel, ULORAWAN_REGION_ERR_NONE);
+    ulorawan_retrans_attempt_Expect(&session);
+    ulorawan_tx_start_ExpectAndReturn(&session, ULORAWAN_ERR_NONE);
+
+    // Act
+    int32_t result = ulorawan_uplink_dispatch(&session);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(5, session.region_params.data_rate);
+    TEST_ASSERT_EQUAL_UINT8(1, ulorawan_uplink_queue_count(&session.uplink_queue));
+    TEST_ASSERT_EQUAL_UINT32(0x00010002, session.keys.fcnt_up);
+}
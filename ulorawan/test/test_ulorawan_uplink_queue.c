@@ -0,0 +1,183 @@
+/**
+ * \file
+ *
+ * \brief 
+ *
+ * Copyright (c) 2023 Derek Goslin
+ *
+ * @author Derek Goslin
+ *
+ * \page License
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "unity.h"
+#include "ulorawan_uplink_queue.h"
+#include "ulorawan_error_codes.h"
+
+TEST_FILE("log_console.c")
+
+static struct ulorawan_uplink_queue queue;
+
+static int32_t push(uint8_t port, uint8_t priority, uint32_t lifetime,
+                    uint32_t now)
+{
+    const uint8_t payload[] = {port, priority};
+    struct ulorawan_uplink_req req = {.port = port,
+                                      .payload = payload,
+                                      .size = sizeof(payload),
+                                      .confirm = false,
+                                      .priority = priority,
+                                      .lifetime = lifetime};
+
+    return ulorawan_uplink_queue_push(&queue, &req, now);
+}
+
+void setUp(void)
+{
+    memset(&queue, 0, sizeof(queue));
+}
+
+void tearDown(void) {}
+
+void test_ulorawan_uplink_queue_empty()
+{
+    // Act & Assert
+    TEST_ASSERT_NULL(ulorawan_uplink_queue_peek(&queue));
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_uplink_queue_count(&queue));
+}
+
+void test_ulorawan_uplink_queue_push_too_large()
+{
+    // Arrange
+    uint8_t payload[ULORAWAN_UPLINK_MAX_PAYLOAD + 1];
+    struct ulorawan_uplink_req req = {.port = 1,
+                                      .payload = payload,
+                                      .size = sizeof(payload),
+                                      .priority = 1};
+
+    // Act
+    int32_t result = ulorawan_uplink_queue_push(&queue, &req, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_PARAMS, result);
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_uplink_queue_count(&queue));
+}
+
+void test_ulorawan_uplink_queue_priority_order()
+{
+    // Arrange
+    push(1, 10, 0, 0);
+    push(2, 20, 0, 0);
+    push(3, 10, 0, 0);
+    push(4, 30, 0, 0);
+
+    // Act & Assert
+    const uint8_t expected[] = {4, 2, 1, 3};
+
+    for (uint8_t i = 0; i < sizeof(expected); i++) {
+        struct ulorawan_uplink_msg *msg = ulorawan_uplink_queue_peek(&queue);
+        TEST_ASSERT_NOT_NULL(msg);
+        TEST_ASSERT_EQUAL_UINT8(expected[i], msg->port);
+        TEST_ASSERT_EQUAL_UINT8(expected[i], msg->payload[0]);
+        ulorawan_uplink_queue_pop(&queue);
+    }
+
+    TEST_ASSERT_NULL(ulorawan_uplink_queue_peek(&queue));
+    TEST_ASSERT_EQUAL_UINT32(4, queue.stats.queued);
+    TEST_ASSERT_EQUAL_UINT32(4, queue.stats.sent);
+    TEST_ASSERT_EQUAL_UINT8(4, queue.stats.high_water);
+}
+
+void test_ulorawan_uplink_queue_full()
+{
+    // Arrange
+    for (uint8_t i = 0; i < ULORAWAN_UPLINK_QUEUE_DEPTH; i++) {
+        push(i + 1, 10, 0, 0);
+    }
+
+    // Act
+    int32_t result = push(100, 10, 0, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_FULL, result);
+    TEST_ASSERT_EQUAL_UINT8(ULORAWAN_UPLINK_QUEUE_DEPTH,
+        ulorawan_uplink_queue_count(&queue));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats.dropped_full);
+}
+
+void test_ulorawan_uplink_queue_full_displaces_lower_priority()
+{
+    // Arrange
+    for (uint8_t i = 0; i < ULORAWAN_UPLINK_QUEUE_DEPTH; i++) {
+        push(i + 1, 10, 0, 0);
+    }
+
+    // Act
+    int32_t result = push(100, 20, 0, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_HEX8(ULORAWAN_ERR_NONE, result);
+    TEST_ASSERT_EQUAL_UINT8(100, ulorawan_uplink_queue_peek(&queue)->port);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats.dropped_full);
+
+    for (uint8_t i = 0; i < ULORAWAN_UPLINK_QUEUE_DEPTH; i++) {
+        ulorawan_uplink_queue_pop(&queue);
+    }
+
+    TEST_ASSERT_NULL(ulorawan_uplink_queue_peek(&queue));
+}
+
+void test_ulorawan_uplink_queue_expire()
+{
+    // Arrange
+    push(1, 10, 100, 0xFFFFFFF0);
+    push(2, 10, 0, 0xFFFFFFF0);
+    push(3, 10, 500, 0xFFFFFFF0);
+
+    // Act
+    uint8_t before = ulorawan_uplink_queue_expire(&queue, 0x00000050);
+    uint8_t after = ulorawan_uplink_queue_expire(&queue, 0x00000060);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, before);
+    TEST_ASSERT_EQUAL_UINT8(1, after);
+    TEST_ASSERT_EQUAL_UINT8(2, ulorawan_uplink_queue_count(&queue));
+    TEST_ASSERT_EQUAL_UINT8(2, ulorawan_uplink_queue_peek(&queue)->port);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats.dropped_expired);
+}
+
+void test_ulorawan_uplink_queue_drop()
+{
+    // Arrange
+    push(1, 10, 0, 0);
+
+    // Act
+    ulorawan_uplink_queue_drop(&queue);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT8(0, ulorawan_uplink_queue_count(&queue));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats.dropped_size);
+    TEST_ASSERT_EQUAL_UINT32(0, queue.stats.sent);
+}